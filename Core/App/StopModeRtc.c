@@ -2,28 +2,180 @@
 #include "rtc.h" // 确保引入了 RTC 硬件句柄 hrtc
 #include "main.h"
 #include "cmsis_os.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "power.h"
 
+// RTC 由 LSI 驱动, 预分频为 1/STOP_RTC_TICK_HZ 秒: 计数器 CNT 每 1/16 秒加 1, 分频计数器 DIV 在每个计数内
+// 从 STOP_RTC_DIV_PERIOD - 1 递减到 0
+#define STOP_RTC_DIV_PERIOD   (LSI_VALUE / STOP_RTC_TICK_HZ)
+// 一个内核节拍的 LSI 周期数
+#define STOP_RTC_LSI_PER_TICK (LSI_VALUE / configTICK_RATE_HZ)
 
-//extern void SystemClock_Config(void);
-// ==========================================
-// 设定 RTC 闹钟并进入 Stop 模式的终极函数
-// 参数 seconds: 你想深度睡眠多少秒
-// ==========================================
-void Enter_Deep_Stop_Mode_With_RTC(uint32_t seconds) 
-{
+// 闹钟至少设在当前计数之后这么多个计数: 写闹钟寄存器(等 RTOFF、进出配置模式)要几个 LSI 周期,
+// 只差一个计数时 DIV 可能正好回绕, 计数器越过闹钟值后闹钟就不会再触发
+#define STOP_ALARM_MIN_COUNTS 2U
+
+// STOP 唤醒延迟: 用 DWT 周期计数器从醒来一直量到第一个非空闲任务切入。
+// 时钟恢复之前内核跑在 HSI 上, 之后跑在恢复后的 SYSCLK 上, 两段分别按各自频率换算
+static volatile uint8_t stopWakePending; // 已经醒来, 还没有任务切入
+static uint32_t stopWakeCycles;          // 刚醒来时的 CYCCNT
+static uint32_t stopClockCycles;         // 时钟恢复完成时的 CYCCNT
+static uint32_t stopClockHz;             // 恢复后的 SYSCLK
+static TaskHandle_t stopIdleTask;
+static StopMode_WakeStats stopWakeStats;
+
+// 唤醒后等待时钟就绪的上限(DWT 周期数, 此时 SYSCLK 为 HSI)。调度器挂起、中断关闭时 HAL_GetTick 不走,
+// HAL_RCC_OscConfig 的超时永远不会到, 只能自己按周期计数限时
+#define STOP_HSE_TIMEOUT_CYCLES   (HSE_STARTUP_TIMEOUT * (HSI_VALUE / 1000U))
+#define STOP_PLL_TIMEOUT_CYCLES   (PLL_TIMEOUT_VALUE * (HSI_VALUE / 1000U))
+#define STOP_SWITCH_TIMEOUT_CYCLES 1000U
+// 唤醒后等待 RTC 影子寄存器重新同步(RSF)的上限: 正常两个 RTCCLK 周期(LSI 下约 50us)就会置位
+#define STOP_RSF_TIMEOUT_US       1000U
+
+/**
+ * @brief 读取 RTC: 计数器和本计数内已经过的 LSI 周期数
+ */
+static void StopMode_ReadRtc(uint32_t *counts, uint32_t *elapsed) {
+    uint32_t high, low, div;
+    // 读 DIV 的过程中计数器进位则重读, 保证三者属于同一个计数
+    do {
+        high = hrtc.Instance->CNTH;
+        low = hrtc.Instance->CNTL;
+        div = ((hrtc.Instance->DIVH & RTC_DIVH_RTC_DIV) << 16) | hrtc.Instance->DIVL;
+    } while (hrtc.Instance->CNTL != low || hrtc.Instance->CNTH != high);
+
+    *counts = (high << 16) | (low & 0xFFFFU);
+    *elapsed = div < STOP_RTC_DIV_PERIOD ? STOP_RTC_DIV_PERIOD - 1U - div : 0U;
+}
+
+/**
+ * @brief RTC 时间换算成节拍, 与 TickType_t 一样按 32 位回绕
+ */
+static uint32_t StopMode_RtcTicks(uint32_t counts, uint32_t elapsed) {
+    return (uint32_t) (((uint64_t) counts * STOP_RTC_DIV_PERIOD + elapsed) / STOP_RTC_LSI_PER_TICK);
+}
+
+void StopMode_Init(void) {
+    // 打开 DWT 周期计数器, 测量唤醒延迟
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0U;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    // 与闹钟寄存器一样在配置模式下写预分频寄存器, 新的预分频从下一个计数开始生效
+    while((hrtc.Instance->CRL & RTC_CRL_RTOFF) == (uint32_t)RESET) {}
+    hrtc.Instance->CRL |= RTC_CRL_CNF;
+    hrtc.Instance->PRLH = (STOP_RTC_DIV_PERIOD - 1U) >> 16;
+    hrtc.Instance->PRLL = (STOP_RTC_DIV_PERIOD - 1U) & 0xFFFFU;
+    hrtc.Instance->CRL &= ~RTC_CRL_CNF;
+    while((hrtc.Instance->CRL & RTC_CRL_RTOFF) == (uint32_t)RESET) {}
+}
+
+uint32_t StopMode_RtcSeconds(void) {
+    uint32_t counts, elapsed;
+    StopMode_ReadRtc(&counts, &elapsed);
+    return counts / STOP_RTC_TICK_HZ;
+}
+
+uint32_t StopMode_TicksToNextSecond(void) {
+    uint32_t counts, elapsed;
+    StopMode_ReadRtc(&counts, &elapsed);
+    const uint32_t inSecond = (counts % STOP_RTC_TICK_HZ) * STOP_RTC_DIV_PERIOD + elapsed;
+    return configTICK_RATE_HZ - inSecond / STOP_RTC_LSI_PER_TICK + STOP_WAKEUP_TICKS;
+}
+
+void StopMode_TaskSwitchedIn(void) {
+    if (!stopWakePending || xTaskGetCurrentTaskHandle() == stopIdleTask) {
+        return;
+    }
+    const uint32_t now = DWT->CYCCNT;
+    const uint32_t us = (stopClockCycles - stopWakeCycles) / (HSI_VALUE / 1000000U) +
+                        (now - stopClockCycles) / (stopClockHz / 1000000U);
+    stopWakePending = 0;
+
+    stopWakeStats.count++;
+    stopWakeStats.totalUs += us;
+    stopWakeStats.lastUs = us;
+    if (us > stopWakeStats.maxUs) {
+        stopWakeStats.maxUs = us;
+    }
+}
+
+void StopMode_GetWakeStats(StopMode_WakeStats *stats) {
+    taskENTER_CRITICAL();
+    *stats = stopWakeStats;
+    taskEXIT_CRITICAL();
+}
 
-    // 1. 获取当前的 RTC 时间
-    RTC_TimeTypeDef sTime = {0};
-    RTC_DateTypeDef sDate = {0}; // F1 虽然没有硬件日期，但 HAL 库流程需要读取清除标志
-    HAL_RTC_GetTime(&hrtc, &sTime, RTC_FORMAT_BIN);
-    HAL_RTC_GetDate(&hrtc, &sDate, RTC_FORMAT_BIN);
+/**
+ * @brief 等待寄存器中的状态位, 最多 cycles 个 DWT 周期
+ * @return 1 表示等到了, 0 表示超时
+ */
+static uint8_t StopMode_WaitBits(volatile uint32_t *reg, uint32_t mask, uint32_t value, uint32_t cycles) {
+    const uint32_t start = DWT->CYCCNT;
+    while ((*reg & mask) != value) {
+        if (DWT->CYCCNT - start > cycles) {
+            return 0;
+        }
+    }
+    return 1;
+}
 
-    // 2. 计算唤醒时间 (简单粗暴的秒数累加)
-    // 注意：如果是生产级代码，这里需要处理 60秒进位 到分钟、小时的复杂逻辑
-    // 为了快速验证，STM32F1 允许我们直接操作底层的 32 位计数器更方便：
-    uint32_t current_counter = hrtc.Instance->CNTL | (hrtc.Instance->CNTH << 16);
-    uint32_t alarm_counter = current_counter + seconds;
+/**
+ * @brief STOP 期间 APB1 接口停止, CNT/DIV 的影子寄存器可能还是睡前的旧值: 清除 RSF 并等它重新置位 (RM0008)
+ * @note 中断关闭时 HAL_GetTick 不走, HAL_RTC_WaitForSynchro 的超时永远不会到, 按 DWT 周期限时
+ * @return 1 表示已同步; 0 表示超时, 读到的 RTC 不可信
+ */
+static uint8_t StopMode_SyncRtc(void) {
+    hrtc.Instance->CRL &= ~RTC_CRL_RSF;
+    return StopMode_WaitBits(&hrtc.Instance->CRL, RTC_CRL_RSF, RTC_CRL_RSF,
+                             STOP_RSF_TIMEOUT_US * (SystemCoreClock / 1000000U));
+}
 
+/**
+ * @brief STOP 唤醒后恢复系统时钟
+ *
+ * STOP 模式保留全部寄存器和 SRAM, 唤醒后只有时钟回到复位状态: HSE 和 PLL 关闭, SYSCLK 切回 HSI 8MHz。
+ * 总线分频、Flash 等待周期、PLL 倍频和来源(CFGR)、TIM2 时基和 RTC/ADC 的时钟选择都还在, 因此只重新起振 HSE、
+ * 锁定 PLL, 再把 SYSCLK 切回 PLL; 不再像 SystemClock_Config 那样在 8MHz 下重复配置总线、重新初始化 TIM2 时基、
+ * 访问备份域配置 RTC 时钟。
+ * HSE 起振或 PLL 锁定超时则关掉它们留在 HSI 上: SystemCoreClock 和 HAL 时基随之改为 8MHz, 内核照常运行,
+ * 按 PCLK 配好的串口波特率等外设时序在复位前都不准; 之后的唤醒不再尝试 HSE
+ */
+static void StopMode_RestoreClocks(void) {
+    if (!stopWakeStats.hseFailed) {
+        RCC->CR |= RCC_CR_HSEON;
+        if (StopMode_WaitBits(&RCC->CR, RCC_CR_HSERDY, RCC_CR_HSERDY, STOP_HSE_TIMEOUT_CYCLES)) {
+            RCC->CR |= RCC_CR_PLLON;
+            if (StopMode_WaitBits(&RCC->CR, RCC_CR_PLLRDY, RCC_CR_PLLRDY, STOP_PLL_TIMEOUT_CYCLES)) {
+                // 总线分频和 Flash 等待周期在 STOP 中保持不变, 直接切换 SYSCLK, 几个时钟周期内完成
+                __HAL_RCC_SYSCLK_CONFIG(RCC_SYSCLKSOURCE_PLLCLK);
+                if (StopMode_WaitBits(&RCC->CFGR, RCC_CFGR_SWS, RCC_SYSCLKSOURCE_STATUS_PLLCLK,
+                                      STOP_SWITCH_TIMEOUT_CYCLES)) {
+                    return;
+                }
+            }
+        }
+        stopWakeStats.hseFailed = 1;
+    }
+
+    // 留在 HSI 上
+    __HAL_RCC_SYSCLK_CONFIG(RCC_SYSCLKSOURCE_HSI);
+    RCC->CR &= ~(RCC_CR_PLLON | RCC_CR_HSEON);
+    if (SystemCoreClock != HSI_VALUE) {
+        SystemCoreClock = HSI_VALUE;
+        HAL_InitTick(uwTickPrio); // TIM2 时基按新的 PCLK1 重新分频
+    }
+}
+
+// ==========================================
+// 设定 RTC 闹钟并进入 Stop 模式
+// 参数 alarm_counter: RTC 计数器到达这个值时唤醒
+// 返回: 1 表示进入过 Stop 模式; 写完闹钟时计数器已经到了闹钟值则不进入, 返回 0
+// 醒来后 RTC 的影子寄存器还没有重新同步, 由调用者 StopMode_SyncRtc 之后再读
+// ==========================================
+static uint8_t Enter_Deep_Stop_Mode_Until(uint32_t alarm_counter)
+{
     HAL_PWR_EnableBkUpAccess(); // 允许访问备份域
 
     // ==========================================
@@ -45,36 +197,106 @@ void Enter_Deep_Stop_Mode_With_RTC(uint32_t seconds)
 
     // 5. 再次等待写操作物理生效
     while((hrtc.Instance->CRL & RTC_CRL_RTOFF) == (uint32_t)RESET) {}
-    
+
+    // 写的过程中计数器已经到了闹钟值: 闹钟不会再触发, 不能进入 Stop 模式 (否则只有按键能唤醒)
+    uint32_t counts, elapsed;
+    StopMode_ReadRtc(&counts, &elapsed);
+    if ((int32_t)(alarm_counter - counts) <= 0) {
+        return 0;
+    }
+
     // 3. 使能 RTC 闹钟中断 (EXTI Line 17)
     hrtc.Instance->CRH |= RTC_CRH_ALRIE; // F1 专属：暴力开启 RTC 闹钟中断允许位
     __HAL_RTC_ALARM_EXTI_ENABLE_IT();
     __HAL_RTC_ALARM_EXTI_ENABLE_RISING_EDGE();
 
-    // 4. 睡前准备：关闭无关外设，暂停 SysTick
-    // OLED_Display_Off(); 
-    HAL_SuspendTick(); 
+    // 4. 睡前准备：关闭无关外设，暂停 HAL 时基 (SysTick 已由调用者停止)
+    HAL_SuspendTick();
     HAL_GPIO_WritePin(GPIOB, GPIO_PIN_5, GPIO_PIN_RESET); // 亮红灯：代表彻底死睡了
 
     // 5. 拔掉主时钟电源，进入深寒 (Stop 模式)！
     HAL_PWR_EnterSTOPMode(PWR_LOWPOWERREGULATOR_ON, PWR_STOPENTRY_WFI);
+    stopWakeCycles = DWT->CYCCNT;
 
     // ==========================================
     // 漫长的等待... 此时整板电流低至微安级
-    // 闹钟时间到 -> 触发中断 -> 瞬间苏醒！
+    // 闹钟时间到或按键按下 -> EXTI 挂起 -> 瞬间苏醒！
     // ==========================================
 
-    // 6. 醒来第一件事：重新启动 72MHz 高速心脏！
-    SystemClock_Config();
+    // 6. 醒来第一件事：重新启动 72MHz 高速心脏！(只恢复 STOP 丢失的时钟)
+    StopMode_RestoreClocks();
+    stopClockCycles = DWT->CYCCNT;
+    stopClockHz = SystemCoreClock;
 
-    // 7. 恢复滴答定时器
+    // 7. 恢复 HAL 时基
     HAL_ResumeTick();
-    
-    // 8. 唤醒外设
-    // OLED_Display_On();
+
     HAL_GPIO_WritePin(GPIOB, GPIO_PIN_5, GPIO_PIN_SET); // 灭红灯：代表醒来干活了
-    
+
     // 清除闹钟中断标志，为下一次睡眠做准备
     __HAL_RTC_ALARM_EXTI_CLEAR_FLAG();
     hrtc.Instance->CRL &= ~RTC_CRL_ALRF; // F1 专属：暴力清除 RTC 闹钟触发标志位
-}
\ No newline at end of file
+
+    // 醒来后空闲任务可能还要再转几圈(闹钟比任务解除阻塞提前 STOP_WAKEUP_TICKS 个节拍),
+    // 记下的时刻一直保留到第一个非空闲任务切入, 或者被下一次唤醒覆盖
+    stopIdleTask = xTaskGetCurrentTaskHandle();
+    stopWakePending = 1;
+    return 1;
+}
+
+/**
+ * @brief 无节拍空闲: 所有任务阻塞超过 xExpectedIdleTime 个节拍时由空闲任务调用(调度器已挂起)
+ *
+ * 内核的延时任务列表和软件定时器列表就是按时间排好序的唤醒时刻(传感器采集、蜂鸣器翻转、屏幕闪烁、遥测批量发送),
+ * xExpectedIdleTime 是其中最近的一个; 闹钟设在它之前的最后一个 RTC 计数(1/16 秒)上
+ */
+void vPortSuppressTicksAndSleep(TickType_t xExpectedIdleTime)
+{
+    uint32_t counts, elapsed;
+
+    // 关中断期间挂起的中断仍能把 WFI/STOP 唤醒, 醒来后恢复完时钟才执行中断服务函数
+    __disable_irq();
+    StopMode_ReadRtc(&counts, &elapsed);
+    if (eTaskConfirmSleepModeStatus() == eAbortSleep) {
+        __enable_irq();
+        return;
+    }
+
+    // 睡眠时长从这次读到的 RTC 时刻算起, 醒来后按 RTC 走过的时间补节拍。
+    // 醒着时内核节拍由 SysTick(HSE)计时, 与 LSI 驱动的 RTC 有频差, 每次睡眠都重新以 RTC 为起点, 误差不会累积
+    const uint32_t rtcBefore = StopMode_RtcTicks(counts, elapsed);
+
+    // 睡到下一个任务解除阻塞之前 STOP_WAKEUP_TICKS 个节拍
+    const int64_t sleepTicks = (int64_t) xExpectedIdleTime - STOP_WAKEUP_TICKS;
+    const uint32_t sleepCounts =
+        sleepTicks > 0 ? (uint32_t) ((elapsed + (uint64_t) sleepTicks * STOP_RTC_LSI_PER_TICK) / STOP_RTC_DIV_PERIOD)
+                       : 0U;
+
+    // 闹钟离现在不到 STOP_ALARM_MIN_COUNTS 个计数(约 1/8 秒), 或者还有传输在进行(睡眠屏障未全部置位,
+    // STOP 会截断传输): 只进入 Sleep 模式, 等下一个节拍或完成中断
+    if (sleepCounts < STOP_ALARM_MIN_COUNTS || !Power_IsIdle()) {
+        __WFI();
+        __enable_irq();
+        return;
+    }
+
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+    const uint8_t stopped = Enter_Deep_Stop_Mode_Until(counts + sleepCounts);
+
+    // 按 RTC 补上 SysTick 停止期间的节拍(没有进入 STOP 时只有写闹钟的几十微秒); 按键提前唤醒时同样按实际时间补。
+    // 进入过 STOP 而 RTC 没能重新同步时读到的还是睡前的值, 不补节拍, 宁可内核时间落后也不按错误的读数跳
+    if (!stopped || StopMode_SyncRtc()) {
+        StopMode_ReadRtc(&counts, &elapsed);
+        TickType_t step = StopMode_RtcTicks(counts, elapsed) - rtcBefore;
+        if (step > xExpectedIdleTime) {
+            step = xExpectedIdleTime; // 不能越过下一个任务解除阻塞的时刻
+        }
+        vTaskStepTick(step);
+    }
+
+    // 时钟退回 HSI 时 SysTick 的重装值也要跟着改
+    SysTick->LOAD = SystemCoreClock / configTICK_RATE_HZ - 1U;
+    SysTick->VAL = 0U;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+    __enable_irq();
+}
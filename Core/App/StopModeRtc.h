@@ -3,9 +3,67 @@
 //
 #include <stdint.h>
 #ifndef SMARTFRAMZET6_STOPMODERTC_H
+#define SMARTFRAMZET6_STOPMODERTC_H
 
-void Enter_Deep_Stop_Mode_With_RTC(uint32_t seconds);
+/**
+ * @file StopModeRtc.h
+ * @brief FreeRTOS 无节拍空闲(configUSE_TICKLESS_IDLE = 2)的 STOP 模式实现
+ *
+ * 所有任务都阻塞时, 空闲任务调用 vPortSuppressTicksAndSleep(xExpectedIdleTime):
+ * - 睡眠屏障(power.h)还有子系统未空闲, 或者离最近的唤醒时刻不到两个 RTC 计数时只执行 WFI(Sleep 模式),
+ *   SysTick 照常运行
+ * - 否则停止 SysTick, 把 RTC 闹钟设在下一个任务解除阻塞之前最后一个 RTC 计数(1/16 秒)上, 进入 STOP 模式
+ * - 被闹钟或按键 EXTI 唤醒后只恢复 STOP 丢失的时钟(HSE、PLL、SYSCLK 切换), 按 RTC 计数器和分频计数器(DIV)
+ *   重新对齐内核节拍数(vTaskStepTick)
+ * 唤醒时刻由内核的延时任务列表和软件定时器列表决定, 任务只需要阻塞, 不再由 SensorTask 自己决定何时睡眠。
+ *
+ * RTC 计数器按 1/16 秒计数(StopMode_Init 设置预分频), 时间戳用 StopMode_RtcSeconds 换算成秒。
+ * 闹钟之后到任务解除阻塞之间最多还有一个计数在 Sleep 模式中度过, 周期性任务可以用 StopMode_TicksToNextSecond()
+ * 把唤醒时刻对齐到 RTC 秒边界之后, 整段等待都在 STOP 模式中
+ */
 
-#define SMARTFRAMZET6_STOPMODERTC_H
+// RTC 计数频率: 闹钟的分辨率为 1/16 秒
+#define STOP_RTC_TICK_HZ 16U
+
+// STOP 唤醒后重新起振 HSE、锁定 PLL 所需的节拍数, 闹钟要比任务解除阻塞的时刻至少提前这么多
+#define STOP_WAKEUP_TICKS 2U
+
+/**
+ * @brief 把 RTC 预分频设为 1/STOP_RTC_TICK_HZ 秒, 在 MX_RTC_Init 之后、调度器启动之前调用
+ * @note 之后 HAL_RTC_GetTime/SetTime 把计数器当作秒, 不能再用, 时间统一通过 StopMode_RtcSeconds 读取
+ */
+void StopMode_Init(void);
+
+/**
+ * @brief RTC 时间(秒), STOP 模式中继续计数
+ */
+uint32_t StopMode_RtcSeconds(void);
+
+/**
+ * @brief 到下一个 RTC 秒边界之后、唤醒恢复完成时的节拍数
+ * @note 周期性任务以此作为 osDelay 的参数, 醒来的时刻正好落在 RTC 闹钟之后
+ */
+uint32_t StopMode_TicksToNextSecond(void);
+
+/**
+ * @brief STOP 唤醒到第一个非空闲任务开始执行的延迟统计(DWT 周期计数器测量)
+ */
+typedef struct {
+    uint32_t count;   // 统计到的唤醒次数(醒来后又进入 STOP、没有任务执行的不计)
+    uint32_t lastUs;  // 最近一次的延迟
+    uint32_t maxUs;   // 最大延迟
+    uint64_t totalUs; // 累计延迟, 除以 count 得到平均值
+    uint8_t hseFailed;    // 唤醒后 HSE/PLL 超时, 已退回 HSI 运行
+} StopMode_WakeStats;
+
+/**
+ * @brief traceTASK_SWITCHED_IN 钩子(FreeRTOSConfig.h), 在任务切换中调用
+ */
+void StopMode_TaskSwitchedIn(void);
+
+/**
+ * @brief 读取唤醒延迟统计
+ */
+void StopMode_GetWakeStats(StopMode_WakeStats *stats);
 
-#endif //SMARTFRAMZET6_STOPMODERTC_H
\ No newline at end of file
+#endif //SMARTFRAMZET6_STOPMODERTC_H
@@ -11,13 +11,44 @@
  * - 使用FreeRTOS软件定时器，周期为500ms
  * - 定时器回调函数在每次触发时切换蜂鸣器状态（开/关）
  * - 实现周期性响铃效果（500ms开，500ms关）
+ * - beep_state 和睡眠屏障的 POWER_BEEP 位只在定时器服务任务中修改：Beep_off 不直接关断，
+ *   而是把关断函数挂到定时器命令队列上，与回调串行执行，不会和执行到一半的回调交错
  *
  * @note 使用TIM4的PWM通道4控制蜂鸣器
  */
 
 #include "cmsis_os2.h"
+#include "FreeRTOS.h"
 #include "main.h"
+#include "power.h"
 #include "tim.h"
+#include "timers.h"
+
+// Beep_off 等待定时器命令队列空位的上限
+#define BEEP_CMD_WAIT_MS 10U
+
+static uint8_t beep_state = 0;    // 蜂鸣器状态：0-关闭，1-开启（只在定时器服务任务中修改）
+static uint8_t beep_enabled = 0;  // 报警要求响铃（只在SensorTask中修改）
+
+/**
+ * @brief 睡眠屏障的空闲检查：PWM停止时才能进入STOP模式（STOP中TIM3停振，蜂鸣器会哑掉）
+ */
+static uint8_t Beep_IsIdle(void) {
+    return beep_state == 0;
+}
+
+/**
+ * @brief 关闭PWM输出并通知睡眠屏障
+ * @note 在定时器服务任务中执行
+ */
+static void Beep_Silence(void *param, uint32_t value) {
+    (void) param;
+    (void) value;
+    HAL_TIM_PWM_Stop(&htim3, TIM_CHANNEL_1);
+    __HAL_TIM_SET_COMPARE(&htim3, TIM_CHANNEL_1, 0);
+    beep_state = 0;
+    Power_Idle(POWER_BEEP, Beep_IsIdle);
+}
 
 /**
  * @brief 启动蜂鸣器
@@ -28,6 +59,7 @@
  * @note 由SensorTask在检测到报警时调用
  */
 void Beep_on(void) {
+    beep_enabled = 1;
     // 启动软件定时器，周期500ms（周期性定时器）
     osTimerStart(BeepTimerHandle, 500);
 }
@@ -35,17 +67,25 @@ void Beep_on(void) {
 /**
  * @brief 停止蜂鸣器
  *
- * 停止软件定时器，并立即关闭蜂鸣器PWM输出
+ * 停止软件定时器，并关闭蜂鸣器PWM输出
  *
- * @note 由SensorTask在无报警时调用
+ * @note
+ * - 由SensorTask在无报警时调用，已经停止时直接返回
+ * - SensorTask优先级高于定时器服务任务，返回时回调可能正执行到一半；
+ *   关断放在停止命令之后进入同一个命令队列，等回调返回后才执行
+ * - 命令队列满时最多等 BEEP_CMD_WAIT_MS；仍然送不进去就保持 beep_enabled，下一次调用时重试
  */
 void Beep_off(void) {
-    // 停止软件定时器
-    osTimerStop(BeepTimerHandle);
+    if (!beep_enabled) {
+        return;
+    }
+    beep_enabled = 0;
 
-    // 停止PWM输出并设置占空比为0
-    HAL_TIM_PWM_Stop(&htim3, TIM_CHANNEL_1);
-    __HAL_TIM_SET_COMPARE(&htim3, TIM_CHANNEL_1, 0);
+    // 停止命令送不进去时定时器还在运行，回调照常开关PWM，不挂关断函数（会被下一次回调重新开启）
+    if (xTimerStop((TimerHandle_t) BeepTimerHandle, pdMS_TO_TICKS(BEEP_CMD_WAIT_MS)) != pdPASS ||
+        xTimerPendFunctionCall(Beep_Silence, NULL, 0, pdMS_TO_TICKS(BEEP_CMD_WAIT_MS)) != pdPASS) {
+        beep_enabled = 1;
+    }
 }
 
 /**
@@ -63,14 +103,18 @@ void Beep_off(void) {
  *
  * @note
  * - 使用静态变量beep_state保持状态（在函数调用之间保持）
+ * - 报警已解除（beep_enabled为0）时不再开启，只停止定时器
+ * - 响铃的半个周期里清除睡眠屏障的POWER_BEEP位，只进入Sleep模式
  * - 占空比设置为100，可根据需要调整音量
  * - 定时器周期为500ms，实现500ms开、500ms关的周期性响铃
  */
 void BeepTimerCallback(void *argument){
-    static uint8_t beep_state = 0;  // 蜂鸣器状态：0-关闭，1-开启（静态变量保持状态）
-
-    if(beep_state == 0){
+    if(!beep_enabled){
+        // 停止命令之前已在队列中的到期回调，关断由随后的 Beep_Silence 完成
+        osTimerStop(BeepTimerHandle);
+    }else if(beep_state == 0){
         // 状态0：开启蜂鸣器
+        Power_Busy(POWER_BEEP);
         HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_1);  // 启动PWM输出
         __HAL_TIM_SET_COMPARE(&htim3, TIM_CHANNEL_1, 250);  // 设置占空比（音量）
         beep_state = 1;  // 切换到开启状态
@@ -79,5 +123,6 @@ void BeepTimerCallback(void *argument){
         HAL_TIM_PWM_Stop(&htim3, TIM_CHANNEL_1);  // 停止PWM输出
         __HAL_TIM_SET_COMPARE(&htim3, TIM_CHANNEL_1, 0);  // 设置占空比为0
         beep_state = 0;  // 切换到关闭状态
+        Power_Idle(POWER_BEEP, Beep_IsIdle);
     }
 }
\ No newline at end of file
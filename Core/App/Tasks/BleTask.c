@@ -3,75 +3,111 @@
  * @brief 蓝牙通信任务
  *
  * 本任务负责：
- * 1. 从BLE队列接收报警消息
- * 2. 通过UART3（DMA方式）发送消息到蓝牙模块
- * 3. 等待发送完成后释放消息内存
+ * 1. 从BLE队列接收报警消息和周期快照
+ * 2. 按TELEMETRY_FORMAT把消息编码成二进制帧或JSON文本（telemetry.h）
+ * 3. 写入UART2的DMA发送环形缓冲区（ble_uart.h），由DMA中断依次发给蓝牙模块
+ * 4. 写入后立即把消息块还给蓝牙消息池，不等待发送完成
+ * 5. 一次唤醒取完队列中的全部消息后才启动发送，同一次采集产生的报警和快照在串口上连续发出，
+ *    蓝牙模块每个周期只忙一次
  *
  * 任务优先级：osPriorityLow（低优先级，不影响实时性要求高的任务）
- * 任务阻塞：使用osWaitForever等待队列消息，有消息时才执行
+ * 任务阻塞：使用osWaitForever等待队列消息，有消息时才执行；环形缓冲区满时挂起等待DMA中断通知
  *
- * 消息格式：
- * JSON格式的字符串，例如：{"type":"warning", "reason":"temperature_high", "value":35.5}
+ * 消息格式（见telemetry.h）：
+ * - 二进制帧（默认）：COBS编码，以0x00分隔，一条报警15字节，主机端用Host/Tools/telemetry_decode解码
+ * - JSON：每条以换行结尾，例如：{"type":"warning", "reason":"temperature_high", "event":"raised", "value":35.5, "time":1234}\n
+ * - 快照（TELEMETRY_SNAPSHOT）：FarmState的全部字段，二进制帧28字节
+ * 消息在线上首尾相接连续发出，接收方按分隔符分割
  *
  * @note
- * - 消息由SensorTask通过pvPortMalloc分配内存创建
- * - 本任务负责在发送完成后使用vPortFree释放内存
- * - 使用DMA方式发送，提高效率
+ * - 消息（Telemetry_Message）由SensorTask从蓝牙消息池（bleMsgPool，静态分配的定长块）分配并填写
+ * - 本任务负责在写入环形缓冲区后使用BlockPool_Free释放消息块
+ * - 多条消息可以同时在环形缓冲区中排队，DMA连续发送，任务不轮询串口状态
+ * - 睡眠屏障（power.h）的POWER_BLE_TX位由SensorTask入队时清除，队列取空、这一批写完且环形缓冲区发完时置位；
+ *   空闲检查直接看队列深度，不另设由两个任务增减的计数
  */
 
 #include "cmsis_os2.h"
 #include "main.h"
-#include "stm32f1xx_hal_uart.h"
-#include "usart.h"
 #include <stdio.h>
 #include <string.h>
-#include "freertos.h"
+#include "FreeRTOS.h"
 #include "farmState.h"
+#include "ble_uart.h"
+#include "power.h"
+#include "telemetry.h"
+
+// 本任务正在编码、写入一批消息（只在本任务中修改）：这时消息已出队但还没进环形缓冲区
+static volatile uint8_t bleBatchActive = 0;
+
+/**
+ * @brief 队列中没有消息、没有正在写入的一批且环形缓冲区已发完，POWER_BLE_TX的空闲检查
+ */
+static uint8_t BleTask_IsIdle(void) {
+    return osMessageQueueGetCount(BLEQueueHandle) == 0 && !bleBatchActive && BleUart_IsIdle();
+}
+
+/**
+ * @brief 环形缓冲区发完（USART2中断上下文），请求置位POWER_BLE_TX
+ */
+void BleUart_TxIdleCallback(void) {
+    Power_IdleFromISR(POWER_BLE_TX, BleTask_IsIdle);
+}
 
 /**
  * @brief 蓝牙通信任务主函数
  *
  * 任务执行流程：
  * 1. 从BLE队列阻塞等待消息（队列为空时任务挂起）
- * 2. 收到消息后，通过UART3（DMA方式）发送到蓝牙模块
- * 3. 等待DMA发送完成（轮询UART状态）
- * 4. 释放消息内存（使用vPortFree）
- * 5. 继续等待下一条消息
+ * 2. 收到消息后编码，追加到发送环形缓冲区（暂不启动DMA）
+ * 3. 释放消息块（使用BlockPool_Free）
+ * 4. 不等待地取队列中的下一条消息，重复2、3直到队列取空
+ * 5. 启动DMA把这一批消息一次发出，继续等待下一批
  *
  * @param argument 任务参数（未使用）
  *
  * @note
  * - 使用osWaitForever阻塞等待，队列为空时任务挂起，不占用CPU
- * - 消息指针存储在队列中，实际消息内容在FreeRTOS堆中
- * - 使用DMA发送可以提高效率，避免阻塞CPU
- * - 必须等待发送完成后再释放内存，否则可能导致数据损坏
+ * - 消息指针存储在队列中，实际消息内容在蓝牙消息池的块中
+ * - 环形缓冲区满时BleUart_Write挂起本任务，DMA腾出空间后由中断唤醒
  */
 void StartBLETask(void *argument) {
     // 主循环：持续处理队列中的消息
     for (;;) {
-        char *msg;
+        Telemetry_Message *msg;
+#if TELEMETRY_FORMAT == TELEMETRY_FORMAT_JSON
+        char encoded[TELEMETRY_JSON_MAX];
+#else
+        uint8_t encoded[TELEMETRY_FRAME_MAX];
+#endif
 
         // 从BLE队列阻塞等待消息（队列为空时任务挂起，等待时间无限）
         osMessageQueueGet(BLEQueueHandle, &msg, NULL, osWaitForever);
+        // 上一批的发送完成中断可能刚在取走消息之后置位了POWER_BLE_TX，重新清除
+        bleBatchActive = 1;
+        Power_Busy(POWER_BLE_TX);
 
-        if (msg != NULL) {
-             // 通过UART2使用DMA方式发送消息到蓝牙模块
-             HAL_UART_Transmit_DMA(&huart2, (uint8_t *)msg, strlen(msg));
+        // SensorTask优先级更高，本任务运行时这一次采集的消息都已入队，取空队列就是一整批
+        do {
+            if (msg == NULL) {
+                continue;
+            }
+            // 编码后复制进环形缓冲区，消息块就可以释放，DMA直接从环形缓冲区发送
+#if TELEMETRY_FORMAT == TELEMETRY_FORMAT_JSON
+            const uint16_t len = Telemetry_FormatJson(msg, encoded, sizeof(encoded));
+#else
+            const uint16_t len = Telemetry_EncodeFrame(msg, encoded, sizeof(encoded));
+#endif
+            BleUart_Append(encoded, len, osWaitForever);
 
-             // 等待DMA发送完成（轮询UART状态，直到发送完成）
-             while (1) {
-                 if (HAL_UART_GetState(&huart2) == HAL_UART_STATE_READY) {
-                     break; // UART状态为READY表示发送完成
-                 }
-                 osDelay(1); // 延时1ms后继续检查
-             }
+            // 把消息块还给消息池（消息由SensorTask从bleMsgPool分配）
+            BlockPool_Free(&bleMsgPool, msg);
+        } while (osMessageQueueGet(BLEQueueHandle, &msg, NULL, 0) == osOK);
 
-            // 发送完成后，释放消息内存（消息由SensorTask使用pvPortMalloc分配）
-            vPortFree(msg);
-            // 【核心改造】：活干完了，待办任务 -1
-            if (ble_pending_msgs > 0) {
-                ble_pending_msgs--;
-            }
-        }
+        // 这一批全部写入后只启动一次DMA
+        BleUart_Flush();
+        bleBatchActive = 0;
+        // 一般由发送完成中断置位；这一批没有写入任何数据时（例如编码失败）在这里置位
+        Power_Idle(POWER_BLE_TX, BleTask_IsIdle);
     }
-}
\ No newline at end of file
+}
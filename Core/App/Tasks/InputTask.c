@@ -5,14 +5,14 @@
  * 本任务负责：
  * 1. 检测按键输入（KEY1、KEY3）
  * 2. 检测旋钮旋转方向
- * 3. 根据输入控制页面切换和阈值编辑
+ * 3. 根据输入控制页面切换和阈值编辑，并请求ScreenTask刷新屏幕
  *
  * 任务优先级：osPriorityHigh（高优先级，保证用户输入响应及时）
  * 任务周期：10ms（快速响应）
  *
  * 用户交互逻辑：
  * - KEY1：切换页面（首页 <-> 阈值设置页）
- * - KEY3：在阈值设置页中，切换浏览/编辑模式
+ * - KEY3：在阈值设置页中，切换浏览/编辑模式；在历史曲线页中，切换时间分辨率（秒/分钟/小时）
  * - 旋钮左旋/右旋：
  *   - 浏览模式：切换选中的阈值项
  *   - 编辑模式：减小/增大当前选中项的值
@@ -23,8 +23,16 @@
 #include "global/screen.h"
 #include "key.h"
 #include "knob.h"
+#include "power.h"
 #include <stdint.h>
 
+/**
+ * @brief 睡眠屏障的空闲检查：离开阈值设置页后旋钮不再使用，STOP模式中TIM4停止计数也没关系
+ */
+static uint8_t Input_KnobIsIdle(void) {
+  return pageIndex != PAGE_RANGE;
+}
+
 /**
  * @brief 编辑阈值数值
  *
@@ -40,6 +48,7 @@
  * @note
  * - 浮点数类型（温度、湿度）每次调整0.1
  * - 整数类型（土壤湿度、光照、降雨量）每次调整1
+ * - 修改后的阈值防抖保存到Flash（见EnvSafeRange_Save），重启后保留
  */
 void EditRangeValue(RangeEditIndex index, int8_t direction) {
   switch (index) {
@@ -117,6 +126,9 @@ void EditRangeValue(RangeEditIndex index, int8_t direction) {
   default:
     break;
   }
+
+  // 只记录修改时刻，停止转动一段时间后由SensorTask一次写入Flash
+  EnvSafeRange_Changed();
 }
 
 /**
@@ -126,6 +138,7 @@ void EditRangeValue(RangeEditIndex index, int8_t direction) {
  * 1. 初始化旋钮（按键通过GPIO中断处理，无需初始化）
  * 2. 进入主循环：
  *    - 检测KEY1按下：切换页面
+ *    - 在历史曲线页时：检测KEY3按下：切换时间分辨率
  *    - 在阈值设置页时：
  *      * 检测KEY3按下：切换浏览/编辑模式
  *      * 检测旋钮旋转：
@@ -151,6 +164,13 @@ void StartInputTask(void *argument) {
     // 如果在其他页面，旋钮无效，直接进入 osWaitForever 深度死睡，直到 EXTI 中断把它踹醒！
     uint32_t waitTime = (pageIndex == PAGE_RANGE) ? 50 : osWaitForever;
 
+    // 设置页上旋钮的脉冲由 TIM4 计数，STOP 模式会丢掉这期间的转动：不允许进入 STOP
+    if (pageIndex == PAGE_RANGE) {
+      Power_Busy(POWER_KNOB);
+    } else {
+      Power_Idle(POWER_KNOB, Input_KnobIsIdle);
+    }
+
     // 任务在这里挂起等待：
     // 1. 要么被按键的 EXTI 中断（信号量）瞬间叫醒
     // 2. 要么 50ms 超时自然醒（仅限设置页）
@@ -169,6 +189,7 @@ void StartInputTask(void *argument) {
       if (HAL_GPIO_ReadPin(GPIOE, GPIO_PIN_4) == GPIO_PIN_RESET) {
 
         ScreenPage_NextPage(); // 执行翻页
+        Screen_Notify(SCREEN_EVENT_INPUT);
 
         // 【核心防连按机制】：死等用户松开手指！
         // 只要引脚还是低电平，就在这里转圈，并且交出 CPU 避免卡死其他任务
@@ -196,6 +217,7 @@ void StartInputTask(void *argument) {
         if (HAL_GPIO_ReadPin(GPIOE, GPIO_PIN_3) == GPIO_PIN_RESET) {
 
           RangeEditState_Toggle(); // 切换编辑模式
+          Screen_Notify(SCREEN_EVENT_INPUT);
 
           // 死等用户松手
           while(HAL_GPIO_ReadPin(GPIOE, GPIO_PIN_3) == GPIO_PIN_RESET) {
@@ -222,6 +244,29 @@ void StartInputTask(void *argument) {
           EditRangeValue(rangeEditIndex, 1);  // 右旋：增大值
         }
       }
+
+      // 旋钮动作会改变选中项或阈值，请求刷新屏幕
+      if (direction == KNOB_DIR_LEFT || direction == KNOB_DIR_RIGHT) {
+        Screen_Notify(SCREEN_EVENT_INPUT);
+      }
+    } else if (SCREEN_IS_HISTORY_PAGE(pageIndex)) {
+
+      // ==========================================
+      // 3. 历史曲线页：KEY3 切换时间分辨率（秒/分钟/小时）
+      // ==========================================
+      if (HAL_GPIO_ReadPin(GPIOE, GPIO_PIN_3) == GPIO_PIN_RESET) {
+        osDelay(20);
+        if (HAL_GPIO_ReadPin(GPIOE, GPIO_PIN_3) == GPIO_PIN_RESET) {
+
+          HistoryTier_Next();
+          Screen_Notify(SCREEN_EVENT_INPUT);
+
+          // 死等用户松手
+          while(HAL_GPIO_ReadPin(GPIOE, GPIO_PIN_3) == GPIO_PIN_RESET) {
+            osDelay(10);
+          }
+        }
+      }
     }
 
     // 延时10ms后继续下一次输入检测
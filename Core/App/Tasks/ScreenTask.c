@@ -5,16 +5,18 @@
  * 本任务负责：
  * 1. 初始化OLED显示屏
  * 2. 根据当前页面索引渲染相应的界面
- * 3. 定期刷新显示内容
+ * 3. 收到刷新请求（Screen_Notify）时刷新显示内容
  *
  * 任务优先级：osPriorityBelowNormal5（低优先级，不影响实时性要求高的任务）
- * 任务周期：10ms（保证显示流畅）
+ * 任务周期：无固定周期，由SensorTask/InputTask/闪烁定时器的刷新请求驱动，最高SCREEN_MAX_FPS帧每秒
  *
  * 显示页面：
  * - 首页（PAGE_HOME）：显示当前环境状态数据
  * - 阈值设置页（PAGE_RANGE）：显示和编辑报警阈值
+ * - 历史曲线页（PAGE_HISTORY_xxx）：土壤、降雨、光照、温度、湿度、气压的历史曲线，
+ *   时间分辨率（秒/分钟/小时）由KEY3切换
  *
- * @note 使用i2c1Mutex互斥锁保护I2C1总线，因为OLED和AHT20共享I2C1
+ * @note OLED与AHT20、BMP280共享I2C2，由i2c_bus传输队列串行化
  */
 
 #include "font.h"
@@ -22,6 +24,7 @@
 #include "cmsis_os.h"
 #include "global/farmState.h"
 #include "global/screen.h"
+#include "global/power.h"
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
@@ -45,6 +48,45 @@
    const uint8_t len = strlen(str);
    return x - (len * width) / 2;
  }
+// 各页面的静态图层：标题栏和标签只在第一次显示时绘制，之后每帧直接复制
+OLED_LAYER(home1Layer, 0, 7);  // 标题栏和两行标签位于第0-6页
+OLED_LAYER(home2Layer, 0, 8);  // "气压"位于第6-7页
+OLED_LAYER(range1Layer, 0, 2); // 阈值设置页只有标题栏不变，其余各行随阈值长度居中
+OLED_LAYER(range2Layer, 0, 2);
+
+/**
+ * @brief 绘制首页的静态内容：标题栏和各项标签
+ */
+static void drawHome1Layer(void) {
+  // 显示标题栏（反色显示）
+  OLED_PrintASCIIString(30, 0, " Smart Farm ", &afont12x6, OLED_COLOR_REVERSED);
+  // 第一行标签：温度、湿度、光照强度
+  OLED_PrintString(9, 15, "温度", &font12x12, OLED_COLOR_NORMAL);
+  OLED_PrintString(52, 15, "湿度", &font12x12, OLED_COLOR_NORMAL);
+  OLED_PrintString(95, 15, "光照", &font12x12, OLED_COLOR_NORMAL);
+  // 第二行标签：土壤湿度、降雨量、水泵状态
+  OLED_PrintString(9, 42, "土壤", &font12x12, OLED_COLOR_NORMAL);
+  OLED_PrintString(52, 42, "降雨", &font12x12, OLED_COLOR_NORMAL);
+  OLED_PrintString(95, 42, "水泵", &font12x12, OLED_COLOR_NORMAL);
+}
+
+/**
+ * @brief 绘制第二首页的静态内容：标题栏和标签
+ */
+static void drawHome2Layer(void) {
+  OLED_PrintASCIIString(30, 0, " Smart Farm ", &afont12x6, OLED_COLOR_REVERSED);
+  OLED_PrintString(9, 20, "BMP内部温度", &font12x12, OLED_COLOR_NORMAL);
+  OLED_PrintString(9, 48, "气压", &font12x12, OLED_COLOR_NORMAL);
+}
+
+static void drawRange1Layer(void) {
+  OLED_PrintString(25, 0, " 报警阈值(1/2) ", &font12x12, OLED_COLOR_REVERSED);
+}
+
+static void drawRange2Layer(void) {
+  OLED_PrintString(25, 0, " 报警阈值(2/2) ", &font12x12, OLED_COLOR_REVERSED);
+}
+
 /**
  * @brief 渲染首页界面
  *
@@ -57,17 +99,16 @@
  * - 屏幕尺寸：128x64像素
  * - 使用12x12字体显示中文标签和数值
  * - 数值居中显示在对应区域
+ * - 标题栏和标签来自静态图层（drawHome1Layer），每帧只绘制数值
  */
 void renderHome1Page() {
   char msg[16];
   uint8_t x;
 
-  // 显示标题栏（反色显示）
-  OLED_PrintASCIIString(30, 0, " Smart Farm ", &afont12x6, OLED_COLOR_REVERSED);
+  OLED_NewFrameWithLayer(&home1Layer, drawHome1Layer);
 
   // 第一行：温度、湿度、光照强度
   // 温度显示
-  OLED_PrintString(9, 15, "温度", &font12x12, OLED_COLOR_NORMAL);
   int minInt, minDec;
   floatToIntDec(farmState.temperature, &minInt, &minDec);
   sprintf(msg, "%d.%d", minInt, minDec);
@@ -77,33 +118,28 @@ void renderHome1Page() {
   OLED_PrintString(x, 26, msg, &font12x12, OLED_COLOR_NORMAL);
 
   // 湿度显示
-  OLED_PrintString(52, 15, "湿度", &font12x12, OLED_COLOR_NORMAL);
   floatToIntDec(farmState.humidity, &minInt, &minDec);
   sprintf(msg, "%d.%d%%", minInt, minDec);
   x = getCenteredX(msg, 64, 6);  // 64是湿度区域中心X坐标
   OLED_PrintString(x, 26, msg, &font12x12, OLED_COLOR_NORMAL);
 
   // 光照强度显示
-  OLED_PrintString(95, 15, "光照", &font12x12, OLED_COLOR_NORMAL);
   sprintf(msg, "%d lx", farmState.lightIntensity);
   x = getCenteredX(msg, 107, 6);  // 107是光照区域中心X坐标
   OLED_PrintString(x, 26, msg, &font12x12, OLED_COLOR_NORMAL);
 
   // 第二行：土壤湿度、降雨量、水泵状态
   // 土壤湿度显示
-  OLED_PrintString(9, 42, "土壤", &font12x12, OLED_COLOR_NORMAL);
   sprintf(msg, "%d%%", farmState.soilMoisture);
   x = getCenteredX(msg, 21, 6);
   OLED_PrintString(x, 52, msg, &font12x12, OLED_COLOR_NORMAL);
 
   // 降雨量显示
-  OLED_PrintString(52, 42, "降雨", &font12x12, OLED_COLOR_NORMAL);
   sprintf(msg, "%d%%", farmState.rainGauge);
   x = getCenteredX(msg, 64, 6);
   OLED_PrintString(x, 52, msg, &font12x12, OLED_COLOR_NORMAL);
 
   // 水泵状态显示
-  OLED_PrintString(95, 42, "水泵", &font12x12, OLED_COLOR_NORMAL);
   if (farmState.waterPumpState) {
     OLED_PrintString(101, 52, "开", &font12x12, OLED_COLOR_NORMAL);
   } else {
@@ -116,12 +152,11 @@ void renderHome2Page() {
    char strBuf2[20];
    int intPart, decPart;
    int16_t x;
-   // 显示标题栏（反色显示）
-   OLED_PrintASCIIString(30, 0, " Smart Farm ", &afont12x6, OLED_COLOR_REVERSED);
+   // 标题栏和标签来自静态图层
+   OLED_NewFrameWithLayer(&home2Layer, drawHome2Layer);
 
    // --- 1. 显示温度 ---
-   OLED_PrintString(9, 20, "BMP内部温度", &font12x12, OLED_COLOR_NORMAL);
-   doubleToIntDec(farmState.bmp_temp, &intPart, &decPart);
+   fixedToIntDec(farmState.bmp_temp, 100, &intPart, &decPart); // 0.01℃
    sprintf(strBuf1, "%d.%d", intPart, decPart);
    x = getCenteredX(strBuf1, 96, 6);  // 计算居中位置（21是温度区域中心X坐标）
    sprintf(strBuf1, "%d.%d℃", intPart, decPart);
@@ -129,10 +164,7 @@ void renderHome2Page() {
    OLED_PrintString(x, 20, strBuf1, &font12x12, OLED_COLOR_NORMAL);
 
    // --- 2. 显示气压 ---
-   double hPa = farmState.pressure / 100.0;
-   OLED_PrintString(9, 48, "气压", &font12x12, OLED_COLOR_NORMAL);
-
-   doubleToIntDec(hPa, &intPart, &decPart);
+   fixedToIntDec((int32_t)farmState.pressure, 256 * 100, &intPart, &decPart); // Q24.8 Pa -> hPa
 
    // 直接组装最终的完整字符串
    sprintf(strBuf2, "%d.%dhPa", intPart, decPart);
@@ -161,6 +193,17 @@ void renderHome2Page() {
 #define RANGE_RAIN_GAUGE_Y (RANGE_SOIL_MOISTURE_Y + RANGE_LINE_HEIGHT + 5)  // 降雨量行的Y坐标
 #define RANGE_RAIN_GAUGE_LINT_Y (RANGE_RAIN_GAUGE_Y + RANGE_LINE_HEIGHT -1)  // 降雨量行下划线Y坐标
 
+// 编辑模式下划线当前是否显示，由闪烁定时器翻转
+static volatile uint8_t blinkOn = 1;
+
+/**
+ * @brief 闪烁定时器回调（定时器服务任务中执行）：翻转下划线并请求刷新
+ */
+void ScreenBlinkCallback(void *argument) {
+  blinkOn = !blinkOn;
+  Screen_Notify(SCREEN_EVENT_BLINK);
+}
+
 /**
  * @brief 渲染阈值设置页界面
  *
@@ -171,10 +214,8 @@ void renderHome2Page() {
  * 显示逻辑：
  * - 显示格式：最小值 < 参数名 < 最大值（或 参数名 < 最大值）
  * - 当前选中的阈值项会显示下划线
- * - 编辑模式下，下划线会闪烁（每10次刷新切换一次）
+ * - 编辑模式下，下划线会闪烁（由ScreenBlinkTimer每SCREEN_BLINK_MS毫秒翻转一次）
  * - 浏览模式下，下划线固定显示
- *
- * @note 使用静态变量flashCount实现下划线闪烁效果
  */
 void renderRangePage() {
   uint8_t x;
@@ -186,8 +227,8 @@ void renderRangePage() {
 
   // 根据当前编辑索引判断显示第一页还是第二页
   if (rangeEditIndex <= RANGE_EDIT_LIGHT_INTENSITY_MAX) {
-    // 第一页：显示温度、湿度、光照强度的阈值
-    OLED_PrintString(25, 0, " 报警阈值(1/2) ", &font12x12, OLED_COLOR_REVERSED);
+    // 第一页：显示温度、湿度、光照强度的阈值（标题栏来自静态图层）
+    OLED_NewFrameWithLayer(&range1Layer, drawRange1Layer);
     // 显示温度阈值范围
     int minInt, minDec, maxInt, maxDec;
     floatToIntDec(farmSafeRange.minTemperature, &minInt, &minDec);
@@ -254,8 +295,8 @@ void renderRangePage() {
       underLineY = RANGE_LIGHT_INTENSITY_LINT_Y;
     }
   }else{
-    // 第二页：显示土壤湿度、降雨量的阈值
-    OLED_PrintString(25, 0, " 报警阈值(2/2) ", &font12x12, OLED_COLOR_REVERSED);
+    // 第二页：显示土壤湿度、降雨量的阈值（标题栏来自静态图层）
+    OLED_NewFrameWithLayer(&range2Layer, drawRange2Layer);
     // 显示土壤湿度阈值范围
     sprintf(msg, "%d < 土壤 < %d", farmSafeRange.minSoilMoisture, farmSafeRange.maxSoilMoisture);
     msgLength = (strlen(msg) - 2) * 6;
@@ -290,12 +331,10 @@ void renderRangePage() {
   }
 
   // 绘制下划线（用于指示当前选中的阈值项）
-  static uint8_t flashCount = 0;  // 闪烁计数器（静态变量保持状态）
   if (underlineLength > 0) {
     if (rangeEditState == RANGE_EDIT_STATE_EDITING) {
-      // 编辑模式：下划线闪烁（每10次刷新切换一次，实现闪烁效果）
-      flashCount = (flashCount + 1) % 10;
-      if (flashCount < 5) {
+      // 编辑模式：下划线闪烁（亮灭由闪烁定时器切换）
+      if (blinkOn) {
         OLED_DrawLine(underlineX, underLineY, underlineX + underlineLength, underLineY, OLED_COLOR_NORMAL);
       }
     }else{
@@ -308,45 +347,124 @@ void renderRangePage() {
 // 假设你的颜色枚举中，点亮像素是 1 或者某个特定的宏
 #define OLED_COLOR_ON 0  // 根据你 oled.h 里的枚举值调整
 
+// 历史曲线的绘图区域（标题栏下方），每个点占一列
+#define HISTORY_PLOT_TOP 14
+#define HISTORY_PLOT_BOTTOM 63
+#define HISTORY_PLOT_WIDTH 128
+// 读取途中历史数据被SensorTask改写时最多重画的次数
+#define HISTORY_PLOT_ATTEMPTS 3
+
+_Static_assert(HISTORY_MIN_POINTS >= HISTORY_PLOT_WIDTH, "history keeps fewer points than one plot");
+
+// 各序列纵轴的最小跨度（history.h中的存储单位），数据几乎不变时不把噪声放大到满屏
+static const int16_t historyMinSpan[HISTORY_SERIES_COUNT] = {
+  [HISTORY_TEMPERATURE] = 20,     // 2.0℃
+  [HISTORY_HUMIDITY] = 50,        // 5.0%
+  [HISTORY_PRESSURE] = 20,        // 2.0hPa
+  [HISTORY_SOIL_MOISTURE] = 10,   // 10%
+  [HISTORY_RAIN_GAUGE] = 10,      // 10%
+  [HISTORY_LIGHT_INTENSITY] = 50, // 50lx
+};
+
+// 各时间分辨率在标题栏右侧的标记
+static char *const historyTierLabel[HISTORY_TIER_COUNT] = {"1s", "1m", "1h"};
+
+/**
+ * @brief 把历史数据映射到绘图区域的纵坐标
+ */
+static uint8_t historyY(int16_t value, int32_t lo, int32_t span) {
+  return HISTORY_PLOT_BOTTOM - (value - lo) * (HISTORY_PLOT_BOTTOM - HISTORY_PLOT_TOP) / span;
+}
+
+/**
+ * @brief 绘制一遍历史曲线
+ * @return 0: 读取途中数据被改写（History_Stale），画出的曲线不完整
+ */
+static uint8_t drawHistoryCurveOnce(HistorySeries series, HistoryTier tier) {
+  const uint16_t total = History_Count(series, tier);
+  const uint8_t count = total < HISTORY_PLOT_WIDTH ? total : HISTORY_PLOT_WIDTH;
+  HistoryReader reader;
+  HistoryPoint point;
+  if (count == 0) {
+    return 1;
+  }
+
+  // 计算显示范围内的最小值和最大值
+  int32_t lo = INT16_MAX;
+  int32_t hi = INT16_MIN;
+  History_Read(&reader, series, tier, total - count);
+  while (History_Next(&reader, &point)) {
+    if (point.min < lo) lo = point.min;
+    if (point.max > hi) hi = point.max;
+  }
+  if (History_Stale(&reader)) {
+    return 0;
+  }
+  int32_t span = hi - lo;
+  if (span < historyMinSpan[series]) {
+    lo -= (historyMinSpan[series] - span) / 2;
+    span = historyMinSpan[series];
+  }
+
+  const uint8_t firstX = HISTORY_PLOT_WIDTH - count;
+  uint8_t lastY = 0;
+  History_Read(&reader, series, tier, total - count);
+  for (uint8_t i = 0; i < count && History_Next(&reader, &point); i++) {
+    const uint8_t x = firstX + i;
+    const uint8_t y = historyY(point.mean, lo, span);
+
+    // 平均值折线：第一个点只画一个像素
+    if (i == 0) {
+      OLED_SetPixel(x, y, OLED_COLOR_NORMAL);
+    } else {
+      OLED_DrawLine(x - 1, lastY, x, y, OLED_COLOR_NORMAL);
+    }
+    lastY = y;
+
+    // 最小值/最大值包络
+    if (point.max != point.min) {
+      const uint8_t yMax = historyY(point.max, lo, span);
+      const uint8_t yMin = historyY(point.min, lo, span);
+      OLED_DrawLine(x, yMax, x, yMin, OLED_COLOR_NORMAL);
+      if (yMin - yMax >= 2) {
+        OLED_SetPixel(x, y, OLED_COLOR_REVERSED);
+      }
+    }
+  }
+  return !History_Stale(&reader);
+}
+
 /**
  * @brief 绘制传感器历史数据曲线
- * @param history 指向历史数据结构体的指针
+ * @param series 历史数据序列
+ * @param tier 时间分辨率
+ *
+ * - 显示最新的HISTORY_PLOT_WIDTH个点，每个点占一列，最新的点在最右侧
+ * - 纵轴按显示范围内的最小值/最大值自动缩放（不小于historyMinSpan）
+ * - 平均值连成折线；分钟级和小时级的点另外画出从最小值到最大值的竖线（包络），
+ *   竖线足够长时平均值处反色显示
+ * - 历史数据是压缩存储的，两遍（求范围、绘制）都用HistoryReader边解码边处理
+ * - 读取途中SensorTask丢弃或改写了正在读的块时清空绘图区重画
  */
-void OLED_DrawHistoryCurve(SensorHistory_t *history) {
-   uint8_t last_x = 0;
-   uint8_t last_y = 63;
-   uint8_t is_first_point = 1;
-
-   // 遍历 128 个数据点
-   for (uint8_t i = 0; i < HISTORY_MAX_LEN; i++) {
-     // 【灵魂算法】：计算在环形缓冲区里的真实读取位置
-     // history->head_index 指向的是即将被覆盖的最老的数据
-     uint8_t read_idx = (history->head_index + i) % HISTORY_MAX_LEN;
-
-     // 拿出现实数据 (0~100%)
-     uint8_t val = history->buffer[read_idx];
-
-     // 映射到屏幕坐标
-     // X 轴：从 0 画到 127
-     uint8_t x = i;
-     // Y 轴：0~100 映射为 63~0。公式：63 - (val * 63 / 100)
-     uint8_t y = 63 - (val * 63 / 100);
-
-     // 如果是第一个点，只记录坐标，不画线
-     if (is_first_point) {
-       last_x = x;
-       last_y = y;
-       is_first_point = 0;
-     } else {
-       // 把上一个点和当前点连起来
-       OLED_DrawLine(last_x, last_y, x, y, OLED_COLOR_ON);
-
-       // 更新上一坐标点
-       last_x = x;
-       last_y = y;
-     }
-   }
- }
+void OLED_DrawHistoryCurve(HistorySeries series, HistoryTier tier) {
+  for (uint8_t attempt = 0; attempt < HISTORY_PLOT_ATTEMPTS; attempt++) {
+    if (drawHistoryCurveOnce(series, tier)) {
+      return;
+    }
+    OLED_DrawFilledRectangle(0, HISTORY_PLOT_TOP, HISTORY_PLOT_WIDTH, HISTORY_PLOT_BOTTOM - HISTORY_PLOT_TOP + 1,
+                             OLED_COLOR_REVERSED);
+  }
+}
+
+/**
+ * @brief 渲染历史曲线页：左上角标题，右上角时间分辨率，下方曲线
+ */
+static void renderHistoryPage(char *title, HistorySeries series) {
+  OLED_NewFrame();
+  OLED_PrintString(0, 0, title, &font12x12, OLED_COLOR_NORMAL);
+  OLED_PrintASCIIString(116, 0, historyTierLabel[historyTier], &afont12x6, OLED_COLOR_REVERSED);
+  OLED_DrawHistoryCurve(series, historyTier);
+}
 
 
 // 【注意】：波特律动的文本输出需要传入字体指针。
@@ -410,23 +528,38 @@ void OLED_BootAnimation(void) {
   OLED_ShowFrame();
 }
 
+/**
+ * @brief 编辑模式下启动闪烁定时器，离开编辑模式后停止，避免无意义的刷新请求
+ */
+static void updateBlinkTimer(void) {
+  const uint8_t blinking = pageIndex == PAGE_RANGE && rangeEditState == RANGE_EDIT_STATE_EDITING;
+  const uint8_t running = osTimerIsRunning(ScreenBlinkTimerHandle);
+
+  if (blinking && !running) {
+    blinkOn = 1; // 刚进入编辑模式时先显示下划线
+    osTimerStart(ScreenBlinkTimerHandle, SCREEN_BLINK_MS);
+  } else if (!blinking && running) {
+    osTimerStop(ScreenBlinkTimerHandle);
+  }
+}
+
 /**
  * @brief 屏幕显示任务主函数
  *
  * 任务执行流程：
  * 1. 初始化OLED显示屏
  * 2. 进入主循环：
- *    - 创建新的显示帧缓冲区
- *    - 根据当前页面索引调用相应的渲染函数
- *    - 使用互斥锁保护I2C总线，将帧缓冲区内容发送到OLED显示
- *    - 延时10ms后继续下一次刷新
+ *    - 阻塞等待ScreenEvent中的刷新请求（SensorTask/InputTask/闪烁定时器）
+ *    - 距上一帧不足1000/SCREEN_MAX_FPS毫秒时先等待，期间的请求合并为一帧
+ *    - 根据当前页面索引调用相应的渲染函数（首页和阈值设置页以静态图层为底图）
+ *    - 将帧缓冲区内容发送到OLED显示
  *
  * @param argument 任务参数（未使用）
  *
  * @note
- * - 使用i2c1Mutex互斥锁保护I2C1总线，因为OLED和AHT20共享I2C1
- * - 10ms的刷新周期保证显示流畅（100Hz刷新率）
- * - 使用双缓冲机制：先在新缓冲区绘制，再一次性显示，避免闪烁
+ * - 没有请求时任务一直挂起，不占用CPU和I2C2总线
+ * - OLED驱动使用双缓冲：OLED_ShowFrame()提交后立即返回，下一帧绘制在另一块显存中进行
+ * - 渲染/合并的帧数记录在screenFrameStats中，由SensorTask随农场日志输出
  */
 void StartScreenTask(void *argument) {
    osDelay(100);
@@ -435,12 +568,36 @@ void StartScreenTask(void *argument) {
   OLED_Init();
   OLED_BootAnimation();
 
-  // 主循环：持续刷新显示内容
+  const uint32_t minFrameTicks = osKernelGetTickFreq() / SCREEN_MAX_FPS;
+  uint32_t lastFrameTick = osKernelGetTickCount() - minFrameTicks;
+  uint32_t lastRequests = screenFrameStats.requests;
+
+  // 开机动画结束后先显示一次当前页面
+  Screen_Notify(SCREEN_EVENT_ALL);
+
+  // 主循环：有刷新请求时才渲染
   for (;;) {
-    // 创建新的显示帧缓冲区（双缓冲机制）
-    OLED_NewFrame();
+    osEventFlagsWait(ScreenEventHandle, SCREEN_EVENT_ALL, osFlagsWaitAny, osWaitForever);
+
+    // 限速：离上一帧太近时先等待，等待期间到达的请求合并到这一帧
+    const uint32_t elapsed = osKernelGetTickCount() - lastFrameTick;
+    if (elapsed < minFrameTicks) {
+      osDelay(minFrameTicks - elapsed);
+    }
+    osEventFlagsClear(ScreenEventHandle, SCREEN_EVENT_ALL);
+    lastFrameTick = osKernelGetTickCount();
+
+    const uint32_t requests = screenFrameStats.requests;
+    if (requests - lastRequests > 1) {
+      screenFrameStats.skipped += requests - lastRequests - 1;
+    }
+    lastRequests = requests;
+    screenFrameStats.rendered++;
+
+    updateBlinkTimer();
 
     // 根据当前页面索引渲染相应的界面
+    // 首页和阈值设置页的渲染函数以静态图层为底图开始新的一帧，其余页面先清空显存（双缓冲机制）
     switch (pageIndex) {
     case PAGE_HOME1:
       renderHome1Page();  // 渲染首页：显示环境状态数据
@@ -452,32 +609,32 @@ void StartScreenTask(void *argument) {
       renderRangePage(); // 渲染阈值设置页：显示和编辑报警阈值
       break;
     case PAGE_HISTORY:
-      // 【新增】：渲染历史曲线页！
-      // 左上角写个标题，以免用户不知道这是啥
-      OLED_PrintString(0, 0,"Soil History", &font12x12, OLED_COLOR_NORMAL);
-      // 调用曲线绘制函数
-      OLED_DrawHistoryCurve(&soilHistory);
+      renderHistoryPage("Soil History", HISTORY_SOIL_MOISTURE);
       break;
     case PAGE_HISTORY_RAIN:
-      // 【新增】：渲染降雨量曲线
-      OLED_PrintString(0, 0,"Rainfall", &font12x12, OLED_COLOR_NORMAL);
-      OLED_DrawHistoryCurve(&rainHistory); // 传降雨数据的指针
+      renderHistoryPage("Rainfall", HISTORY_RAIN_GAUGE);
       break;
     case PAGE_HISTORY_LIGHT:
-        // 【新增】：渲染降雨量曲线
-      OLED_PrintString(0, 0,"Light History", &font12x12, OLED_COLOR_NORMAL);
-      OLED_DrawHistoryCurve(&lightHistory); // 传降雨数据的指针
+      renderHistoryPage("Light History", HISTORY_LIGHT_INTENSITY);
+      break;
+    case PAGE_HISTORY_TEMPERATURE:
+      renderHistoryPage("Temp History", HISTORY_TEMPERATURE);
+      break;
+    case PAGE_HISTORY_HUMIDITY:
+      renderHistoryPage("Humidity History", HISTORY_HUMIDITY);
+      break;
+    case PAGE_HISTORY_PRESSURE:
+      renderHistoryPage("Pressure History", HISTORY_PRESSURE);
       break;
     default:
+      OLED_NewFrame();
       break;
     }
 
-    // 使用互斥锁保护I2C总线，将帧缓冲区内容发送到OLED显示
-    osMutexAcquire(i2c2MutexHandle, osWaitForever);
+    // 将帧缓冲区内容发送到OLED显示（I2C2由i2c_bus队列串行化，无需加锁）
     OLED_ShowFrame();
-    osMutexRelease(i2c2MutexHandle);
 
-    // 延时10ms后继续下一次刷新
-    osDelay(10);
+    // 这一帧已交给I2C2（由POWER_I2C位覆盖），渲染期间没有新的请求时释放POWER_DISPLAY位
+    Power_Idle(POWER_DISPLAY, Screen_IsIdle);
   }
 }
@@ -6,7 +6,9 @@
  * 1. 初始化所有传感器（AHT20温湿度、土壤湿度、光照、降雨量）
  * 2. 定期读取传感器数据并更新全局状态
  * 3. 检查环境参数是否超出安全范围
- * 4. 当检测到异常时，发送报警消息到BLE队列并启动蜂鸣器
+ * 4. 由报警状态机（alarm.h）判断异常，报警、解除和提醒时发送消息到BLE队列，报警期间启动蜂鸣器
+ * 5. 每TELEMETRY_SNAPSHOT_PERIOD_S秒把FarmState的全部字段作为一条快照发送到BLE队列
+ * 6. 记录历史数据，每分钟把分钟点追加到Flash日志，开机时回放恢复
  *
  * 任务优先级：osPriorityNormal
  * 任务周期：1000ms（1秒）
@@ -14,7 +16,7 @@
 
 #include "aht20.h"
 #include "cmsis_os2.h"
-#include "freertos.h"
+#include "FreeRTOS.h"
 #include "global/farmState.h"
 #include "light.h"
 #include "main.h"
@@ -29,173 +31,168 @@
 #include "global/adc_buffer.h"
 #include "adc.h"
 #include "screen.h"
+#include "history.h"
+#include "flash_log.h"
 #include "BMP280.h"
 #include "StopModeRtc.h"
 #include "oled.h"
 #include "debug_log.h"
+#include "alarm.h"
+#include "power.h"
+#include "telemetry.h"
 #include "usart.h"
 
 
 extern volatile uint32_t ui_keep_awake_ms;
-// 记录当前有多少条蓝牙消息正在处理中
-extern volatile uint8_t ble_pending_msgs ;
 
+/**
+ * @brief 浮点数四舍五入为0.1单位的定点数
+ */
+static int32_t ToTenths(float value) {
+  return (int32_t)(value * 10.0f + (value < 0 ? -0.5f : 0.5f));
+}
 
 /**
- * @brief 发送浮点数类型的报警消息
- *
- * 分配内存创建JSON格式的报警消息，并通过队列发送给BLETask
- * 消息格式：{"type":"warning", "reason":"报警原因", "value":数值}
- *
- * @param reason 报警原因字符串（如"temperature_high"）
- * @param value 报警时的数值（浮点数）
- *
- * @note 使用pvPortMalloc分配内存，BLETask负责释放
+ * @brief 从蓝牙消息池分配一条消息并填好类型和时间戳
+ * @return 消息池已满时返回NULL（计入池的分配失败次数），这条消息被丢弃
  */
-static void SendWarningFloat(const char *reason, float value) {
-  // 在FreeRTOS堆中分配内存用于存储消息
-  char *msg = pvPortMalloc(100);
-  if (msg == NULL) {
-    return; // 内存分配失败，直接返回
+static Telemetry_Message *NewMessage(Telemetry_Type type) {
+  // 从静态消息池中分配一块，O(1)，不占用FreeRTOS堆
+  Telemetry_Message *msg = BlockPool_Alloc(&bleMsgPool);
+  if (msg != NULL) {
+    msg->type = type;
+    msg->timestamp = StopMode_RtcSeconds();
   }
+  return msg;
+}
 
-  // 将浮点数转换为整数和小数部分
-  int minInt, minDec;
-  floatToIntDec(value, &minInt, &minDec);
-
-  // 格式化JSON消息
-  snprintf(msg, 100, "{\"type\":\"warning\", \"reason\":\"%s\", \"value\":%d.%d}", reason, minInt, minDec);
-
-  // 将消息指针放入BLE队列，等待BLETask处理
-  if (osMessageQueuePut(BLEQueueHandle, &msg, 0, 0) == osOK) {
-    ble_pending_msgs++;
-  }else
-  {
-    vPortFree(msg);
+/**
+ * @brief 把消息交给BLETask，由BLETask按TELEMETRY_FORMAT编码（二进制帧或JSON）
+ * @note 消息块由BLETask编码后释放；队列满时把块还给消息池
+ */
+static void PostMessage(Telemetry_Message *msg) {
+  // 将消息指针放入BLE队列，等待BLETask处理；发完之前睡眠屏障的POWER_BLE_TX位保持清除
+  Power_Busy(POWER_BLE_TX);
+  if (osMessageQueuePut(BLEQueueHandle, &msg, 0, 0) != osOK) {
+    BlockPool_Free(&bleMsgPool, msg);
   }
 }
 
 /**
- * @brief 发送整数类型的报警消息
- *
- * 分配内存创建JSON格式的报警消息，并通过队列发送给BLETask
- * 消息格式：{"type":"warning", "reason":"报警原因", "value":数值}
+ * @brief 发送报警消息，作为报警状态机（alarm.h）的事件回调，只在报警、解除和提醒时调用
  *
- * @param reason 报警原因字符串（如"soil_moisture_low"）
- * @param value 报警时的数值（整数）
- *
- * @note 使用pvPortMalloc分配内存，BLETask负责释放
+ * @param reason 报警原因
+ * @param event 报警、解除或提醒
+ * @param value 当前数值，单位0.1
  */
-static void SendWarningInt(const char *reason, int value) {
-  // 在FreeRTOS堆中分配内存用于存储消息
-  char *msg = pvPortMalloc(100);
+static void SendWarning(Telemetry_Reason reason, Telemetry_Event event, int32_t value) {
+  Telemetry_Message *msg = NewMessage(TELEMETRY_WARNING);
   if (msg == NULL) {
-    return; // 内存分配失败，直接返回
+    return; // 消息池已满，直接返回
   }
 
-  // 格式化JSON消息
-  snprintf(msg, 100, "{\"type\":\"warning\", \"reason\":\"%s\", \"value\":%d}", reason, value);
-
-  // 将消息指针放入BLE队列，等待BLETask处理
-  if (osMessageQueuePut(BLEQueueHandle, &msg, 0, 0) == osOK) {
-      ble_pending_msgs++;
-  }else
-  {
-   vPortFree(msg);
-  }
+  msg->warning.reason = reason;
+  msg->warning.event = event;
+  msg->warning.value = value;
+  PostMessage(msg);
 }
 
 /**
- * @brief 检查浮点数是否在安全范围内
- *
- * 如果值超出范围，发送相应的报警消息
- *
- * @param value 要检查的浮点数值
- * @param min 最小值阈值
- * @param max 最大值阈值
- * @param minReason 低于最小值时的报警原因字符串
- * @param maxReason 高于最大值时的报警原因字符串
- * @return 返回1表示有报警，返回0表示正常
+ * @brief 发送一条快照：当前FarmState的全部字段，温湿度换成0.1单位的定点数
  */
-static uint8_t CheckRangeFloat(float value, float min, float max, const char *minReason, const char *maxReason) {
-  uint8_t warning = 0;
-
-  // 检查是否低于最小值
-  if (value < min) {
-    SendWarningFloat(minReason, value);
-    warning = 1;
-  }
-
-  // 检查是否高于最大值
-  if (value > max) {
-    SendWarningFloat(maxReason, value);
-    warning = 1;
+static void SendSnapshot(void) {
+  Telemetry_Message *msg = NewMessage(TELEMETRY_SNAPSHOT);
+  if (msg == NULL) {
+    return;
   }
 
-  return warning;
+  msg->snapshot.temperature = (int16_t)ToTenths(farmState.temperature);
+  msg->snapshot.humidity = (uint16_t)ToTenths(farmState.humidity);
+  msg->snapshot.rainGauge = farmState.rainGauge;
+  msg->snapshot.soilMoisture = farmState.soilMoisture;
+  msg->snapshot.lightIntensity = farmState.lightIntensity;
+  msg->snapshot.pressure = farmState.pressure;
+  msg->snapshot.bmpTemp = farmState.bmp_temp;
+  msg->snapshot.waterPumpState = farmState.waterPumpState;
+  PostMessage(msg);
 }
 
 /**
- * @brief 检查整数是否在安全范围内
- *
- * 如果值超出范围，发送相应的报警消息
- *
- * @param value 要检查的整数值
- * @param min 最小值阈值
- * @param max 最大值阈值
- * @param minReason 低于最小值时的报警原因字符串
- * @param maxReason 高于最大值时的报警原因字符串
- * @return 返回1表示有报警，返回0表示正常
+ * @brief 把当前环境数据按history.h规定的单位记录到历史数据中
  */
-static uint8_t CheckRangeInt(int value, int min, int max, const char *minReason, const char *maxReason) {
-  uint8_t warning = 0;
-
-  // 检查是否低于最小值
-  if (value < min) {
-    SendWarningInt(minReason, value);
-    warning = 1;
+static void RecordHistory(void) {
+  int16_t values[HISTORY_SERIES_COUNT];
+  values[HISTORY_TEMPERATURE] = (int16_t)(farmState.temperature * 10);
+  values[HISTORY_HUMIDITY] = (int16_t)(farmState.humidity * 10);
+  values[HISTORY_PRESSURE] = (int16_t)((farmState.pressure >> 8) / 10); // Q24.8 Pa -> 0.1hPa
+  values[HISTORY_SOIL_MOISTURE] = (int16_t)farmState.soilMoisture;
+  values[HISTORY_RAIN_GAUGE] = (int16_t)farmState.rainGauge;
+  values[HISTORY_LIGHT_INTENSITY] = farmState.lightIntensity > INT16_MAX ? INT16_MAX : (int16_t)farmState.lightIntensity;
+
+  // 每凑满一分钟把分钟点追加到Flash日志，掉电重启后可以回放
+  const HistoryPoint *minute = History_Add(values);
+  if (minute != NULL) {
+    FlashLog_Append(FLASH_LOG_HISTORY_MINUTE, minute, sizeof(HistoryPoint) * HISTORY_SERIES_COUNT);
   }
+}
 
-  // 检查是否高于最大值
-  if (value > max) {
-    SendWarningInt(maxReason, value);
-    warning = 1;
+/**
+ * @brief Flash日志回放回调：把保存的分钟点写回历史数据
+ */
+static void ReplayHistory(FlashLog_Type type, const void *data, uint16_t len, void *context) {
+  (void)context;
+  if (type == FLASH_LOG_HISTORY_MINUTE && len == sizeof(HistoryPoint) * HISTORY_SERIES_COUNT) {
+    HistoryPoint points[HISTORY_SERIES_COUNT];
+    memcpy(points, data, sizeof(points)); // Flash中的数据只按半字对齐
+    History_AddMinute(points);
   }
+}
 
-  return warning;
+/**
+ * @brief 扫描Flash日志并回放上次运行保存的分钟点，重建分钟级/小时级历史
+ */
+static void RestoreHistory(void) {
+  FlashLog_Stats stats;
+  FlashLog_Init();
+  FlashLog_Replay(ReplayHistory, NULL);
+  FlashLog_GetStats(&stats);
+  printf("[Flash日志] 回放%lu条 跳过%lu条 | 有效段%u 序号%lu 当前段%lu字节\r\n",
+         (unsigned long)stats.records, (unsigned long)stats.skipped, stats.segments,
+         (unsigned long)stats.sequence, (unsigned long)stats.used);
 }
 
 /**
  * @brief 传感器任务主函数
  *
  * 任务执行流程：
- * 1. 初始化环境安全范围阈值
+ * 1. 初始化环境安全范围阈值，从Flash日志恢复历史数据
  * 2. 初始化所有传感器（需要互斥锁保护I2C总线）
  * 3. 进入主循环：
  *    - 读取所有传感器数据
  *    - 更新全局状态变量
- *    - 检查各参数是否超出安全范围
- *    - 如有异常，发送报警并启动蜂鸣器
+ *    - 用报警状态机检查各参数是否超出安全范围
+ *    - 报警状态变化时发送消息，报警期间启动蜂鸣器
  *    - 延时1秒后继续下一次循环
  *
  * @param argument 任务参数（未使用）
  *
  * @note
- * - 使用i2c1Mutex互斥锁保护I2C1总线，因为OLED和AHT20共享I2C1
+ * - AHT20、BMP280与OLED共享I2C2，由i2c_bus传输队列串行化，不需要互斥锁
  * - 任务周期为1秒，保证数据更新及时且不会过于频繁
  */
 void StartSensorTask(void *argument) {
-  // 初始化环境安全范围阈值（设置默认值）
+  // 初始化环境安全范围阈值（读取Flash中保存的阈值，没有时使用默认值）
   EnvSafeRange_Init();
 
-  // 初始化AHT20温湿度传感器（需要I2C通信，使用互斥锁保护）
-  osMutexAcquire(i2c2MutexHandle, osWaitForever);
-  AHT20_Init();
-  osMutexRelease(i2c2MutexHandle);
+  // 从Flash日志恢复历史数据（在第一次采样之前，保证回放的分钟点排在新数据前面）
+  RestoreHistory();
 
-  osMutexAcquire(i2c2MutexHandle, osWaitForever);
-  BMP280_Init();
-  osMutexRelease(i2c2MutexHandle);
+  // 初始化AHT20温湿度传感器和BMP280（I2C2由i2c_bus队列串行化，无需加锁）
+  AHT20_Init();
+  if (BMP280_Init() != BMP280_OK) {
+    // 没有配置成正常模式时芯片不测量，之后读到的气压和温度一直是复位值
+    printf("[BMP280] 初始化失败\r\n");
+  }
 
   // 初始化其他传感器（使用ADC，不需要I2C）
   //Rain_init();           // 降雨量传感器
@@ -204,56 +201,30 @@ void StartSensorTask(void *argument) {
   HAL_ADC_Start_DMA(&hadc1, (uint32_t*)adc_buffer, ADC_CHANNEL_COUNT);
 
 
-  // 加一个计数器，决定多长时间记录一个点
-  // 假设任务是 1 秒循环一次，如果要记录过去 2 小时的数据，
-  // 120 分钟 / 128 个点 ≈ 差不多每 1 分钟（60秒）记录一次。
-  // 这里为了你方便看效果，我们先设为每 1 秒记录一次！
-  static uint8_t record_timer = 0;
-  // 【低功耗改造 1】：我们假设每次深度休眠 5 秒。
-  // 那么 timer 不再是每次加 1，而是每次加 5！
-  const uint32_t SLEEP_SECONDS = 5; // 设定系统每次深睡的秒数
   // 用于控制传感器读取频率的计数器
   uint8_t read_countdown = 0;
+  // 上一条快照的RTC时间（秒），初值保证第一次采集后立即发送一条
+  uint32_t last_snapshot = StopMode_RtcSeconds() - TELEMETRY_SNAPSHOT_PERIOD_S;
   // 主循环：定期采集传感器数据并检测报警
   for (;;) {
     if (read_countdown == 0) {
-    // 读取AHT20温湿度传感器数据（需要I2C通信，使用互斥锁保护）
-    osMutexAcquire(i2c2MutexHandle, osWaitForever);
-    AHT20_Read(&farmState.temperature, &farmState.humidity);
-    osMutexRelease(i2c2MutexHandle);
-    osMutexAcquire(i2c2MutexHandle, osWaitForever);
-    // 【关键顺序】：必须先读温度！因为底层的 t_fine 变量靠它更新！
-    farmState.bmp_temp = BMP280_ReadTemp();
-    osMutexRelease(i2c2MutexHandle);
-    osMutexAcquire(i2c2MutexHandle, osWaitForever);
-    // 有了新鲜的 t_fine，此时测气压和海拔才是绝对精准的
-    farmState.pressure = BMP280_ReadPress();
-    osMutexRelease(i2c2MutexHandle);
+    // 先触发AHT20测量（约80ms，期间总线空闲），趁这段时间读BMP280
+    AHT20_Trigger();
+    // BMP280 一次连续读出同一次转换的温度和气压，整数补偿（读取失败时保留上一次的值）
+    BMP280_ReadTempPressFixed(&farmState.bmp_temp, &farmState.pressure);
+    // 再取AHT20结果，只等剩余的测量时间，等待期间本任务挂起（失败时保留上一次的值）
+    AHT20_Wait(&farmState.temperature, &farmState.humidity);
 
     // 读取其他传感器数据（使用ADC，不需要互斥锁）
     farmState.rainGauge = Rain_Get();           // 读取降雨量
     farmState.soilMoisture = SoilMoisture_Get(); // 读取土壤湿度
     farmState.lightIntensity = Light_Get();     // 读取光照强度
 
-    // 【核心新增】：周期性把数据压入环形缓冲区
-    // 【低功耗改造 2】：时间累加要匹配我们的休眠时间
-    record_timer += SLEEP_SECONDS;
-    if (record_timer >= 5) { // 1秒记录一次（后期可改成 60 就是一分钟记一次）
-      // 写入当前土壤湿度
-      soilHistory.buffer[soilHistory.head_index] = farmState.soilMoisture;
-      // 游标往前推一步。如果到了 128，就自动回到 0，覆盖最老的数据
-      soilHistory.head_index = (soilHistory.head_index + 1) % HISTORY_MAX_LEN;
-
-      // 2. 【新增】：记录降雨量
-      rainHistory.buffer[rainHistory.head_index] = farmState.rainGauge;
-      rainHistory.head_index = (rainHistory.head_index + 1) % HISTORY_MAX_LEN;
-
-      // 3. 【新增】：记录光照历史
-      lightHistory.buffer[lightHistory.head_index] = farmState.lightIntensity;
-      lightHistory.head_index = (lightHistory.head_index + 1) % HISTORY_MAX_LEN;
+    // 记录历史数据：秒级缓冲区每次采样一个点，分钟级/小时级由累加器逐次合并
+    RecordHistory();
 
-      record_timer = 0;
-    }
+    // 阈值修改后停止调整一段时间才写入Flash（防抖，转动旋钮时不会每一步都写）
+    EnvSafeRange_Save();
 
     // 根据土壤湿度自动控制水泵
     // 当土壤湿度低于最低阈值时打开水泵，高于最低阈值时关闭水泵
@@ -267,41 +238,37 @@ void StartSensorTask(void *argument) {
       farmState.waterPumpState = 0;
     }
 
-    // 检查各环境参数是否超出安全范围，累计报警标志
-    uint8_t warning = 0;
-    warning += CheckRangeFloat(farmState.temperature, farmSafeRange.minTemperature,
-                               farmSafeRange.maxTemperature, "temperature_low", "temperature_high");
-    warning += CheckRangeFloat(farmState.humidity, farmSafeRange.minHumidity,
-                               farmSafeRange.maxHumidity, "humidity_low", "humidity_high");
-
-    // 降雨量只有上限检查（超过阈值才报警）
-    if (farmState.rainGauge > farmSafeRange.maxRainGauge) {
-      warning += 1;
-      SendWarningInt("rain_gauge_high", farmSafeRange.maxRainGauge);
-    }
-
-    warning += CheckRangeInt(farmState.soilMoisture, farmSafeRange.minSoilMoisture,
-                             farmSafeRange.maxSoilMoisture, "soil_moisture_low", "soil_moisture_high");
-    warning += CheckRangeInt(farmState.lightIntensity, farmSafeRange.minLightIntensity,
-                             farmSafeRange.maxLightIntensity, "light_intensity_low", "light_intensity_high");
+    // 报警状态机：超出范围并保持一段时间才报警，越过回差并保持一段时间才解除，只在状态变化和定期提醒时发消息
+    const uint8_t warning = Alarm_Update(&farmState, &farmSafeRange, StopMode_RtcSeconds(), SendWarning);
 
-    // 根据报警标志控制蜂鸣器
+    // 根据报警状态控制蜂鸣器（报警持续期间一直响，解除后停止）
     if (warning > 0) {
       Beep_on();  // 有报警，启动蜂鸣器
     } else {
       Beep_off(); // 无报警，关闭蜂鸣器
     }
 
+    // 每TELEMETRY_SNAPSHOT_PERIOD_S秒发送一条快照，和本次的报警一起由BLETask一次发出
+    // 按RTC计时，亮屏（100ms循环）和熄屏（STOP模式1秒循环）时周期相同
+    if (TELEMETRY_SNAPSHOT_PERIOD_S > 0U && StopMode_RtcSeconds() - last_snapshot >= TELEMETRY_SNAPSHOT_PERIOD_S) {
+      last_snapshot = StopMode_RtcSeconds();
+      SendSnapshot();
+    }
+
       // 定义用于存储拆分结果的变量
       int t_int, t_dec, h_int, h_dec, p_int, p_dec;
 
       // 拆分浮点数
       floatToIntDec(farmState.temperature, &t_int, &t_dec);
       floatToIntDec(farmState.humidity, &h_int, &h_dec);
-      floatToIntDec(farmState.pressure, &p_int, &p_dec);
+      fixedToIntDec((int32_t)farmState.pressure, 256, &p_int, &p_dec); // Q24.8 -> Pa
+
+      BlockPool_Stats pool;
+      BlockPool_GetStats(&bleMsgPool, &pool);
 
       // 【核心修改】：使用 %d.%d 替代 %.1f
-      printf("[农场日志] T:%d.%d H:%d.%d 土壤:%d 降雨:%d 光照:%d 气压:%d.%d | UI:%lu ms -> %s\r\n",
+      printf("[农场日志] T:%d.%d H:%d.%d 土壤:%d 降雨:%d 光照:%d 气压:%d.%d | UI:%lu ms -> %s | 帧:渲染%lu 合并%lu"
+             " | 蓝牙池:峰值%lu/%u 丢弃%lu\r\n",
              t_int, t_dec,
              h_int, h_dec,
              farmState.soilMoisture,
@@ -309,7 +276,15 @@ void StartSensorTask(void *argument) {
              farmState.lightIntensity,
              p_int, p_dec,
              ui_keep_awake_ms,
-             (ui_keep_awake_ms > 0) ? "OLED亮起" : "OLED熄灭(后台采样)");
+             (ui_keep_awake_ms > 0) ? "OLED亮起" : "OLED熄灭(后台采样)",
+             screenFrameStats.rendered,
+             screenFrameStats.skipped,
+             (unsigned long)pool.highWater, pool.blockCount, (unsigned long)pool.failures);
+
+      // 屏幕亮着时请求刷新（熄屏期间不刷，按键唤醒后的第一次采集会再请求）
+      if (ui_keep_awake_ms > 0) {
+        Screen_Notify(SCREEN_EVENT_DATA);
+      }
 
       // 重新设定倒计时。配合下面的 100ms 延时，10 次正好是 1 秒采集一次！
       read_countdown = 10;
@@ -323,9 +298,7 @@ void StartSensorTask(void *argument) {
 
       // 【UI 活跃期】：开机动画播放中，或刚按了按键
       // 1. 叫醒屏幕
-      osMutexAcquire(i2c2MutexHandle, osWaitForever);
       OLED_DisPlay_On();
-      osMutexRelease(i2c2MutexHandle);
 
       // 2. 【极其关键】：让出 CPU 100 毫秒！
       // 这 100 毫秒里，FreeRTOS 会安排 ScreenTask 去刷开机动画或菜单
@@ -339,42 +312,13 @@ void StartSensorTask(void *argument) {
 
       // 【熄屏休眠期】：没有人看屏幕，果断切断耗电大户
       // 1. 息屏
-      osMutexAcquire(i2c2MutexHandle, osWaitForever);
       OLED_DisPlay_Off();
-      osMutexRelease(i2c2MutexHandle);
-
-      // 1. 【新增软件锁】：死等 BLE 队列里的所有消息被 BLETask 彻底发完且释放内存！
-      while (ble_pending_msgs > 0) {
-        osDelay(1); // 让出 CPU 给 BLETask 拼命干活
-      }
-
-      // ==========================================
-      // 【终极串口排空防线】：必须严格按照以下两步走！
-      // ==========================================
-
-      // 1. 等待 HAL 库状态机就绪（这意味着 DMA 已经把所有砖块搬完了）
-      // 【极其关键】：这里必须用 osDelay(1) 挂起自己，交出 CPU 治权！
-      // 否则底层的 DMA 传输完成中断永远无法触发，状态机永远卡死在 BUSY！
-      while (huart1.gState != HAL_UART_STATE_READY || huart2.gState != HAL_UART_STATE_READY) {
-        osDelay(1);
-      }
-
-      // 2. 此时 DMA 虽然下班了，但串口的“物理移位寄存器”里还含着最后一块砖
-      // 死等 TC (Transmission Complete) 标志位变为 1，确保最后一个 bit 彻底飞出引脚
-      while (__HAL_UART_GET_FLAG(&huart1, UART_FLAG_TC) == RESET) {}
-      while (__HAL_UART_GET_FLAG(&huart2, UART_FLAG_TC) == RESET) {}
-
-      while (HAL_I2C_GetState(&hi2c2) != HAL_I2C_STATE_READY) {
-        osDelay(1);
-      }
-
-      // 给 I2C 一点物理缓冲时间
-      osDelay(5);
-      // 2. 带着单片机进入 Stop 模式死睡 1 秒钟！
-      // 注意：这 1 秒的死睡，替代了原本循环里的 osDelay，所以报警延迟绝对不超过 1 秒！
-      Enter_Deep_Stop_Mode_With_RTC(1);
 
-      SystemClock_Config();
+      // 2. 阻塞到下一个 RTC 秒边界之后（醒来的时刻正好在 RTC 闹钟之后）
+      // 所有任务都阻塞时，空闲任务自己进入 Stop 模式（StopModeRtc.c 中的 vPortSuppressTicksAndSleep），
+      // 蓝牙/调试串口/I2C2/屏幕还在传输时只进入 Sleep 模式，醒来后内核节拍按 RTC 补齐
+      // 这 1 秒的等待和亮屏时一样是普通的 osDelay，所以报警延迟绝对不超过 1 秒！
+      osDelay(StopMode_TicksToNextSecond());
 
       // 3. 醒来后，强行把读取倒计时清零
       // 确保醒来的下一个瞬间，立刻读取传感器并判断灾害！
@@ -0,0 +1,150 @@
+#include "alarm.h"
+
+#include <stddef.h>
+
+// 通道没有这一侧的阈值(降雨量只有上限)
+#define ALARM_NO_LIMIT 0xFFFFU
+
+typedef enum {
+    ALARM_FIELD_FLOAT = 0,   // float, 单位 1
+    ALARM_FIELD_U16,         // uint16_t, 单位 1
+} Alarm_FieldType;
+
+typedef enum {
+    ALARM_LEVEL_NORMAL = 0,
+    ALARM_LEVEL_LOW,
+    ALARM_LEVEL_HIGH,
+} Alarm_Level;
+
+/**
+ * @brief 一个报警通道: 数值在 FarmState 中、阈值在 FarmSafeRange 中的偏移, 三者类型相同
+ */
+typedef struct {
+    uint8_t type;              // Alarm_FieldType
+    uint16_t value;            // FarmState 中的偏移
+    uint16_t min;              // FarmSafeRange 中的偏移, ALARM_NO_LIMIT 表示没有下限
+    uint16_t max;              // FarmSafeRange 中的偏移, ALARM_NO_LIMIT 表示没有上限
+    uint8_t lowReason;         // Telemetry_Reason
+    uint8_t highReason;
+    int32_t hysteresis;        // 回差, 单位 0.1
+    uint16_t holdS;
+    uint16_t reminderS;
+} Alarm_Channel;
+
+typedef struct {
+    uint8_t level;             // 当前状态, Alarm_Level
+    uint8_t pending;           // 正在等待保持时间的目标状态, 与 level 相同时表示没有
+    uint32_t pendingSince;     // 开始偏离当前状态的时间
+    uint32_t notifiedAt;       // 上一次报警或提醒的时间
+} Alarm_State;
+
+static const Alarm_Channel alarmChannel[] = {
+    {ALARM_FIELD_FLOAT, offsetof(FarmState, temperature), offsetof(FarmSafeRange, minTemperature),
+     offsetof(FarmSafeRange, maxTemperature), TELEMETRY_REASON_TEMPERATURE_LOW, TELEMETRY_REASON_TEMPERATURE_HIGH,
+     5, ALARM_HOLD_S, ALARM_REMINDER_S},
+    {ALARM_FIELD_FLOAT, offsetof(FarmState, humidity), offsetof(FarmSafeRange, minHumidity),
+     offsetof(FarmSafeRange, maxHumidity), TELEMETRY_REASON_HUMIDITY_LOW, TELEMETRY_REASON_HUMIDITY_HIGH,
+     20, ALARM_HOLD_S, ALARM_REMINDER_S},
+    {ALARM_FIELD_U16, offsetof(FarmState, rainGauge), ALARM_NO_LIMIT,
+     offsetof(FarmSafeRange, maxRainGauge), TELEMETRY_REASON_COUNT, TELEMETRY_REASON_RAIN_GAUGE_HIGH,
+     30, ALARM_HOLD_S, ALARM_REMINDER_S},
+    {ALARM_FIELD_U16, offsetof(FarmState, soilMoisture), offsetof(FarmSafeRange, minSoilMoisture),
+     offsetof(FarmSafeRange, maxSoilMoisture), TELEMETRY_REASON_SOIL_MOISTURE_LOW,
+     TELEMETRY_REASON_SOIL_MOISTURE_HIGH, 20, ALARM_HOLD_S, ALARM_REMINDER_S},
+    // 光照随云层变化快, 保持时间长一些
+    {ALARM_FIELD_U16, offsetof(FarmState, lightIntensity), offsetof(FarmSafeRange, minLightIntensity),
+     offsetof(FarmSafeRange, maxLightIntensity), TELEMETRY_REASON_LIGHT_INTENSITY_LOW,
+     TELEMETRY_REASON_LIGHT_INTENSITY_HIGH, 100, 10U, ALARM_REMINDER_S},
+};
+
+#define ALARM_CHANNEL_COUNT (sizeof(alarmChannel) / sizeof(alarmChannel[0]))
+
+static Alarm_State alarmState[ALARM_CHANNEL_COUNT];
+
+/**
+ * @brief 读出一个字段, 换算成 0.1 单位并四舍五入
+ */
+static int32_t Alarm_Read(const void *base, uint16_t offset, uint8_t type) {
+    const uint8_t *field = (const uint8_t *) base + offset;
+    if (type == ALARM_FIELD_FLOAT) {
+        const float value = *(const float *) field;
+        return (int32_t) (value * 10.0f + (value < 0 ? -0.5f : 0.5f));
+    }
+    return (int32_t) *(const uint16_t *) field * 10;
+}
+
+/**
+ * @brief 按当前状态和回差判断数值应处于的状态
+ */
+static Alarm_Level Alarm_Target(const Alarm_Channel *channel, uint8_t level, int32_t value, int32_t min,
+                                int32_t max) {
+    const uint8_t hasMin = channel->min != ALARM_NO_LIMIT;
+    const uint8_t hasMax = channel->max != ALARM_NO_LIMIT;
+
+    if (hasMax && value > max) {
+        return ALARM_LEVEL_HIGH;
+    }
+    if (hasMin && value < min) {
+        return ALARM_LEVEL_LOW;
+    }
+    // 在范围内: 已报警的一侧要越过回差才回到正常
+    if (level == ALARM_LEVEL_HIGH && value > max - channel->hysteresis) {
+        return ALARM_LEVEL_HIGH;
+    }
+    if (level == ALARM_LEVEL_LOW && value < min + channel->hysteresis) {
+        return ALARM_LEVEL_LOW;
+    }
+    return ALARM_LEVEL_NORMAL;
+}
+
+static Telemetry_Reason Alarm_Reason(const Alarm_Channel *channel, uint8_t level) {
+    return (Telemetry_Reason) (level == ALARM_LEVEL_LOW ? channel->lowReason : channel->highReason);
+}
+
+void Alarm_Reset(void) {
+    for (uint32_t i = 0; i < ALARM_CHANNEL_COUNT; i++) {
+        alarmState[i] = (Alarm_State) {0};
+    }
+}
+
+uint8_t Alarm_Update(const FarmState *state, const FarmSafeRange *range, uint32_t now, Alarm_Notify notify) {
+    uint8_t active = 0;
+
+    for (uint32_t i = 0; i < ALARM_CHANNEL_COUNT; i++) {
+        const Alarm_Channel *channel = &alarmChannel[i];
+        Alarm_State *alarm = &alarmState[i];
+        const int32_t value = Alarm_Read(state, channel->value, channel->type);
+        const int32_t min = channel->min != ALARM_NO_LIMIT ? Alarm_Read(range, channel->min, channel->type) : 0;
+        const int32_t max = channel->max != ALARM_NO_LIMIT ? Alarm_Read(range, channel->max, channel->type) : 0;
+        const Alarm_Level target = Alarm_Target(channel, alarm->level, value, min, max);
+
+        if (target == alarm->level) {
+            // 回到当前状态, 之前的偏离没有保持够时间, 作废
+            alarm->pending = alarm->level;
+        } else if (target != alarm->pending) {
+            alarm->pending = target;
+            alarm->pendingSince = now;
+        }
+
+        if (alarm->pending != alarm->level && now - alarm->pendingSince >= channel->holdS) {
+            // 从一侧直接跳到另一侧时先解除再报警
+            if (alarm->level != ALARM_LEVEL_NORMAL) {
+                notify(Alarm_Reason(channel, alarm->level), TELEMETRY_EVENT_CLEARED, value);
+            }
+            alarm->level = alarm->pending;
+            if (alarm->level != ALARM_LEVEL_NORMAL) {
+                notify(Alarm_Reason(channel, alarm->level), TELEMETRY_EVENT_RAISED, value);
+                alarm->notifiedAt = now;
+            }
+        } else if (alarm->level != ALARM_LEVEL_NORMAL && channel->reminderS != 0U &&
+                   now - alarm->notifiedAt >= channel->reminderS) {
+            notify(Alarm_Reason(channel, alarm->level), TELEMETRY_EVENT_REMINDER, value);
+            alarm->notifiedAt = now;
+        }
+
+        if (alarm->level != ALARM_LEVEL_NORMAL) {
+            active++;
+        }
+    }
+    return active;
+}
@@ -0,0 +1,48 @@
+#ifndef SMARTFARM_ALARM_H
+#define SMARTFARM_ALARM_H
+
+#include <stdint.h>
+
+#include "farmState.h"
+#include "telemetry.h"
+
+/**
+ * @file alarm.h
+ * @brief 环境参数报警状态机
+ *
+ * 每个报警通道(温度、湿度、降雨、土壤湿度、光照)有三个状态: 正常、过低、过高, 状态变化时才产生事件:
+ * - 超出阈值并连续保持 holdS 秒后进入报警状态, 产生 TELEMETRY_EVENT_RAISED
+ * - 报警后数值要越过回差(过高时低于 上限-回差, 过低时高于 下限+回差)并连续保持 holdS 秒才解除,
+ *   产生 TELEMETRY_EVENT_CLEARED; 在阈值附近抖动的数值不会反复报警/解除
+ * - 报警持续期间每 reminderS 秒产生一次 TELEMETRY_EVENT_REMINDER
+ * 以前每秒超出范围就发一条消息, 一个持续的异常会一直占满蓝牙队列, 现在同一异常只在开始、结束和提醒时各发一条
+ *
+ * 通道由 alarm.c 中的表描述(FarmState 中的数值、FarmSafeRange 中的上下限、报警原因、回差和时间),
+ * 增加通道只需在表中加一行。数值和阈值统一换算成 0.1 单位的整数比较。
+ * 本模块不依赖 HAL 和 FreeRTOS, 主机上的 alarm_bench 直接编译同一份代码回放带噪声的采样序列
+ */
+
+// 默认的最短保持时间(秒)
+#define ALARM_HOLD_S 3U
+// 默认的提醒周期(秒), 0 表示不提醒
+#define ALARM_REMINDER_S 300U
+
+/**
+ * @brief 事件回调
+ * @param value 当前数值, 单位 0.1
+ */
+typedef void (*Alarm_Notify)(Telemetry_Reason reason, Telemetry_Event event, int32_t value);
+
+/**
+ * @brief 清除全部通道的状态(全部回到正常, 不产生事件)
+ */
+void Alarm_Reset(void);
+
+/**
+ * @brief 用一次采样更新全部通道, 每个状态变化调用一次 notify
+ * @param now 当前时间(秒), 只用差值, 允许回绕
+ * @return 处于报警状态的通道数, 用于控制蜂鸣器
+ */
+uint8_t Alarm_Update(const FarmState *state, const FarmSafeRange *range, uint32_t now, Alarm_Notify notify);
+
+#endif //SMARTFARM_ALARM_H
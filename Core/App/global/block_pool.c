@@ -0,0 +1,56 @@
+#include "block_pool.h"
+
+#include <stddef.h>
+
+void *BlockPool_Alloc(BlockPool *pool) {
+    uint32_t mask = __atomic_load_n(&pool->freeMask, __ATOMIC_RELAXED);
+    uint32_t index;
+
+    // 比较交换失败说明位图被其他任务或中断改过, mask 已更新为新值, 重新选一块
+    do {
+        if (mask == 0U) {
+            __atomic_fetch_add(&pool->failures, 1U, __ATOMIC_RELAXED);
+            return NULL;
+        }
+        index = (uint32_t) __builtin_ctz(mask);
+    } while (!__atomic_compare_exchange_n(&pool->freeMask, &mask, mask & ~(1UL << index), 1,
+                                          __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+
+    const uint32_t used = __atomic_add_fetch(&pool->used, 1U, __ATOMIC_RELAXED);
+    uint32_t highWater = __atomic_load_n(&pool->highWater, __ATOMIC_RELAXED);
+    while (used > highWater &&
+           !__atomic_compare_exchange_n(&pool->highWater, &highWater, used, 1, __ATOMIC_RELAXED,
+                                        __ATOMIC_RELAXED)) {
+    }
+    return pool->storage + index * pool->blockSize;
+}
+
+uint8_t BlockPool_Free(BlockPool *pool, void *block) {
+    const uint8_t *address = (const uint8_t *) block;
+
+    if (address < pool->storage) {
+        return 0;
+    }
+    const uint32_t offset = (uint32_t) (address - pool->storage);
+    const uint32_t index = offset / pool->blockSize;
+    if (index >= pool->blockCount || offset % pool->blockSize != 0U) {
+        return 0;
+    }
+
+    // 先减占用再放回位图, 这块被其他任务立即分配走时占用也不会超过块数
+    const uint32_t bit = 1UL << index;
+    __atomic_fetch_sub(&pool->used, 1U, __ATOMIC_RELAXED);
+    if (__atomic_fetch_or(&pool->freeMask, bit, __ATOMIC_RELEASE) & bit) {
+        __atomic_fetch_add(&pool->used, 1U, __ATOMIC_RELAXED);
+        return 0; // 重复释放: 这一位本来就是 1, 或操作没有改变位图
+    }
+    return 1;
+}
+
+void BlockPool_GetStats(const BlockPool *pool, BlockPool_Stats *stats) {
+    stats->blockSize = pool->blockSize;
+    stats->blockCount = pool->blockCount;
+    stats->used = pool->used;
+    stats->highWater = pool->highWater;
+    stats->failures = pool->failures;
+}
@@ -0,0 +1,72 @@
+#ifndef SMARTFARM_BLOCK_POOL_H
+#define SMARTFARM_BLOCK_POOL_H
+
+#include <stdint.h>
+
+/**
+ * @file block_pool.h
+ * @brief 静态分配的定长块内存池
+ *
+ * 用来代替消息路径上的 pvPortMalloc/vPortFree:
+ * - 块在编译时静态分配, 不占 FreeRTOS 堆, 不会产生碎片; 池满时分配失败并计数, 不影响其他模块的堆分配
+ * - 空闲块用一个 32 位位图表示, 分配 = 找最低位的 1(CLZ/RBIT 指令) + 一次比较交换, 释放 = 一次原子或,
+ *   都是 O(1)
+ * - 位图用 LDREX/STREX(GCC __atomic 内建函数)修改, 不关中断也不用互斥量, 任务和中断里都可以分配和释放;
+ *   被中断打断时 STREX 失败重试一次即可
+ * - 记录当前占用、占用的最高水位和分配失败次数, 用来确定池的大小
+ */
+
+// 一个池最多的块数(位图的位数)
+#define BLOCK_POOL_MAX_BLOCKS 32U
+
+typedef struct {
+    uint8_t *storage;              // 块存储区, blockSize * blockCount 字节
+    uint16_t blockSize;            // 每块的字节数(4 字节对齐)
+    uint8_t blockCount;            // 块数, 不超过 BLOCK_POOL_MAX_BLOCKS
+    volatile uint32_t freeMask;    // 空闲块位图, 第 i 位为 1 表示第 i 块空闲
+    volatile uint32_t used;        // 当前已分配的块数
+    volatile uint32_t highWater;   // 已分配块数的最大值
+    volatile uint32_t failures;    // 池满导致分配失败的次数
+} BlockPool;
+
+typedef struct {
+    uint16_t blockSize;
+    uint8_t blockCount;
+    uint32_t used;
+    uint32_t highWater;
+    uint32_t failures;
+} BlockPool_Stats;
+
+/**
+ * @brief 定义一个块内存池及其静态存储区
+ * @param name 池的变量名
+ * @param size 每块的字节数, 向上对齐到 4 字节
+ * @param count 块数, 1 ~ BLOCK_POOL_MAX_BLOCKS
+ */
+#define BLOCK_POOL_DEFINE(name, size, count)                                                       \
+    _Static_assert((count) >= 1U && (count) <= BLOCK_POOL_MAX_BLOCKS, #name ": block count");      \
+    static uint32_t name##Storage[((size) + 3U) / 4U * (count)];                                   \
+    BlockPool name = {                                                                             \
+        .storage = (uint8_t *) name##Storage,                                                      \
+        .blockSize = (uint16_t) (((size) + 3U) & ~3U),                                             \
+        .blockCount = (count),                                                                     \
+        .freeMask = (count) == 32U ? 0xFFFFFFFFUL : (1UL << ((count) & 31U)) - 1U,                 \
+    }
+
+/**
+ * @brief 分配一块
+ * @return 块的地址(4 字节对齐); 池满时返回 NULL
+ * @note 可在中断中调用
+ */
+void *BlockPool_Alloc(BlockPool *pool);
+
+/**
+ * @brief 释放一块
+ * @return 1: 已释放; 0: 不是这个池的块或已经释放过, 池不变
+ * @note 可在中断中调用
+ */
+uint8_t BlockPool_Free(BlockPool *pool, void *block);
+
+void BlockPool_GetStats(const BlockPool *pool, BlockPool_Stats *stats);
+
+#endif //SMARTFARM_BLOCK_POOL_H
@@ -1,7 +1,12 @@
 
 #include "farmState.h"
 
-extern volatile uint8_t ble_pending_msgs = 0;
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "config_store.h"
+
+BLOCK_POOL_DEFINE(bleMsgPool, BLE_MSG_SIZE, BLE_MSG_POOL_BLOCKS);
 
 // 全局变量定义
 // 【修改这里】：暂时赋初值，防止屏幕上全显示 0
@@ -15,10 +20,14 @@ FarmState farmState = {
 };
 FarmSafeRange farmSafeRange; // 环境安全范围阈值，用户可通过界面修改
 
+// 阈值有未保存的修改，以及最后一次修改的时刻（内核节拍）
+static volatile uint8_t safeRangeDirty;
+static volatile uint32_t safeRangeChangedAt;
+
 /**
  * @brief 初始化环境安全范围阈值
  *
- * 设置默认的安全范围值，在系统启动时调用一次
+ * 先设置默认的安全范围值，再用Flash中保存的阈值覆盖（整个结构体一次读出），在系统启动时调用一次
  * 这些默认值适用于大多数农作物的生长环境
  *
  * 默认值说明：
@@ -47,4 +56,31 @@ void EnvSafeRange_Init() {
 
     // 最大降雨量阈值：80%
     farmSafeRange.maxRainGauge = 30;
+
+    // 用上次保存的阈值覆盖默认值（没有保存过或结构体长度变了时保持默认值）
+    ConfigStore_Init();
+    ConfigStore_Read(CONFIG_KEY_SAFE_RANGE, &farmSafeRange, sizeof(farmSafeRange));
+}
+
+void EnvSafeRange_Changed(void) {
+    safeRangeChangedAt = osKernelGetTickCount();
+    safeRangeDirty = 1;
+}
+
+/**
+ * @brief 防抖保存：连续调整期间只记录时刻，停下来ENV_SAFE_RANGE_SAVE_DELAY_MS之后才写一次Flash
+ *
+ * 先清除修改标志再复制阈值：复制过程中InputTask又修改时标志会重新置位，下一次再保存
+ */
+void EnvSafeRange_Save(void) {
+    FarmSafeRange snapshot;
+    if (!safeRangeDirty ||
+        osKernelGetTickCount() - safeRangeChangedAt < pdMS_TO_TICKS(ENV_SAFE_RANGE_SAVE_DELAY_MS)) {
+        return;
+    }
+    safeRangeDirty = 0;
+    memcpy(&snapshot, &farmSafeRange, sizeof(snapshot)); // 连同填充字节一起复制, 与Flash中的值逐字节比较
+    if (ConfigStore_Write(CONFIG_KEY_SAFE_RANGE, &snapshot, sizeof(snapshot)) != HAL_OK) {
+        safeRangeDirty = 1; // 写失败时下次再试
+    }
 }
@@ -6,6 +6,9 @@
 
 #include <stdint.h>
 
+#include "block_pool.h"
+#include "telemetry.h"
+
 /**
  * @file farmState.h
  * @brief 农场环境状态管理模块
@@ -29,8 +32,8 @@ typedef struct {
     uint16_t rainGauge;      // 降雨量（单位：百分比，0-100）
     uint16_t soilMoisture;   // 土壤湿度（单位：百分比，0-100）
     uint16_t lightIntensity; // 光照强度（单位：勒克斯 lx）
-    double pressure;     // 大气压 (Pa)
-    double bmp_temp;     // BMP280 内部温度 (通常用做校准参考，也可显示)
+    uint32_t pressure;       // 大气压（Q24.8 格式的 Pa，即 Pa*256）
+    int32_t bmp_temp;        // BMP280 内部温度（单位：0.01摄氏度，通常用做校准参考，也可显示）
 
     uint8_t waterPumpState;  // 水泵状态：0-关闭, 1-开启
 } FarmState;
@@ -58,15 +61,37 @@ typedef struct {
 extern FarmState farmState;        // 当前农场环境状态（由SensorTask更新）
 extern FarmSafeRange farmSafeRange; // 环境安全范围阈值（用户可配置）
 
+// 最后一次修改阈值之后多久写入Flash（毫秒），连续转动旋钮期间不写
+#define ENV_SAFE_RANGE_SAVE_DELAY_MS 3000
+
 /**
  * @brief 初始化环境安全范围阈值
  *
- * 设置默认的安全范围值，在系统启动时调用
+ * 读取上次保存在Flash中的阈值，没有保存过时使用默认值，在系统启动时调用
  * 用户后续可以通过界面修改这些值
  */
 void EnvSafeRange_Init();
 
-extern volatile uint8_t ble_pending_msgs ;
+/**
+ * @brief 标记阈值已被修改，由InputTask在每次修改后调用
+ */
+void EnvSafeRange_Changed(void);
+
+/**
+ * @brief 阈值修改后超过ENV_SAFE_RANGE_SAVE_DELAY_MS没有再修改时，把阈值写入Flash
+ * @note 由SensorTask周期调用（Flash只在SensorTask中擦写）
+ */
+void EnvSafeRange_Save(void);
+
+// 蓝牙消息池每块的字节数：一条Telemetry_Message，由BLETask按TELEMETRY_FORMAT编码后发送
+#define BLE_MSG_SIZE sizeof(Telemetry_Message)
+// 蓝牙消息池的块数，与freertos.c中BLEQueue的深度相同：分配到块的消息一定能放进队列
+#define BLE_MSG_POOL_BLOCKS 16
+
+/**
+ * @brief 蓝牙消息池：SensorTask分配并填写消息，BLETask编码写入发送缓冲区后释放
+ */
+extern BlockPool bleMsgPool;
 
 
 #endif //SMARTFARM_FARM_STATE_H
@@ -0,0 +1,428 @@
+#include "history.h"
+
+#include <string.h>
+
+/**
+ * @brief 一个序列在一种分辨率下的块环形缓冲区
+ */
+typedef struct {
+    uint8_t head;    // 正在写入的块
+    uint8_t used;    // 已使用的块数
+    uint16_t points; // 所有已使用块中的点数
+    int16_t last;    // 最新一个点的平均值
+    uint16_t version; // 改写已写入的数据时为奇数，见history.h中的并发说明
+} HistoryStream;
+
+/**
+ * @brief 正在合并的一个点
+ */
+typedef struct {
+    int16_t min;
+    int16_t max;
+    int32_t sum;
+} HistoryAccumulator;
+
+static HistoryBlock secondBlocks[HISTORY_SERIES_COUNT][HISTORY_SECOND_BLOCKS];
+static HistoryBlock minuteBlocks[HISTORY_SERIES_COUNT][HISTORY_MINUTE_BLOCKS];
+static HistoryBlock hourBlocks[HISTORY_SERIES_COUNT][HISTORY_HOUR_BLOCKS];
+static HistoryStream historyStreams[HISTORY_TIER_COUNT][HISTORY_SERIES_COUNT];
+
+static const uint8_t historyBlockCount[HISTORY_TIER_COUNT] = {
+    HISTORY_SECOND_BLOCKS, HISTORY_MINUTE_BLOCKS, HISTORY_HOUR_BLOCKS,
+};
+
+// 下一个分钟点 / 小时点的累加器，以及已经合并的个数
+static HistoryAccumulator minuteAccumulator[HISTORY_SERIES_COUNT];
+static HistoryAccumulator hourAccumulator[HISTORY_SERIES_COUNT];
+static uint8_t minuteSamples;
+static uint8_t hourMinutes;
+
+_Static_assert(sizeof(secondBlocks) + sizeof(minuteBlocks) + sizeof(hourBlocks) + sizeof(historyStreams) +
+               sizeof(minuteAccumulator) + sizeof(hourAccumulator) <= HISTORY_RAM_BUDGET,
+               "history buffers exceed HISTORY_RAM_BUDGET");
+
+#define HISTORY_BLOCK_BITS (HISTORY_BLOCK_BYTES * 8)
+
+// 原始编码每个点的位数：秒级点一个值，分钟/小时点平均值、最小值、最大值三个值
+#define HISTORY_RAW_BITS(aggregated) ((aggregated) ? 3 * 16 : 16)
+// 块写满时至少有的点数：压缩后放不下而原始编码能多放下一个点时改成原始编码
+#define HISTORY_MIN_BLOCK_POINTS(aggregated) (HISTORY_BLOCK_BITS / HISTORY_RAW_BITS(aggregated))
+// 最新一块刚开始时只有一个点，其余块都写满
+#define HISTORY_MIN_TIER_POINTS(blocks, aggregated) (((blocks) - 1) * HISTORY_MIN_BLOCK_POINTS(aggregated) + 1)
+
+_Static_assert(HISTORY_MIN_TIER_POINTS(HISTORY_SECOND_BLOCKS, 0) >= HISTORY_MIN_POINTS,
+               "HISTORY_SECOND_BLOCKS too small for HISTORY_MIN_POINTS");
+_Static_assert(HISTORY_MIN_TIER_POINTS(HISTORY_MINUTE_BLOCKS, 1) >= HISTORY_MIN_POINTS,
+               "HISTORY_MINUTE_BLOCKS too small for HISTORY_MIN_POINTS");
+_Static_assert(HISTORY_MIN_TIER_POINTS(HISTORY_HOUR_BLOCKS, 1) >= HISTORY_MIN_POINTS,
+               "HISTORY_HOUR_BLOCKS too small for HISTORY_MIN_POINTS");
+
+// ========================== 变长码 ==========================
+// 码字按写入顺序：0 -> "0"；<16 -> "10"+4位；<256 -> "110"+8位；<4096 -> "1110"+12位；其余 -> "1111"+16位
+// （块内从低位开始写）。原始编码的块不用变长码，每个值直接写16位
+
+static HistoryBlock *History_Blocks(HistoryTier tier, HistorySeries series) {
+    switch (tier) {
+    case HISTORY_TIER_MINUTE:
+        return minuteBlocks[series];
+    case HISTORY_TIER_HOUR:
+        return hourBlocks[series];
+    default:
+        return secondBlocks[series];
+    }
+}
+
+static uint16_t History_ZigZag(int16_t value) {
+    return (uint16_t) (((uint16_t) value << 1) ^ (uint16_t) (value >> 15));
+}
+
+static int16_t History_UnZigZag(uint16_t code) {
+    return (int16_t) ((code >> 1) ^ (uint16_t) -(int16_t) (code & 1));
+}
+
+static uint8_t History_CodeBits(uint16_t code) {
+    if (code == 0) return 1;
+    if (code < 16) return 2 + 4;
+    if (code < 256) return 3 + 8;
+    if (code < 4096) return 4 + 12;
+    return 4 + 16;
+}
+
+static void History_PutBits(HistoryBlock *block, uint32_t value, uint8_t bits) {
+    for (uint8_t i = 0; i < bits; i++, block->bits++) {
+        if (value & (1UL << i)) {
+            block->data[block->bits / 8] |= 1U << (block->bits % 8);
+        }
+    }
+}
+
+static void History_PutCode(HistoryBlock *block, uint16_t code) {
+    if (code == 0) {
+        History_PutBits(block, 0x0, 1);
+    } else if (code < 16) {
+        History_PutBits(block, 0x1 | (uint32_t) code << 2, 2 + 4);
+    } else if (code < 256) {
+        History_PutBits(block, 0x3 | (uint32_t) code << 3, 3 + 8);
+    } else if (code < 4096) {
+        History_PutBits(block, 0x7 | (uint32_t) code << 4, 4 + 12);
+    } else {
+        History_PutBits(block, 0xF | (uint32_t) code << 4, 4 + 16);
+    }
+}
+
+/**
+ * @brief 读取bits位，超出块的范围时返回0（写入时不会越界，只防止读到正在被改写的块）
+ */
+static uint16_t History_GetBits(const HistoryBlock *block, uint16_t *pos, uint8_t bits) {
+    uint16_t value = 0;
+    if (*pos + bits > HISTORY_BLOCK_BITS) {
+        *pos = HISTORY_BLOCK_BITS;
+        return 0;
+    }
+    for (uint8_t i = 0; i < bits; i++, (*pos)++) {
+        if (block->data[*pos / 8] & (1U << (*pos % 8))) {
+            value |= 1U << i;
+        }
+    }
+    return value;
+}
+
+static uint16_t History_GetCode(const HistoryBlock *block, uint16_t *pos) {
+    if (!History_GetBits(block, pos, 1)) return 0;
+    if (!History_GetBits(block, pos, 1)) return History_GetBits(block, pos, 4);
+    if (!History_GetBits(block, pos, 1)) return History_GetBits(block, pos, 8);
+    if (!History_GetBits(block, pos, 1)) return History_GetBits(block, pos, 12);
+    return History_GetBits(block, pos, 16);
+}
+
+// ========================== 点的编码 ==========================
+
+/**
+ * @brief 一个点写入块中需要的位数
+ * @param last 上一个点的平均值
+ */
+static uint8_t History_PointBits(const HistoryBlock *block, int16_t last, HistoryPoint point, uint8_t aggregated) {
+    if (block->raw) {
+        return HISTORY_RAW_BITS(aggregated);
+    }
+    uint8_t bits = History_CodeBits(History_ZigZag((int16_t) (point.mean - last)));
+    if (aggregated) {
+        bits += History_CodeBits((uint16_t) (point.mean - point.min));
+        bits += History_CodeBits((uint16_t) (point.max - point.mean));
+    }
+    return bits;
+}
+
+static void History_PutPoint(HistoryBlock *block, int16_t last, HistoryPoint point, uint8_t aggregated) {
+    if (block->raw) {
+        History_PutBits(block, (uint16_t) point.mean, 16);
+        if (aggregated) {
+            History_PutBits(block, (uint16_t) point.min, 16);
+            History_PutBits(block, (uint16_t) point.max, 16);
+        }
+        return;
+    }
+    History_PutCode(block, History_ZigZag((int16_t) (point.mean - last)));
+    if (aggregated) {
+        History_PutCode(block, (uint16_t) (point.mean - point.min));
+        History_PutCode(block, (uint16_t) (point.max - point.mean));
+    }
+}
+
+/**
+ * @brief 从块中解码一个点
+ * @param mean 输入上一个点的平均值，输出这个点的平均值
+ */
+static void History_GetPoint(const HistoryBlock *block, uint8_t raw, uint16_t *pos, int16_t *mean,
+                             HistoryPoint *point, uint8_t aggregated) {
+    if (raw) {
+        *mean = (int16_t) History_GetBits(block, pos, 16);
+        point->mean = *mean;
+        point->min = aggregated ? (int16_t) History_GetBits(block, pos, 16) : *mean;
+        point->max = aggregated ? (int16_t) History_GetBits(block, pos, 16) : *mean;
+        return;
+    }
+    *mean = (int16_t) (*mean + History_UnZigZag(History_GetCode(block, pos)));
+    point->mean = *mean;
+    point->min = *mean;
+    point->max = *mean;
+    if (aggregated) {
+        point->min = (int16_t) (*mean - History_GetCode(block, pos));
+        point->max = (int16_t) (*mean + History_GetCode(block, pos));
+    }
+}
+
+// ========================== 写入 ==========================
+
+/**
+ * @brief 开始改写已经写入的数据，版本号变为奇数
+ * @note 顺序一致的原子写带内存屏障，之后对块的修改不会被提前到它前面
+ */
+static void History_BeginRewrite(HistoryStream *stream) {
+    __atomic_store_n(&stream->version, (uint16_t) (stream->version + 1U), __ATOMIC_SEQ_CST);
+}
+
+static void History_EndRewrite(HistoryStream *stream) {
+    __atomic_store_n(&stream->version, (uint16_t) (stream->version + 1U), __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief 开始新块；块都用完时复用最老的一块，其中的点被丢弃
+ */
+static HistoryBlock *History_NewBlock(HistoryTier tier, HistoryStream *stream, HistoryBlock *blocks) {
+    History_BeginRewrite(stream);
+    if (stream->used == 0) {
+        stream->head = 0;
+        stream->used = 1;
+    } else {
+        stream->head = (stream->head + 1) % historyBlockCount[tier];
+        if (stream->used < historyBlockCount[tier]) {
+            stream->used++;
+        } else {
+            stream->points -= blocks[stream->head].count; // 丢弃最老的一块
+        }
+    }
+    HistoryBlock *block = &blocks[stream->head];
+    block->count = 0;
+    block->raw = 0;
+    block->bits = 0;
+    block->base = stream->last;
+    memset(block->data, 0, sizeof(block->data));
+    History_EndRewrite(stream);
+    return block;
+}
+
+/**
+ * @brief 把写满的压缩块就地改写成原始编码（调用者已确认改写后还能多放下一个点）
+ */
+static void History_ToRaw(HistoryStream *stream, HistoryBlock *block, uint8_t aggregated) {
+    HistoryPoint points[HISTORY_BLOCK_BITS / 16];
+    uint16_t pos = 0;
+    int16_t mean = block->base;
+    for (uint8_t i = 0; i < block->count; i++) {
+        History_GetPoint(block, 0, &pos, &mean, &points[i], aggregated);
+    }
+
+    History_BeginRewrite(stream);
+    block->raw = 1;
+    block->bits = 0;
+    memset(block->data, 0, sizeof(block->data));
+    for (uint8_t i = 0; i < block->count; i++) {
+        History_PutPoint(block, 0, points[i], aggregated);
+    }
+    History_EndRewrite(stream);
+}
+
+/**
+ * @brief 向一个序列追加一个点
+ *
+ * 当前块放不下时，改成原始编码能多放下这个点就改写当前块，否则开始新块
+ */
+static void History_Append(HistoryTier tier, HistorySeries series, HistoryPoint point) {
+    HistoryStream *stream = &historyStreams[tier][series];
+    HistoryBlock *blocks = History_Blocks(tier, series);
+    const uint8_t aggregated = tier != HISTORY_TIER_SECOND;
+    HistoryBlock *block = &blocks[stream->head];
+
+    if (stream->used == 0) {
+        stream->last = point.mean;
+        block = History_NewBlock(tier, stream, blocks);
+    } else if (block->count == UINT8_MAX ||
+               block->bits + History_PointBits(block, stream->last, point, aggregated) > HISTORY_BLOCK_BITS) {
+        if (!block->raw && (block->count + 1U) * HISTORY_RAW_BITS(aggregated) <= HISTORY_BLOCK_BITS) {
+            History_ToRaw(stream, block, aggregated);
+        } else {
+            block = History_NewBlock(tier, stream, blocks);
+        }
+    }
+
+    History_PutPoint(block, stream->last, point, aggregated);
+    // 先写数据再加点数，读取者按点数解码时数据已经写好
+    __atomic_store_n(&block->count, (uint8_t) (block->count + 1U), __ATOMIC_RELEASE);
+    stream->points++;
+    stream->last = point.mean;
+}
+
+/**
+ * @brief 记录一次采样
+ *
+ * 写入秒级序列并合并到分钟累加器；累加满HISTORY_SAMPLES_PER_MINUTE次后生成一个分钟点，
+ * 由History_AddMinute()写入分钟级序列并合并到小时累加器。每个点只被合并一次，不需要回头遍历历史数据
+ */
+const HistoryPoint *History_Add(const int16_t values[HISTORY_SERIES_COUNT]) {
+    static HistoryPoint minutePoints[HISTORY_SERIES_COUNT];
+
+    for (uint8_t s = 0; s < HISTORY_SERIES_COUNT; s++) {
+        HistoryAccumulator *acc = &minuteAccumulator[s];
+        History_Append(HISTORY_TIER_SECOND, s, (HistoryPoint) {values[s], values[s], values[s]});
+        if (minuteSamples == 0) {
+            acc->min = values[s];
+            acc->max = values[s];
+            acc->sum = 0;
+        }
+        if (values[s] < acc->min) acc->min = values[s];
+        if (values[s] > acc->max) acc->max = values[s];
+        acc->sum += values[s];
+    }
+    if (++minuteSamples < HISTORY_SAMPLES_PER_MINUTE) {
+        return NULL;
+    }
+    minuteSamples = 0;
+
+    for (uint8_t s = 0; s < HISTORY_SERIES_COUNT; s++) {
+        const HistoryAccumulator *minute = &minuteAccumulator[s];
+        minutePoints[s] = (HistoryPoint) {minute->min, minute->max, (int16_t) (minute->sum / HISTORY_SAMPLES_PER_MINUTE)};
+    }
+    History_AddMinute(minutePoints);
+    return minutePoints;
+}
+
+/**
+ * @brief 写入一个分钟点，再合并到小时累加器（各分钟点采样数相同，平均值的平均即为总平均）
+ */
+void History_AddMinute(const HistoryPoint points[HISTORY_SERIES_COUNT]) {
+    for (uint8_t s = 0; s < HISTORY_SERIES_COUNT; s++) {
+        const HistoryPoint point = points[s];
+        HistoryAccumulator *acc = &hourAccumulator[s];
+        History_Append(HISTORY_TIER_MINUTE, s, point);
+        if (hourMinutes == 0) {
+            acc->min = point.min;
+            acc->max = point.max;
+            acc->sum = 0;
+        }
+        if (point.min < acc->min) acc->min = point.min;
+        if (point.max > acc->max) acc->max = point.max;
+        acc->sum += point.mean;
+    }
+    if (++hourMinutes < HISTORY_MINUTES_PER_HOUR) {
+        return;
+    }
+    hourMinutes = 0;
+
+    for (uint8_t s = 0; s < HISTORY_SERIES_COUNT; s++) {
+        const HistoryAccumulator *hour = &hourAccumulator[s];
+        History_Append(HISTORY_TIER_HOUR, s,
+                       (HistoryPoint) {hour->min, hour->max, (int16_t) (hour->sum / HISTORY_MINUTES_PER_HOUR)});
+    }
+}
+
+// ========================== 读取 ==========================
+
+uint16_t History_Count(HistorySeries series, HistoryTier tier) {
+    return historyStreams[tier][series].points;
+}
+
+uint16_t History_Size(HistorySeries series, HistoryTier tier) {
+    const HistoryStream *stream = &historyStreams[tier][series];
+    const HistoryBlock *blocks = History_Blocks(tier, series);
+    uint16_t size = 0;
+    for (uint8_t i = 0; i < stream->used; i++) {
+        size += sizeof(HistoryBlock) - HISTORY_BLOCK_BYTES + (blocks[i].bits + 7) / 8;
+    }
+    return size;
+}
+
+/**
+ * @brief 解码器切换到下一块
+ */
+static void History_LoadBlock(HistoryReader *reader, uint8_t block) {
+    reader->block = block;
+    reader->left = __atomic_load_n(&reader->blocks[block].count, __ATOMIC_ACQUIRE);
+    reader->raw = reader->blocks[block].raw;
+    reader->bit = 0;
+    reader->mean = reader->blocks[block].base;
+}
+
+void History_Read(HistoryReader *reader, HistorySeries series, HistoryTier tier, uint16_t first) {
+    const HistoryStream *stream = &historyStreams[tier][series];
+    reader->blocks = History_Blocks(tier, series);
+    reader->blockCount = historyBlockCount[tier];
+    reader->aggregated = tier != HISTORY_TIER_SECOND;
+    reader->version = &stream->version;
+    reader->seen = __atomic_load_n(&stream->version, __ATOMIC_ACQUIRE);
+    reader->stale = reader->seen & 1U; // 写入者正在改写
+    reader->blocksLeft = reader->stale ? 0 : stream->used;
+    reader->left = 0;
+    if (reader->blocksLeft == 0) {
+        return;
+    }
+    History_LoadBlock(reader, (stream->head + reader->blockCount - stream->used + 1) % reader->blockCount);
+
+    // 整块跳过，不需要解码
+    while (first >= reader->left && reader->blocksLeft > 1) {
+        first -= reader->left;
+        reader->blocksLeft--;
+        History_LoadBlock(reader, (reader->block + 1) % reader->blockCount);
+    }
+    HistoryPoint point;
+    while (first-- > 0 && History_Next(reader, &point)) {
+    }
+}
+
+uint8_t History_Next(HistoryReader *reader, HistoryPoint *point) {
+    while (reader->left == 0) {
+        if (reader->blocksLeft <= 1) {
+            reader->blocksLeft = 0;
+            return 0;
+        }
+        reader->blocksLeft--;
+        History_LoadBlock(reader, (reader->block + 1) % reader->blockCount);
+    }
+    History_GetPoint(&reader->blocks[reader->block], reader->raw, &reader->bit, &reader->mean, point,
+                     reader->aggregated);
+
+    // 解码之后再核对版本号：解码期间块被丢弃或改写过，这个点和之后的点都不可信
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(reader->version, __ATOMIC_RELAXED) != reader->seen) {
+        reader->stale = 1;
+        reader->left = 0;
+        reader->blocksLeft = 0;
+        return 0;
+    }
+    reader->left--;
+    return 1;
+}
+
+uint8_t History_Stale(const HistoryReader *reader) {
+    return reader->stale;
+}
@@ -0,0 +1,164 @@
+#ifndef SMARTFARM_HISTORY_H
+#define SMARTFARM_HISTORY_H
+
+#include <stdint.h>
+
+/**
+ * @file history.h
+ * @brief 多分辨率传感器历史数据（压缩存储）
+ *
+ * 每个序列按三种时间分辨率保存历史：
+ * - 秒级：每次采样（约1秒）一个点
+ * - 分钟级：每60次采样合并成一个点
+ * - 小时级：每60个分钟点合并成一个点
+ *
+ * 分钟级和小时级的每个点保存该时间段内的最小值、最大值和平均值，
+ * 由累加器逐次合并，每次采样的开销是固定的O(1)
+ *
+ * 压缩存储：
+ * - 每个序列的每种分辨率是一串固定大小的块（HistoryBlock），写满后开始新块，块用完时丢弃最老的一块
+ * - 块内按位紧密排列：平均值存与上一个点的差值（zigzag），分钟/小时点再存 平均值-最小值、最大值-平均值
+ * - 每个值是一个变长码：0 -> 1位；|差值|<8 -> 6位；<128 -> 11位；<2048 -> 16位；其余 -> 20位
+ * - 变化缓慢的传感器数据大多只需几位，同样的RAM能保存的点数是原始int16的数倍；
+ *   能保存多少点取决于数据变化的剧烈程度，用History_Count()查询
+ * - 噪声大的数据压缩后反而比原始int16长：一块写满时如果改成原始编码（每个值16位）能多放下一个点，
+ *   就把这一块就地改写成原始编码。因此每块至少有 块位数/原始位数 个点，块数按这个最坏情况保证
+ *   每种分辨率至少保存HISTORY_MIN_POINTS个点（一屏曲线）
+ * - 读取用HistoryReader从最老的点顺序解码，不需要把整串数据解压到RAM
+ *
+ * 并发：只有一个写入者（SensorTask），读取者不加锁。写入者丢弃最老的块或改写一块之前把序列的版本号改成奇数，
+ * 改完再改回偶数；HistoryReader每解码一个点都核对版本号，变了就停止读取并由History_Stale()报告，
+ * 调用者重新读取即可。追加点只写在已读范围之后，不影响正在读的点
+ *
+ * 数据由SensorTask写入，由ScreenTask的历史曲线页读取；分钟点同时追加到Flash日志（flash_log.h），
+ * 开机时用History_AddMinute()回放，重建分钟级和小时级历史
+ */
+
+// 每个块的数据字节数
+#define HISTORY_BLOCK_BYTES 32
+// 最坏情况下（全部是原始编码的块，最新的一块刚开始）每个序列每种分辨率至少保存的点数
+#define HISTORY_MIN_POINTS 128
+// 每个序列在各分辨率下的块数，history.c中按HISTORY_MIN_POINTS静态检查
+#define HISTORY_SECOND_BLOCKS 9
+#define HISTORY_MINUTE_BLOCKS 27
+#define HISTORY_HOUR_BLOCKS 27
+// 每个分钟点合并的采样数 / 每个小时点合并的分钟点数
+#define HISTORY_SAMPLES_PER_MINUTE 60
+#define HISTORY_MINUTES_PER_HOUR 60
+
+/**
+ * @brief 历史数据序列
+ *
+ * 各序列的存储单位（int16_t）：
+ * - 温度、湿度：0.1℃、0.1%
+ * - 气压：0.1hPa
+ * - 土壤湿度、降雨量：%
+ * - 光照强度：lx（超过32767时按32767保存）
+ */
+typedef enum {
+  HISTORY_TEMPERATURE = 0,
+  HISTORY_HUMIDITY,
+  HISTORY_PRESSURE,
+  HISTORY_SOIL_MOISTURE,
+  HISTORY_RAIN_GAUGE,
+  HISTORY_LIGHT_INTENSITY,
+  HISTORY_SERIES_COUNT,
+} HistorySeries;
+
+/**
+ * @brief 时间分辨率
+ */
+typedef enum {
+  HISTORY_TIER_SECOND = 0,
+  HISTORY_TIER_MINUTE,
+  HISTORY_TIER_HOUR,
+  HISTORY_TIER_COUNT,
+} HistoryTier;
+
+/**
+ * @brief 一个历史点：时间段内的最小值、最大值和平均值（秒级点三者相同）
+ */
+typedef struct {
+  int16_t min;
+  int16_t max;
+  int16_t mean;
+} HistoryPoint;
+
+/**
+ * @brief 一个压缩块
+ */
+typedef struct {
+  int16_t base;   // 块内第一个点的平均值以此为参考计算差值
+  uint8_t count;  // 块内的点数
+  uint8_t raw;    // 1: 原始编码，每个值直接存16位
+  uint16_t bits;  // 已写入的位数
+  uint8_t data[HISTORY_BLOCK_BYTES];
+} HistoryBlock;
+
+/**
+ * @brief 顺序读取一个序列的解码器，由History_Read()初始化
+ */
+typedef struct {
+  const HistoryBlock *blocks; // 该序列该分辨率的所有块
+  uint8_t blockCount;         // 块的总数
+  uint8_t block;              // 当前块下标
+  uint8_t blocksLeft;         // 还没读完的块数（含当前块）
+  uint8_t left;               // 当前块中还没读的点数
+  uint16_t bit;               // 当前块中的读取位置
+  uint8_t aggregated;         // 1: 分钟/小时点（带最小值、最大值）
+  uint8_t raw;                // 当前块是原始编码
+  uint8_t stale;              // 1: 读取途中数据被改写，已停止读取
+  int16_t mean;               // 上一个点的平均值
+  const uint16_t *version;    // 序列的版本号
+  uint16_t seen;              // History_Read()时的版本号
+} HistoryReader;
+
+// 所有历史数据占用的RAM上限（字节），history.c中静态检查
+#define HISTORY_RAM_BUDGET 14848
+
+/**
+ * @brief 记录一次采样
+ * @param values 各序列的当前值，按HistorySeries排列，单位见HistorySeries
+ * @return 这次采样凑满一分钟时返回刚生成的分钟点（按HistorySeries排列，下次调用前有效），否则返回NULL
+ * @note 由SensorTask每次采样后调用
+ */
+const HistoryPoint *History_Add(const int16_t values[HISTORY_SERIES_COUNT]);
+
+/**
+ * @brief 直接写入一个分钟点（合并到小时级的方式与History_Add()生成的分钟点相同）
+ * @param points 各序列的分钟点，按HistorySeries排列
+ * @note 开机时回放Flash日志中保存的分钟点
+ */
+void History_AddMinute(const HistoryPoint points[HISTORY_SERIES_COUNT]);
+
+/**
+ * @brief 获取某一序列某一分辨率当前保存的点数
+ */
+uint16_t History_Count(HistorySeries series, HistoryTier tier);
+
+/**
+ * @brief 获取某一序列某一分辨率当前占用的字节数（块头+已写入的数据）
+ */
+uint16_t History_Size(HistorySeries series, HistoryTier tier);
+
+/**
+ * @brief 开始顺序读取
+ * @param reader 解码器
+ * @param series 序列
+ * @param tier 分辨率
+ * @param first 从第几个点开始读（0为最老的点），之前的整块直接跳过，块内的点解码后丢弃
+ */
+void History_Read(HistoryReader *reader, HistorySeries series, HistoryTier tier, uint16_t first);
+
+/**
+ * @brief 读取下一个点
+ * @return 1: 读到了一个点；0: 已经读完，或者数据被改写（History_Stale()）
+ */
+uint8_t History_Next(HistoryReader *reader, HistoryPoint *point);
+
+/**
+ * @brief 读取途中SensorTask丢弃或改写了正在读的数据，已经读出的点不完整，需要重新History_Read()
+ */
+uint8_t History_Stale(const HistoryReader *reader);
+
+#endif //SMARTFARM_HISTORY_H
@@ -0,0 +1,84 @@
+#include "power.h"
+
+#include "cmsis_os2.h"
+#include "FreeRTOS.h"
+#include "main.h"
+#include "task.h"
+#include "timers.h"
+
+// 睡眠屏障的位数, 与 power.h 中的 POWER_ALL 对应
+#define POWER_BIT_COUNT 6U
+_Static_assert(POWER_ALL < (1UL << POWER_BIT_COUNT), "POWER_BIT_COUNT must cover POWER_ALL");
+
+// 定时器命令队列满时没能推迟的置位: 位掩码和各位的空闲检查, 由 Power_IsIdle 直接检查
+static uint32_t powerDeferred;
+static Power_IdleCheck powerDeferredChecks[POWER_BIT_COUNT];
+static uint32_t powerPendFailures;
+
+/**
+ * @brief 在调度器挂起的状态下检查并置位, 任务不能在检查和置位之间开始新的工作
+ * @note 由任务或定时器服务任务调用
+ */
+static void Power_Settle(void *isIdle, uint32_t bits) {
+    vTaskSuspendAll();
+    if (((Power_IdleCheck) isIdle)()) {
+        osEventFlagsSet(PowerEventHandle, bits);
+    }
+    (void) xTaskResumeAll();
+}
+
+/**
+ * @brief 调度器启动前(例如 main 中的 printf)不修改事件组
+ */
+static uint8_t Power_Running(void) {
+    return xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED;
+}
+
+void Power_Init(void) {
+    osEventFlagsSet(PowerEventHandle, POWER_ALL);
+}
+
+void Power_Busy(uint32_t bits) {
+    if (Power_Running()) {
+        __atomic_fetch_and(&powerDeferred, ~bits, __ATOMIC_RELAXED);
+        osEventFlagsClear(PowerEventHandle, bits);
+    }
+}
+
+void Power_Idle(uint32_t bits, Power_IdleCheck isIdle) {
+    if (Power_Running()) {
+        Power_Settle((void *) isIdle, bits);
+    }
+}
+
+void Power_IdleFromISR(uint32_t bits, Power_IdleCheck isIdle) {
+    // 定时器服务任务优先级最低, 本来就要等其他任务都挂起后才运行, 不需要在中断退出时切换任务
+    if (!Power_Running() || xTimerPendFunctionCallFromISR(Power_Settle, (void *) isIdle, bits, NULL) == pdPASS) {
+        return;
+    }
+    // 命令队列已满: xEventGroupSetBitsFromISR 同样要经过这个队列, 只能记下来留给 Power_IsIdle 检查,
+    // 否则这一位要等子系统下次完成工作才会置位, 期间一直进不了 STOP 模式
+    __atomic_fetch_add(&powerPendFailures, 1U, __ATOMIC_RELAXED);
+    for (uint32_t i = 0; i < POWER_BIT_COUNT; i++) {
+        if ((bits & (1UL << i)) != 0U) {
+            powerDeferredChecks[i] = isIdle;
+        }
+    }
+    __atomic_fetch_or(&powerDeferred, bits, __ATOMIC_RELEASE);
+}
+
+uint8_t Power_IsIdle(void) {
+    uint32_t bits = osEventFlagsGet(PowerEventHandle);
+    const uint32_t deferred = __atomic_load_n(&powerDeferred, __ATOMIC_ACQUIRE) & ~bits;
+
+    for (uint32_t i = 0; i < POWER_BIT_COUNT; i++) {
+        if ((deferred & (1UL << i)) != 0U && powerDeferredChecks[i]()) {
+            bits |= 1UL << i;
+        }
+    }
+    return (bits & POWER_ALL) == POWER_ALL;
+}
+
+uint32_t Power_GetPendFailures(void) {
+    return __atomic_load_n(&powerPendFailures, __ATOMIC_RELAXED);
+}
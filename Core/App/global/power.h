@@ -0,0 +1,67 @@
+#ifndef SMARTFARM_POWER_H
+#define SMARTFARM_POWER_H
+
+#include <stdint.h>
+
+/**
+ * @file power.h
+ * @brief 进入 STOP 模式前的睡眠屏障
+ *
+ * 每个会在后台继续工作的子系统在 PowerEvent 事件组中有一位, 置位表示空闲:
+ * - 开始工作时在任务中调用 Power_Busy 清除自己的位
+ * - 工作完成时在完成中断中调用 Power_IdleFromISR, 或在任务中调用 Power_Idle
+ * 空闲任务进入 STOP 模式前(StopModeRtc.c)用 Power_IsIdle 检查全部位都已置位, 否则只进入 Sleep 模式等完成中断,
+ * 不再逐个子系统每毫秒轮询
+ *
+ * 中断不能直接修改事件组, 置位由定时器服务任务在中断之后执行(xTimerPendFunctionCallFromISR)。
+ * 延后执行时子系统可能已经开始了新的工作, 因此置位前先在调度器挂起的状态下再调用一次子系统的空闲检查,
+ * 检查通过才置位; 任务中的 Power_Busy 不会插在检查和置位之间。
+ * 定时器命令队列满、推迟失败时, 该位和它的空闲检查记在一旁, 由 Power_IsIdle 每次直接检查, 直到子系统再次 Power_Busy
+ */
+
+// 子系统的空闲位
+#define POWER_BLE_TX    0x01U   // 蓝牙: 队列中的消息和 UART2 发送环形缓冲区
+#define POWER_DEBUG_LOG 0x02U   // 调试串口 USART1 的 printf 输出
+#define POWER_I2C       0x04U   // I2C2 传输队列
+#define POWER_DISPLAY   0x08U   // 已请求但还没有交给 I2C2 的屏幕刷新
+#define POWER_BEEP      0x10U   // 蜂鸣器: 响铃的半个周期里 TIM3 输出 PWM
+#define POWER_KNOB      0x20U   // 旋钮: 阈值设置页上 TIM4 对编码器计数
+#define POWER_ALL       (POWER_BLE_TX | POWER_DEBUG_LOG | POWER_I2C | POWER_DISPLAY | POWER_BEEP | POWER_KNOB)
+
+/**
+ * @brief 子系统的空闲检查, 在调度器挂起时调用, 不能阻塞
+ */
+typedef uint8_t (*Power_IdleCheck)(void);
+
+/**
+ * @brief 全部子系统初始为空闲, 在 PowerEvent 创建后调用
+ */
+void Power_Init(void);
+
+/**
+ * @brief 子系统开始工作(任务中调用)
+ */
+void Power_Busy(uint32_t bits);
+
+/**
+ * @brief 子系统可能已经空闲: isIdle 返回 1 时置位(任务中调用)
+ */
+void Power_Idle(uint32_t bits, Power_IdleCheck isIdle);
+
+/**
+ * @brief 同 Power_Idle, 在完成中断中调用, 由定时器服务任务稍后检查并置位
+ */
+void Power_IdleFromISR(uint32_t bits, Power_IdleCheck isIdle);
+
+/**
+ * @brief 全部子系统是否空闲, 不阻塞(空闲任务在调度器挂起时调用)
+ * @return 1 表示全部空闲
+ */
+uint8_t Power_IsIdle(void);
+
+/**
+ * @brief Power_IdleFromISR 因定时器命令队列满而推迟失败的次数
+ */
+uint32_t Power_GetPendFailures(void);
+
+#endif //SMARTFARM_POWER_H
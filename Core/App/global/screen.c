@@ -3,13 +3,29 @@
 //
 
 #include "screen.h"
-
-SensorHistory_t soilHistory = { {0}, 0 }; // 初始化土壤缓冲区
-SensorHistory_t rainHistory = { {0}, 0 }; // 【新增】：初始化降雨量缓冲区
-SensorHistory_t lightHistory = { {0}, 0 }; // 【新增】：初始化光照缓冲区
+#include "main.h"
+#include "power.h"
 
 volatile uint32_t ui_keep_awake_ms = 6000;
 
+ScreenFrameStats screenFrameStats;
+
+/**
+ * @brief 请求ScreenTask刷新屏幕
+ *
+ * 在ScreenEvent事件组中置位，ScreenTask按SCREEN_MAX_FPS限速后渲染一帧，
+ * 两帧之间的多个请求只渲染一次；请求在交给I2C2之前占用睡眠屏障的POWER_DISPLAY位
+ */
+void Screen_Notify(uint32_t events) {
+    screenFrameStats.requests++;
+    Power_Busy(POWER_DISPLAY);
+    osEventFlagsSet(ScreenEventHandle, events);
+}
+
+uint8_t Screen_IsIdle(void) {
+    return (osEventFlagsGet(ScreenEventHandle) & SCREEN_EVENT_ALL) == 0U;
+}
+
 // 全局变量定义
 ScreenPage pageIndex = PAGE_HOME1; // 当前页面索引，默认为首页
 
@@ -104,3 +120,18 @@ void RangeEditState_Toggle() {
         RangeEditState_QuitEditing();
     }
 }
+
+// 全局变量定义
+HistoryTier historyTier = HISTORY_TIER_SECOND; // 历史曲线页的时间分辨率，默认为秒级
+
+/**
+ * @brief 切换历史曲线页的时间分辨率
+ *
+ * 调用时机：在历史曲线页，InputTask检测到KEY3按下时调用
+ */
+void HistoryTier_Next() {
+    historyTier++;
+    if (historyTier == HISTORY_TIER_COUNT) {
+        historyTier = HISTORY_TIER_SECOND;
+    }
+}
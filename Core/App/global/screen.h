@@ -7,6 +7,8 @@
 
 #include <stdint.h>
 
+#include "history.h"
+
 /**
  * @file screen.h
  * @brief 屏幕页面和阈值编辑状态管理模块
@@ -31,6 +33,9 @@ typedef enum {
   PAGE_HISTORY = 3,  // 【新增】：历史数据曲线页
   PAGE_HISTORY_RAIN = 4, // 【新增】：降雨量曲线页
   PAGE_HISTORY_LIGHT = 5, // 【新增】：降雨量曲线页
+  PAGE_HISTORY_TEMPERATURE = 6, // 温度曲线页
+  PAGE_HISTORY_HUMIDITY = 7,    // 湿度曲线页
+  PAGE_HISTORY_PRESSURE = 8,    // 气压曲线页
   PAGE_End,       // 结束标志：用于循环切换
 } ScreenPage;
 
@@ -117,23 +122,63 @@ void RangeEditState_QuitEditing();
  */
 void RangeEditState_Toggle();
 
-// 曲线图最大容量，恰好对应 OLED 的 128 列像素
-#define HISTORY_MAX_LEN 128
+// 是否为历史曲线页
+#define SCREEN_IS_HISTORY_PAGE(page) ((page) >= PAGE_HISTORY && (page) < PAGE_End)
 
-// 定义历史数据结构体
-typedef struct {
-  uint8_t buffer[HISTORY_MAX_LEN]; // 存放历史数据的数组 (0~100)
-  uint8_t head_index;              // 指示下一次写入的位置 (0~127)
-} SensorHistory_t;
+extern HistoryTier historyTier; // 历史曲线页当前显示的时间分辨率
 
-// 声明外部变量
-extern SensorHistory_t soilHistory; // 土壤历史数据
-extern SensorHistory_t rainHistory; // 【新增】：降雨量历史数据
-extern SensorHistory_t lightHistory; // 【新增】：光照历史数据
+/**
+ * @brief 切换历史曲线页的时间分辨率
+ *
+ * 循环切换：秒 -> 分钟 -> 小时 -> 秒
+ * 在历史曲线页，由InputTask在用户按下KEY3时调用
+ */
+void HistoryTier_Next();
 
 //开机清醒时间，保证在低功耗睡眠前开机动画渲染完毕
 extern volatile uint32_t ui_keep_awake_ms;
 
+// ========================== 刷新请求 ==========================
+
+/**
+ * @brief 屏幕刷新请求事件(ScreenEvent事件组中的位)
+ *
+ * ScreenTask平时阻塞在事件组上，只有显示内容可能变化时才渲染一帧
+ */
+#define SCREEN_EVENT_DATA   0x01U // SensorTask更新了farmState/历史数据
+#define SCREEN_EVENT_INPUT  0x02U // InputTask切换了页面或修改了阈值
+#define SCREEN_EVENT_BLINK  0x04U // 编辑闪烁定时器翻转了下划线
+#define SCREEN_EVENT_ALL    (SCREEN_EVENT_DATA | SCREEN_EVENT_INPUT | SCREEN_EVENT_BLINK)
+
+// 最高帧率：两帧之间至少间隔 1000/SCREEN_MAX_FPS 毫秒，期间到达的请求合并为一帧
+#define SCREEN_MAX_FPS 25
+// 编辑模式下划线的闪烁半周期（毫秒）
+#define SCREEN_BLINK_MS 250
+
+/**
+ * @brief 屏幕刷新统计，由SensorTask经调试串口输出
+ */
+typedef struct {
+  volatile uint32_t requests; // Screen_Notify()调用次数
+  uint32_t rendered;          // 渲染的帧数
+  uint32_t skipped;           // 被合并到其他帧、没有单独渲染的请求数
+} ScreenFrameStats;
+
+extern ScreenFrameStats screenFrameStats;
+
+/**
+ * @brief 请求ScreenTask刷新屏幕
+ * @param events SCREEN_EVENT_xxx的组合
+ * @note 在任务或定时器回调中调用
+ */
+void Screen_Notify(uint32_t events);
+
+/**
+ * @brief 没有等待渲染的刷新请求，睡眠屏障（power.h）的POWER_DISPLAY空闲检查
+ * @note 已渲染的帧交给I2C2后由POWER_I2C位负责
+ */
+uint8_t Screen_IsIdle(void);
+
 
 
 
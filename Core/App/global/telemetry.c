@@ -0,0 +1,267 @@
+#include "telemetry.h"
+
+#include <stdio.h>
+
+#include "utils.h"
+
+// 帧头: 类型 + 时间戳
+#define TELEMETRY_HEADER 5U
+#define TELEMETRY_CRC    2U
+// 报警消息体: 原因 + 事件 + 数值
+#define TELEMETRY_WARNING_BODY 6U
+// 快照消息体: 温度、湿度、降雨、土壤、光照各 2 字节, 气压、BMP280 温度各 4 字节, 水泵 1 字节
+#define TELEMETRY_SNAPSHOT_BODY 19U
+
+static const struct {
+    const char *name;
+    uint8_t decimal;   // JSON 中带一位小数
+} telemetryReason[TELEMETRY_REASON_COUNT] = {
+    [TELEMETRY_REASON_TEMPERATURE_LOW] = {"temperature_low", 1},
+    [TELEMETRY_REASON_TEMPERATURE_HIGH] = {"temperature_high", 1},
+    [TELEMETRY_REASON_HUMIDITY_LOW] = {"humidity_low", 1},
+    [TELEMETRY_REASON_HUMIDITY_HIGH] = {"humidity_high", 1},
+    [TELEMETRY_REASON_RAIN_GAUGE_HIGH] = {"rain_gauge_high", 0},
+    [TELEMETRY_REASON_SOIL_MOISTURE_LOW] = {"soil_moisture_low", 0},
+    [TELEMETRY_REASON_SOIL_MOISTURE_HIGH] = {"soil_moisture_high", 0},
+    [TELEMETRY_REASON_LIGHT_INTENSITY_LOW] = {"light_intensity_low", 0},
+    [TELEMETRY_REASON_LIGHT_INTENSITY_HIGH] = {"light_intensity_high", 0},
+};
+
+const char *Telemetry_ReasonName(uint8_t reason) {
+    return reason < TELEMETRY_REASON_COUNT ? telemetryReason[reason].name : "unknown";
+}
+
+static const char *const telemetryEvent[TELEMETRY_EVENT_COUNT] = {
+    [TELEMETRY_EVENT_RAISED] = "raised",
+    [TELEMETRY_EVENT_CLEARED] = "cleared",
+    [TELEMETRY_EVENT_REMINDER] = "reminder",
+};
+
+const char *Telemetry_EventName(uint8_t event) {
+    return event < TELEMETRY_EVENT_COUNT ? telemetryEvent[event] : "unknown";
+}
+
+static void Telemetry_Put16(uint8_t *out, uint16_t value) {
+    out[0] = (uint8_t) value;
+    out[1] = (uint8_t) (value >> 8);
+}
+
+static uint16_t Telemetry_Get16(const uint8_t *in) {
+    return (uint16_t) (in[0] | in[1] << 8);
+}
+
+static void Telemetry_Put32(uint8_t *out, uint32_t value) {
+    out[0] = (uint8_t) value;
+    out[1] = (uint8_t) (value >> 8);
+    out[2] = (uint8_t) (value >> 16);
+    out[3] = (uint8_t) (value >> 24);
+}
+
+static uint32_t Telemetry_Get32(const uint8_t *in) {
+    return (uint32_t) in[0] | (uint32_t) in[1] << 8 | (uint32_t) in[2] << 16 | (uint32_t) in[3] << 24;
+}
+
+/**
+ * @brief COBS 编码: 每个 0x00 换成到下一个 0x00 的距离, 每段最多 254 个非零字节
+ * @param out 至少 len + len / 254 + 1 字节
+ * @return 编码后的字节数
+ */
+static uint16_t Telemetry_CobsEncode(const uint8_t *in, uint16_t len, uint8_t *out) {
+    uint16_t code = 0;   // 当前段长度字节的位置
+    uint16_t at = 1;
+    uint8_t distance = 1;
+
+    for (uint16_t i = 0; i < len; i++) {
+        if (in[i] != 0U) {
+            out[at++] = in[i];
+            distance++;
+        }
+        if (in[i] == 0U || distance == 0xFFU) {
+            out[code] = distance;
+            code = at++;
+            distance = 1;
+        }
+    }
+    out[code] = distance;
+    return at;
+}
+
+/**
+ * @return 解码后的字节数; 编码错误或 out 放不下时返回 -1
+ */
+static int32_t Telemetry_CobsDecode(const uint8_t *in, uint16_t len, uint8_t *out, uint16_t size) {
+    uint16_t i = 0;
+    uint16_t at = 0;
+
+    while (i < len) {
+        const uint8_t distance = in[i++];
+        if (distance == 0U || i + distance - 1U > len) {
+            return -1;
+        }
+        for (uint8_t n = 1; n < distance; n++) {
+            if (in[i] == 0U || at >= size) {
+                return -1;
+            }
+            out[at++] = in[i++];
+        }
+        // 不满 254 字节的段后面原本是一个 0x00, 最后一段除外
+        if (distance != 0xFFU && i < len) {
+            if (at >= size) {
+                return -1;
+            }
+            out[at++] = 0;
+        }
+    }
+    return at;
+}
+
+uint16_t Telemetry_EncodeFrame(const Telemetry_Message *msg, uint8_t *out, uint16_t size) {
+    uint8_t payload[TELEMETRY_PAYLOAD_MAX];
+    uint16_t len = TELEMETRY_HEADER;
+
+    payload[0] = msg->type;
+    Telemetry_Put32(payload + 1, msg->timestamp);
+    switch (msg->type) {
+        case TELEMETRY_WARNING:
+            payload[len] = msg->warning.reason;
+            payload[len + 1U] = msg->warning.event;
+            Telemetry_Put32(payload + len + 2U, (uint32_t) msg->warning.value);
+            len += TELEMETRY_WARNING_BODY;
+            break;
+        case TELEMETRY_SNAPSHOT:
+            Telemetry_Put16(payload + len, (uint16_t) msg->snapshot.temperature);
+            Telemetry_Put16(payload + len + 2U, msg->snapshot.humidity);
+            Telemetry_Put16(payload + len + 4U, msg->snapshot.rainGauge);
+            Telemetry_Put16(payload + len + 6U, msg->snapshot.soilMoisture);
+            Telemetry_Put16(payload + len + 8U, msg->snapshot.lightIntensity);
+            Telemetry_Put32(payload + len + 10U, msg->snapshot.pressure);
+            Telemetry_Put32(payload + len + 14U, (uint32_t) msg->snapshot.bmpTemp);
+            payload[len + 18U] = msg->snapshot.waterPumpState;
+            len += TELEMETRY_SNAPSHOT_BODY;
+            break;
+        default:
+            return 0;
+    }
+    const uint16_t crc = crc16Update(CRC16_INIT, payload, len);
+    payload[len++] = (uint8_t) crc;
+    payload[len++] = (uint8_t) (crc >> 8);
+
+    if (size < len + len / 254U + 2U) {
+        return 0;
+    }
+    len = Telemetry_CobsEncode(payload, len, out);
+    out[len++] = TELEMETRY_DELIMITER;
+    return len;
+}
+
+Telemetry_Status Telemetry_DecodeFrame(const uint8_t *frame, uint16_t len, Telemetry_Message *msg) {
+    uint8_t payload[TELEMETRY_PAYLOAD_MAX];
+    const int32_t decoded = Telemetry_CobsDecode(frame, len, payload, sizeof(payload));
+
+    if (decoded < 0) {
+        return TELEMETRY_ERROR_COBS;
+    }
+    if (decoded < (int32_t) (TELEMETRY_HEADER + TELEMETRY_CRC)) {
+        return TELEMETRY_ERROR_LENGTH;
+    }
+    const uint16_t body = (uint16_t) (decoded - TELEMETRY_CRC);
+    const uint16_t crc = (uint16_t) (payload[body] | payload[body + 1U] << 8);
+    if (crc16Update(CRC16_INIT, payload, body) != crc) {
+        return TELEMETRY_ERROR_CRC;
+    }
+
+    msg->type = payload[0];
+    msg->timestamp = Telemetry_Get32(payload + 1);
+    switch (msg->type) {
+        case TELEMETRY_WARNING:
+            if (body != TELEMETRY_HEADER + TELEMETRY_WARNING_BODY) {
+                return TELEMETRY_ERROR_LENGTH;
+            }
+            msg->warning.reason = payload[TELEMETRY_HEADER];
+            msg->warning.event = payload[TELEMETRY_HEADER + 1U];
+            msg->warning.value = (int32_t) Telemetry_Get32(payload + TELEMETRY_HEADER + 2U);
+            return msg->warning.reason < TELEMETRY_REASON_COUNT && msg->warning.event < TELEMETRY_EVENT_COUNT
+                       ? TELEMETRY_OK
+                       : TELEMETRY_ERROR_TYPE;
+        case TELEMETRY_SNAPSHOT: {
+            const uint8_t *in = payload + TELEMETRY_HEADER;
+            if (body != TELEMETRY_HEADER + TELEMETRY_SNAPSHOT_BODY) {
+                return TELEMETRY_ERROR_LENGTH;
+            }
+            msg->snapshot.temperature = (int16_t) Telemetry_Get16(in);
+            msg->snapshot.humidity = Telemetry_Get16(in + 2);
+            msg->snapshot.rainGauge = Telemetry_Get16(in + 4);
+            msg->snapshot.soilMoisture = Telemetry_Get16(in + 6);
+            msg->snapshot.lightIntensity = Telemetry_Get16(in + 8);
+            msg->snapshot.pressure = Telemetry_Get32(in + 10);
+            msg->snapshot.bmpTemp = (int32_t) Telemetry_Get32(in + 14);
+            msg->snapshot.waterPumpState = in[18];
+            return TELEMETRY_OK;
+        }
+        default:
+            return TELEMETRY_ERROR_TYPE;
+    }
+}
+
+/**
+ * @brief 把定点数格式化成带 decimals 位小数的文本, 例如 (-235, 10, 1) -> "-23.5"
+ * @param scale 10 的 decimals 次方
+ */
+static void Telemetry_FormatFixed(char *out, uint16_t size, int32_t value, uint32_t scale, uint8_t decimals) {
+    const uint32_t magnitude = value < 0 ? 0U - (uint32_t) value : (uint32_t) value;
+    snprintf(out, size, "%s%lu.%0*lu", value < 0 ? "-" : "", (unsigned long) (magnitude / scale), decimals,
+             (unsigned long) (magnitude % scale));
+}
+
+uint16_t Telemetry_FormatJson(const Telemetry_Message *msg, char *out, uint16_t size) {
+    int len = 0;
+
+    switch (msg->type) {
+        case TELEMETRY_WARNING: {
+            const int32_t value = msg->warning.value;
+            const uint32_t magnitude = value < 0 ? 0U - (uint32_t) value : (uint32_t) value;
+            const char *sign = value < 0 ? "-" : "";
+            if (msg->warning.reason < TELEMETRY_REASON_COUNT && telemetryReason[msg->warning.reason].decimal) {
+                len = snprintf(out, size,
+                               "{\"type\":\"warning\", \"reason\":\"%s\", \"event\":\"%s\", \"value\":%s%lu.%lu, \"time\":%lu}\n",
+                               Telemetry_ReasonName(msg->warning.reason), Telemetry_EventName(msg->warning.event), sign, (unsigned long) (magnitude / 10U),
+                               (unsigned long) (magnitude % 10U), (unsigned long) msg->timestamp);
+            } else {
+                len = snprintf(out, size,
+                               "{\"type\":\"warning\", \"reason\":\"%s\", \"event\":\"%s\", \"value\":%s%lu, \"time\":%lu}\n",
+                               Telemetry_ReasonName(msg->warning.reason), Telemetry_EventName(msg->warning.event), sign, (unsigned long) (magnitude / 10U),
+                               (unsigned long) msg->timestamp);
+            }
+            break;
+        }
+        case TELEMETRY_SNAPSHOT: {
+            char temperature[12];
+            char humidity[12];
+            char pressure[16];
+            char bmpTemp[12];
+            // Q24.8 Pa 转成 0.01 Pa
+            const uint32_t pressureCenti =
+                (msg->snapshot.pressure >> 8) * 100U + (msg->snapshot.pressure & 0xFFU) * 100U / 256U;
+            Telemetry_FormatFixed(temperature, sizeof(temperature), msg->snapshot.temperature, 10U, 1U);
+            Telemetry_FormatFixed(humidity, sizeof(humidity), msg->snapshot.humidity, 10U, 1U);
+            Telemetry_FormatFixed(pressure, sizeof(pressure), (int32_t) pressureCenti, 100U, 2U);
+            Telemetry_FormatFixed(bmpTemp, sizeof(bmpTemp), msg->snapshot.bmpTemp, 100U, 2U);
+            len = snprintf(out, size,
+                           "{\"type\":\"snapshot\", \"temperature\":%s, \"humidity\":%s, \"rain_gauge\":%u, "
+                           "\"soil_moisture\":%u, \"light_intensity\":%u, \"pressure\":%s, \"bmp_temp\":%s, "
+                           "\"pump\":%u, \"time\":%lu}\n",
+                           temperature, humidity, msg->snapshot.rainGauge, msg->snapshot.soilMoisture,
+                           msg->snapshot.lightIntensity, pressure, bmpTemp, msg->snapshot.waterPumpState,
+                           (unsigned long) msg->timestamp);
+            break;
+        }
+        default:
+            len = snprintf(out, size, "{\"type\":\"unknown\", \"id\":%u, \"time\":%lu}\n", msg->type,
+                           (unsigned long) msg->timestamp);
+            break;
+    }
+    if (len < 0) {
+        return 0;
+    }
+    return (uint16_t) ((uint32_t) len < size ? (uint32_t) len : size - 1U);
+}
@@ -0,0 +1,136 @@
+#ifndef SMARTFARM_TELEMETRY_H
+#define SMARTFARM_TELEMETRY_H
+
+#include <stdint.h>
+
+/**
+ * @file telemetry.h
+ * @brief 蓝牙链路上的消息格式
+ *
+ * 两种格式, 用 TELEMETRY_FORMAT 在编译时选择:
+ * - 二进制帧(默认): 类型(1) + 时间戳(4) + 消息体 + CRC16(2), 多字节字段小端;
+ *   整帧用 COBS 编码后以一个 0x00 结尾, 帧内不会出现 0x00, 接收方按 0x00 分帧, 丢字节后从下一个 0x00 重新同步。
+ *   一条报警在线上 15 字节, 一条快照 28 字节, 9600 波特率下分别约 15ms 和 30ms
+ * - JSON: 与以前相同的文本加上时间戳, 每条以换行结尾, 例如
+ *   {"type":"warning", "reason":"temperature_high", "event":"raised", "value":35.5, "time":1234}
+ *
+ * 除报警外, SensorTask 每 TELEMETRY_SNAPSHOT_PERIOD_S 秒发送一条快照(TELEMETRY_SNAPSHOT), 包含 FarmState 的全部字段
+ *
+ * 本文件和 telemetry.c 不依赖 HAL 和 FreeRTOS, 主机上的解码工具(Host/Tools/telemetry_decode.c)直接编译同一份代码
+ */
+
+#define TELEMETRY_FORMAT_BINARY 0
+#define TELEMETRY_FORMAT_JSON   1
+#ifndef TELEMETRY_FORMAT
+#define TELEMETRY_FORMAT TELEMETRY_FORMAT_BINARY
+#endif
+
+// 帧分隔符
+#define TELEMETRY_DELIMITER 0x00U
+// COBS 编码前一帧的最大字节数(含 CRC)
+#define TELEMETRY_PAYLOAD_MAX 64U
+// 编码后一帧的最大字节数: COBS 每 254 字节多 1 字节, 再加开头的 1 字节和结尾的分隔符
+#define TELEMETRY_FRAME_MAX (TELEMETRY_PAYLOAD_MAX + TELEMETRY_PAYLOAD_MAX / 254U + 2U)
+// 一条 JSON 消息的最大字节数(含换行和结尾的 0)
+#define TELEMETRY_JSON_MAX 192U
+
+// 快照的发送周期(秒), 0 表示不发送快照, 只发报警
+#ifndef TELEMETRY_SNAPSHOT_PERIOD_S
+#define TELEMETRY_SNAPSHOT_PERIOD_S 10U
+#endif
+
+/**
+ * @brief 消息类型, 帧的第一个字节
+ */
+typedef enum {
+    TELEMETRY_WARNING = 1,   // 环境参数超出安全范围
+    TELEMETRY_SNAPSHOT = 2,  // 周期发送的全部环境数据
+} Telemetry_Type;
+
+/**
+ * @brief 报警原因
+ * @note 编号写在帧里, 只能在末尾追加
+ */
+typedef enum {
+    TELEMETRY_REASON_TEMPERATURE_LOW = 0,
+    TELEMETRY_REASON_TEMPERATURE_HIGH,
+    TELEMETRY_REASON_HUMIDITY_LOW,
+    TELEMETRY_REASON_HUMIDITY_HIGH,
+    TELEMETRY_REASON_RAIN_GAUGE_HIGH,
+    TELEMETRY_REASON_SOIL_MOISTURE_LOW,
+    TELEMETRY_REASON_SOIL_MOISTURE_HIGH,
+    TELEMETRY_REASON_LIGHT_INTENSITY_LOW,
+    TELEMETRY_REASON_LIGHT_INTENSITY_HIGH,
+    TELEMETRY_REASON_COUNT,
+} Telemetry_Reason;
+
+/**
+ * @brief 报警消息的事件, 由报警状态机(alarm.h)在状态变化时产生
+ * @note 编号写在帧里, 只能在末尾追加
+ */
+typedef enum {
+    TELEMETRY_EVENT_RAISED = 0,   // 超出范围并保持了最短时间
+    TELEMETRY_EVENT_CLEARED,      // 回到范围内(越过回差)并保持了最短时间
+    TELEMETRY_EVENT_REMINDER,     // 报警持续中的周期提醒
+    TELEMETRY_EVENT_COUNT,
+} Telemetry_Event;
+
+/**
+ * @brief 解码结果
+ */
+typedef enum {
+    TELEMETRY_OK = 0,
+    TELEMETRY_ERROR_COBS,     // COBS 编码错误(帧被截断或混入了 0x00)
+    TELEMETRY_ERROR_CRC,      // CRC 不对
+    TELEMETRY_ERROR_LENGTH,   // 长度与类型不符
+    TELEMETRY_ERROR_TYPE,     // 未知的类型、报警原因或事件
+} Telemetry_Status;
+
+/**
+ * @brief 一条消息, 在 SensorTask 和 BLETask 之间通过蓝牙消息池传递, BLETask 按 TELEMETRY_FORMAT 编码后发送
+ */
+typedef struct {
+    uint8_t type;            // Telemetry_Type
+    uint32_t timestamp;      // RTC 计数器(秒)
+    union {
+        struct {
+            uint8_t reason;  // Telemetry_Reason
+            uint8_t event;   // Telemetry_Event
+            int32_t value;   // 报警时的数值, 单位 0.1
+        } warning;
+        struct {
+            int16_t temperature;      // 0.1 °C
+            uint16_t humidity;        // 0.1 %
+            uint16_t rainGauge;
+            uint16_t soilMoisture;
+            uint16_t lightIntensity;
+            uint32_t pressure;        // Q24.8 Pa, 与 FarmState 相同
+            int32_t bmpTemp;          // 0.01 °C
+            uint8_t waterPumpState;
+        } snapshot;
+    };
+} Telemetry_Message;
+
+/**
+ * @brief 编码成以分隔符结尾的二进制帧
+ * @return 帧的字节数(含分隔符); out 放不下时返回 0
+ */
+uint16_t Telemetry_EncodeFrame(const Telemetry_Message *msg, uint8_t *out, uint16_t size);
+
+/**
+ * @brief 解码一帧
+ * @param frame 两个分隔符之间的数据(不含分隔符)
+ */
+Telemetry_Status Telemetry_DecodeFrame(const uint8_t *frame, uint16_t len, Telemetry_Message *msg);
+
+/**
+ * @brief 格式化成以换行结尾的 JSON 文本
+ * @return 文本的字节数(不含结尾的 0); out 放不下时截断
+ */
+uint16_t Telemetry_FormatJson(const Telemetry_Message *msg, char *out, uint16_t size);
+
+const char *Telemetry_ReasonName(uint8_t reason);
+
+const char *Telemetry_EventName(uint8_t event);
+
+#endif //SMARTFARM_TELEMETRY_H
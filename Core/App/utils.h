@@ -1,5 +1,10 @@
 #ifndef SMARTFARM_UTILS_H
 #define SMARTFARM_UTILS_H
+#include <stdint.h>
 void floatToIntDec(float value, int *intPart, int *decPart);
 void doubleToIntDec(double value, int *intPart, int *decPart);
+void fixedToIntDec(int32_t value, int32_t divisor, int *intPart, int *decPart);
+
+#define CRC16_INIT 0xFFFFU
+uint16_t crc16Update(uint16_t crc, const void *data, uint32_t len);
 #endif //SMARTFARM_UTILS_H
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "BMP280.h"
+#include "i2c_bus.h"
 #include "math.h"
 
 BMP280_Calibration BMP280_Cal;	//BMP280校准结构体
@@ -6,7 +7,7 @@ BMP280_Calibration BMP280_Cal;	//BMP280校准结构体
 /*
  * 函数：BMP280初始化
  * 参数：无
- * 返回：读取ID成功并初始化成功返回0，读取ID错误返回1
+ * 返回：读取ID成功并初始化成功返回0，读取ID、校准值或写配置寄存器失败返回1
  */
 GPIO_PinState BMP280_Init(void)
 {
@@ -17,66 +18,41 @@ GPIO_PinState BMP280_Init(void)
 	}
 
 
-	//初始化校准值
-	uint8_t lsb;
-	uint8_t msb;
-
-	HAL_I2C_Mem_Read(&BMP280_I2C, BMP280_ADDRESS, BMP280_DIG_T1_LSB_REG, 1, &lsb, 1, BMP280_TIMEOUT);
-	HAL_I2C_Mem_Read(&BMP280_I2C, BMP280_ADDRESS, BMP280_DIG_T1_MSB_REG, 1, &msb, 1, BMP280_TIMEOUT);
-	BMP280_Cal.T1 = (uint16_t)lsb + ((uint16_t)msb << 8);
-
-	HAL_I2C_Mem_Read(&BMP280_I2C, BMP280_ADDRESS, BMP280_DIG_T2_LSB_REG, 1, &lsb, 1, BMP280_TIMEOUT);
-	HAL_I2C_Mem_Read(&BMP280_I2C, BMP280_ADDRESS, BMP280_DIG_T2_MSB_REG, 1, &msb, 1, BMP280_TIMEOUT);
-	BMP280_Cal.T2 = (uint16_t)lsb + ((uint16_t)msb << 8);
-
-	HAL_I2C_Mem_Read(&BMP280_I2C, BMP280_ADDRESS, BMP280_DIG_T3_LSB_REG, 1, &lsb, 1, BMP280_TIMEOUT);
-	HAL_I2C_Mem_Read(&BMP280_I2C, BMP280_ADDRESS, BMP280_DIG_T3_MSB_REG, 1, &msb, 1, BMP280_TIMEOUT);
-	BMP280_Cal.T3 = (uint16_t)lsb + ((uint16_t)msb << 8);
-
-	HAL_I2C_Mem_Read(&BMP280_I2C, BMP280_ADDRESS, BMP280_DIG_P1_LSB_REG, 1, &lsb, 1, BMP280_TIMEOUT);
-	HAL_I2C_Mem_Read(&BMP280_I2C, BMP280_ADDRESS, BMP280_DIG_P1_MSB_REG, 1, &msb, 1, BMP280_TIMEOUT);
-	BMP280_Cal.P1 = (uint16_t)lsb + ((uint16_t)msb << 8);
-
-	HAL_I2C_Mem_Read(&BMP280_I2C, BMP280_ADDRESS, BMP280_DIG_P2_LSB_REG, 1, &lsb, 1, BMP280_TIMEOUT);
-	HAL_I2C_Mem_Read(&BMP280_I2C, BMP280_ADDRESS, BMP280_DIG_P2_MSB_REG, 1, &msb, 1, BMP280_TIMEOUT);
-	BMP280_Cal.P2 = (uint16_t)lsb + ((uint16_t)msb << 8);
-
-	HAL_I2C_Mem_Read(&BMP280_I2C, BMP280_ADDRESS, BMP280_DIG_P3_LSB_REG, 1, &lsb, 1, BMP280_TIMEOUT);
-	HAL_I2C_Mem_Read(&BMP280_I2C, BMP280_ADDRESS, BMP280_DIG_P3_MSB_REG, 1, &msb, 1, BMP280_TIMEOUT);
-	BMP280_Cal.P3 = (uint16_t)lsb + ((uint16_t)msb << 8);
-
-	HAL_I2C_Mem_Read(&BMP280_I2C, BMP280_ADDRESS, BMP280_DIG_P4_LSB_REG, 1, &lsb, 1, BMP280_TIMEOUT);
-	HAL_I2C_Mem_Read(&BMP280_I2C, BMP280_ADDRESS, BMP280_DIG_P4_MSB_REG, 1, &msb, 1, BMP280_TIMEOUT);
-	BMP280_Cal.P4 = (uint16_t)lsb + ((uint16_t)msb << 8);
-
-	HAL_I2C_Mem_Read(&BMP280_I2C, BMP280_ADDRESS, BMP280_DIG_P5_LSB_REG, 1, &lsb, 1, BMP280_TIMEOUT);
-	HAL_I2C_Mem_Read(&BMP280_I2C, BMP280_ADDRESS, BMP280_DIG_P5_MSB_REG, 1, &msb, 1, BMP280_TIMEOUT);
-	BMP280_Cal.P5 = (uint16_t)lsb + ((uint16_t)msb << 8);
-
-	HAL_I2C_Mem_Read(&BMP280_I2C, BMP280_ADDRESS, BMP280_DIG_P6_LSB_REG, 1, &lsb, 1, BMP280_TIMEOUT);
-	HAL_I2C_Mem_Read(&BMP280_I2C, BMP280_ADDRESS, BMP280_DIG_P6_MSB_REG, 1, &msb, 1, BMP280_TIMEOUT);
-	BMP280_Cal.P6 = (uint16_t)lsb + ((uint16_t)msb << 8);
-
-	HAL_I2C_Mem_Read(&BMP280_I2C, BMP280_ADDRESS, BMP280_DIG_P7_LSB_REG, 1, &lsb, 1, BMP280_TIMEOUT);
-	HAL_I2C_Mem_Read(&BMP280_I2C, BMP280_ADDRESS, BMP280_DIG_P7_MSB_REG, 1, &msb, 1, BMP280_TIMEOUT);
-	BMP280_Cal.P7 = (uint16_t)lsb + ((uint16_t)msb << 8);
-
-	HAL_I2C_Mem_Read(&BMP280_I2C, BMP280_ADDRESS, BMP280_DIG_P8_LSB_REG, 1, &lsb, 1, BMP280_TIMEOUT);
-	HAL_I2C_Mem_Read(&BMP280_I2C, BMP280_ADDRESS, BMP280_DIG_P8_MSB_REG, 1, &msb, 1, BMP280_TIMEOUT);
-	BMP280_Cal.P8 = (uint16_t)lsb + ((uint16_t)msb << 8);
+	//初始化校准值：0x88~0x9F共24字节一次连续读出，寄存器地址自动递增
+	uint8_t calib[BMP280_CALIB_LEN];
+	if(I2CBus_MemRead(BMP280_ADDRESS, BMP280_DIG_T1_LSB_REG, calib, BMP280_CALIB_LEN) != HAL_OK)
+	{
+		return BMP280_ERROR;
+	}
 
-	HAL_I2C_Mem_Read(&BMP280_I2C, BMP280_ADDRESS, BMP280_DIG_P9_LSB_REG, 1, &lsb, 1, BMP280_TIMEOUT);
-	HAL_I2C_Mem_Read(&BMP280_I2C, BMP280_ADDRESS, BMP280_DIG_P9_MSB_REG, 1, &msb, 1, BMP280_TIMEOUT);
-	BMP280_Cal.P9 = (uint16_t)lsb + ((uint16_t)msb << 8);
+	//每个校准值都是低字节在前
+	BMP280_Cal.T1 = (uint16_t)calib[0] + ((uint16_t)calib[1] << 8);
+	BMP280_Cal.T2 = (uint16_t)calib[2] + ((uint16_t)calib[3] << 8);
+	BMP280_Cal.T3 = (uint16_t)calib[4] + ((uint16_t)calib[5] << 8);
+	BMP280_Cal.P1 = (uint16_t)calib[6] + ((uint16_t)calib[7] << 8);
+	BMP280_Cal.P2 = (uint16_t)calib[8] + ((uint16_t)calib[9] << 8);
+	BMP280_Cal.P3 = (uint16_t)calib[10] + ((uint16_t)calib[11] << 8);
+	BMP280_Cal.P4 = (uint16_t)calib[12] + ((uint16_t)calib[13] << 8);
+	BMP280_Cal.P5 = (uint16_t)calib[14] + ((uint16_t)calib[15] << 8);
+	BMP280_Cal.P6 = (uint16_t)calib[16] + ((uint16_t)calib[17] << 8);
+	BMP280_Cal.P7 = (uint16_t)calib[18] + ((uint16_t)calib[19] << 8);
+	BMP280_Cal.P8 = (uint16_t)calib[20] + ((uint16_t)calib[21] << 8);
+	BMP280_Cal.P9 = (uint16_t)calib[22] + ((uint16_t)calib[23] << 8);
 
 	BMP280_Cal.t_fine = 0;
 
-	//配置寄存器
+	//配置寄存器：写失败时芯片停在休眠模式，不会开始测量
 	uint8_t WriteBuffer = t_0_5ms | Filter_16;//等待时间0.05ms，滤波器等级4
-	HAL_I2C_Mem_Write(&BMP280_I2C, BMP280_ADDRESS, BMP280_CONFIG, 1, &WriteBuffer, 1, BMP280_TIMEOUT);
+	if(I2CBus_MemWrite(BMP280_ADDRESS, BMP280_CONFIG, &WriteBuffer, 1) != HAL_OK)
+	{
+		return BMP280_ERROR;
+	}
 
 	WriteBuffer = Temp_OverSampl_1|Press_OverSampl_16| Normal_Mode;//过温度采样1，压力过采样8，正常模式
-	HAL_I2C_Mem_Write(&BMP280_I2C, BMP280_ADDRESS, BMP280_CTRL_MEAS, 1, &WriteBuffer, 1, BMP280_TIMEOUT);
+	if(I2CBus_MemWrite(BMP280_ADDRESS, BMP280_CTRL_MEAS, &WriteBuffer, 1) != HAL_OK)
+	{
+		return BMP280_ERROR;
+	}
 
 
 	return BMP280_OK;
@@ -92,12 +68,22 @@ uint8_t BMP280_ReadID(void)
 	uint8_t ID;
 
 
-	HAL_I2C_Mem_Read(&BMP280_I2C, BMP280_ADDRESS, BMP280_ID, 1, &ID, 1, BMP280_TIMEOUT);
+	I2CBus_MemRead(BMP280_ADDRESS, BMP280_ID, &ID, 1);
 
 
 	return ID;
 }
 
+/*
+ * 函数：把MSB、LSB、XLSB三个寄存器拼成20位原始值
+ * 参数：reg 依次为MSB、LSB、XLSB
+ * 返回：原始测量值
+ */
+static int32_t BMP280_RawValue(const uint8_t *reg)
+{
+	return ((int32_t)reg[2] >> 4) + ((int32_t)reg[1] << 4) + ((int32_t)reg[0] << 12);
+}
+
 /*
  * 函数：BMP280读取温度值
  * 参数：无
@@ -108,17 +94,13 @@ double BMP280_ReadTemp(void)
 	double Temperature;
 	int32_t Temp_Reg;
 
-	uint8_t Temp_xlsb;
-	uint8_t Temp_lsb;
-	uint8_t Temp_msb;
+	uint8_t Temp[3];
 
-	//I2C读取存储温度数据的寄存器
-	HAL_I2C_Mem_Read(&BMP280_I2C, BMP280_ADDRESS, BMP280_TEMP_XLSB, 1, &Temp_xlsb, 1, BMP280_TIMEOUT);
-	HAL_I2C_Mem_Read(&BMP280_I2C, BMP280_ADDRESS, BMP280_TEMP_LSB, 1, &Temp_lsb, 1, BMP280_TIMEOUT);
-	HAL_I2C_Mem_Read(&BMP280_I2C, BMP280_ADDRESS, BMP280_TEMP_MSB, 1, &Temp_msb, 1, BMP280_TIMEOUT);
+	//I2C连续读取存储温度数据的寄存器（0xFA~0xFC）
+	I2CBus_MemRead(BMP280_ADDRESS, BMP280_TEMP_MSB, Temp, 3);
 
 	//数据拼接
-	Temp_Reg = ((int32_t)Temp_xlsb >> 4) + ((int32_t)Temp_lsb << 4) + ((int32_t)Temp_msb << 12);
+	Temp_Reg = BMP280_RawValue(Temp);
 
 	//计算并校准
 	Temperature = BMP280_compensate_T(Temp_Reg);
@@ -136,23 +118,66 @@ double BMP280_ReadPress(void)
 	double Pressure;
 	int32_t Press_Reg;
 
-	uint8_t Press_xlsb;
-	uint8_t Press_lsb;
-	uint8_t Press_msb;
+	uint8_t Press[3];
 
-	//I2C读取存储大气压数据的寄存器
-	HAL_I2C_Mem_Read(&BMP280_I2C, BMP280_ADDRESS, BMP280_PRESS_XLSB, 1, &Press_xlsb, 1, BMP280_TIMEOUT);
-	HAL_I2C_Mem_Read(&BMP280_I2C, BMP280_ADDRESS, BMP280_PRESS_LSB, 1, &Press_lsb, 1, BMP280_TIMEOUT);
-	HAL_I2C_Mem_Read(&BMP280_I2C, BMP280_ADDRESS, BMP280_PRESS_MSB, 1, &Press_msb, 1, BMP280_TIMEOUT);
+	//I2C连续读取存储大气压数据的寄存器（0xF7~0xF9）
+	I2CBus_MemRead(BMP280_ADDRESS, BMP280_PRESS_MSB, Press, 3);
 
 	//数据拼接
-	Press_Reg = ((int32_t)Press_xlsb >> 4) + ((int32_t)Press_lsb << 4) + ((int32_t)Press_msb << 12);
+	Press_Reg = BMP280_RawValue(Press);
 	//计算并校准
 	Pressure = BMP280_compensate_P(Press_Reg);
 
 	return Pressure;
 }
 
+/*
+ * 函数：BMP280同时读取温度和大气压
+ * 参数：Temperature 温度值（摄氏度），Pressure 大气压（Pa）
+ * 返回：读取成功返回0，I2C通信失败返回1（此时不修改输出值）
+ * 注意：0xF7~0xFC一次连续读出，温度和气压来自同一次转换，且先补偿温度再补偿气压，
+ *       不再依赖调用方先调用BMP280_ReadTemp()更新t_fine
+ */
+uint8_t BMP280_ReadTempPress(double *Temperature, double *Pressure)
+{
+	uint8_t Data[BMP280_DATA_LEN];
+
+	//I2C连续读取气压（0xF7~0xF9）和温度（0xFA~0xFC）寄存器
+	if(I2CBus_MemRead(BMP280_ADDRESS, BMP280_PRESS_MSB, Data, BMP280_DATA_LEN) != HAL_OK)
+	{
+		return BMP280_ERROR;
+	}
+
+	//计算并校准，温度补偿会更新t_fine，必须在气压补偿之前
+	*Temperature = BMP280_compensate_T(BMP280_RawValue(&Data[3]));
+	*Pressure = BMP280_compensate_P(BMP280_RawValue(&Data[0]));
+
+	return BMP280_OK;
+}
+
+/*
+ * 函数：BMP280同时读取温度和大气压（定点数）
+ * 参数：Temperature 温度值（0.01摄氏度），Pressure 大气压（Q24.8格式的Pa，即Pa*256）
+ * 返回：读取成功返回0，I2C通信失败返回1（此时不修改输出值）
+ * 注意：全程整数运算，不调用软浮点库，适合没有FPU的Cortex-M3
+ */
+uint8_t BMP280_ReadTempPressFixed(int32_t *Temperature, uint32_t *Pressure)
+{
+	uint8_t Data[BMP280_DATA_LEN];
+
+	//I2C连续读取气压（0xF7~0xF9）和温度（0xFA~0xFC）寄存器
+	if(I2CBus_MemRead(BMP280_ADDRESS, BMP280_PRESS_MSB, Data, BMP280_DATA_LEN) != HAL_OK)
+	{
+		return BMP280_ERROR;
+	}
+
+	//温度补偿会更新t_fine，必须在气压补偿之前
+	*Temperature = BMP280_compensate_T_int32(BMP280_RawValue(&Data[3]));
+	*Pressure = BMP280_compensate_P_int64(BMP280_RawValue(&Data[0]));
+
+	return BMP280_OK;
+}
+
 /*
  * 函数：根据BMP280测得的大气压值计算海拔高度
  * 参数：无
@@ -213,3 +238,45 @@ double BMP280_compensate_P(int adc_P)
 	p = p + (var1 + var2 + ((double)BMP280_Cal.P7)) / 16.0;
 	return p;
 }
+
+/*
+ * 函数：BMP280温度校准（32位整数，数据手册3.11.3节）
+ * 参数：adc_T 温度原始值
+ * 返回：温度值（0.01摄氏度），例如5123表示51.23℃
+ */
+int32_t BMP280_compensate_T_int32(int32_t adc_T)
+{
+	int32_t var1, var2;
+	var1 = ((((adc_T >> 3) - ((int32_t)BMP280_Cal.T1 << 1))) * ((int32_t)BMP280_Cal.T2)) >> 11;
+	var2 = (((((adc_T >> 4) - ((int32_t)BMP280_Cal.T1)) * ((adc_T >> 4) - ((int32_t)BMP280_Cal.T1))) >> 12) *
+	((int32_t)BMP280_Cal.T3)) >> 14;
+	BMP280_Cal.t_fine = var1 + var2;
+	return (BMP280_Cal.t_fine * 5 + 128) >> 8;
+}
+
+/*
+ * 函数：BMP280大气压值校准（64位整数，数据手册3.11.3节）
+ * 参数：adc_P 大气压原始值
+ * 返回：大气压（Q24.8格式的Pa），例如24674867表示24674867/256=96386.2Pa
+ * 注意：使用BMP280_compensate_T_int32()更新的t_fine；有符号数左移改写为乘法，避免未定义行为
+ */
+uint32_t BMP280_compensate_P_int64(int32_t adc_P)
+{
+	int64_t var1, var2, p;
+	var1 = ((int64_t)BMP280_Cal.t_fine) - 128000;
+	var2 = var1 * var1 * (int64_t)BMP280_Cal.P6;
+	var2 = var2 + ((var1 * (int64_t)BMP280_Cal.P5) * ((int64_t)1 << 17));
+	var2 = var2 + (((int64_t)BMP280_Cal.P4) * ((int64_t)1 << 35));
+	var1 = ((var1 * var1 * (int64_t)BMP280_Cal.P3) >> 8) + ((var1 * (int64_t)BMP280_Cal.P2) * ((int64_t)1 << 12));
+	var1 = (((((int64_t)1) << 47) + var1)) * ((int64_t)BMP280_Cal.P1) >> 33;
+	if (var1 == 0)
+	{
+		return 0; // avoid exception caused by division by zero
+	}
+	p = 1048576 - adc_P;
+	p = (((p << 31) - var2) * 3125) / var1;
+	var1 = (((int64_t)BMP280_Cal.P9) * (p >> 13) * (p >> 13)) >> 25;
+	var2 = (((int64_t)BMP280_Cal.P8) * p) >> 19;
+	p = ((p + var1 + var2) >> 8) + (((int64_t)BMP280_Cal.P7) * 16);
+	return (uint32_t)p;
+}
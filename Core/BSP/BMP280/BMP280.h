@@ -4,7 +4,7 @@
 #include "main.h"
 #include "i2c.h"
 
-#define BMP280_I2C	hi2c2			//BMP280使用的I2C
+//BMP280挂在I2C2上, 经i2c_bus传输队列访问
 
 //BMP280常用读写寄存器
 #define	BMP280_ADDRESS		0xEE	//根据BMP280电路原理图，可能为0xEE或0xEC
@@ -44,6 +44,10 @@
 #define BMP280_DIG_P9_LSB_REG   0x9E
 #define BMP280_DIG_P9_MSB_REG   0x9F
 
+//连续读取长度
+#define BMP280_CALIB_LEN	24	//校准值 0x88~0x9F
+#define BMP280_DATA_LEN		6	//气压+温度 0xF7~0xFC
+
 //过采样设置,即分辨率设置，过采样率越高，分辨率越高
 #define Temp_OverSampl_0	0x00
 #define Temp_OverSampl_1	0x20
@@ -84,9 +88,6 @@
 #define BMP280_OK		0
 #define BMP280_ERROR	1
 
-//BMP280 I2C通信等待时间
-#define BMP280_TIMEOUT	100
-
 //BMP280校准结构体
 typedef struct
 {
@@ -111,11 +112,15 @@ GPIO_PinState BMP280_Init(void);
 uint8_t BMP280_ReadID(void);
 double BMP280_ReadTemp(void);
 double BMP280_ReadPress(void);
+uint8_t BMP280_ReadTempPress(double *Temperature, double *Pressure);
+uint8_t BMP280_ReadTempPressFixed(int32_t *Temperature, uint32_t *Pressure);
 double BMP280_ReadAltitude(void);
 
 //无需在主函数调用
 double BMP280_compensate_T(int adc_T);
 double BMP280_compensate_P(int adc_P);
+int32_t BMP280_compensate_T_int32(int32_t adc_T);
+uint32_t BMP280_compensate_P_int64(int32_t adc_P);
 
 
 #endif
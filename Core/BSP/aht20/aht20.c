@@ -1,45 +1,132 @@
 #include "aht20.h"
+#include "i2c_bus.h"
+#include "cmsis_os2.h"
 
 #define AHT20_ADDRESS 0x70
 
-uint8_t readBuffer[6] = {0};
+#define AHT20_POWER_ON_MS   40  // 上电后到可以通信的时间
+#define AHT20_MEASURE_MS    80  // 触发到测量完成的典型时间
+#define AHT20_POLL_MS       5   // 测量超时后重新查询状态的间隔
+#define AHT20_POLL_RETRIES  10  // 最多再等 50ms
+
+#define AHT20_STATUS_BUSY        0x80
+#define AHT20_STATUS_CALIBRATED  0x08
+
+static uint32_t triggerTick;     // 最近一次触发测量的时刻
+static uint8_t measuring = 0;    // 已触发, 结果尚未取走
+
+static uint32_t AHT20_MsToTicks(uint32_t ms)
+{
+    return (ms * osKernelGetTickFreq() + 999U) / 1000U;
+}
 
 /**
  * @brief  初始化AHT20
+ * @note   上电等待期间任务挂起, 不占用CPU和总线
  */
 void AHT20_Init()
 {
-    uint8_t readBuffer;
-    HAL_Delay(40);
-    HAL_I2C_Master_Receive(&hi2c2, AHT20_ADDRESS, &readBuffer, 1, HAL_MAX_DELAY);
-    if ((readBuffer & 0x08) == 0x00)
+    uint8_t status = 0;
+    osDelay(AHT20_MsToTicks(AHT20_POWER_ON_MS));
+    I2CBus_Read(AHT20_ADDRESS, &status, 1);
+    if ((status & AHT20_STATUS_CALIBRATED) == 0x00)
     {
         uint8_t sendBuffer[3] = {0xBE, 0x08, 0x00};
-        HAL_I2C_Master_Transmit(&hi2c2, AHT20_ADDRESS, sendBuffer, 3, HAL_MAX_DELAY);
+        I2CBus_Write(AHT20_ADDRESS, sendBuffer, 3);
+    }
+}
+
+/**
+ * @brief  触发一次测量, 立即返回
+ * @return AHT20_OK 或 AHT20_ERROR(I2C通信失败)
+ * @note   测量在传感器内部进行, 期间总线空闲, 可以先去读其他器件
+ */
+uint8_t AHT20_Trigger(void)
+{
+    uint8_t sendBuffer[3] = {0xAC, 0x33, 0x00};
+
+    if (I2CBus_Write(AHT20_ADDRESS, sendBuffer, 3) != HAL_OK)
+    {
+        measuring = 0;
+        return AHT20_ERROR;
     }
+    triggerTick = osKernelGetTickCount();
+    measuring = 1;
+    return AHT20_OK;
 }
 
 /**
- * @brief  获取温度和湿度
+ * @brief  取回测量结果
  * @param  Temperature: 存储获取到的温度
  * @param  Humidity: 存储获取到的湿度
+ * @return AHT20_OK: 已更新输出值; AHT20_BUSY: 测量尚未完成, 稍后再调用; AHT20_ERROR: 未触发或通信失败
+ * @note   测量时间未到时不访问总线
  */
-void AHT20_Read(float *Temperature, float *Humidity)
+uint8_t AHT20_Fetch(float *Temperature, float *Humidity)
 {
-    uint8_t sendBuffer[3] = {0xAC, 0x33, 0x00};
     uint8_t readBuffer[6] = {0};
 
-    HAL_I2C_Master_Transmit(&hi2c2, AHT20_ADDRESS, sendBuffer, 3, HAL_MAX_DELAY);
-    HAL_Delay(75);
-    HAL_I2C_Master_Receive(&hi2c2, AHT20_ADDRESS, readBuffer, 6, HAL_MAX_DELAY);
+    if (!measuring)
+    {
+        return AHT20_ERROR;
+    }
+    if (osKernelGetTickCount() - triggerTick < AHT20_MsToTicks(AHT20_MEASURE_MS))
+    {
+        return AHT20_BUSY;
+    }
+    if (I2CBus_Read(AHT20_ADDRESS, readBuffer, 6) != HAL_OK)
+    {
+        measuring = 0;
+        return AHT20_ERROR;
+    }
+    if ((readBuffer[0] & AHT20_STATUS_BUSY) != 0x00)
+    {
+        return AHT20_BUSY;
+    }
+    measuring = 0;
+
+    uint32_t data = 0;
+    data = ((uint32_t)readBuffer[3] >> 4) + ((uint32_t)readBuffer[2] << 4) + ((uint32_t)readBuffer[1] << 12);
+    *Humidity = data * 100.0f / (1 << 20);
 
-    if ((readBuffer[0] & 0x80) == 0x00)
+    data = (((uint32_t)readBuffer[3] & 0x0F) << 16) + ((uint32_t)readBuffer[4] << 8) + (uint32_t)readBuffer[5];
+    *Temperature = data * 200.0f / (1 << 20) - 50;
+    return AHT20_OK;
+}
+
+/**
+ * @brief  等待已触发的测量完成并取回结果
+ * @return 同AHT20_Fetch(), 超时仍未完成返回AHT20_BUSY
+ * @note   等待期间任务挂起; 在触发后做了其他事情时, 只等剩余的时间
+ */
+uint8_t AHT20_Wait(float *Temperature, float *Humidity)
+{
+    const uint32_t measureTicks = AHT20_MsToTicks(AHT20_MEASURE_MS);
+    const uint32_t elapsed = osKernelGetTickCount() - triggerTick;
+    uint8_t result;
+
+    if (measuring && elapsed < measureTicks)
+    {
+        osDelay(measureTicks - elapsed);
+    }
+    result = AHT20_Fetch(Temperature, Humidity);
+    for (uint8_t retry = 0; result == AHT20_BUSY && retry < AHT20_POLL_RETRIES; retry++)
     {
-        uint32_t data = 0;
-        data = ((uint32_t)readBuffer[3] >> 4) + ((uint32_t)readBuffer[2] << 4) + ((uint32_t)readBuffer[1] << 12);
-        *Humidity = data * 100.0f / (1 << 20);
+        osDelay(AHT20_MsToTicks(AHT20_POLL_MS));
+        result = AHT20_Fetch(Temperature, Humidity);
+    }
+    return result;
+}
 
-        data = (((uint32_t)readBuffer[3] & 0x0F) << 16) + ((uint32_t)readBuffer[4] << 8) + (uint32_t)readBuffer[5];
-        *Temperature = data * 200.0f / (1 << 20) - 50;
+/**
+ * @brief  获取温度和湿度(触发并等待)
+ * @param  Temperature: 存储获取到的温度
+ * @param  Humidity: 存储获取到的湿度
+ */
+void AHT20_Read(float *Temperature, float *Humidity)
+{
+    if (AHT20_Trigger() == AHT20_OK)
+    {
+        AHT20_Wait(Temperature, Humidity);
     }
-}
\ No newline at end of file
+}
@@ -4,9 +4,18 @@
 #include "i2c.h"
 #include "main.h"
 
+#define AHT20_OK     0
+#define AHT20_BUSY   1
+#define AHT20_ERROR  2
+
 // 初始化AHT20
 void AHT20_Init();
 
+// 分步测量: 触发后总线和CPU都空闲, 可以先读其他传感器, 再取结果
+uint8_t AHT20_Trigger(void);
+uint8_t AHT20_Fetch(float *Temperature, float *Humidity);
+uint8_t AHT20_Wait(float *Temperature, float *Humidity);
+
 // 获取温度和湿度
 void AHT20_Read(float *Temperature, float *Humidity);
 
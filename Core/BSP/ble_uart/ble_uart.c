@@ -0,0 +1,137 @@
+/**
+ * @file ble_uart.c
+ * @brief USART2 DMA 发送环形缓冲区
+ *
+ * 三个自由增长的计数把环形缓冲区分成三段(取模后是在环中的位置):
+ * - [ringReleased, ringQueued): 已交给 DMA, 还不能覆盖
+ * - [ringQueued, ringWritten): 已写入, 等待当前 DMA 结束后发送
+ * - [ringWritten, ringReleased + BLE_UART_RING_SIZE): 空闲, 写入者可以直接写
+ * 写入者只改 ringWritten, 中断只改 ringQueued 和 ringReleased, 数据复制不需要关中断
+ */
+#include "ble_uart.h"
+
+#include <string.h>
+
+#include "cmsis_os2.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "usart.h"
+
+// DMA 腾出空间时通知写入者的线程标志位
+#define BLE_UART_SPACE_FLAG 0x00000200U
+
+_Static_assert((BLE_UART_RING_SIZE & (BLE_UART_RING_SIZE - 1U)) == 0U, "ring size must be a power of two");
+
+static uint8_t ring[BLE_UART_RING_SIZE];
+static volatile uint32_t ringWritten;    // 写入者已写入的字节数
+static volatile uint32_t ringQueued;     // 已交给 DMA 的字节数
+static volatile uint32_t ringReleased;   // DMA 已读出、空间可以重用的字节数
+static uint32_t dmaStart;                // 当前 DMA 区间的起点
+static volatile uint8_t dmaBusy;
+static osThreadId_t ringWriter;          // 等待空间的写入者
+
+/**
+ * @brief DMA 空闲时把下一段连续的数据交给 DMA
+ * @note 在临界区或 USART2 中断中调用
+ */
+static void BleUart_Kick(void) {
+    if (dmaBusy || ringQueued == ringWritten) {
+        return;
+    }
+    const uint32_t start = ringQueued % BLE_UART_RING_SIZE;
+    uint32_t len = ringWritten - ringQueued;
+    if (len > BLE_UART_RING_SIZE - start) {
+        len = BLE_UART_RING_SIZE - start; // 回绕: 先发到环末尾, 剩下的由完成中断接着发
+    }
+    if (HAL_UART_Transmit_DMA(&huart2, ring + start, (uint16_t) len) == HAL_OK) {
+        dmaStart = ringQueued;
+        ringQueued += len;
+        dmaBusy = 1;
+    }
+}
+
+/**
+ * @brief 把 DMA 已读出的空间还给写入者
+ * @note 在 USART2/DMA 中断中调用
+ */
+static void BleUart_Release(uint32_t released) {
+    ringReleased = released;
+    if (ringWriter != NULL) {
+        osThreadFlagsSet(ringWriter, BLE_UART_SPACE_FLAG);
+    }
+}
+
+uint16_t BleUart_Append(const void *data, uint16_t len, uint32_t timeout) {
+    const uint8_t *bytes = (const uint8_t *) data;
+    uint16_t written = 0;
+
+    ringWriter = osThreadGetId();
+    while (written < len) {
+        // 先清标志再看空间: 检查之后腾出的空间一定会留下标志, 等待不会错过
+        osThreadFlagsClear(BLE_UART_SPACE_FLAG);
+        const uint32_t space = BLE_UART_RING_SIZE - (ringWritten - ringReleased);
+        if (space == 0U) {
+            // 缓冲区已满, 先把攒下的数据发出去才会有空间
+            BleUart_Flush();
+            if (osThreadFlagsWait(BLE_UART_SPACE_FLAG, osFlagsWaitAny, timeout) & osFlagsError) {
+                break;
+            }
+            continue;
+        }
+
+        const uint32_t count = space < (uint32_t) (len - written) ? space : (uint32_t) (len - written);
+        const uint32_t at = ringWritten % BLE_UART_RING_SIZE;
+        const uint32_t first = count < BLE_UART_RING_SIZE - at ? count : BLE_UART_RING_SIZE - at;
+        memcpy(ring + at, bytes + written, first);
+        memcpy(ring, bytes + written + first, count - first);
+
+        ringWritten += count;
+        written += (uint16_t) count;
+    }
+    return written;
+}
+
+void BleUart_Flush(void) {
+    taskENTER_CRITICAL();
+    BleUart_Kick();
+    taskEXIT_CRITICAL();
+}
+
+uint16_t BleUart_Write(const void *data, uint16_t len, uint32_t timeout) {
+    const uint16_t written = BleUart_Append(data, len, timeout);
+    BleUart_Flush();
+    return written;
+}
+
+uint8_t BleUart_IsIdle(void) {
+    return !dmaBusy && ringReleased == ringWritten;
+}
+
+__weak void BleUart_TxIdleCallback(void) {
+}
+
+// ========================== HAL 回调(USART2/DMA1 通道 7 中断上下文) ==========================
+
+/**
+ * @brief DMA 已读出当前区间的前一半, 这部分空间可以先还给写入者
+ */
+void HAL_UART_TxHalfCpltCallback(UART_HandleTypeDef *huart) {
+    if (huart == &huart2 && dmaBusy) {
+        BleUart_Release(dmaStart + (ringQueued - dmaStart) / 2U);
+    }
+}
+
+/**
+ * @brief 当前区间已全部发出(HAL 在 USART 的 TC 中断里调用), 接着发下一段
+ */
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart) {
+    if (huart != &huart2) {
+        return;
+    }
+    dmaBusy = 0;
+    BleUart_Release(ringQueued);
+    BleUart_Kick();
+    if (!dmaBusy) {
+        BleUart_TxIdleCallback();
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef SMARTFARM_BLE_UART_H
+#define SMARTFARM_BLE_UART_H
+
+#include "main.h"
+
+/**
+ * @file ble_uart.h
+ * @brief USART2(蓝牙模块)的 DMA 发送环形缓冲区
+ *
+ * 写入的数据追加到一个静态的环形缓冲区后立即返回, DMA 直接从环形缓冲区发送, 不需要每条消息单独等待:
+ * - 空闲时写入会启动 DMA, 发送区间是环形缓冲区中一段连续的数据(到缓冲区末尾为止)
+ * - DMA 半传输中断把已发出的前一半空间还给写入者; 传输完成中断在中断里直接启动下一段连续数据,
+ *   数据在环末尾回绕时分两段发出
+ * - 缓冲区满时写入者挂起等待线程标志(底层为 FreeRTOS 任务通知), 由 DMA 中断在腾出空间时唤醒, 不轮询
+ * - BleUart_Append 只写入不启动 DMA, 几条消息攒齐后调用一次 BleUart_Flush, 串口一次连续发完;
+ *   DMA 正在发送时追加的数据由完成中断接着发, 不需要 Flush
+ *
+ * @note 只有 BLETask 写入; HAL_UART_TxCpltCallback/HAL_UART_TxHalfCpltCallback 定义在本模块中
+ */
+
+// 环形缓冲区字节数, 必须是 2 的幂; 9600 波特率下约 0.5 秒的数据
+#define BLE_UART_RING_SIZE 512U
+
+/**
+ * @brief 追加数据, 环形缓冲区放不下时挂起等待 DMA 腾出空间
+ * @param timeout 等待空间的最长时间(内核节拍), osWaitForever 表示一直等
+ * @return 写入的字节数; 超时时小于 len, 已写入的部分照常发送
+ */
+uint16_t BleUart_Write(const void *data, uint16_t len, uint32_t timeout);
+
+/**
+ * @brief 追加数据但不启动 DMA, 之后需要调用 BleUart_Flush
+ * @note 缓冲区满时先启动 DMA 再等待空间, 所以超过缓冲区大小的数据也能写完
+ * @return 同 BleUart_Write
+ */
+uint16_t BleUart_Append(const void *data, uint16_t len, uint32_t timeout);
+
+/**
+ * @brief DMA 空闲时把已追加的数据交给 DMA
+ */
+void BleUart_Flush(void);
+
+/**
+ * @brief 环形缓冲区已空且最后一段已发完
+ * @note 完成回调由 USART 的 TC 中断触发, 返回 1 时最后一个字节也已从移位寄存器发出
+ */
+uint8_t BleUart_IsIdle(void);
+
+/**
+ * @brief 环形缓冲区的数据全部发完时在 USART2 中断中调用, 默认为空, 应用层可以重新定义(与 HAL 回调相同)
+ */
+void BleUart_TxIdleCallback(void);
+
+#endif //SMARTFARM_BLE_UART_H
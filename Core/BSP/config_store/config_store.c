@@ -0,0 +1,236 @@
+#include "config_store.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "utils.h"
+
+// 段头: 序号(32 位) + 序号的 CRC16 + 魔数(16 位), 魔数最后写
+#define CONFIG_STORE_MAGIC 0x4643U
+#define CONFIG_STORE_ERASED 0xFFFFU
+#define CONFIG_STORE_HEADER 8U
+// 记录: 键(16 位) + 长度(16 位) + 值(补齐到半字) + CRC16
+#define CONFIG_STORE_RECORD_HEADER 4U
+
+typedef struct {
+    uint32_t sequence;
+    uint16_t crc;
+    uint16_t magic;
+} ConfigStore_PageHeader;
+
+_Static_assert(sizeof(ConfigStore_PageHeader) == CONFIG_STORE_HEADER, "page header size");
+_Static_assert(CONFIG_STORE_ADDR % FLASH_PAGE_SIZE == 0, "CONFIG region must be page aligned");
+
+static uint8_t configPage;                          // 当前页
+static uint32_t configSequence;                     // 当前页的序号, 0 表示还没有有效的页
+static uint32_t configOffset;                       // 当前页中下一条记录的偏移
+static uint16_t configRecord[CONFIG_KEY_COUNT];     // 每个键最新记录在当前页中的偏移, 0 表示没有
+
+static const uint8_t *ConfigStore_Page(uint8_t page) {
+    return (const uint8_t *) (CONFIG_STORE_ADDR + (uint32_t) page * FLASH_PAGE_SIZE);
+}
+
+static uint16_t ConfigStore_ReadHalfWord(const uint8_t *address) {
+    return *(const volatile uint16_t *) address;
+}
+
+static uint32_t ConfigStore_RecordSize(uint16_t len) {
+    return CONFIG_STORE_RECORD_HEADER + ((len + 1U) & ~1U) + 2U;
+}
+
+static uint32_t ConfigStore_PageSequence(uint8_t page) {
+    const ConfigStore_PageHeader *header = (const ConfigStore_PageHeader *) ConfigStore_Page(page);
+    if (header->magic != CONFIG_STORE_MAGIC || header->sequence == 0U ||
+        crc16Update(CRC16_INIT, &header->sequence, sizeof(header->sequence)) != header->crc) {
+        return 0;
+    }
+    return header->sequence;
+}
+
+/**
+ * @brief 记录的 CRC: 结果为 0xFFFF 时改存 0, 这样 CRC 位置还是擦除状态的记录(写到一半掉电)一定无效
+ */
+static uint16_t ConfigStore_Crc(const void *header, const void *value, uint16_t len) {
+    const uint16_t crc = crc16Update(crc16Update(CRC16_INIT, header, CONFIG_STORE_RECORD_HEADER), value, len);
+    return crc == CONFIG_STORE_ERASED ? 0U : crc;
+}
+
+/**
+ * @brief 扫描当前页, 记下每个键最新的有效记录和写入位置
+ * @note 长度损坏时这一页不再追加, 下次写入时换页
+ */
+static void ConfigStore_Scan(void) {
+    const uint8_t *page = ConfigStore_Page(configPage);
+    uint32_t offset = CONFIG_STORE_HEADER;
+
+    memset(configRecord, 0, sizeof(configRecord));
+    while (offset + CONFIG_STORE_RECORD_HEADER <= FLASH_PAGE_SIZE) {
+        const uint16_t key = ConfigStore_ReadHalfWord(page + offset);
+        const uint16_t len = ConfigStore_ReadHalfWord(page + offset + 2U);
+        if (key == CONFIG_STORE_ERASED) {
+            break;
+        }
+        const uint32_t size = ConfigStore_RecordSize(len);
+        if (offset + size > FLASH_PAGE_SIZE) {
+            offset = FLASH_PAGE_SIZE;
+            break;
+        }
+        const uint16_t crc = ConfigStore_ReadHalfWord(page + offset + size - 2U);
+        if (key < CONFIG_KEY_COUNT &&
+            ConfigStore_Crc(page + offset, page + offset + CONFIG_STORE_RECORD_HEADER, len) == crc) {
+            configRecord[key] = (uint16_t) offset;
+        }
+        offset += size;
+    }
+    configOffset = offset;
+}
+
+void ConfigStore_Init(void) {
+    const uint32_t sequence0 = ConfigStore_PageSequence(0);
+    const uint32_t sequence1 = ConfigStore_PageSequence(1);
+
+    configPage = sequence1 > sequence0 ? 1U : 0U;
+    configSequence = sequence1 > sequence0 ? sequence1 : sequence0;
+    if (configSequence == 0U) {
+        // 两页都无效: 当作第 1 页已写满, 第一次写入时换到第 0 页
+        configPage = 1;
+        configOffset = FLASH_PAGE_SIZE;
+        memset(configRecord, 0, sizeof(configRecord));
+        return;
+    }
+    ConfigStore_Scan();
+}
+
+/**
+ * @brief 找到一个键的最新值
+ * @return 指向 Flash 中的值; 没有保存过或长度不符时返回 NULL
+ */
+static const uint8_t *ConfigStore_Find(ConfigStore_Key key, uint16_t len) {
+    if (key >= CONFIG_KEY_COUNT || configRecord[key] == 0U) {
+        return NULL;
+    }
+    const uint8_t *record = ConfigStore_Page(configPage) + configRecord[key];
+    if (ConfigStore_ReadHalfWord(record + 2U) != len) {
+        return NULL;
+    }
+    return record + CONFIG_STORE_RECORD_HEADER;
+}
+
+HAL_StatusTypeDef ConfigStore_Read(ConfigStore_Key key, void *value, uint16_t len) {
+    const uint8_t *stored = ConfigStore_Find(key, len);
+    if (stored == NULL) {
+        return HAL_ERROR;
+    }
+    memcpy(value, stored, len);
+    return HAL_OK;
+}
+
+static HAL_StatusTypeDef ConfigStore_Program(uint8_t page, uint32_t offset, uint16_t value) {
+    return HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD,
+                             CONFIG_STORE_ADDR + (uint32_t) page * FLASH_PAGE_SIZE + offset, value);
+}
+
+/**
+ * @brief 在 page 的 offset 处写一条记录, CRC 最后写
+ * @param offset 写完(包括写失败)后指向下一条记录
+ */
+static HAL_StatusTypeDef ConfigStore_PutRecord(uint8_t page, uint32_t *offset, uint16_t key, const uint8_t *value,
+                                               uint16_t len) {
+    const uint16_t header[2] = {key, len};
+    const uint16_t crc = ConfigStore_Crc(header, value, len);
+    HAL_StatusTypeDef status = ConfigStore_Program(page, *offset, key);
+
+    if (status == HAL_OK) {
+        status = ConfigStore_Program(page, *offset + 2U, len);
+    }
+    uint32_t at = *offset + CONFIG_STORE_RECORD_HEADER;
+    for (uint16_t i = 0; i < len && status == HAL_OK; i += 2U, at += 2U) {
+        const uint16_t high = i + 1U < len ? value[i + 1U] : 0xFFU;
+        status = ConfigStore_Program(page, at, (uint16_t) (value[i] | high << 8));
+    }
+    if (status == HAL_OK) {
+        status = ConfigStore_Program(page, at, crc);
+    }
+    *offset += ConfigStore_RecordSize(len);
+    return status;
+}
+
+/**
+ * @brief 换页: 擦除另一页, 写入各键的最新值(key 用新值), 最后写段头使新页生效
+ */
+static HAL_StatusTypeDef ConfigStore_Swap(ConfigStore_Key key, const uint8_t *value, uint16_t len) {
+    const uint8_t target = (uint8_t) (configPage ^ 1U);
+    const uint32_t sequence = configSequence + 1U;
+    const uint16_t crc = crc16Update(CRC16_INIT, &sequence, sizeof(sequence));
+    FLASH_EraseInitTypeDef erase = {0};
+    uint32_t pageError = 0;
+    uint32_t offset = CONFIG_STORE_HEADER;
+    uint16_t records[CONFIG_KEY_COUNT] = {0};
+
+    // 擦除前先清掉目标页的魔数, 擦到一半掉电时不会被当成有效的页
+    erase.TypeErase = FLASH_TYPEERASE_PAGES;
+    erase.PageAddress = CONFIG_STORE_ADDR + (uint32_t) target * FLASH_PAGE_SIZE;
+    erase.NbPages = 1;
+    HAL_StatusTypeDef status = ConfigStore_Program(target, offsetof(ConfigStore_PageHeader, magic), 0);
+    if (status == HAL_OK) {
+        status = HAL_FLASHEx_Erase(&erase, &pageError);
+    }
+
+    for (uint16_t k = 1; k < CONFIG_KEY_COUNT && status == HAL_OK; k++) {
+        if (k == key) {
+            records[k] = (uint16_t) offset;
+            status = ConfigStore_PutRecord(target, &offset, k, value, len);
+        } else if (configRecord[k] != 0U) {
+            const uint8_t *old = ConfigStore_Page(configPage) + configRecord[k];
+            records[k] = (uint16_t) offset;
+            status = ConfigStore_PutRecord(target, &offset, k, old + CONFIG_STORE_RECORD_HEADER,
+                                           ConfigStore_ReadHalfWord(old + 2U));
+        }
+    }
+
+    if (status == HAL_OK) {
+        status = ConfigStore_Program(target, 0, (uint16_t) sequence);
+    }
+    if (status == HAL_OK) {
+        status = ConfigStore_Program(target, 2, (uint16_t) (sequence >> 16));
+    }
+    if (status == HAL_OK) {
+        status = ConfigStore_Program(target, offsetof(ConfigStore_PageHeader, crc), crc);
+    }
+    if (status == HAL_OK) {
+        status = ConfigStore_Program(target, offsetof(ConfigStore_PageHeader, magic), CONFIG_STORE_MAGIC);
+    }
+    if (status == HAL_OK) {
+        configPage = target;
+        configSequence = sequence;
+        configOffset = offset;
+        memcpy(configRecord, records, sizeof(configRecord));
+    }
+    return status;
+}
+
+HAL_StatusTypeDef ConfigStore_Write(ConfigStore_Key key, const void *value, uint16_t len) {
+    const uint8_t *stored = ConfigStore_Find(key, len);
+    const uint32_t size = ConfigStore_RecordSize(len);
+    HAL_StatusTypeDef status;
+
+    if (key == 0U || key >= CONFIG_KEY_COUNT || size > FLASH_PAGE_SIZE / 2U) {
+        return HAL_ERROR;
+    }
+    if (stored != NULL && memcmp(stored, value, len) == 0) {
+        return HAL_OK;
+    }
+
+    HAL_FLASH_Unlock();
+    if (configOffset + size > FLASH_PAGE_SIZE) {
+        status = ConfigStore_Swap(key, value, len);
+    } else {
+        const uint32_t offset = configOffset;
+        status = ConfigStore_PutRecord(configPage, &configOffset, key, value, len);
+        if (status == HAL_OK) {
+            configRecord[key] = (uint16_t) offset;
+        }
+    }
+    HAL_FLASH_Lock();
+    return status;
+}
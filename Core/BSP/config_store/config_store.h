@@ -0,0 +1,51 @@
+#ifndef SMARTFARM_CONFIG_STORE_H
+#define SMARTFARM_CONFIG_STORE_H
+
+#include "main.h"
+
+/**
+ * @file config_store.h
+ * @brief 片内 Flash 上的键值配置存储
+ *
+ * 占用链接脚本(STM32F103XX_FLASH.ld)中的 CONFIG 区, 两页轮流使用(双缓冲):
+ * - 当前页是段头有效且序号较大的一页; 每次写入在当前页末尾追加一条记录(键 + 长度 + 值 + CRC16),
+ *   同一个键以最后一条 CRC 正确的记录为准, 平时写入不擦除
+ * - 当前页写满时把各键的最新记录复制到另一页, 最后才写新页的段头(序号 + 1), 段头写完的那一刻新页生效;
+ *   在这之前掉电, 旧页保持不变, 因此任何时刻掉电读到的都是某一次完整写入的值
+ * - 初始化时只扫描当前页一次, 记下每个键最新记录的位置; 读取是一次 memcpy, 值按结构体原样保存, 不需要解析
+ *
+ * @note 与 flash_log 一样在 SensorTask 中写入(两者共用 Flash 控制器, 不能在不同任务中同时擦写)
+ */
+
+// CONFIG 区的起始地址, 必须与链接脚本中的 CONFIG 区一致; 两页轮流使用
+#define CONFIG_STORE_ADDR 0x0807F000UL
+#define CONFIG_STORE_PAGES 2U
+
+/**
+ * @brief 配置项
+ * @note 值按结构体原样保存, 读取时长度必须一致; 结构体布局改变时换一个新键, 旧记录会在下次换页时丢弃
+ */
+typedef enum {
+    CONFIG_KEY_SAFE_RANGE = 1,   // FarmSafeRange
+    CONFIG_KEY_COUNT,
+} ConfigStore_Key;
+
+/**
+ * @brief 扫描 CONFIG 区, 找到当前页和每个键的最新记录
+ */
+void ConfigStore_Init(void);
+
+/**
+ * @brief 读取一个键的值
+ * @param len 值的字节数, 必须与保存时相同
+ * @return HAL_OK: 已读出; HAL_ERROR: 没有保存过或长度不符, value 不变
+ */
+HAL_StatusTypeDef ConfigStore_Read(ConfigStore_Key key, void *value, uint16_t len);
+
+/**
+ * @brief 写入一个键的值, 与已保存的值相同时不写
+ * @return HAL_OK: 已写入, 掉电后保留
+ */
+HAL_StatusTypeDef ConfigStore_Write(ConfigStore_Key key, const void *value, uint16_t len);
+
+#endif //SMARTFARM_CONFIG_STORE_H
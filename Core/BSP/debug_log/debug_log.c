@@ -3,6 +3,7 @@
 #include "cmsis_os.h"  // 引入 FreeRTOS 的 osDelay
 #include <stdio.h>
 #include <stdarg.h>
+#include "power.h"
 
 // 【极其致命的一步】：告诉编译器，huart1 这个硬件句柄在 main.c 里已经初始化好了，直接拿来用！
 extern UART_HandleTypeDef huart1;
@@ -36,9 +37,17 @@ void DMA_Printf(const char *format, ...)
 // ==========================================
 // 顺手把标准 printf 重定向也搬过来，保持 main.c 清爽
 // ==========================================
+// 睡眠屏障的空闲检查：USART1 没有正在进行的发送
+static uint8_t DebugLog_IsIdle(void) {
+    return huart1.gState == HAL_UART_STATE_READY;
+}
+
 #ifdef __GNUC__
 int _write(int file, char *ptr, int len) {
+    // 阻塞发送在 TC 置位（最后一个字节离开移位寄存器）后才返回，返回时即可通知睡眠屏障
+    Power_Busy(POWER_DEBUG_LOG);
     HAL_UART_Transmit(&huart1, (uint8_t *)ptr, len, HAL_MAX_DELAY);
+    Power_Idle(POWER_DEBUG_LOG, DebugLog_IsIdle);
     return len;
 }
 #else
@@ -0,0 +1,208 @@
+#include "flash_log.h"
+
+#include <stddef.h>
+
+#include "utils.h"
+
+// 段头: 序号(32 位) + 序号的 CRC16 + 魔数(16 位), 魔数最后写
+#define FLASH_LOG_MAGIC 0x4C47U
+// 未写入的半字
+#define FLASH_LOG_ERASED 0xFFFFU
+
+typedef struct {
+    uint32_t sequence;
+    uint16_t crc;
+    uint16_t magic;
+} FlashLog_SegmentHeader;
+
+_Static_assert(sizeof(FlashLog_SegmentHeader) == FLASH_LOG_SEGMENT_HEADER, "segment header size");
+_Static_assert(FLASH_LOG_SIZE % FLASH_PAGE_SIZE == 0 && FLASH_LOG_ADDR % FLASH_PAGE_SIZE == 0,
+               "LOG region must be page aligned");
+
+static uint8_t logHead;          // 正在写入的段
+static uint32_t logOffset;       // 正在写入的段中下一条记录的偏移
+static uint32_t logSequence;     // 正在写入的段的序号, 0 表示 LOG 区里还没有有效的段
+static FlashLog_Stats logStats;
+
+static const uint8_t *FlashLog_Page(uint8_t page) {
+    return (const uint8_t *) (FLASH_LOG_ADDR + (uint32_t) page * FLASH_PAGE_SIZE);
+}
+
+static uint16_t FlashLog_ReadHalfWord(const uint8_t *address) {
+    return *(const volatile uint16_t *) address;
+}
+
+static uint8_t FlashLog_IsSegment(uint8_t page) {
+    const FlashLog_SegmentHeader *header = (const FlashLog_SegmentHeader *) FlashLog_Page(page);
+    return header->magic == FLASH_LOG_MAGIC && header->sequence != 0U &&
+           crc16Update(CRC16_INIT, &header->sequence, sizeof(header->sequence)) == header->crc;
+}
+
+static uint32_t FlashLog_RecordSize(uint16_t len) {
+    return FLASH_LOG_RECORD_HEADER + ((len + 1U) & ~1U) + 2U;
+}
+
+/**
+ * @brief 记录的 CRC: 结果为 0xFFFF 时改存 0, 这样 CRC 位置还是擦除状态的记录(写到一半掉电)一定无效
+ */
+static uint16_t FlashLog_Crc(const void *header, const void *data, uint16_t len) {
+    const uint16_t crc = crc16Update(crc16Update(CRC16_INIT, header, FLASH_LOG_RECORD_HEADER), data, len);
+    return crc == FLASH_LOG_ERASED ? 0U : crc;
+}
+
+/**
+ * @brief 顺序遍历一段中的记录
+ * @param callback 为 NULL 时只找写入位置
+ * @return 下一条记录的偏移; 遇到损坏的长度时返回 FLASH_PAGE_SIZE, 这一段不再写入
+ */
+static uint32_t FlashLog_Walk(uint8_t page, FlashLog_ReplayFn callback, void *context) {
+    const uint8_t *segment = FlashLog_Page(page);
+    uint32_t offset = FLASH_LOG_SEGMENT_HEADER;
+
+    while (offset + FLASH_LOG_RECORD_HEADER <= FLASH_PAGE_SIZE) {
+        const uint16_t len = FlashLog_ReadHalfWord(segment + offset);
+        if (len == FLASH_LOG_ERASED) {
+            break;
+        }
+        const uint32_t size = FlashLog_RecordSize(len);
+        if (len > FLASH_LOG_RECORD_MAX || offset + size > FLASH_PAGE_SIZE) {
+            return FLASH_PAGE_SIZE;
+        }
+        if (callback != NULL) {
+            const uint8_t *record = segment + offset;
+            const uint16_t crc = FlashLog_ReadHalfWord(record + size - 2U);
+            if (FlashLog_Crc(record, record + FLASH_LOG_RECORD_HEADER, len) == crc) {
+                callback((FlashLog_Type) record[2], record + FLASH_LOG_RECORD_HEADER, len, context);
+                logStats.records++;
+            } else {
+                logStats.skipped++;
+            }
+        }
+        offset += size;
+    }
+    return offset;
+}
+
+void FlashLog_Init(void) {
+    logSequence = 0;
+    logStats = (FlashLog_Stats) {0};
+
+    // 序号最大的段就是最新一段; 段是按页轮流写的, 它后面的各页依次是从最老到次新的段
+    for (uint8_t page = 0; page < FLASH_LOG_PAGES; page++) {
+        if (!FlashLog_IsSegment(page)) {
+            continue;
+        }
+        const uint32_t sequence = ((const FlashLog_SegmentHeader *) FlashLog_Page(page))->sequence;
+        logStats.segments++;
+        if (sequence > logSequence) {
+            logSequence = sequence;
+            logHead = page;
+        }
+    }
+
+    if (logSequence == 0U) {
+        // 空的 LOG 区: 假装最后一页已写满, 第一次追加时从第 0 页开始
+        logHead = FLASH_LOG_PAGES - 1U;
+        logOffset = FLASH_PAGE_SIZE;
+    } else {
+        logOffset = FlashLog_Walk(logHead, NULL, NULL);
+    }
+    logStats.sequence = logSequence;
+    logStats.used = logSequence != 0U ? logOffset : 0U;
+}
+
+uint32_t FlashLog_Replay(FlashLog_ReplayFn callback, void *context) {
+    const uint32_t before = logStats.records;
+    if (logSequence == 0U) {
+        return 0;
+    }
+    for (uint8_t i = 1; i <= FLASH_LOG_PAGES; i++) {
+        const uint8_t page = (uint8_t) ((logHead + i) % FLASH_LOG_PAGES);
+        if (FlashLog_IsSegment(page)) {
+            FlashLog_Walk(page, callback, context);
+        }
+    }
+    return logStats.records - before;
+}
+
+static HAL_StatusTypeDef FlashLog_Program(uint32_t offset, uint16_t value) {
+    return HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD,
+                             FLASH_LOG_ADDR + (uint32_t) logHead * FLASH_PAGE_SIZE + offset, value);
+}
+
+/**
+ * @brief 擦除下一页(最老的一段)并写入新的段头
+ * @note 擦除前先把旧段头的魔数清零(已写过的半字可以再写 0), 擦到一半掉电时这一页不会被当成有效的段;
+ *       新段头先写序号和 CRC、最后写魔数, 段头没写完就掉电时这一页同样被忽略
+ */
+static HAL_StatusTypeDef FlashLog_Rotate(void) {
+    FLASH_EraseInitTypeDef erase = {0};
+    uint32_t pageError = 0;
+    const uint32_t sequence = logSequence + 1U;
+    const uint16_t crc = crc16Update(CRC16_INIT, &sequence, sizeof(sequence));
+
+    logHead = (uint8_t) ((logHead + 1U) % FLASH_LOG_PAGES);
+    logOffset = FLASH_PAGE_SIZE; // 段头写完之前当作已写满
+    erase.TypeErase = FLASH_TYPEERASE_PAGES;
+    erase.PageAddress = FLASH_LOG_ADDR + (uint32_t) logHead * FLASH_PAGE_SIZE;
+    erase.NbPages = 1;
+    if (FlashLog_Program(offsetof(FlashLog_SegmentHeader, magic), 0) != HAL_OK ||
+        HAL_FLASHEx_Erase(&erase, &pageError) != HAL_OK ||
+        FlashLog_Program(0, (uint16_t) sequence) != HAL_OK ||
+        FlashLog_Program(2, (uint16_t) (sequence >> 16)) != HAL_OK ||
+        FlashLog_Program(offsetof(FlashLog_SegmentHeader, crc), crc) != HAL_OK ||
+        FlashLog_Program(offsetof(FlashLog_SegmentHeader, magic), FLASH_LOG_MAGIC) != HAL_OK) {
+        return HAL_ERROR;
+    }
+    logSequence = sequence;
+    logOffset = FLASH_LOG_SEGMENT_HEADER;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef FlashLog_Append(FlashLog_Type type, const void *data, uint16_t len) {
+    const uint8_t *bytes = (const uint8_t *) data;
+    const uint32_t size = FlashLog_RecordSize(len);
+    HAL_StatusTypeDef status = HAL_OK;
+
+    if (len > FLASH_LOG_RECORD_MAX) {
+        return HAL_ERROR;
+    }
+
+    uint8_t header[FLASH_LOG_RECORD_HEADER] = {(uint8_t) len, (uint8_t) (len >> 8), (uint8_t) type, 0xFF};
+    const uint16_t crc = FlashLog_Crc(header, data, len);
+
+    HAL_FLASH_Unlock();
+    if (logOffset + size > FLASH_PAGE_SIZE) {
+        status = FlashLog_Rotate();
+    }
+    // 长度、类型、数据、CRC 依次写入, CRC 最后写, 写完才算提交
+    uint32_t offset = logOffset;
+    if (status == HAL_OK) {
+        status = FlashLog_Program(offset, (uint16_t) (header[0] | header[1] << 8));
+        offset += 2U;
+    }
+    if (status == HAL_OK) {
+        status = FlashLog_Program(offset, (uint16_t) (header[2] | header[3] << 8));
+        offset += 2U;
+    }
+    for (uint16_t i = 0; i < len && status == HAL_OK; i += 2U, offset += 2U) {
+        const uint16_t high = i + 1U < len ? bytes[i + 1U] : 0xFFU;
+        status = FlashLog_Program(offset, (uint16_t) (bytes[i] | high << 8));
+    }
+    if (status == HAL_OK) {
+        status = FlashLog_Program(offset, crc);
+    }
+    HAL_FLASH_Lock();
+
+    // 写失败时这条记录的位置不再使用, 下一条从它后面开始(下次开机时它因 CRC 不对被跳过)
+    if (logOffset != FLASH_PAGE_SIZE) {
+        logOffset += size;
+    }
+    logStats.sequence = logSequence;
+    logStats.used = logOffset;
+    return status;
+}
+
+void FlashLog_GetStats(FlashLog_Stats *stats) {
+    *stats = logStats;
+}
@@ -0,0 +1,76 @@
+#ifndef SMARTFARM_FLASH_LOG_H
+#define SMARTFARM_FLASH_LOG_H
+
+#include "main.h"
+
+/**
+ * @file flash_log.h
+ * @brief 片内 Flash 上的只追加日志
+ *
+ * 占用链接脚本(STM32F103XX_FLASH.ld)中程序区之后保留的 LOG 区, 掉电后保留, 开机时顺序回放:
+ * - LOG 区按 Flash 页(2KB)分成若干段, 段首是段头(序号 + CRC + 魔数), 之后是一条接一条的记录
+ * - 记录 = 长度(16 位) + 类型 + 数据(补齐到半字) + CRC16, 只在写满一段后才擦除下一段,
+ *   各段按序号轮流擦写, 磨损平均分布在整个 LOG 区
+ * - 写入顺序保证任何时刻掉电都能恢复: 擦除前先清掉旧段头的魔数, 新段头最后写魔数, 魔数或序号的 CRC
+ *   不对的段整段忽略; 记录最后写 CRC, CRC 不对的记录按长度跳过, 长度本身损坏时这一段不再写入
+ * - 回放直接读 Flash, 不需要缓冲区; 开机扫描只读每段 8 字节的段头和最新一段的记录头
+ *
+ * @note F103 只有一个 Flash bank, 擦写期间 CPU 取指暂停(写一个半字约 50us, 擦一页约 20ms),
+ *       只在 SensorTask 中调用, 不要在中断里写
+ */
+
+// LOG 区的起始地址和页数, 必须与链接脚本中的 LOG 区一致
+#define FLASH_LOG_ADDR 0x08070000UL
+#define FLASH_LOG_PAGES 30U
+#define FLASH_LOG_SIZE (FLASH_LOG_PAGES * FLASH_PAGE_SIZE)
+
+// 段头和记录头的字节数, 以及一条记录最多能带的数据
+#define FLASH_LOG_SEGMENT_HEADER 8U
+#define FLASH_LOG_RECORD_HEADER 4U
+#define FLASH_LOG_RECORD_MAX (FLASH_PAGE_SIZE - FLASH_LOG_SEGMENT_HEADER - FLASH_LOG_RECORD_HEADER - 2U)
+
+/**
+ * @brief 记录类型
+ */
+typedef enum {
+    FLASH_LOG_HISTORY_MINUTE = 1,   // 一个分钟点: HistoryPoint[HISTORY_SERIES_COUNT]
+} FlashLog_Type;
+
+/**
+ * @brief 开机扫描和回放的统计
+ */
+typedef struct {
+    uint32_t sequence;   // 最新一段的序号, 即 LOG 区总共擦过多少页
+    uint16_t segments;   // 有效的段数
+    uint32_t records;    // 回放的记录数
+    uint32_t skipped;    // CRC 不对被跳过的记录数(掉电时写了一半的记录)
+    uint32_t used;       // 最新一段已写入的字节数(含段头)
+} FlashLog_Stats;
+
+/**
+ * @brief 回放回调
+ * @param data 直接指向 Flash 中的数据, 回调返回后不再有效
+ */
+typedef void (*FlashLog_ReplayFn)(FlashLog_Type type, const void *data, uint16_t len, void *context);
+
+/**
+ * @brief 扫描 LOG 区, 找到最新一段和写入位置, 必须在其他接口之前调用
+ */
+void FlashLog_Init(void);
+
+/**
+ * @brief 从最老的记录开始按写入顺序回放所有有效记录
+ * @return 回放的记录数
+ */
+uint32_t FlashLog_Replay(FlashLog_ReplayFn callback, void *context);
+
+/**
+ * @brief 追加一条记录, 当前段放不下时擦除最老的一段接着写
+ * @param len 数据字节数, 不超过 FLASH_LOG_RECORD_MAX
+ * @return HAL_OK: 已写入并可在下次开机时回放
+ */
+HAL_StatusTypeDef FlashLog_Append(FlashLog_Type type, const void *data, uint16_t len);
+
+void FlashLog_GetStats(FlashLog_Stats *stats);
+
+#endif //SMARTFARM_FLASH_LOG_H
@@ -0,0 +1,294 @@
+/**
+ * @file i2c_bus.c
+ * @brief I2C2 中断驱动的传输队列
+ *
+ * AHT20、BMP280 和 OLED 共用 I2C2。各任务把传输描述符提交到队列后挂起等待任务通知,
+ * 总线由 I2C2 事件/错误中断推进: 一次传输完成后在中断里直接启动队列中的下一次,
+ * 传输期间 CPU 可以运行其他任务或进入空闲。
+ *
+ * HAL 的 *_IT 启动函数发现 BUSY 标志置位(上一次传输的停止条件还没发完)时会原地等待, 最长 25ms。
+ * 这里启动前先检查 BUSY, 不让 HAL 在临界区或中断里等:
+ * - 任务提交时在临界区外读几次 BUSY(约一个停止条件的时间), 清除后再进入临界区启动
+ * - 中断里遇到 BUSY 时不启动, 交给定时器服务任务(xTimerPendFunctionCallFromISR)启动
+ * - 仍然 BUSY 时不原地等待, 重新挂到定时器命令队列末尾, 其他软件定时器照常执行;
+ *   BUSY 持续 25ms(总线卡死)后以 HAL_BUSY 结束该描述符
+ * 队首描述符在启动之前不会有完成中断, 所以同一时刻只有一个调用者负责启动它。
+ *
+ * - 队列是描述符自带 next 指针的单向链表, 队首就是正在传输的描述符, 不需要额外分配内存
+ * - 所有传输严格按提交顺序完成, 同一任务连续提交多个描述符后只需等待最后一个
+ * - 完成通知使用 CMSIS-RTOS2 线程标志(底层为 FreeRTOS 任务通知)
+ * - 提交时清除睡眠屏障(power.h)中的 POWER_I2C 位, 队列取空时在中断中请求置位
+ * - 带 header 的写传输用 HAL 的顺序传输接口分两段发出(I2C_FIRST_FRAME + I2C_LAST_FRAME),
+ *   在总线上仍是一次完整的传输, 例如 OLED 的页地址指令 + 直接取自显存的一页数据
+ *
+ * @note I2C2_TX/I2C2_RX 的 DMA 请求固定在 DMA1 通道 4/5 上, 这两个通道已分配给 USART1 的 DMA 收发,
+ *       因此这里使用中断方式传输
+ */
+#include "i2c_bus.h"
+#include "i2c.h"
+#include "FreeRTOS.h"
+#include "power.h"
+#include "task.h"
+#include "timers.h"
+
+// 传输完成通知使用的线程标志位
+#define I2C_BUS_DONE_FLAG 0x00000100U
+
+// 等待 BUSY 清除的上限, 与 HAL 启动函数内部的 I2C_TIMEOUT_BUSY_FLAG 相同
+#define I2C_BUS_BUSY_TIMEOUT_MS 25U
+
+// 每次启动前最多读 BUSY 的次数, 72MHz 下约 10us, 即 100kHz 下一个停止条件的时间
+#define I2C_BUS_BUSY_POLLS 200U
+
+static I2CBus_Transfer *queueHead = NULL; // 正在传输的描述符
+static I2CBus_Transfer *queueTail = NULL;
+static uint8_t busyWaiting = 0;           // 队首描述符因 BUSY 推迟启动中
+static uint32_t busySince;                // 开始推迟的时刻(HAL_GetTick)
+
+/**
+ * @brief 总线上是否还有未结束的传输(BUSY 标志)
+ */
+static uint8_t I2CBus_LineBusy(void) {
+    return __HAL_I2C_GET_FLAG(&hi2c2, I2C_FLAG_BUSY) != RESET;
+}
+
+/**
+ * @brief 启动一次传输
+ * @return BUSY 置位时不调用 HAL, 返回 HAL_BUSY
+ * @note 在临界区或 I2C2 中断中调用
+ */
+static HAL_StatusTypeDef I2CBus_Start(I2CBus_Transfer *transfer) {
+    if (I2CBus_LineBusy()) {
+        return HAL_BUSY;
+    }
+    switch (transfer->op) {
+        case I2C_BUS_WRITE:
+            if (transfer->headerLen != 0U) {
+                transfer->headerSent = 0;
+                return HAL_I2C_Master_Seq_Transmit_IT(&hi2c2, transfer->address, transfer->header,
+                                                      transfer->headerLen, I2C_FIRST_FRAME);
+            }
+            return HAL_I2C_Master_Transmit_IT(&hi2c2, transfer->address, transfer->data, transfer->len);
+        case I2C_BUS_READ:
+            return HAL_I2C_Master_Receive_IT(&hi2c2, transfer->address, transfer->data, transfer->len);
+        case I2C_BUS_MEM_WRITE:
+            return HAL_I2C_Mem_Write_IT(&hi2c2, transfer->address, transfer->memAddress, I2C_MEMADD_SIZE_8BIT,
+                                        transfer->data, transfer->len);
+        case I2C_BUS_MEM_READ:
+            return HAL_I2C_Mem_Read_IT(&hi2c2, transfer->address, transfer->memAddress, I2C_MEMADD_SIZE_8BIT,
+                                       transfer->data, transfer->len);
+        default:
+            return HAL_ERROR;
+    }
+}
+
+/**
+ * @brief 结束队首传输并通知提交者
+ * @note 在临界区或 I2C2 中断中调用
+ */
+static void I2CBus_Finish(HAL_StatusTypeDef status) {
+    I2CBus_Transfer *finished = queueHead;
+
+    queueHead = finished->next;
+    if (queueHead == NULL) {
+        queueTail = NULL;
+    }
+    finished->status = status;
+    finished->done = 1;
+    osThreadFlagsSet(finished->owner, I2C_BUS_DONE_FLAG);
+
+    if (queueHead == NULL) {
+        // 队列取空, 通知睡眠屏障
+        Power_IdleFromISR(POWER_I2C, I2CBus_IsIdle);
+    }
+}
+
+static void I2CBus_StartDeferred(void *param, uint32_t value);
+
+/**
+ * @brief 结束队首传输并通知提交者, 然后启动后续传输
+ * @note 在临界区或 I2C2 中断中调用
+ */
+static void I2CBus_Complete(HAL_StatusTypeDef status) {
+    I2CBus_Finish(status);
+    while (queueHead != NULL) {
+        status = I2CBus_Start(queueHead);
+        if (status == HAL_OK) {
+            return;
+        }
+        // 上一次传输的停止条件还在发送, 由定时器服务任务等它发完后启动;
+        // 定时器命令队列已满时只能以 HAL_BUSY 结束, 提交者按传输失败处理
+        if (status == HAL_BUSY &&
+            xTimerPendFunctionCallFromISR(I2CBus_StartDeferred, NULL, 0, NULL) == pdPASS) {
+            return;
+        }
+        // 启动失败(例如参数错误)时直接以失败结束该描述符, 继续下一个
+        I2CBus_Finish(status);
+    }
+}
+
+/**
+ * @brief 在任务中启动队首传输, 总线仍然 BUSY 时交给定时器服务任务稍后重试
+ * @note 队首描述符还没有启动, 调用者是唯一负责启动它的一方
+ */
+static void I2CBus_Kick(void) {
+    HAL_StatusTypeDef status;
+
+    for (uint32_t polls = 0; polls < I2C_BUS_BUSY_POLLS && I2CBus_LineBusy(); polls++) {
+    }
+
+    taskENTER_CRITICAL();
+    status = I2CBus_Start(queueHead);
+    taskEXIT_CRITICAL();
+    if (status == HAL_OK) {
+        busyWaiting = 0;
+        return;
+    }
+    if (status == HAL_BUSY) {
+        if (!busyWaiting) {
+            busyWaiting = 1;
+            busySince = HAL_GetTick();
+        }
+        // 不在这里等: 重新排到定时器命令队列末尾, 命令队列满或总线卡死超时时以 HAL_BUSY 结束
+        if (HAL_GetTick() - busySince < I2C_BUS_BUSY_TIMEOUT_MS &&
+            xTimerPendFunctionCall(I2CBus_StartDeferred, NULL, 0, 0) == pdPASS) {
+            return;
+        }
+    }
+    busyWaiting = 0;
+
+    taskENTER_CRITICAL();
+    I2CBus_Complete(status);
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief 因 BUSY 没能启动的传输, 由定时器服务任务接着启动
+ */
+static void I2CBus_StartDeferred(void *param, uint32_t value) {
+    (void) param;
+    (void) value;
+    I2CBus_Kick();
+}
+
+/**
+ * @brief 提交一次传输, 立即返回
+ * @param transfer 传输描述符, 需填好 op/address/memAddress/data/len
+ * @note 只能在任务中调用, 完成后通知的是调用者所在任务
+ */
+void I2CBus_Submit(I2CBus_Transfer *transfer) {
+    uint8_t idle;
+
+    transfer->owner = osThreadGetId();
+    transfer->status = HAL_BUSY;
+    transfer->done = 0;
+    transfer->next = NULL;
+
+    Power_Busy(POWER_I2C);
+    taskENTER_CRITICAL();
+    idle = queueTail == NULL;
+    if (idle) {
+        queueHead = transfer;
+    } else {
+        queueTail->next = transfer;
+    }
+    queueTail = transfer;
+    taskEXIT_CRITICAL();
+
+    if (idle) {
+        // 总线空闲, 由提交者立即开始
+        I2CBus_Kick();
+    }
+}
+
+/**
+ * @brief 等待传输完成
+ * @return 传输结果, HAL_OK 表示成功
+ */
+HAL_StatusTypeDef I2CBus_Wait(I2CBus_Transfer *transfer) {
+    // 同一任务的多个描述符共用一个标志位, 被唤醒后还要确认是不是自己等的那一个
+    while (!transfer->done) {
+        osThreadFlagsWait(I2C_BUS_DONE_FLAG, osFlagsWaitAny, osWaitForever);
+    }
+    return transfer->status;
+}
+
+static HAL_StatusTypeDef I2CBus_Transact(I2CBus_Op op, uint16_t address, uint8_t memAddress, uint8_t *data,
+                                         uint16_t len) {
+    I2CBus_Transfer transfer = {
+        .op = op,
+        .address = address,
+        .memAddress = memAddress,
+        .data = data,
+        .len = len,
+    };
+    I2CBus_Submit(&transfer);
+    return I2CBus_Wait(&transfer);
+}
+
+HAL_StatusTypeDef I2CBus_Write(uint16_t address, uint8_t *data, uint16_t len) {
+    return I2CBus_Transact(I2C_BUS_WRITE, address, 0, data, len);
+}
+
+HAL_StatusTypeDef I2CBus_Read(uint16_t address, uint8_t *data, uint16_t len) {
+    return I2CBus_Transact(I2C_BUS_READ, address, 0, data, len);
+}
+
+HAL_StatusTypeDef I2CBus_MemWrite(uint16_t address, uint8_t memAddress, uint8_t *data, uint16_t len) {
+    return I2CBus_Transact(I2C_BUS_MEM_WRITE, address, memAddress, data, len);
+}
+
+HAL_StatusTypeDef I2CBus_MemRead(uint16_t address, uint8_t memAddress, uint8_t *data, uint16_t len) {
+    return I2CBus_Transact(I2C_BUS_MEM_READ, address, memAddress, data, len);
+}
+
+/**
+ * @brief 队列为空且总线空闲, 进入 STOP 模式前用来确认没有未完成的传输
+ */
+uint8_t I2CBus_IsIdle(void) {
+    return queueHead == NULL && HAL_I2C_GetState(&hi2c2) == HAL_I2C_STATE_READY;
+}
+
+// ========================== HAL 回调(I2C2 中断上下文) ==========================
+
+void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef *hi2c) {
+    if (hi2c->Instance != I2C2) {
+        return;
+    }
+    // header 已发完, 不产生重复起始条件, 接着发送数据并在最后产生停止条件
+    if (queueHead != NULL && queueHead->headerLen != 0U && !queueHead->headerSent) {
+        queueHead->headerSent = 1;
+        const HAL_StatusTypeDef status = HAL_I2C_Master_Seq_Transmit_IT(&hi2c2, queueHead->address,
+                                                                        queueHead->data, queueHead->len,
+                                                                        I2C_LAST_FRAME);
+        if (status != HAL_OK) {
+            I2CBus_Complete(status);
+        }
+        return;
+    }
+    I2CBus_Complete(HAL_OK);
+}
+
+void HAL_I2C_MasterRxCpltCallback(I2C_HandleTypeDef *hi2c) {
+    if (hi2c->Instance == I2C2) {
+        I2CBus_Complete(HAL_OK);
+    }
+}
+
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c) {
+    if (hi2c->Instance == I2C2) {
+        I2CBus_Complete(HAL_OK);
+    }
+}
+
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c) {
+    if (hi2c->Instance == I2C2) {
+        I2CBus_Complete(HAL_OK);
+    }
+}
+
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c) {
+    if (hi2c->Instance == I2C2) {
+        I2CBus_Complete(HAL_ERROR);
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef SMARTFARM_I2C_BUS_H
+#define SMARTFARM_I2C_BUS_H
+
+#include "main.h"
+#include "cmsis_os2.h"
+
+/**
+ * @brief I2C2 传输类型
+ */
+typedef enum {
+    I2C_BUS_WRITE = 0,   // 主机写, data 整体作为一次写传输; 设置了 header 时先发 header 再发 data, 中间没有停止条件
+    I2C_BUS_READ,        // 主机读
+    I2C_BUS_MEM_WRITE,   // 写寄存器: 8 位寄存器地址 + data
+    I2C_BUS_MEM_READ,    // 读寄存器: 写 8 位寄存器地址, 重复起始后读 data
+} I2CBus_Op;
+
+/**
+ * @brief I2C2 传输描述符
+ * @note 提交后到完成前, 描述符和 data 指向的缓冲区都必须保持有效
+ */
+typedef struct I2CBus_Transfer {
+    I2CBus_Op op;
+    uint16_t address;     // 8 位器件地址, 与 HAL 的 DevAddress 一致
+    uint8_t memAddress;   // 寄存器地址, 仅 MEM 操作使用
+    uint8_t *data;
+    uint16_t len;
+    uint8_t *header;      // 可选的前导字节, 仅 WRITE 使用; 让前导和数据分处两块内存时不必拼接
+    uint16_t headerLen;
+
+    // 以下由总线引擎填写
+    volatile HAL_StatusTypeDef status;
+    volatile uint8_t done;
+    uint8_t headerSent;
+    osThreadId_t owner;
+    struct I2CBus_Transfer *next;
+} I2CBus_Transfer;
+
+// 异步接口: 提交后立即返回, 按提交顺序依次完成
+void I2CBus_Submit(I2CBus_Transfer *transfer);
+HAL_StatusTypeDef I2CBus_Wait(I2CBus_Transfer *transfer);
+
+// 同步接口: 提交并等待完成, 等待期间任务挂起
+HAL_StatusTypeDef I2CBus_Write(uint16_t address, uint8_t *data, uint16_t len);
+HAL_StatusTypeDef I2CBus_Read(uint16_t address, uint8_t *data, uint16_t len);
+HAL_StatusTypeDef I2CBus_MemWrite(uint16_t address, uint8_t memAddress, uint8_t *data, uint16_t len);
+HAL_StatusTypeDef I2CBus_MemRead(uint16_t address, uint8_t memAddress, uint8_t *data, uint16_t len);
+
+uint8_t I2CBus_IsIdle(void);
+
+#endif //SMARTFARM_I2C_BUS_H
@@ -7,9 +7,11 @@
  * 英文字库已包含
  * 中文字库请使用波特律动LED取模工具生成(https://led.baud-dance.com)
  * 图模也使用波特律动LED取模工具生成
+ * 中文字库(zhHxW表)的查找下标在构建时由cmake/font_index.cmake生成到font_index.h, 新增字模后重新构建即可
  */
 
 #include "font.h"
+#include "font_index.h"
 
 // 8*6 ASCII
 const unsigned char ascii_8x6[][6] = {
@@ -432,7 +434,7 @@ const uint8_t zh12x12[][28] = {
     /* 20 气 */ {0xe6,0xb0,0x94,0x00,0x10,0x08,0x24,0x2b,0x2a,0x2a,0x2a,0xea,0x0a,0x02,0x80,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x01,0x02,0x04,0x07,0x00,},
     /* 21 压 */ {0xe5,0x8e,0x8b,0x00,0x00,0x00,0xff,0x21,0x21,0x21,0xfd,0x21,0xa1,0x21,0x01,0x00,0x04,0x03,0x04,0x04,0x04,0x04,0x07,0x04,0x04,0x05,0x04,0x00,}
     };
-    const Font font12x12 = {.w =12, .h = 12, .chars = (const uint8_t *)zh12x12,.len = sizeof(zh12x12)/28, .ascii = &afont12x6};
+    const Font font12x12 = {.w =12, .h = 12, .chars = (const uint8_t *)zh12x12,.len = sizeof(zh12x12)/28, .index = zh12x12_index, .ascii = &afont12x6};
 
 /* ======================================================== */
 /* 以下是手动补全的 font16x16 定义 (修复报错用)            */
@@ -456,5 +458,6 @@ const Font font16x16 = {
     .w = 16,
     .chars = (const uint8_t *)zh16x16,
     .len = 0,  // 长度为0，表示目前没有存汉字
+    .index = zh16x16_index,
     .ascii = &afont16x8 // 关联 ASCII 字库
 };
\ No newline at end of file
@@ -19,7 +19,8 @@ typedef struct Font {
   uint8_t h;              // 字高度
   uint8_t w;              // 字宽度
   const uint8_t *chars;   // 字库 字库前4字节存储utf8编码 剩余字节存储字模数据
-  uint8_t len;            // 字库长度 超过256则请改为uint16_t
+  uint16_t len;           // 字库长度
+  const uint16_t *index;  // 按utf8编码升序排列的字模下标, 构建时由cmake/font_index.cmake生成; NULL时顺序查找
   const ASCIIFont *ascii; // 缺省ASCII字体 当字库中没有对应字符且需要显示ASCII字符时使用
 } Font;
 
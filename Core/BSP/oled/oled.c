@@ -22,7 +22,7 @@
  *
  */
 #include "oled.h"
-#include "i2c.h"
+#include "i2c_bus.h"
 #include <math.h>
 #include <stdlib.h>
 
@@ -34,8 +34,23 @@
 #define OLED_ROW 8 * OLED_PAGE // OLED行数
 #define OLED_COLUMN 128        // OLED列数
 
-// 显存
-uint8_t OLED_GRAM[OLED_PAGE][OLED_COLUMN];
+#define OLED_COLUMN_OFFSET 2     // 屏幕第0列对应控制器显存的第2列
+
+// 显存: 两帧轮流使用, OLED_GRAM指向正在绘制的一帧, 另一帧是最近一次提交给屏幕的内容(可能仍在发送)
+static uint8_t OLED_Buffer[2][OLED_PAGE][OLED_COLUMN];
+uint8_t (*OLED_GRAM)[OLED_COLUMN] = OLED_Buffer[0];
+static uint8_t OLED_Front = 1;      // 最近一次提交给屏幕的显存下标
+static uint8_t OLED_GRAMStale = 0;  // 1: OLED_GRAM还是两帧之前的内容, 写入前要先复制最近一帧
+static uint8_t OLED_SentValid = 0;  // 0: 屏幕内容未知(刚初始化或传输失败), 下一帧整屏发送
+
+// 每页一个传输描述符: 页地址和列地址指令作为header, 数据直接取自显存
+#define OLED_PAGE_HEADER_LEN 7
+static uint8_t OLED_PageHeader[OLED_PAGE][OLED_PAGE_HEADER_LEN];
+static I2CBus_Transfer OLED_PageTransfer[OLED_PAGE];
+static uint8_t OLED_PendingPages = 0; // 上一帧提交的描述符个数
+
+// 刷新统计
+OLED_FrameStats OLED_Stats;
 
 // ========================== 底层通信函数 ==========================
 
@@ -45,20 +60,33 @@ uint8_t OLED_GRAM[OLED_PAGE][OLED_COLUMN];
  * @param len 要发送的数据长度
  * @return None
  * @note 此函数是移植本驱动时的重要函数 将本驱动库移植到其他平台时应根据实际情况修改此函数
+ * @note 经I2C总线队列发送, 传输期间调用任务挂起
  */
 void OLED_Send(uint8_t *data, uint8_t len) {
-  HAL_I2C_Master_Transmit(&hi2c2, OLED_ADDRESS, data, len, HAL_MAX_DELAY);
+  I2CBus_Write(OLED_ADDRESS, data, len);
 }
 
 /**
  * @brief 向OLED发送指令
  */
 void OLED_SendCmd(uint8_t cmd) {
-  static uint8_t sendBuffer[2] = {0};
-  sendBuffer[1] = cmd;
+  uint8_t sendBuffer[2] = {0x00, cmd};
   OLED_Send(sendBuffer, 2);
 }
 
+/**
+ * @brief 在一次I2C传输中向OLED发送一组指令
+ * @param cmds 指令序列
+ * @param len 指令个数
+ * @note 带参数的指令和参数必须在同一次传输中发送, 否则其他任务的传输可能插在中间
+ */
+static void OLED_SendCmds(const uint8_t *cmds, uint8_t len) {
+  uint8_t sendBuffer[32];
+  sendBuffer[0] = 0x00; // 控制字节: 后续均为指令
+  memcpy(sendBuffer + 1, cmds, len);
+  OLED_Send(sendBuffer, len + 1);
+}
+
 // ========================== OLED驱动函数 ==========================
 
 /**
@@ -66,50 +94,28 @@ void OLED_SendCmd(uint8_t cmd) {
  * @note 此函数是移植本驱动时的重要函数 将本驱动库移植到其他驱动芯片时应根据实际情况修改此函数
  */
 void OLED_Init() {
-  OLED_SendCmd(0xAE); /*关闭显示 display off*/
-
-  OLED_SendCmd(0x20);
-  OLED_SendCmd(0x10);
-
-  OLED_SendCmd(0xB0);
-
-  OLED_SendCmd(0xC8);
-
-  OLED_SendCmd(0x00);
-  OLED_SendCmd(0x10);
-
-  OLED_SendCmd(0x40);
-
-  OLED_SendCmd(0x81);
-
-  OLED_SendCmd(0xDF);
-  OLED_SendCmd(0xA1);
-
-  OLED_SendCmd(0xA6);
-  OLED_SendCmd(0xA8);
-
-  OLED_SendCmd(0x3F);
-
-  OLED_SendCmd(0xA4);
-
-  OLED_SendCmd(0xD3);
-  OLED_SendCmd(0x00);
-
-  OLED_SendCmd(0xD5);
-  OLED_SendCmd(0xF0);
-
-  OLED_SendCmd(0xD9);
-  OLED_SendCmd(0x22);
-
-  OLED_SendCmd(0xDA);
-  OLED_SendCmd(0x12);
-
-  OLED_SendCmd(0xDB);
-  OLED_SendCmd(0x20);
-
-  OLED_SendCmd(0x8D);
-  OLED_SendCmd(0x14);
-
+  static const uint8_t initCmds[] = {
+      0xAE,       /*关闭显示 display off*/
+      0x20, 0x10, // 页寻址模式
+      0xB0,       // 页地址
+      0xC8,       // COM扫描方向
+      0x00, 0x10, // 列地址
+      0x40,       // 起始行
+      0x81, 0xDF, // 对比度
+      0xA1,       // 段重映射
+      0xA6,       // 正常显示
+      0xA8, 0x3F, // 复用率
+      0xA4,       // 显示跟随显存
+      0xD3, 0x00, // 显示偏移
+      0xD5, 0xF0, // 时钟分频
+      0xD9, 0x22, // 预充电周期
+      0xDA, 0x12, // COM引脚配置
+      0xDB, 0x20, // VCOMH电压
+      0x8D, 0x14, // 开启电荷泵
+  };
+  OLED_SendCmds(initCmds, sizeof(initCmds));
+
+  OLED_SentValid = 0;
   OLED_NewFrame();
   OLED_ShowFrame();
 
@@ -120,18 +126,22 @@ void OLED_Init() {
  * @brief 开启OLED显示
  */
 void OLED_DisPlay_On() {
-  OLED_SendCmd(0x8D); // 电荷泵使能
-  OLED_SendCmd(0x14); // 开启电荷泵
-  OLED_SendCmd(0xAF); // 点亮屏幕
+  static const uint8_t cmds[] = {
+      0x8D, 0x14, // 电荷泵使能 开启电荷泵
+      0xAF,       // 点亮屏幕
+  };
+  OLED_SendCmds(cmds, sizeof(cmds));
 }
 
 /**
  * @brief 关闭OLED显示
  */
 void OLED_DisPlay_Off() {
-  OLED_SendCmd(0x8D); // 电荷泵使能
-  OLED_SendCmd(0x10); // 关闭电荷泵
-  OLED_SendCmd(0xAE); // 关闭屏幕
+  static const uint8_t cmds[] = {
+      0x8D, 0x10, // 电荷泵使能 关闭电荷泵
+      0xAE,       // 关闭屏幕
+  };
+  OLED_SendCmds(cmds, sizeof(cmds));
 }
 
 /**
@@ -154,23 +164,114 @@ void OLED_SetColorMode(OLED_ColorMode mode) {
  * @brief 清空显存 绘制新的一帧
  */
 void OLED_NewFrame() {
-  memset(OLED_GRAM, 0, sizeof(OLED_GRAM));
+  memset(OLED_GRAM, 0, sizeof(OLED_Buffer[0]));
+  OLED_GRAMStale = 0;
+}
+
+/**
+ * @brief 以静态图层为底图绘制新的一帧
+ * @param layer 图层
+ * @param draw 绘制图层内容的函数, 只在图层第一次使用时调用
+ * @note 第一次调用时清空显存, 调用draw绘制后把图层覆盖的页保存下来;
+ *       之后每帧只需把保存的页复制到显存, 其余页清空, 再在上面绘制变化的内容
+ * @note draw只能绘制在图层覆盖的页内, 覆盖范围以外的内容不会保存
+ */
+void OLED_NewFrameWithLayer(OLED_Layer *layer, void (*draw)(void)) {
+  uint8_t *first = OLED_GRAM[layer->firstPage];
+  const uint16_t size = layer->pageCount * OLED_COLUMN;
+  if (!layer->ready) {
+    OLED_NewFrame();
+    draw();
+    memcpy(layer->pages, first, size);
+    layer->ready = 1;
+    return;
+  }
+  memset(OLED_GRAM, 0, sizeof(OLED_Buffer[0]));
+  memcpy(first, layer->pages, size);
+  OLED_GRAMStale = 0;
+}
+
+/**
+ * @brief 在不清空显存的情况下继续绘制时, 先把最近一帧复制到OLED_GRAM
+ * @note 由各个写显存的函数调用, OLED_ShowFrame()之后的第一次写入才会真正复制
+ */
+static void OLED_PrepareGRAM() {
+  if (OLED_GRAMStale) {
+    memcpy(OLED_GRAM, OLED_Buffer[OLED_Front], sizeof(OLED_Buffer[0]));
+    OLED_GRAMStale = 0;
+  }
 }
 
 /**
  * @brief 将当前显存显示到屏幕上
  * @note 此函数是移植本驱动时的重要函数 将本驱动库移植到其他驱动芯片时应根据实际情况修改此函数
+ * @note 与最近一帧逐页比较: 没有变化的页不发送, 有变化的页只发送变化的第一列到最后一列;
+ *       整帧都没有变化时不访问总线
+ * @note 每页是一次I2C传输: 7字节header(Co=1的控制字节 + 页地址/列地址指令, 最后是数据控制字节)
+ *       之后直接从显存发送数据, 整帧的各页在i2c_bus队列中由中断依次接力发送
+ * @note 提交后立即返回并切换到另一块显存, 调用者可以在本帧发送期间绘制下一帧;
+ *       下一次调用时才等待本帧发送完成
  */
 void OLED_ShowFrame() {
-  static uint8_t sendBuffer[OLED_COLUMN + 1];
-  sendBuffer[0] = 0x40;
+  uint8_t failed = 0;
+  uint8_t submitted = 0;
+
+  // 等待上一帧发完, 之后另一块显存才可以作为比较基准
+  for (uint8_t i = 0; i < OLED_PendingPages; i++) {
+    failed |= I2CBus_Wait(&OLED_PageTransfer[i]) != HAL_OK;
+  }
+  if (failed) {
+    OLED_SentValid = 0; // 传输失败时屏幕内容未知, 整屏重发
+  }
+  OLED_PendingPages = 0;
+  OLED_PrepareGRAM();
+
+  const uint8_t(*front)[OLED_COLUMN] = OLED_Buffer[OLED_Front];
+  OLED_Stats.frames++;
   for (uint8_t i = 0; i < OLED_PAGE; i++) {
-    OLED_SendCmd(0xB0 + i); // 设置页地址
-    OLED_SendCmd(0x02);     // 设置列地址低4位
-    OLED_SendCmd(0x10);     // 设置列地址高4位
-    memcpy(sendBuffer + 1, OLED_GRAM[i], OLED_COLUMN);
-    OLED_Send(sendBuffer, OLED_COLUMN + 1);
+    uint8_t first = 0;
+    uint8_t last = OLED_COLUMN - 1;
+    if (OLED_SentValid) {
+      while (first < OLED_COLUMN && OLED_GRAM[i][first] == front[i][first]) first++;
+      if (first == OLED_COLUMN) continue; // 本页没有变化
+      while (OLED_GRAM[i][last] == front[i][last]) last--;
+    }
+    const uint8_t len = last - first + 1;
+    const uint8_t column = first + OLED_COLUMN_OFFSET;
+
+    uint8_t *header = OLED_PageHeader[submitted];
+    header[0] = 0x80;                 // 控制字节: 单个指令
+    header[1] = 0xB0 + i;             // 设置页地址
+    header[2] = 0x80;
+    header[3] = column & 0x0F;        // 设置列地址低4位
+    header[4] = 0x80;
+    header[5] = 0x10 | (column >> 4); // 设置列地址高4位
+    header[6] = 0x40;                 // 控制字节: 之后均为数据
+
+    I2CBus_Transfer *transfer = &OLED_PageTransfer[submitted];
+    transfer->op = I2C_BUS_WRITE;
+    transfer->address = OLED_ADDRESS;
+    transfer->header = header;
+    transfer->headerLen = OLED_PAGE_HEADER_LEN;
+    transfer->data = &OLED_GRAM[i][first];
+    transfer->len = len;
+    I2CBus_Submit(transfer);
+
+    submitted++;
+    OLED_Stats.pages++;
+    OLED_Stats.bytes += OLED_PAGE_HEADER_LEN + len;
+  }
+
+  if (submitted == 0) {
+    OLED_Stats.skippedFrames++;
+    return;
   }
+  // 刚提交的显存在发送完成前不能再写, 之后的绘制使用另一块
+  OLED_PendingPages = submitted;
+  OLED_SentValid = 1;
+  OLED_Front = !OLED_Front;
+  OLED_GRAM = OLED_Buffer[!OLED_Front];
+  OLED_GRAMStale = 1;
 }
 
 /**
@@ -181,6 +282,7 @@ void OLED_ShowFrame() {
  */
 void OLED_SetPixel(uint8_t x, uint8_t y, OLED_ColorMode color) {
   if (x >= OLED_COLUMN || y >= OLED_ROW) return;
+  OLED_PrepareGRAM();
   if (!color) {
     OLED_GRAM[y / 8][x] |= 1 << (y % 8);
   } else {
@@ -204,6 +306,7 @@ void OLED_SetByte_Fine(uint8_t page, uint8_t column, uint8_t data, uint8_t start
   static uint8_t temp;
   if (page >= OLED_PAGE || column >= OLED_COLUMN) return;
   if (color) data = ~data;
+  OLED_PrepareGRAM();
 
   temp = data | (0xff << (end + 1)) | (0xff >> (8 - start));
   OLED_GRAM[page][column] &= temp;
@@ -226,6 +329,7 @@ void OLED_SetByte_Fine(uint8_t page, uint8_t column, uint8_t data, uint8_t start
 void OLED_SetByte(uint8_t page, uint8_t column, uint8_t data, OLED_ColorMode color) {
   if (page >= OLED_PAGE || column >= OLED_COLUMN) return;
   if (color) data = ~data;
+  OLED_PrepareGRAM();
   OLED_GRAM[page][column] = data;
 }
 
@@ -283,30 +387,107 @@ void OLED_SetBits(uint8_t x, uint8_t y, uint8_t data, OLED_ColorMode color) {
  * @param color 颜色
  * @note 此函数将显存中从(x,y)开始的w*h个像素设置为data中的数据
  * @note data的数据应该采用列行式排列
+ * @note 按数据的每一行(8像素高)整行处理: 每列数据左移y%8位后同时写入相邻的两页, 反色用异或实现;
+ *       y是8的整数倍时整字节直接写入. 结果与逐字节调用OLED_SetBits/OLED_SetBits_Fine完全一致
  */
 void OLED_SetBlock(uint8_t x, uint8_t y, const uint8_t *data, uint8_t w, uint8_t h, OLED_ColorMode color) {
-  uint8_t fullRow = h / 8; // 完整的行数
-  uint8_t partBit = h % 8; // 不完整的字节中的有效位数
-  for (uint8_t i = 0; i < w; i++) {
-    for (uint8_t j = 0; j < fullRow; j++) {
-      OLED_SetBits(x + i, y + j * 8, data[i + j * w], color);
+  const uint8_t invert = color ? 0xFF : 0x00;
+  const uint8_t shift = y % 8;
+  const uint8_t rows = (h + 7) / 8;
+  uint8_t page = y / 8;
+  if (x >= OLED_COLUMN || page >= OLED_PAGE || w == 0 || h == 0) return;
+  const uint8_t columns = (w < OLED_COLUMN - x) ? w : OLED_COLUMN - x; // 超出屏幕右侧的列不绘制
+  OLED_PrepareGRAM();
+
+  for (uint8_t j = 0; j < rows && page < OLED_PAGE; j++, page++) {
+    const uint8_t bits = (j == rows - 1 && h % 8) ? h % 8 : 8; // 本行的有效位数
+    const uint16_t mask = ((1U << bits) - 1) << shift;
+    const uint8_t lowMask = mask & 0xFF;
+    const uint8_t highMask = mask >> 8;
+    const uint8_t *src = data + j * w;
+    uint8_t *low = &OLED_GRAM[page][x];
+
+    if (lowMask == 0xFF) {
+      // 整字节对齐: 直接写入
+      for (uint8_t i = 0; i < columns; i++) {
+        low[i] = src[i] ^ invert;
+      }
+    } else if (highMask == 0 || page + 1 >= OLED_PAGE) {
+      // 只落在一页内(或下一页超出屏幕)
+      for (uint8_t i = 0; i < columns; i++) {
+        const uint8_t value = (uint8_t)(src[i] ^ invert) << shift;
+        low[i] = (low[i] & ~lowMask) | (value & lowMask);
+      }
+    } else {
+      // 跨两页: 一次移位同时得到两页的内容
+      uint8_t *high = &OLED_GRAM[page + 1][x];
+      for (uint8_t i = 0; i < columns; i++) {
+        const uint16_t value = (uint16_t)(uint8_t)(src[i] ^ invert) << shift;
+        low[i] = (low[i] & ~lowMask) | (value & lowMask);
+        high[i] = (high[i] & ~highMask) | ((value >> 8) & highMask);
+      }
     }
   }
-  if (partBit) {
-    uint16_t fullNum = w * fullRow; // 完整的字节数
-    for (uint8_t i = 0; i < w; i++) {
-      OLED_SetBits_Fine(x + i, y + (fullRow * 8), data[fullNum + i], partBit, color);
-    }
+}
+
+// 页内掩码: OLED_MaskFrom[n]为第n位及以上各位, OLED_MaskTo[n]为第n位及以下各位
+static const uint8_t OLED_MaskFrom[8] = {0xFF, 0xFE, 0xFC, 0xF8, 0xF0, 0xE0, 0xC0, 0x80};
+static const uint8_t OLED_MaskTo[8] = {0x01, 0x03, 0x07, 0x0F, 0x1F, 0x3F, 0x7F, 0xFF};
+
+/**
+ * @brief 把一页中x1到x2列的mask位设置为同一颜色
+ * @param page 页地址
+ * @param x1 起始列
+ * @param x2 终止列(包含)
+ * @param mask 要设置的位
+ * @param color 颜色
+ * @note mask为0xFF时整字节写入, 相当于memset; 否则逐列按mask置位或清零
+ */
+static void OLED_FillPageSpan(uint8_t page, uint8_t x1, uint8_t x2, uint8_t mask, OLED_ColorMode color) {
+  uint8_t *column = &OLED_GRAM[page][x1];
+  const uint8_t len = x2 - x1 + 1;
+  if (mask == 0xFF) {
+    memset(column, color ? 0x00 : 0xFF, len);
+  } else if (!color) {
+    for (uint8_t i = 0; i < len; i++) column[i] |= mask;
+  } else {
+    for (uint8_t i = 0; i < len; i++) column[i] &= ~mask;
   }
-  // 使用OLED_SetPixel实现
-  // for (uint8_t i = 0; i < w; i++) {
-  //   for (uint8_t j = 0; j < h; j++) {
-  //     for (uint8_t k = 0; k < 8; k++) {
-  //       if (j * 8 + k >= h) break; // 防止越界(不完整的字节
-  //       OLED_SetPixel(x + i, y + j * 8 + k, !((data[i + j * w] >> k) & 0x01));
-  //     }
-  //   }
-  // }
+}
+
+/**
+ * @brief 填充(x1,y1)到(x2,y2)的矩形区域(包含边界)
+ * @note 按页处理: 首页和末页用预先计算的掩码, 中间各页整字节写入.
+ *       水平线是只有一行的区域, 竖线是只有一列的区域. 超出屏幕的部分不绘制
+ */
+static void OLED_FillArea(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, OLED_ColorMode color) {
+  uint8_t temp;
+  if (x1 > x2) {
+    temp = x1;
+    x1 = x2;
+    x2 = temp;
+  }
+  if (y1 > y2) {
+    temp = y1;
+    y1 = y2;
+    y2 = temp;
+  }
+  if (x1 >= OLED_COLUMN || y1 >= OLED_ROW) return;
+  if (x2 >= OLED_COLUMN) x2 = OLED_COLUMN - 1;
+  if (y2 >= OLED_ROW) y2 = OLED_ROW - 1;
+  OLED_PrepareGRAM();
+
+  const uint8_t firstPage = y1 / 8;
+  const uint8_t lastPage = y2 / 8;
+  if (firstPage == lastPage) {
+    OLED_FillPageSpan(firstPage, x1, x2, OLED_MaskFrom[y1 % 8] & OLED_MaskTo[y2 % 8], color);
+    return;
+  }
+  OLED_FillPageSpan(firstPage, x1, x2, OLED_MaskFrom[y1 % 8], color);
+  for (uint8_t page = firstPage + 1; page < lastPage; page++) {
+    OLED_FillPageSpan(page, x1, x2, 0xFF, color);
+  }
+  OLED_FillPageSpan(lastPage, x1, x2, OLED_MaskTo[y2 % 8], color);
 }
 
 // ========================== 图形绘制函数 ==========================
@@ -317,28 +498,12 @@ void OLED_SetBlock(uint8_t x, uint8_t y, const uint8_t *data, uint8_t w, uint8_t
  * @param x2 终止点横坐标
  * @param y2 终止点纵坐标
  * @param color 颜色
- * @note 此函数使用Bresenham算法绘制线段
+ * @note 竖线和水平线按页填充, 斜线使用Bresenham算法逐点绘制
  */
 void OLED_DrawLine(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, OLED_ColorMode color) {
-  static uint8_t temp = 0;
-  if (x1 == x2) {
-    if (y1 > y2) {
-      temp = y1;
-      y1 = y2;
-      y2 = temp;
-    }
-    for (uint8_t y = y1; y <= y2; y++) {
-      OLED_SetPixel(x1, y, color);
-    }
-  } else if (y1 == y2) {
-    if (x1 > x2) {
-      temp = x1;
-      x1 = x2;
-      x2 = temp;
-    }
-    for (uint8_t x = x1; x <= x2; x++) {
-      OLED_SetPixel(x, y1, color);
-    }
+  if (x1 == x2 || y1 == y2) {
+    // 竖线和水平线按页整块填充
+    OLED_FillArea(x1, y1, x2, y2, color);
   } else {
     // Bresenham直线算法
     int16_t dx = x2 - x1;
@@ -394,9 +559,8 @@ void OLED_DrawRectangle(uint8_t x, uint8_t y, uint8_t w, uint8_t h, OLED_ColorMo
  * @param color 颜色
  */
 void OLED_DrawFilledRectangle(uint8_t x, uint8_t y, uint8_t w, uint8_t h, OLED_ColorMode color) {
-  for (uint8_t i = 0; i < h; i++) {
-    OLED_DrawLine(x, y + i, x + w, y + i, color);
-  }
+  if (h == 0) return;
+  OLED_FillArea(x, y, x + w, y + h - 1, color);
 }
 
 /**
@@ -607,17 +771,46 @@ uint8_t _OLED_GetUTF8Len(char *string) {
 }
 
 /**
- * @brief 绘制字符串
- * @param x 起始点横坐标
- * @param y 起始点纵坐标
- * @param str 字符串
+ * @brief 在字库中查找一个字符的字模
  * @param font 字体
- * @param color 颜色
- *
- * @note 为保证字符串中的中文会被自动识别并绘制, 需:
- * 1. 编译器字符集设置为UTF-8
- * 2. 使用波特律动LED取模工具生成字模(https://led.baud-dance.com)
+ * @param str 字符的UTF-8编码
+ * @param utf8Len UTF-8编码长度(1-4)
+ * @return 字模头指针(前4字节为UTF-8编码, 之后为字模数据), 字库中没有该字符时返回NULL
+ * @note 字库带有构建时生成的排序下标(font->index)时二分查找, 比较的是把4字节编码拼成的32位整数;
+ *       没有下标时退回顺序查找
  */
+const uint8_t *OLED_FindGlyph(const Font *font, const char *str, uint8_t utf8Len) {
+  const uint16_t oneLen = (((font->h + 7) / 8) * font->w) + 4; // 一个字模占多少字节
+  uint32_t key = 0;
+
+  if (font->index == NULL) {
+    for (uint16_t j = 0; j < font->len; j++) {
+      const uint8_t *head = font->chars + j * oneLen;
+      if (memcmp(str, head, utf8Len) == 0) return head;
+    }
+    return NULL;
+  }
+
+  // 字模头部不足4字节的部分补0, 与生成下标时的排序键一致
+  for (uint8_t k = 0; k < 4; k++) {
+    key = (key << 8) | (k < utf8Len ? (uint8_t)str[k] : 0);
+  }
+  uint16_t low = 0;
+  uint16_t high = font->len;
+  while (low < high) {
+    const uint16_t mid = (low + high) / 2;
+    const uint8_t *head = font->chars + font->index[mid] * oneLen;
+    const uint32_t headKey = ((uint32_t)head[0] << 24) | ((uint32_t)head[1] << 16) | ((uint32_t)head[2] << 8) | head[3];
+    if (headKey == key) return head;
+    if (headKey < key) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return NULL;
+}
+
 /**
  * @brief 绘制字符串
  * @param x 起始点横坐标
@@ -631,31 +824,23 @@ uint8_t _OLED_GetUTF8Len(char *string) {
  * 2. 使用波特律动LED取模工具生成字模(https://led.baud-dance.com)
  */
 void OLED_PrintString(uint8_t x, uint8_t y, char *str, const Font *font, OLED_ColorMode color) {
-  uint16_t i = 0;                                       // 字符串索引
-  uint8_t oneLen = (((font->h + 7) / 8) * font->w) + 4; // 一个字模占多少字节
-  uint8_t found;                                        // 是否找到字模
-  uint8_t utf8Len;                                      // UTF-8编码长度
-  uint8_t *head;                                        // 字模头指针
+  uint16_t i = 0;         // 字符串索引
+  uint8_t utf8Len;        // UTF-8编码长度
+  const uint8_t *head;    // 字模头指针
   while (str[i]) {
-    found = 0;
     utf8Len = _OLED_GetUTF8Len(str + i);
     if (utf8Len == 0) break; // 有问题的UTF-8编码
 
-    // 寻找字符  TODO 优化查找算法, 二分查找或者hash
-    for (uint8_t j = 0; j < font->len; j++) {
-      head = (uint8_t *)(font->chars) + (j * oneLen);
-      if (memcmp(str + i, head, utf8Len) == 0) {
-        OLED_SetBlock(x, y, head + 4, font->w, font->h, color);
-        // 移动光标
-        x += font->w;
-        i += utf8Len;
-        found = 1;
-        break;
-      }
+    head = OLED_FindGlyph(font, str + i, utf8Len);
+    if (head != NULL) {
+      OLED_SetBlock(x, y, head + 4, font->w, font->h, color);
+      // 移动光标
+      x += font->w;
+      i += utf8Len;
     }
 
     // 若未找到字模,且为ASCII字符, 则缺省显示ASCII字符
-    if (found == 0) {
+    else {
       if (utf8Len == 1) {
         OLED_PrintASCIIChar(x, y, str[i], font->ascii, color);
         // 移动光标
@@ -10,13 +10,43 @@ typedef enum {
   OLED_COLOR_REVERSED    // 反色模式 白底黑字
 } OLED_ColorMode;
 
+/**
+ * @brief OLED刷新统计
+ */
+typedef struct {
+  uint32_t frames;        // OLED_ShowFrame()调用次数
+  uint32_t skippedFrames; // 与上一帧完全相同, 没有访问总线的帧数
+  uint32_t pages;         // 实际发送的页数
+  uint32_t bytes;         // 实际发送的字节数(含控制字节和页/列地址指令)
+} OLED_FrameStats;
+
+extern OLED_FrameStats OLED_Stats;
+
+/**
+ * @brief 静态图层: 页面中不变的内容(标题栏、标签等)只绘制一次, 按整页保存
+ * @note 用OLED_LAYER定义, 用OLED_NewFrameWithLayer()作为一帧的底图
+ */
+typedef struct {
+  uint8_t firstPage; // 图层覆盖的第一页
+  uint8_t pageCount; // 图层覆盖的页数
+  uint8_t ready;     // 1: 已绘制并保存
+  uint8_t *pages;    // pageCount*128字节, 与显存相同的列行式排列
+} OLED_Layer;
+
+// 定义覆盖第first页起共count页的静态图层
+#define OLED_LAYER(name, first, count)       \
+  static uint8_t name##_Pages[(count) * 128]; \
+  static OLED_Layer name = {(first), (count), 0, name##_Pages}
+
 void OLED_Init();
 void OLED_DisPlay_On();
 void OLED_DisPlay_Off();
 
 void OLED_NewFrame();
+void OLED_NewFrameWithLayer(OLED_Layer *layer, void (*draw)(void));
 void OLED_ShowFrame();
 void OLED_SetPixel(uint8_t x, uint8_t y, OLED_ColorMode color);
+void OLED_SetBlock(uint8_t x, uint8_t y, const uint8_t *data, uint8_t w, uint8_t h, OLED_ColorMode color);
 
 void OLED_DrawLine(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, OLED_ColorMode color);
 void OLED_DrawRectangle(uint8_t x, uint8_t y, uint8_t w, uint8_t h, OLED_ColorMode color);
@@ -31,5 +61,6 @@ void OLED_DrawImage(uint8_t x, uint8_t y, const Image *img, OLED_ColorMode color
 void OLED_PrintASCIIChar(uint8_t x, uint8_t y, char ch, const ASCIIFont *font, OLED_ColorMode color);
 void OLED_PrintASCIIString(uint8_t x, uint8_t y, char *str, const ASCIIFont *font, OLED_ColorMode color);
 void OLED_PrintString(uint8_t x, uint8_t y, char *str, const Font *font, OLED_ColorMode color);
+const uint8_t *OLED_FindGlyph(const Font *font, const char *str, uint8_t utf8Len);
 
 #endif // __OLED_H__
\ No newline at end of file
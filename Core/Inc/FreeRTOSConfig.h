@@ -53,6 +53,7 @@
 /* USER CODE BEGIN 0 */
   extern void configureTimerForRunTimeStats(void);
   extern unsigned long getRunTimeCounterValue(void);
+  extern void StopMode_TaskSwitchedIn(void);
 /* USER CODE END 0 */
 #endif
 #ifndef CMSIS_device_header
@@ -79,6 +80,7 @@
 #define configUSE_COUNTING_SEMAPHORES            1
 #define configUSE_PORT_OPTIMISED_TASK_SELECTION  0
 #define configRECORD_STACK_HIGH_ADDRESS          1
+#define configUSE_TICKLESS_IDLE                  2
 
 /* Co-routine definitions. */
 #define configUSE_CO_ROUTINES                    0
@@ -160,6 +162,8 @@ standard names. */
 
 /* USER CODE BEGIN Defines */
 /* Section where parameter definitions can be added (for instance, to override default ones in FreeRTOS.h) */
+/* STOP 唤醒后第一个非空闲任务切入时记录唤醒延迟, 见 StopModeRtc.h */
+#define traceTASK_SWITCHED_IN() StopMode_TaskSwitchedIn()
 /* USER CODE END Defines */
 
 #endif /* FREERTOS_CONFIG_H */
@@ -43,12 +43,15 @@ extern "C" {
 /* USER CODE BEGIN EC */
 // 消息队列句柄 用于其他任务向BLE任务发送信息
 extern osMessageQueueId_t BLEQueueHandle;
-// I2C1 互斥锁句柄 防止AHT20与OLED同时访问I2C总线
-extern osMutexId_t i2c2MutexHandle;
 // 蜂鸣器定时器句柄
 extern osTimerId_t BeepTimerHandle;
 //按键中断操作句柄
 extern osSemaphoreId_t InputEventSemHandle;
+// 屏幕刷新请求事件组与编辑闪烁定时器句柄
+extern osEventFlagsId_t ScreenEventHandle;
+extern osTimerId_t ScreenBlinkTimerHandle;
+// 睡眠屏障事件组（power.h）
+extern osEventFlagsId_t PowerEventHandle;
 /* USER CODE END EC */
 
 /* Exported macro ------------------------------------------------------------*/
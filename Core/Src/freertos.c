@@ -31,6 +31,7 @@
 #include "font.h"
 #include <math.h>
 #include "usart.h"
+#include "power.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -90,16 +91,26 @@ osTimerId_t BeepTimerHandle;
 const osTimerAttr_t BeepTimer_attributes = {
   .name = "BeepTimer"
 };
-/* Definitions for i2c2Mutex */
-osMutexId_t i2c2MutexHandle;
-const osMutexAttr_t i2c2Mutex_attributes = {
-  .name = "i2c2Mutex"
+/* Definitions for ScreenBlinkTimer */
+osTimerId_t ScreenBlinkTimerHandle;
+const osTimerAttr_t ScreenBlinkTimer_attributes = {
+  .name = "ScreenBlinkTimer"
 };
 /* Definitions for InputEventSem */
 osSemaphoreId_t InputEventSemHandle;
 const osSemaphoreAttr_t InputEventSem_attributes = {
   .name = "InputEventSem"
 };
+/* Definitions for ScreenEvent */
+osEventFlagsId_t ScreenEventHandle;
+const osEventFlagsAttr_t ScreenEvent_attributes = {
+  .name = "ScreenEvent"
+};
+/* Definitions for PowerEvent */
+osEventFlagsId_t PowerEventHandle;
+const osEventFlagsAttr_t PowerEvent_attributes = {
+  .name = "PowerEvent"
+};
 
 /* Private function prototypes -----------------------------------------------*/
 /* USER CODE BEGIN FunctionPrototypes */
@@ -111,6 +122,7 @@ extern void StartInputTask(void *argument);
 extern void StartScreenTask(void *argument);
 extern void StartBLETask(void *argument);
 extern void BeepTimerCallback(void *argument);
+extern void ScreenBlinkCallback(void *argument);
 
 void MX_FREERTOS_Init(void); /* (MISRA C 2004 rule 8.1) */
 
@@ -140,10 +152,6 @@ void MX_FREERTOS_Init(void) {
   /* USER CODE BEGIN Init */
 
   /* USER CODE END Init */
-  /* Create the mutex(es) */
-  /* creation of i2c2Mutex */
-  i2c2MutexHandle = osMutexNew(&i2c2Mutex_attributes);
-
   /* USER CODE BEGIN RTOS_MUTEX */
   /* add mutexes, ... */
   /* USER CODE END RTOS_MUTEX */
@@ -160,6 +168,9 @@ void MX_FREERTOS_Init(void) {
   /* creation of BeepTimer */
   BeepTimerHandle = osTimerNew(BeepTimerCallback, osTimerPeriodic, NULL, &BeepTimer_attributes);
 
+  /* creation of ScreenBlinkTimer */
+  ScreenBlinkTimerHandle = osTimerNew(ScreenBlinkCallback, osTimerPeriodic, NULL, &ScreenBlinkTimer_attributes);
+
   /* USER CODE BEGIN RTOS_TIMERS */
   /* start timers, add new ones, ... */
   /* USER CODE END RTOS_TIMERS */
@@ -189,8 +200,17 @@ void MX_FREERTOS_Init(void) {
   /* add threads, ... */
   /* USER CODE END RTOS_THREADS */
 
+  /* Create the event(s) */
+  /* creation of ScreenEvent */
+  ScreenEventHandle = osEventFlagsNew(&ScreenEvent_attributes);
+
+  /* creation of PowerEvent */
+  PowerEventHandle = osEventFlagsNew(&PowerEvent_attributes);
+
   /* USER CODE BEGIN RTOS_EVENTS */
   /* add events, ... */
+  // 睡眠屏障：全部子系统初始为空闲
+  Power_Init();
   /* USER CODE END RTOS_EVENTS */
 
 }
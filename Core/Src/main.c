@@ -33,6 +33,7 @@
 #include <screen.h>
 #include <stdio.h>  // 【新增】引入 printf 所在的标准库
 #include <stdarg.h> // 处理可变参数需要的库
+#include "StopModeRtc.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -107,6 +108,7 @@ int main(void)
   MX_TIM3_Init();
   MX_RTC_Init();
   /* USER CODE BEGIN 2 */
+  StopMode_Init();
 
   /* USER CODE END 2 */
 
@@ -0,0 +1,185 @@
+/**
+ * @file alarm_bench.c
+ * @brief 报警状态机(alarm.c)的主机回放
+ *
+ * - 不带参数: 使用一天的合成数据, 每个通道都会在阈值附近停留并叠加噪声(温度午后越过上限、湿度清晨越过上限、
+ *   降雨在上限附近波动、土壤湿度在上限附近缓慢漂移、光照夜间过低中午过高)
+ * - 带一个参数: 从文件中读取农场日志("[农场日志] T:... H:... 土壤:... 降雨:... 光照:...",
+ *   即调试串口或主机仿真的输出)作为采样序列, 每行一秒
+ * - 阈值使用 EnvSafeRange_Init() 的默认值
+ * - 对比以前每次采样超出范围就发一条消息的做法和状态机产生的事件: 消息总数、单次采样最多的消息数、
+ *   蜂鸣器响的秒数、蓝牙串口的发送时间, 以及每个报警原因的 raised/cleared/reminder 条数
+ * - 检查事件顺序(未报警时不应解除或提醒, 已报警时不应重复报警), 不正确时返回非 0
+ *
+ * 用法: cmake --build build/Host --target alarm_bench && ./build/Host/cmake/host/alarm_bench [farm.log]
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "alarm.h"
+
+#define BENCH_TRACE_MAX 100000
+// 一条报警的二进制帧字节数(telemetry.h), 9600 波特率下每字节约 1.04ms
+#define BENCH_FRAME_BYTES 15U
+#define BENCH_BYTE_MS     (10.0 / 9.6)
+
+static FarmState *benchTrace;
+static uint32_t benchTraceLen;
+
+static uint32_t benchEvents[TELEMETRY_REASON_COUNT][TELEMETRY_EVENT_COUNT];
+static uint8_t benchActive[TELEMETRY_REASON_COUNT];
+static uint32_t benchCycleEvents;
+static uint32_t benchErrors;
+
+static double Bench_Noise(double amplitude) {
+    return amplitude * ((double) rand() / RAND_MAX * 2.0 - 1.0);
+}
+
+static uint16_t Bench_Clamp(double value) {
+    return value < 0 ? 0 : value > 0xFFFF ? 0xFFFF : (uint16_t) lround(value);
+}
+
+/**
+ * @brief 合成一天的采样序列, 每秒一个点
+ */
+static void Bench_Synthetic(void) {
+    const uint32_t day = 24 * 3600;
+    double soil = 46.0;
+
+    benchTraceLen = day;
+    srand(1);
+    for (uint32_t t = 0; t < day; t++) {
+        const double phase = 2.0 * M_PI * t / day;
+        FarmState *s = &benchTrace[t];
+
+        // 温度 14~31℃, 午后超过 30℃ 约一小时, 传感器噪声 ±0.3℃
+        s->temperature = (float) (22.5 - 8.5 * cos(phase - 0.6) + Bench_Noise(0.3));
+        // 湿度清晨接近 70%, 噪声 ±1.5%
+        s->humidity = (float) (62.0 + 8.5 * cos(phase) + Bench_Noise(1.5));
+        // 降雨每 4 小时一阵, 在上限 30% 上下波动
+        const uint32_t inHour = t % (4 * 3600);
+        s->rainGauge = inHour < 1800 ? Bench_Clamp(30.0 + 4.0 * sin(inHour / 120.0) + Bench_Noise(2.0)) : 0;
+        // 土壤湿度缓慢下降, 浇水后回升, 在上限 50% 附近抖动 ±1%
+        soil += (t % 10800 < 5400) ? 0.0015 : -0.0015;
+        s->soilMoisture = Bench_Clamp(soil + Bench_Noise(1.0));
+        // 光照: 白天正弦变化(云层造成 ±10% 的波动), 夜间为 0
+        const double sun = sin(phase - M_PI / 2);
+        s->lightIntensity = sun > 0 ? Bench_Clamp(1000.0 * sun * (1.0 + Bench_Noise(0.1))) : 0;
+    }
+}
+
+/**
+ * @brief 从农场日志读取采样序列
+ */
+static int Bench_Recorded(const char *path) {
+    FILE *file = fopen(path, "r");
+    char line[512];
+    if (file == NULL) {
+        perror(path);
+        return -1;
+    }
+    benchTraceLen = 0;
+    while (benchTraceLen < BENCH_TRACE_MAX && fgets(line, sizeof(line), file) != NULL) {
+        const char *start = strstr(line, "T:");
+        int tInt, tDec, hInt, hDec, soil, rain, light;
+        if (start == NULL || sscanf(start, "T:%d.%d H:%d.%d 土壤:%d 降雨:%d 光照:%d", &tInt, &tDec, &hInt, &hDec, &soil,
+                                    &rain, &light) != 7) {
+            continue;
+        }
+        FarmState *s = &benchTrace[benchTraceLen++];
+        s->temperature = (float) (tInt + (tInt < 0 ? -tDec : tDec) / 10.0);
+        s->humidity = (float) (hInt + hDec / 10.0);
+        s->soilMoisture = (uint16_t) soil;
+        s->rainGauge = (uint16_t) rain;
+        s->lightIntensity = (uint16_t) light;
+    }
+    fclose(file);
+    if (benchTraceLen == 0) {
+        fprintf(stderr, "%s: no farm log lines found\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief 以前的做法(SensorTask 中的 CheckRangeFloat/CheckRangeInt): 每次采样每个超出范围的参数发一条消息
+ * @return 本次采样的消息数
+ */
+static uint32_t Bench_Legacy(const FarmState *s, const FarmSafeRange *r) {
+    return (s->temperature < r->minTemperature) + (s->temperature > r->maxTemperature) +
+           (s->humidity < r->minHumidity) + (s->humidity > r->maxHumidity) + (s->rainGauge > r->maxRainGauge) +
+           (s->soilMoisture < r->minSoilMoisture) + (s->soilMoisture > r->maxSoilMoisture) +
+           (s->lightIntensity < r->minLightIntensity) + (s->lightIntensity > r->maxLightIntensity);
+}
+
+static void Bench_Notify(Telemetry_Reason reason, Telemetry_Event event, int32_t value) {
+    (void) value;
+    if ((event == TELEMETRY_EVENT_RAISED) == benchActive[reason]) {
+        fprintf(stderr, "%s: unexpected %s\n", Telemetry_ReasonName(reason), Telemetry_EventName(event));
+        benchErrors++;
+    }
+    if (event == TELEMETRY_EVENT_RAISED) {
+        benchActive[reason] = 1;
+    } else if (event == TELEMETRY_EVENT_CLEARED) {
+        benchActive[reason] = 0;
+    }
+    benchEvents[reason][event]++;
+    benchCycleEvents++;
+}
+
+int main(int argc, char **argv) {
+    const FarmSafeRange range = {
+        .minTemperature = 15, .maxTemperature = 30,
+        .minHumidity = 20, .maxHumidity = 70,
+        .maxRainGauge = 30,
+        .minSoilMoisture = 10, .maxSoilMoisture = 50,
+        .minLightIntensity = 50, .maxLightIntensity = 800,
+    };
+    uint32_t legacyTotal = 0, legacyPeak = 0, legacyBeep = 0;
+    uint32_t total = 0, peak = 0, beep = 0;
+
+    benchTrace = calloc(BENCH_TRACE_MAX, sizeof(*benchTrace));
+    if (benchTrace == NULL) {
+        return 1;
+    }
+    if (argc > 1) {
+        if (Bench_Recorded(argv[1]) != 0) {
+            return 1;
+        }
+        printf("trace: %s, %u samples\n", argv[1], benchTraceLen);
+    } else {
+        Bench_Synthetic();
+        printf("trace: synthetic, %u samples\n", benchTraceLen);
+    }
+
+    Alarm_Reset();
+    for (uint32_t t = 0; t < benchTraceLen; t++) {
+        const uint32_t legacy = Bench_Legacy(&benchTrace[t], &range);
+        legacyTotal += legacy;
+        legacyPeak = legacy > legacyPeak ? legacy : legacyPeak;
+        legacyBeep += legacy > 0;
+
+        benchCycleEvents = 0;
+        beep += Alarm_Update(&benchTrace[t], &range, t, Bench_Notify) > 0;
+        total += benchCycleEvents;
+        peak = benchCycleEvents > peak ? benchCycleEvents : peak;
+    }
+
+    const double hours = benchTraceLen / 3600.0;
+    printf("%-14s %9s %9s %11s %10s\n", "", "messages", "per hour", "peak/sample", "beep s");
+    printf("%-14s %9u %9.1f %11u %10u\n", "per-sample", legacyTotal, legacyTotal / hours, legacyPeak, legacyBeep);
+    printf("%-14s %9u %9.1f %11u %10u\n", "state machine", total, total / hours, peak, beep);
+    printf("reduction: %.1fx, UART busy %.1f s -> %.1f s\n", total ? (double) legacyTotal / total : 0.0,
+           legacyTotal * BENCH_FRAME_BYTES * BENCH_BYTE_MS / 1000.0, total * BENCH_FRAME_BYTES * BENCH_BYTE_MS / 1000.0);
+
+    printf("%-22s %7s %8s %9s\n", "reason", "raised", "cleared", "reminder");
+    for (uint8_t r = 0; r < TELEMETRY_REASON_COUNT; r++) {
+        printf("%-22s %7u %8u %9u\n", Telemetry_ReasonName(r), benchEvents[r][TELEMETRY_EVENT_RAISED],
+               benchEvents[r][TELEMETRY_EVENT_CLEARED], benchEvents[r][TELEMETRY_EVENT_REMINDER]);
+    }
+    printf("%u event order errors\n", benchErrors);
+    free(benchTrace);
+    return benchErrors == 0U ? 0 : 1;
+}
@@ -0,0 +1,139 @@
+/**
+ * @file blit_bench.c
+ * @brief OLED_SetBlock 的主机基准: 按列移位的新实现与原来逐字节调用 OLED_SetBits 的实现对比
+ *
+ * 所有 ASCII 字体的全部字符和 font12x12/font16x16 的全部汉字在偏移 0-7 上各绘制一遍, 取每个字符的平均时钟周期
+ * (x86 上用 TSC, 其他平台换算自纳秒)。两种实现逐像素一致的检查在 Host/Test/oled_blit_test.c 中, 由 ctest 运行
+ *
+ * 用法: cmake --build build/Host --target blit_bench && ./build/Host/cmake/host/blit_bench
+ */
+// x86intrin.h 必须在 CMSIS 头文件之前包含, 否则其中的 __I/__O 等参数名会被 CMSIS 的宏替换
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include <stdio.h>
+#include <time.h>
+
+#include "font.h"
+#include "i2c_bus.h"
+#include "oled.h"
+
+#define BENCH_REPEAT     200
+#define BENCH_MAX_GLYPHS 512
+
+extern const ASCIIFont afont8x6;
+extern const ASCIIFont afont16x8;
+// font.c 只有 24x12 的字模数组, 没有对应的 ASCIIFont
+extern const unsigned char ascii_24x12[][36];
+static const ASCIIFont benchFont24x12 = {24, 12, (unsigned char *) ascii_24x12};
+
+void OLED_SetBits(uint8_t x, uint8_t y, uint8_t data, OLED_ColorMode color);
+void OLED_SetBits_Fine(uint8_t x, uint8_t y, uint8_t data, uint8_t len, OLED_ColorMode color);
+
+// 基准只绘制到显存, I2C 传输用桩函数代替
+void I2CBus_Submit(I2CBus_Transfer *transfer) {
+    transfer->status = HAL_OK;
+    transfer->done = 1;
+}
+
+HAL_StatusTypeDef I2CBus_Wait(I2CBus_Transfer *transfer) {
+    return transfer->status;
+}
+
+HAL_StatusTypeDef I2CBus_Write(uint16_t address, uint8_t *data, uint16_t len) {
+    (void) address;
+    (void) data;
+    (void) len;
+    return HAL_OK;
+}
+
+typedef struct {
+    const uint8_t *data;
+    uint8_t w;
+    uint8_t h;
+} Bench_Glyph;
+
+static Bench_Glyph benchGlyphs[BENCH_MAX_GLYPHS];
+static uint32_t benchGlyphCount;
+
+static void Bench_AddAscii(const ASCIIFont *font) {
+    const uint32_t size = (uint32_t) ((font->h + 7) / 8) * font->w;
+    for (uint32_t ch = 0; ch < 95U && benchGlyphCount < BENCH_MAX_GLYPHS; ch++) {
+        benchGlyphs[benchGlyphCount++] = (Bench_Glyph) {font->chars + ch * size, font->w, font->h};
+    }
+}
+
+static void Bench_AddFont(const Font *font) {
+    const uint32_t size = (uint32_t) ((font->h + 7) / 8) * font->w + 4U;
+    for (uint32_t i = 0; i < font->len && benchGlyphCount < BENCH_MAX_GLYPHS; i++) {
+        benchGlyphs[benchGlyphCount++] = (Bench_Glyph) {font->chars + i * size + 4U, font->w, font->h};
+    }
+}
+
+/**
+ * @brief 原来的实现: 每个字节分别调用 OLED_SetBits / OLED_SetBits_Fine
+ */
+static void Bench_SetBlockReference(uint8_t x, uint8_t y, const uint8_t *data, uint8_t w, uint8_t h,
+                                    OLED_ColorMode color) {
+    uint8_t fullRow = h / 8;
+    uint8_t partBit = h % 8;
+    for (uint8_t i = 0; i < w; i++) {
+        for (uint8_t j = 0; j < fullRow; j++) {
+            OLED_SetBits(x + i, y + j * 8, data[i + j * w], color);
+        }
+    }
+    if (partBit) {
+        uint16_t fullNum = w * fullRow;
+        for (uint8_t i = 0; i < w; i++) {
+            OLED_SetBits_Fine(x + i, y + (fullRow * 8), data[fullNum + i], partBit, color);
+        }
+    }
+}
+
+typedef void (*Bench_BlitFn)(uint8_t x, uint8_t y, const uint8_t *data, uint8_t w, uint8_t h, OLED_ColorMode color);
+
+static uint64_t Bench_Cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000U + (uint64_t) ts.tv_nsec;
+#endif
+}
+
+static uint64_t Bench_Speed(Bench_BlitFn blit) {
+    const uint64_t start = Bench_Cycles();
+    for (int repeat = 0; repeat < BENCH_REPEAT; repeat++) {
+        for (uint32_t g = 0; g < benchGlyphCount; g++) {
+            for (uint8_t offset = 0; offset < 8; offset++) {
+                blit((uint8_t) (g % 100), (uint8_t) (16 + offset), benchGlyphs[g].data, benchGlyphs[g].w,
+                     benchGlyphs[g].h, (OLED_ColorMode) (g & 1));
+            }
+        }
+    }
+    return Bench_Cycles() - start;
+}
+
+int main(void) {
+    Bench_AddAscii(&afont8x6);
+    Bench_AddAscii(&afont12x6);
+    Bench_AddAscii(&afont16x8);
+    Bench_AddAscii(&benchFont24x12);
+    Bench_AddFont(&font12x12);
+    Bench_AddFont(&font16x16);
+
+    OLED_NewFrame();
+    const double blits = (double) BENCH_REPEAT * benchGlyphCount * 8;
+    printf("%u glyphs, per glyph (host %s)\n", benchGlyphCount,
+#if defined(__x86_64__) || defined(__i386__)
+           "TSC cycles"
+#else
+           "ns"
+#endif
+    );
+    printf("  byte-by-byte : %.1f\n", (double) Bench_Speed(Bench_SetBlockReference) / blits);
+    printf("  column blit  : %.1f\n", (double) Bench_Speed(OLED_SetBlock) / blits);
+    return 0;
+}
@@ -0,0 +1,357 @@
+/**
+ * @file block_pool_bench.c
+ * @brief 定长块内存池(block_pool.c)与 heap_4 的对比基准和并发压力测试
+ *
+ * - 单线程: 模拟蓝牙报警路径, 消息(BLE_MSG_SIZE 字节)成串产生、按先进先出发送后释放, 最多
+ *   BLE_MSG_POOL_BLOCKS 条同时在队列中; 同时有其他模块在同一个 heap_4 中分配/释放大小不一的内存,
+ *   堆按目标板的 10KB 计算。消息分别用 pvPortMalloc/vPortFree 和 BlockPool_Alloc/BlockPool_Free 分配
+ *   (随机数序列相同), 输出每次分配和释放的平均/99.9%/最大时钟周期, 以及分配失败(丢失的报警)次数。
+ *   同样的操作序列重复几遍, 每个操作取最小值, 去掉主机调度和中断带来的噪声, 最大值反映分配器本身的最坏情况
+ * - 多线程: 若干线程同时分配、写满、校验、释放, 检查同一块不会同时分给两个线程;
+ *   heap_4 在主机上用互斥锁代替挂起调度器, 对比两者的吞吐量
+ *
+ * 用法: cmake --build build/Host --target block_pool_bench && ./build/Host/cmake/host/block_pool_bench [步数]
+ */
+// x86intrin.h 必须在 CMSIS 头文件之前包含, 否则其中的 __I/__O 等参数名会被 CMSIS 的宏替换
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "block_pool.h"
+#include "farmState.h"
+
+#define BENCH_STEPS_DEFAULT 1000000U
+#define BENCH_REPEATS       5U
+// 目标板的堆大小(Core/Inc/FreeRTOSConfig.h), 主机配置的堆更大, 多出的部分开始时一次占掉
+#define BENCH_TARGET_HEAP   10240U
+// 其他模块同时持有的内存块数和大小范围
+#define BENCH_OTHER_BLOCKS  48U
+#define BENCH_OTHER_MIN     8U
+#define BENCH_OTHER_MAX     400U
+#define BENCH_THREADS       4U
+#define BENCH_THREAD_OPS    500000U
+// 每个线程最多同时持有的块数: 线程数 x 这个值 > 块数, 池会被用满
+#define BENCH_THREAD_HOLD   6U
+
+BLOCK_POOL_DEFINE(benchPool, BLE_MSG_SIZE, BLE_MSG_POOL_BLOCKS);
+
+// ========================== heap_4 需要的内核接口 ==========================
+
+static pthread_mutex_t benchSchedulerLock = PTHREAD_MUTEX_INITIALIZER;
+
+void vTaskSuspendAll(void) {
+    pthread_mutex_lock(&benchSchedulerLock);
+}
+
+BaseType_t xTaskResumeAll(void) {
+    pthread_mutex_unlock(&benchSchedulerLock);
+    return pdFALSE;
+}
+
+// 只有 vPortGetHeapStats() 用到, 本基准不调用
+void vPortEnterCritical(void) {
+}
+
+void vPortExitCritical(void) {
+}
+
+void vAssertCalled(const char *file, unsigned long line) {
+    fprintf(stderr, "assert failed: %s:%lu\n", file, line);
+    exit(2);
+}
+
+// ========================== 计时 ==========================
+
+static uint64_t Bench_Cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000U + (uint64_t) ts.tv_nsec;
+#endif
+}
+
+static const char *Bench_Unit(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return "TSC cycles";
+#else
+    return "ns";
+#endif
+}
+
+typedef struct {
+    uint32_t *samples;
+    uint32_t count;
+} Bench_Latency;
+
+/**
+ * @brief 记录第 count 个操作的耗时, 与前几遍同一个操作的耗时取最小值
+ */
+static void Bench_Record(Bench_Latency *latency, uint64_t cycles) {
+    if (cycles < latency->samples[latency->count]) {
+        latency->samples[latency->count] = (uint32_t) cycles;
+    }
+    latency->count++;
+}
+
+static int Bench_Compare(const void *a, const void *b) {
+    const uint32_t x = *(const uint32_t *) a;
+    const uint32_t y = *(const uint32_t *) b;
+    return x < y ? -1 : x > y;
+}
+
+static void Bench_PrintLatency(const char *name, Bench_Latency *latency) {
+    uint64_t sum = 0;
+
+    if (latency->count == 0U) {
+        return;
+    }
+    qsort(latency->samples, latency->count, sizeof(uint32_t), Bench_Compare);
+    for (uint32_t i = 0; i < latency->count; i++) {
+        sum += latency->samples[i];
+    }
+    printf("  %-6s mean %6.1f  p99.9 %6u  max %8u\n", name, (double) sum / latency->count,
+           latency->samples[(uint32_t) (latency->count * 0.999)], latency->samples[latency->count - 1U]);
+}
+
+// ========================== 单线程: 蓝牙报警路径 ==========================
+
+typedef struct {
+    uint32_t sent;       // 分配成功并"发送"的消息
+    uint32_t lost;       // 分配失败丢失的报警
+    uint32_t full;       // 队列满丢失的报警
+    uint32_t otherLost;  // 其他模块分配失败的次数
+} Bench_Result;
+
+/**
+ * @brief 跑一遍模拟负载
+ * @param usePool 1: 消息从块内存池分配; 0: 消息从 heap_4 分配
+ */
+static Bench_Result Bench_BlePath(uint32_t steps, uint8_t usePool, Bench_Latency *alloc, Bench_Latency *release) {
+    void *queue[BLE_MSG_POOL_BLOCKS];
+    uint32_t head = 0;
+    uint32_t length = 0;
+    void *other[BENCH_OTHER_BLOCKS] = {0};
+    Bench_Result result = {0};
+
+    srand(1);
+    for (uint32_t step = 0; step < steps; step++) {
+        const int op = rand() % 8;
+
+        // 平均每步产生 0.25 条报警、发送 0.5 条: 队列平时很短, 连续几次成串报警时才会排满
+        if (op < 3) {
+            // 其他模块: 随机挑一个槽位, 有内存就释放, 没有就分配一块随机大小的
+            const uint32_t slot = (uint32_t) rand() % BENCH_OTHER_BLOCKS;
+            const size_t size = BENCH_OTHER_MIN + (size_t) rand() % (BENCH_OTHER_MAX - BENCH_OTHER_MIN);
+            if (other[slot] != NULL) {
+                vPortFree(other[slot]);
+                other[slot] = NULL;
+            } else if ((other[slot] = pvPortMalloc(size)) == NULL) {
+                result.otherLost++;
+            }
+        } else if (op < 4) {
+            // SensorTask 产生报警: 一次最多 3 条(同一次采样多个量超限)
+            const uint32_t burst = 1U + (uint32_t) rand() % 3U;
+            for (uint32_t i = 0; i < burst; i++) {
+                const uint64_t start = Bench_Cycles();
+                Telemetry_Message *msg = usePool ? BlockPool_Alloc(&benchPool) : pvPortMalloc(BLE_MSG_SIZE);
+                Bench_Record(alloc, Bench_Cycles() - start);
+                if (msg == NULL) {
+                    result.lost++;
+                    continue;
+                }
+                msg->type = TELEMETRY_WARNING;
+                msg->timestamp = step;
+                msg->warning.reason = TELEMETRY_REASON_TEMPERATURE_HIGH;
+                msg->warning.value = (int32_t) step;
+                if (length == BLE_MSG_POOL_BLOCKS) {
+                    // 队列满: 与 SensorTask 一样还回去
+                    usePool ? (void) BlockPool_Free(&benchPool, msg) : vPortFree(msg);
+                    result.full++;
+                    continue;
+                }
+                queue[(head + length++) % BLE_MSG_POOL_BLOCKS] = msg;
+            }
+        } else if (length > 0U) {
+            // BLETask 发送完成一条, 释放
+            void *msg = queue[head];
+            head = (head + 1U) % BLE_MSG_POOL_BLOCKS;
+            length--;
+            const uint64_t start = Bench_Cycles();
+            usePool ? (void) BlockPool_Free(&benchPool, msg) : vPortFree(msg);
+            Bench_Record(release, Bench_Cycles() - start);
+            result.sent++;
+        }
+    }
+
+    while (length > 0U) {
+        usePool ? (void) BlockPool_Free(&benchPool, queue[head]) : vPortFree(queue[head]);
+        head = (head + 1U) % BLE_MSG_POOL_BLOCKS;
+        length--;
+    }
+    for (uint32_t i = 0; i < BENCH_OTHER_BLOCKS; i++) {
+        vPortFree(other[i]);
+    }
+    return result;
+}
+
+static void Bench_Single(uint32_t steps) {
+    Bench_Latency alloc = {malloc(sizeof(uint32_t) * steps * 3U), 0};
+    Bench_Latency release = {malloc(sizeof(uint32_t) * steps), 0};
+    Bench_Result result = {0};
+    static const char *const names[] = {"heap_4", "pool"};
+
+    printf("single thread, %u steps, %u byte messages, %u byte heap shared with %u other blocks (%u-%u bytes)\n",
+           steps, (unsigned) BLE_MSG_SIZE, BENCH_TARGET_HEAP, BENCH_OTHER_BLOCKS, BENCH_OTHER_MIN, BENCH_OTHER_MAX);
+    printf("latency in %s:\n", Bench_Unit());
+    for (uint8_t usePool = 0; usePool < 2U; usePool++) {
+        memset(alloc.samples, 0xFF, sizeof(uint32_t) * steps * 3U);
+        memset(release.samples, 0xFF, sizeof(uint32_t) * steps);
+        for (uint32_t repeat = 0; repeat < BENCH_REPEATS; repeat++) {
+            alloc.count = 0;
+            release.count = 0;
+            result = Bench_BlePath(steps, usePool, &alloc, &release);
+        }
+        printf("%s: %u messages sent, alarms lost: %u allocation failed + %u queue full, "
+               "%u other allocations failed\n", names[usePool], result.sent, result.lost, result.full,
+               result.otherLost);
+        Bench_PrintLatency("alloc", &alloc);
+        Bench_PrintLatency("free", &release);
+    }
+
+    BlockPool_Stats stats;
+    BlockPool_GetStats(&benchPool, &stats);
+    printf("pool: %u blocks of %u bytes, high water %u\n", stats.blockCount, stats.blockSize, stats.highWater);
+    free(alloc.samples);
+    free(release.samples);
+}
+
+// ========================== 多线程: 并发分配 ==========================
+
+typedef struct {
+    uint8_t id;
+    uint8_t usePool;
+    uint32_t corrupted;
+    uint32_t failed;
+} Bench_Thread;
+
+static void *Bench_Worker(void *argument) {
+    Bench_Thread *thread = argument;
+    uint8_t *held[BENCH_THREAD_HOLD] = {0};
+    uint32_t seed = thread->id + 1U;
+
+    for (uint32_t op = 0; op < BENCH_THREAD_OPS; op++) {
+        seed = seed * 1103515245U + 12345U;
+        const uint32_t slot = (seed >> 16) % BENCH_THREAD_HOLD;
+
+        if (held[slot] != NULL) {
+            // 释放前检查整块仍是本线程写入的内容
+            for (uint32_t i = 0; i < BLE_MSG_SIZE; i++) {
+                if (held[slot][i] != (uint8_t) (thread->id + slot)) {
+                    thread->corrupted++;
+                    break;
+                }
+            }
+            thread->usePool ? (void) BlockPool_Free(&benchPool, held[slot]) : vPortFree(held[slot]);
+            held[slot] = NULL;
+        } else {
+            held[slot] = thread->usePool ? BlockPool_Alloc(&benchPool) : pvPortMalloc(BLE_MSG_SIZE);
+            if (held[slot] == NULL) {
+                thread->failed++;
+            } else {
+                memset(held[slot], thread->id + slot, BLE_MSG_SIZE);
+            }
+        }
+    }
+    for (uint32_t slot = 0; slot < BENCH_THREAD_HOLD; slot++) {
+        if (held[slot] != NULL) {
+            thread->usePool ? (void) BlockPool_Free(&benchPool, held[slot]) : vPortFree(held[slot]);
+        }
+    }
+    return NULL;
+}
+
+static uint32_t Bench_Concurrent(void) {
+    static const char *const names[] = {"heap_4 (locked)", "pool (lock-free)"};
+    uint32_t corrupted = 0;
+
+    printf("%u threads x %u operations, each holding up to %u blocks:\n", BENCH_THREADS, BENCH_THREAD_OPS,
+           BENCH_THREAD_HOLD);
+    for (uint8_t usePool = 0; usePool < 2U; usePool++) {
+        pthread_t threads[BENCH_THREADS];
+        Bench_Thread state[BENCH_THREADS] = {0};
+        struct timespec start, end;
+        uint32_t failed = 0;
+        uint32_t bad = 0;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (uint8_t i = 0; i < BENCH_THREADS; i++) {
+            state[i].id = (uint8_t) (i * BENCH_THREAD_HOLD + 1U);
+            state[i].usePool = usePool;
+            pthread_create(&threads[i], NULL, Bench_Worker, &state[i]);
+        }
+        for (uint8_t i = 0; i < BENCH_THREADS; i++) {
+            pthread_join(threads[i], NULL);
+            failed += state[i].failed;
+            bad += state[i].corrupted;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        const double seconds = (double) (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+        printf("  %-17s %6.2f M ops/s, %u allocations failed, %u blocks corrupted\n", names[usePool],
+               BENCH_THREADS * BENCH_THREAD_OPS / seconds / 1e6, failed, bad);
+        corrupted += bad;
+    }
+
+    BlockPool_Stats stats;
+    BlockPool_GetStats(&benchPool, &stats);
+    if (stats.used != 0U) {
+        printf("pool: %u blocks still in use after all threads returned theirs\n", stats.used);
+        corrupted++;
+    }
+    return corrupted;
+}
+
+/**
+ * @brief 非法释放不能破坏池
+ */
+static uint32_t Bench_Misuse(void) {
+    uint32_t errors = 0;
+    uint8_t *block = BlockPool_Alloc(&benchPool);
+    static uint8_t foreign[BLE_MSG_SIZE];
+
+    errors += BlockPool_Free(&benchPool, block + 1) != 0U;
+    errors += BlockPool_Free(&benchPool, foreign) != 0U;
+    errors += BlockPool_Free(&benchPool, block) != 1U;
+    errors += BlockPool_Free(&benchPool, block) != 0U;
+    errors += benchPool.used != 0U;
+    errors += benchPool.freeMask != (1UL << BLE_MSG_POOL_BLOCKS) - 1U;
+    if (errors != 0U) {
+        printf("misuse: %u checks failed\n", errors);
+    }
+    return errors;
+}
+
+int main(int argc, char **argv) {
+    const uint32_t steps = argc > 1 ? (uint32_t) strtoul(argv[1], NULL, 10) : BENCH_STEPS_DEFAULT;
+
+    // 主机配置的堆是目标板的数倍, 先占掉多出的部分
+    if (pvPortMalloc(configTOTAL_HEAP_SIZE - BENCH_TARGET_HEAP) == NULL) {
+        fprintf(stderr, "cannot reserve the host heap\n");
+        return 1;
+    }
+
+    Bench_Single(steps);
+    const uint32_t errors = Bench_Concurrent() + Bench_Misuse();
+    printf("%s\n", errors == 0U ? "no block handed out twice" : "FAILED");
+    return errors == 0U ? 0 : 1;
+}
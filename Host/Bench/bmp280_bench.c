@@ -0,0 +1,174 @@
+/**
+ * @file bmp280_bench.c
+ * @brief BMP280 补偿算法的主机基准: double 与 32/64 位整数两条路径的耗时和精度对比
+ *
+ * - 校准参数取自数据手册 3.12 节的示例
+ * - 温度原始值扫描整个 20 位范围, 误差统计只计入补偿结果在器件量程内(-40~85℃, 300~1100hPa)的点
+ * - 气压原始值在每个温度点上同样扫描整个 20 位范围
+ * - 耗时为主机上每次调用的平均时钟周期(x86 上用 TSC, 其他平台换算自纳秒)。
+ *   主机有硬件 FPU, 这里 double 路径的开销远低于 Cortex-M3 上的软浮点, 结果只能作为下限参考
+ *
+ * 用法: cmake --build build/Host --target bmp280_bench && ./build/Host/cmake/host/bmp280_bench
+ */
+// x86intrin.h 必须在 CMSIS 头文件之前包含, 否则其中的 __I/__O 等参数名会被 CMSIS 的宏替换
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "BMP280.h"
+#include "i2c_bus.h"
+
+#define BENCH_RAW_MAX    (1L << 20)
+#define BENCH_T_STEP     4099L  // 温度原始值步长(质数, 避免与寄存器位对齐)
+#define BENCH_P_STEP     1031L  // 气压原始值步长
+#define BENCH_REPEAT     20
+
+extern BMP280_Calibration BMP280_Cal;
+
+// 基准只用到补偿函数, I2C 传输用桩函数代替
+HAL_StatusTypeDef I2CBus_MemRead(uint16_t address, uint8_t memAddress, uint8_t *data, uint16_t len) {
+    (void) address;
+    (void) memAddress;
+    (void) data;
+    (void) len;
+    return HAL_ERROR;
+}
+
+HAL_StatusTypeDef I2CBus_MemWrite(uint16_t address, uint8_t memAddress, uint8_t *data, uint16_t len) {
+    (void) address;
+    (void) memAddress;
+    (void) data;
+    (void) len;
+    return HAL_ERROR;
+}
+
+static uint64_t Bench_Cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000U + (uint64_t) ts.tv_nsec;
+#endif
+}
+
+static void Bench_LoadCalibration(void) {
+    BMP280_Cal.T1 = 27504;
+    BMP280_Cal.T2 = 26435;
+    BMP280_Cal.T3 = -1000;
+    BMP280_Cal.P1 = 36477;
+    BMP280_Cal.P2 = -10685;
+    BMP280_Cal.P3 = 3024;
+    BMP280_Cal.P4 = 2855;
+    BMP280_Cal.P5 = 140;
+    BMP280_Cal.P6 = -7;
+    BMP280_Cal.P7 = 15500;
+    BMP280_Cal.P8 = -14600;
+    BMP280_Cal.P9 = 6000;
+    BMP280_Cal.t_fine = 0;
+}
+
+// 防止编译器把被测调用优化掉
+static volatile double benchSinkDouble;
+static volatile int64_t benchSinkInt;
+
+/**
+ * @brief 精度: 全范围扫描, 统计量程内的最大/平均绝对误差
+ */
+static void Bench_Accuracy(void) {
+    double maxTempErr = 0.0;
+    double maxPressErr = 0.0;
+    double sumPressErr = 0.0;
+    uint32_t tempPoints = 0;
+    uint32_t pressPoints = 0;
+    uint32_t skipped = 0;
+
+    for (long adcT = 0; adcT < BENCH_RAW_MAX; adcT += BENCH_T_STEP) {
+        const double tempDouble = BMP280_compensate_T((int) adcT);
+        const int32_t tFineDouble = BMP280_Cal.t_fine;
+        const int32_t tempFixed = BMP280_compensate_T_int32((int32_t) adcT);
+        const int32_t tFineFixed = BMP280_Cal.t_fine;
+
+        if (tempDouble < -40.0 || tempDouble > 85.0) {
+            skipped++;
+            continue;
+        }
+        maxTempErr = fmax(maxTempErr, fabs(tempDouble - tempFixed / 100.0));
+        tempPoints++;
+
+        for (long adcP = 0; adcP < BENCH_RAW_MAX; adcP += BENCH_P_STEP) {
+            double pressDouble;
+            uint32_t pressFixed;
+
+            BMP280_Cal.t_fine = tFineDouble;
+            pressDouble = BMP280_compensate_P((int) adcP);
+            BMP280_Cal.t_fine = tFineFixed;
+            pressFixed = BMP280_compensate_P_int64((int32_t) adcP);
+
+            if (pressDouble < 30000.0 || pressDouble > 110000.0) {
+                skipped++;
+                continue;
+            }
+            const double err = fabs(pressDouble - pressFixed / 256.0);
+            maxPressErr = fmax(maxPressErr, err);
+            sumPressErr += err;
+            pressPoints++;
+        }
+    }
+
+    printf("accuracy (fixed vs double, in-range points only)\n");
+    printf("  temperature: %u points, max |err| %.4f degC (output resolution 0.01)\n",
+           tempPoints, maxTempErr);
+    printf("  pressure   : %u points, max |err| %.4f Pa, mean |err| %.4f Pa\n",
+           pressPoints, maxPressErr, pressPoints != 0U ? sumPressErr / pressPoints : 0.0);
+    printf("  skipped    : %u out-of-range raw values\n", skipped);
+}
+
+/**
+ * @brief 耗时: 对同一组原始值重复调用, 取每次调用的平均周期数
+ */
+static void Bench_Speed(void) {
+    uint64_t doubleCycles = 0;
+    uint64_t fixedCycles = 0;
+    uint64_t calls = 0;
+
+    for (int repeat = 0; repeat < BENCH_REPEAT; repeat++) {
+        uint64_t start = Bench_Cycles();
+        for (long adc = 0; adc < BENCH_RAW_MAX; adc += BENCH_P_STEP) {
+            benchSinkDouble = BMP280_compensate_T((int) (BENCH_RAW_MAX - 1 - adc));
+            benchSinkDouble = BMP280_compensate_P((int) adc);
+        }
+        doubleCycles += Bench_Cycles() - start;
+
+        start = Bench_Cycles();
+        for (long adc = 0; adc < BENCH_RAW_MAX; adc += BENCH_P_STEP) {
+            benchSinkInt = BMP280_compensate_T_int32((int32_t) (BENCH_RAW_MAX - 1 - adc));
+            benchSinkInt = BMP280_compensate_P_int64((int32_t) adc);
+        }
+        fixedCycles += Bench_Cycles() - start;
+
+        calls += (uint64_t) ((BENCH_RAW_MAX + BENCH_P_STEP - 1) / BENCH_P_STEP);
+    }
+
+    printf("speed (T + P compensation per sample, host %s)\n",
+#if defined(__x86_64__) || defined(__i386__)
+           "TSC cycles"
+#else
+           "ns"
+#endif
+    );
+    printf("  double : %.1f\n", (double) doubleCycles / (double) calls);
+    printf("  fixed  : %.1f\n", (double) fixedCycles / (double) calls);
+}
+
+int main(void) {
+    Bench_LoadCalibration();
+    Bench_Accuracy();
+    Bench_Speed();
+    return 0;
+}
@@ -0,0 +1,150 @@
+/**
+ * @file flash_log_bench.c
+ * @brief Flash 日志(flash_log.c)的基准
+ *
+ * LOG 区映射到与目标板相同的地址, HAL_FLASH_Program/HAL_FLASHEx_Erase 用内存上的替身代替, 统计写满整个 LOG 区后的
+ * 回放耗时、每条记录的写入半字数和擦除次数, 以及按每分钟一条分钟点估算的擦写寿命。
+ * 掉电恢复的检查在 Host/Test/flash_log_test.c 中, 由 ctest 运行
+ *
+ * 用法: cmake --build build/Host --target flash_log_bench && ./build/Host/cmake/host/flash_log_bench
+ */
+// x86intrin.h 必须在 CMSIS 头文件之前包含, 否则其中的 __I/__O 等参数名会被 CMSIS 的宏替换
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+
+#include "flash_log.h"
+
+#define BENCH_RECORDS        20000U
+// 每页 1 万次擦写(数据手册的最小值)
+#define BENCH_ENDURANCE      10000U
+
+static uint8_t *benchFlash;
+static uint8_t benchUnlocked;
+static uint32_t benchHalfWords;
+static uint32_t benchErases;
+
+// ========================== HAL 替身 ==========================
+
+HAL_StatusTypeDef HAL_FLASH_Unlock(void) {
+    benchUnlocked = 1;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Lock(void) {
+    benchUnlocked = 0;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint64_t Data) {
+    uint16_t *dest = (uint16_t *) (benchFlash + (Address - FLASH_LOG_ADDR));
+    const uint16_t value = (uint16_t) Data;
+
+    if (!benchUnlocked || TypeProgram != FLASH_TYPEPROGRAM_HALFWORD || Address < FLASH_LOG_ADDR ||
+        Address + 2U > FLASH_LOG_ADDR + FLASH_LOG_SIZE || (*dest != 0xFFFFU && value != 0U)) {
+        fprintf(stderr, "invalid program at 0x%08lx\n", (unsigned long) Address);
+        exit(2);
+    }
+    *dest = value;
+    benchHalfWords++;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef *pEraseInit, uint32_t *PageError) {
+    uint8_t *page = benchFlash + (pEraseInit->PageAddress - FLASH_LOG_ADDR);
+
+    *PageError = 0xFFFFFFFFU;
+    if (!benchUnlocked || pEraseInit->NbPages != 1U || pEraseInit->PageAddress < FLASH_LOG_ADDR ||
+        pEraseInit->PageAddress >= FLASH_LOG_ADDR + FLASH_LOG_SIZE ||
+        pEraseInit->PageAddress % FLASH_PAGE_SIZE != 0U) {
+        fprintf(stderr, "invalid erase at 0x%08lx\n", (unsigned long) pEraseInit->PageAddress);
+        exit(2);
+    }
+    memset(page, 0xFF, FLASH_PAGE_SIZE);
+    benchErases++;
+    return HAL_OK;
+}
+
+static uint32_t benchReplayedCount;
+
+static void Bench_Collect(FlashLog_Type type, const void *data, uint16_t len, void *context) {
+    (void) type;
+    (void) data;
+    (void) len;
+    (void) context;
+    benchReplayedCount++;
+}
+
+// ========================== 基准 ==========================
+
+static uint64_t Bench_Cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000U + (uint64_t) ts.tv_nsec;
+#endif
+}
+
+/**
+ * @brief 按分钟点的大小(6 个序列 x 最小/最大/平均, 36 字节)写满 LOG 区, 测回放耗时和擦写量
+ */
+static void Bench_Throughput(void) {
+    uint8_t minute[36] = {0};
+    const uint32_t records = BENCH_RECORDS;
+    FlashLog_Stats stats;
+
+    memset(benchFlash, 0xFF, FLASH_LOG_SIZE);
+    benchHalfWords = 0;
+    benchErases = 0;
+    FlashLog_Init();
+    for (uint32_t i = 0; i < records; i++) {
+        memcpy(minute, &i, sizeof(i));
+        FlashLog_Append(FLASH_LOG_HISTORY_MINUTE, minute, sizeof(minute));
+    }
+    const double halfWords = (double) benchHalfWords / records;
+    const double erases = (double) benchErases / records;
+
+    benchReplayedCount = 0;
+    const uint64_t start = Bench_Cycles();
+    FlashLog_Init();
+    const uint32_t replayed = FlashLog_Replay(Bench_Collect, NULL);
+    const uint64_t replay = Bench_Cycles() - start;
+    FlashLog_GetStats(&stats);
+
+    printf("minute records (%u bytes): %.1f half-words and %.4f page erases per record\n",
+           (unsigned) sizeof(minute), halfWords, erases);
+    printf("full log: %u segments, %u records kept (%.1f hours of minute points)\n", stats.segments, replayed,
+           replayed / 60.0);
+    printf("boot scan + replay: %.0f %s total, %.1f per record\n", (double) replay,
+#if defined(__x86_64__) || defined(__i386__)
+           "TSC cycles",
+#else
+           "ns",
+#endif
+           (double) replay / replayed);
+    printf("wear at one record per minute: each page erased every %.1f hours, %u cycles last %.0f years\n",
+           FLASH_LOG_PAGES / erases / 60.0, BENCH_ENDURANCE,
+           BENCH_ENDURANCE * (FLASH_LOG_PAGES / erases) / (60.0 * 24.0 * 365.0));
+}
+
+int main(void) {
+    // 与目标板相同的地址, flash_log.c 直接按 FLASH_LOG_ADDR 读取
+    benchFlash = mmap((void *) FLASH_LOG_ADDR, FLASH_LOG_SIZE, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if (benchFlash != (uint8_t *) FLASH_LOG_ADDR) {
+        fprintf(stderr, "cannot map the LOG region at 0x%08lx: %s\n", FLASH_LOG_ADDR, strerror(errno));
+        return 1;
+    }
+
+    Bench_Throughput();
+    return 0;
+}
@@ -0,0 +1,187 @@
+/**
+ * @file font_bench.c
+ * @brief OLED_PrintString 字模查找的主机基准: 原来的顺序 memcmp 查找与构建时生成下标的二分查找对比
+ *
+ * - 字符串取自 ScreenTask.c 中所有 OLED_PrintString 调用(格式化的数值取典型值)
+ * - "lookup" 只统计查找字模的耗时, "render" 统计整串绘制到显存的耗时(包括 OLED_SetBlock)
+ * - 两种查找绘制出的显存逐字节比较, 不一致时返回非 0
+ * - 耗时为主机上每个字符串的平均时钟周期(x86 上用 TSC, 其他平台换算自纳秒)。
+ *   当前字库只有 22 个汉字, 字库越大二分查找的优势越明显
+ *
+ * 用法: cmake --build build/Host --target font_bench && ./build/Host/cmake/host/font_bench
+ */
+// x86intrin.h 必须在 CMSIS 头文件之前包含, 否则其中的 __I/__O 等参数名会被 CMSIS 的宏替换
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "font.h"
+#include "i2c_bus.h"
+#include "oled.h"
+
+#define BENCH_REPEAT 20000
+#define BENCH_GRAM_SIZE (8 * 128)
+
+extern uint8_t (*OLED_GRAM)[128];
+
+// 基准只绘制到显存, I2C 传输用桩函数代替
+void I2CBus_Submit(I2CBus_Transfer *transfer) {
+    transfer->status = HAL_OK;
+    transfer->done = 1;
+}
+
+HAL_StatusTypeDef I2CBus_Wait(I2CBus_Transfer *transfer) {
+    return transfer->status;
+}
+
+HAL_StatusTypeDef I2CBus_Write(uint16_t address, uint8_t *data, uint16_t len) {
+    (void) address;
+    (void) data;
+    (void) len;
+    return HAL_OK;
+}
+
+static char *const benchStrings[] = {
+    "温度", "湿度", "光照", "土壤", "降雨", "水泵", "开", "关",
+    "23.5℃", "71.5%", "37 lx", "53%", "2%",
+    "BMP内部温度", "24.31℃", "气压", "1013.25hPa",
+    " 报警阈值(1/2) ", " 报警阈值(2/2) ",
+    "10.0 < 温度 < 30.0", "40.0 < 湿度 < 80.0", "100 < 光照 < 5000",
+    "20 < 土壤 < 60", "降雨 < 50",
+    "Soil History", "Rainfall", "Light History",
+};
+
+#define BENCH_STRING_COUNT (sizeof(benchStrings) / sizeof(benchStrings[0]))
+
+static uint64_t Bench_Cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000U + (uint64_t) ts.tv_nsec;
+#endif
+}
+
+static uint8_t Bench_Utf8Len(const char *str) {
+    if ((str[0] & 0x80) == 0x00) {
+        return 1;
+    } else if ((str[0] & 0xE0) == 0xC0) {
+        return 2;
+    } else if ((str[0] & 0xF0) == 0xE0) {
+        return 3;
+    } else if ((str[0] & 0xF8) == 0xF0) {
+        return 4;
+    }
+    return 0;
+}
+
+/**
+ * @brief 原来的查找方式: 逐个字模 memcmp
+ */
+static const uint8_t *Bench_FindLinear(const Font *font, const char *str, uint8_t utf8Len) {
+    const uint16_t oneLen = (uint16_t) ((((font->h + 7) / 8) * font->w) + 4);
+    for (uint16_t j = 0; j < font->len; j++) {
+        const uint8_t *head = font->chars + j * oneLen;
+        if (memcmp(str, head, utf8Len) == 0) {
+            return head;
+        }
+    }
+    return NULL;
+}
+
+typedef const uint8_t *(*Bench_FindFn)(const Font *font, const char *str, uint8_t utf8Len);
+
+/**
+ * @brief 与 OLED_PrintString 相同的绘制流程, 查找函数可替换
+ */
+static void Bench_Print(uint8_t x, uint8_t y, const char *str, const Font *font, Bench_FindFn find) {
+    uint16_t i = 0;
+    while (str[i]) {
+        const uint8_t utf8Len = Bench_Utf8Len(str + i);
+        if (utf8Len == 0) {
+            break;
+        }
+        const uint8_t *head = find(font, str + i, utf8Len);
+        if (head != NULL) {
+            OLED_SetBlock(x, y, head + 4, font->w, font->h, OLED_COLOR_NORMAL);
+            x += font->w;
+        } else {
+            OLED_PrintASCIIChar(x, y, utf8Len == 1 ? str[i] : ' ', font->ascii, OLED_COLOR_NORMAL);
+            x += font->ascii->w;
+        }
+        i += utf8Len;
+    }
+}
+
+// 防止编译器把被测调用优化掉
+static const uint8_t *volatile benchSink;
+
+static uint64_t Bench_Lookup(Bench_FindFn find) {
+    const uint64_t start = Bench_Cycles();
+    for (int repeat = 0; repeat < BENCH_REPEAT; repeat++) {
+        for (uint32_t s = 0; s < BENCH_STRING_COUNT; s++) {
+            const char *str = benchStrings[s];
+            for (uint16_t i = 0; str[i] != '\0'; i += Bench_Utf8Len(str + i)) {
+                benchSink = find(&font12x12, str + i, Bench_Utf8Len(str + i));
+            }
+        }
+    }
+    return Bench_Cycles() - start;
+}
+
+static uint64_t Bench_Render(Bench_FindFn find) {
+    const uint64_t start = Bench_Cycles();
+    for (int repeat = 0; repeat < BENCH_REPEAT; repeat++) {
+        for (uint32_t s = 0; s < BENCH_STRING_COUNT; s++) {
+            Bench_Print(0, (uint8_t) ((s % 4) * 16), benchStrings[s], &font12x12, find);
+        }
+    }
+    return Bench_Cycles() - start;
+}
+
+/**
+ * @brief 两种查找绘制出的显存必须一致
+ */
+static int Bench_Verify(void) {
+    static uint8_t linear[BENCH_GRAM_SIZE];
+    int mismatches = 0;
+
+    for (uint32_t s = 0; s < BENCH_STRING_COUNT; s++) {
+        OLED_NewFrame();
+        Bench_Print(0, 0, benchStrings[s], &font12x12, Bench_FindLinear);
+        memcpy(linear, OLED_GRAM, sizeof(linear));
+
+        OLED_NewFrame();
+        OLED_PrintString(0, 0, benchStrings[s], &font12x12, OLED_COLOR_NORMAL);
+        if (memcmp(linear, OLED_GRAM, sizeof(linear)) != 0) {
+            printf("  mismatch: \"%s\"\n", benchStrings[s]);
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+int main(void) {
+    const double strings = (double) BENCH_REPEAT * BENCH_STRING_COUNT;
+    const int mismatches = Bench_Verify();
+
+    printf("font12x12: %u glyphs, %u strings from ScreenTask.c, %s\n", font12x12.len,
+           (unsigned) BENCH_STRING_COUNT, mismatches == 0 ? "output identical" : "OUTPUT DIFFERS");
+    printf("per string (host %s)\n",
+#if defined(__x86_64__) || defined(__i386__)
+           "TSC cycles"
+#else
+           "ns"
+#endif
+    );
+    printf("  lookup : linear %.1f, indexed %.1f\n", (double) Bench_Lookup(Bench_FindLinear) / strings,
+           (double) Bench_Lookup(OLED_FindGlyph) / strings);
+    printf("  render : linear %.1f, indexed %.1f\n", (double) Bench_Render(Bench_FindLinear) / strings,
+           (double) Bench_Render(OLED_FindGlyph) / strings);
+    return mismatches == 0 ? 0 : 1;
+}
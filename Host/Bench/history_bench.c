@@ -0,0 +1,382 @@
+/**
+ * @file history_bench.c
+ * @brief 压缩历史数据(history.c)的主机基准
+ *
+ * - 不带参数: 使用合成数据(缓慢变化的温湿度和气压、阶跃变化的土壤湿度、偶发降雨、带噪声的昼夜光照)
+ * - 带一个参数: 从文件中读取农场日志("[农场日志] T:... H:... 土壤:... 降雨:... 光照:... 气压:...",
+ *   即调试串口或主机仿真的输出)作为采样序列, 不够长时循环使用
+ * - 连续写入四天的采样(每秒一次), 对每个序列每种分辨率输出保存的点数、平均每点字节数(原始int16为2/6字节),
+ *   以及每次History_Add()和每解码一个点的平均时钟周期(x86 上用 TSC, 其他平台换算自纳秒)
+ * - 秒级和分钟级的点与直接计算的结果逐个比较, 不一致时返回非 0
+ * - 最坏情况: 全量程噪声与平稳段交替写入, 每种分辨率保存的点数任何时候都不能少于 HISTORY_MIN_POINTS
+ * - 并发: 一个线程不停写入(丢弃最老的块、改写成原始编码), 另一个线程不加锁读取秒级序列,
+ *   没有被 History_Stale() 报告的读取结果必须是写入序列中连续的一段
+ *
+ * 用法: cmake --build build/Host --target history_bench && ./build/Host/cmake/host/history_bench [farm.log]
+ */
+// x86intrin.h 必须在 CMSIS 头文件之前包含, 否则其中的 __I/__O 等参数名会被 CMSIS 的宏替换
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "history.h"
+
+#define BENCH_SAMPLES     (4 * 24 * 3600)
+#define BENCH_TRACE_MAX   100000
+#define BENCH_DECODE_REPS 200
+#define BENCH_WORST_SECONDS 20000
+#define BENCH_WORST_MINUTES 40000
+#define BENCH_STRESS_READS  20000
+
+static int16_t (*benchTrace)[HISTORY_SERIES_COUNT];
+static uint32_t benchTraceLen;
+
+static const char *const benchSeriesName[HISTORY_SERIES_COUNT] = {
+    "temperature", "humidity", "pressure", "soil", "rain", "light",
+};
+static const char *const benchTierName[HISTORY_TIER_COUNT] = {"second", "minute", "hour"};
+
+static uint64_t Bench_Cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000U + (uint64_t) ts.tv_nsec;
+#endif
+}
+
+static double Bench_Noise(double amplitude) {
+    return amplitude * ((double) rand() / RAND_MAX * 2.0 - 1.0);
+}
+
+/**
+ * @brief 合成一天长度的采样序列(循环使用)
+ */
+static void Bench_Synthetic(void) {
+    const uint32_t day = 24 * 3600;
+    int16_t soil = 45;
+    int16_t rain = 0;
+    double pressure = 10132.0;
+
+    benchTraceLen = day;
+    srand(1);
+    for (uint32_t t = 0; t < day; t++) {
+        const double phase = 2.0 * M_PI * t / day;
+        int16_t *v = benchTrace[t];
+
+        // 温度 18~28℃、湿度 50~80% 随昼夜缓慢变化, 叠加量化噪声
+        v[HISTORY_TEMPERATURE] = (int16_t) lround(230.0 - 50.0 * cos(phase) + Bench_Noise(1.0));
+        v[HISTORY_HUMIDITY] = (int16_t) lround(650.0 + 150.0 * cos(phase) + Bench_Noise(3.0));
+        // 气压随机游走
+        pressure += Bench_Noise(0.3);
+        v[HISTORY_PRESSURE] = (int16_t) lround(pressure);
+        // 土壤湿度每隔一段时间变化 1%, 浇水时跳变
+        if (t % 600 == 0) soil--;
+        if (soil < 20) soil = 60;
+        v[HISTORY_SOIL_MOISTURE] = soil;
+        // 降雨偶尔出现, 持续一段时间后消失
+        if (t % 7200 == 3600) rain = 35;
+        if (t % 7200 == 4800) rain = 0;
+        v[HISTORY_RAIN_GAUGE] = rain ? (int16_t) (rain + rand() % 3) : 0;
+        // 光照: 白天正弦变化, 噪声约 ±2%, 夜间为 0
+        const double sun = sin(phase - M_PI / 2);
+        v[HISTORY_LIGHT_INTENSITY] = sun > 0 ? (int16_t) lround(3000.0 * sun * (1.0 + Bench_Noise(0.02))) : 0;
+    }
+}
+
+/**
+ * @brief 从农场日志读取采样序列
+ */
+static int Bench_Recorded(const char *path) {
+    FILE *file = fopen(path, "r");
+    char line[512];
+    if (file == NULL) {
+        perror(path);
+        return -1;
+    }
+    benchTraceLen = 0;
+    while (benchTraceLen < BENCH_TRACE_MAX && fgets(line, sizeof(line), file) != NULL) {
+        const char *start = strstr(line, "T:");
+        int tInt, tDec, hInt, hDec, soil, rain, light, pInt, pDec;
+        if (start == NULL ||
+            sscanf(start, "T:%d.%d H:%d.%d 土壤:%d 降雨:%d 光照:%d 气压:%d.%d", &tInt, &tDec, &hInt, &hDec, &soil,
+                   &rain, &light, &pInt, &pDec) != 9) {
+            continue;
+        }
+        int16_t *v = benchTrace[benchTraceLen++];
+        v[HISTORY_TEMPERATURE] = (int16_t) (tInt * 10 + (tInt < 0 ? -tDec : tDec));
+        v[HISTORY_HUMIDITY] = (int16_t) (hInt * 10 + hDec);
+        v[HISTORY_PRESSURE] = (int16_t) (pInt / 10); // Pa -> 0.1hPa
+        v[HISTORY_SOIL_MOISTURE] = (int16_t) soil;
+        v[HISTORY_RAIN_GAUGE] = (int16_t) rain;
+        v[HISTORY_LIGHT_INTENSITY] = (int16_t) (light > INT16_MAX ? INT16_MAX : light);
+    }
+    fclose(file);
+    if (benchTraceLen == 0) {
+        fprintf(stderr, "%s: no farm log lines found\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+static const int16_t *Bench_Sample(uint32_t t) {
+    return benchTrace[t % benchTraceLen];
+}
+
+/**
+ * @brief 直接计算第index个分钟点(从第0个采样开始)
+ */
+static HistoryPoint Bench_MinutePoint(HistorySeries series, uint32_t index) {
+    HistoryPoint point = {INT16_MAX, INT16_MIN, 0};
+    int32_t sum = 0;
+    for (uint32_t t = index * HISTORY_SAMPLES_PER_MINUTE; t < (index + 1) * HISTORY_SAMPLES_PER_MINUTE; t++) {
+        const int16_t value = Bench_Sample(t)[series];
+        if (value < point.min) point.min = value;
+        if (value > point.max) point.max = value;
+        sum += value;
+    }
+    point.mean = (int16_t) (sum / HISTORY_SAMPLES_PER_MINUTE);
+    return point;
+}
+
+/**
+ * @brief 检查保存的秒级和分钟级点
+ * @return 不一致的点数
+ */
+static uint32_t Bench_Verify(uint32_t samples) {
+    uint32_t mismatches = 0;
+    for (uint8_t s = 0; s < HISTORY_SERIES_COUNT; s++) {
+        HistoryReader reader;
+        HistoryPoint point;
+        uint32_t count = History_Count(s, HISTORY_TIER_SECOND);
+        uint32_t t = samples - count;
+        History_Read(&reader, s, HISTORY_TIER_SECOND, 0);
+        while (History_Next(&reader, &point)) {
+            const int16_t expected = Bench_Sample(t++)[s];
+            if (point.mean != expected || point.min != expected || point.max != expected) mismatches++;
+        }
+        mismatches += t != samples;
+
+        const uint32_t minutes = samples / HISTORY_SAMPLES_PER_MINUTE;
+        count = History_Count(s, HISTORY_TIER_MINUTE);
+        uint32_t m = minutes - count;
+        History_Read(&reader, s, HISTORY_TIER_MINUTE, 0);
+        while (History_Next(&reader, &point)) {
+            const HistoryPoint expected = Bench_MinutePoint(s, m++);
+            if (memcmp(&point, &expected, sizeof(point)) != 0) mismatches++;
+        }
+        mismatches += m != minutes;
+    }
+    return mismatches;
+}
+
+// 防止编译器把被测调用优化掉
+static volatile int16_t benchSink;
+
+static double Bench_DecodeCycles(HistorySeries series, HistoryTier tier) {
+    const uint16_t count = History_Count(series, tier);
+    HistoryReader reader;
+    HistoryPoint point;
+    if (count == 0) {
+        return 0.0;
+    }
+    const uint64_t start = Bench_Cycles();
+    for (int rep = 0; rep < BENCH_DECODE_REPS; rep++) {
+        History_Read(&reader, series, tier, 0);
+        while (History_Next(&reader, &point)) {
+            benchSink = point.mean;
+        }
+    }
+    return (double) (Bench_Cycles() - start) / ((double) BENCH_DECODE_REPS * count);
+}
+
+/**
+ * @brief 最坏情况的测试数据: 每 37 个点在全量程噪声和平稳段之间切换
+ */
+static int16_t Bench_WorstValue(uint32_t i) {
+    return ((i / 37U) & 1U) ? (int16_t) (rand() & 0xFFFF) : (int16_t) (i / 37U);
+}
+
+/**
+ * @brief 写入最坏情况的数据, 记录各分辨率填满之后保存的最少点数
+ * @return 少于 HISTORY_MIN_POINTS 的分辨率数
+ */
+static uint32_t Bench_WorstCase(void) {
+    uint16_t fewest[HISTORY_TIER_COUNT] = {UINT16_MAX, UINT16_MAX, UINT16_MAX};
+    int16_t values[HISTORY_SERIES_COUNT];
+    HistoryPoint points[HISTORY_SERIES_COUNT];
+    uint32_t failures = 0;
+
+    srand(2);
+    for (uint32_t t = 0; t < BENCH_WORST_SECONDS; t++) {
+        for (uint8_t s = 0; s < HISTORY_SERIES_COUNT; s++) {
+            values[s] = Bench_WorstValue(t);
+        }
+        History_Add(values);
+        // 前一半用来把之前的数据挤出去
+        if (t >= BENCH_WORST_SECONDS / 2) {
+            for (uint8_t s = 0; s < HISTORY_SERIES_COUNT; s++) {
+                const uint16_t count = History_Count(s, HISTORY_TIER_SECOND);
+                if (count < fewest[HISTORY_TIER_SECOND]) fewest[HISTORY_TIER_SECOND] = count;
+            }
+        }
+    }
+    for (uint32_t m = 0; m < BENCH_WORST_MINUTES; m++) {
+        for (uint8_t s = 0; s < HISTORY_SERIES_COUNT; s++) {
+            int16_t a = Bench_WorstValue(m), b = Bench_WorstValue(m), c = Bench_WorstValue(m);
+            int16_t tmp;
+            if (a > b) { tmp = a; a = b; b = tmp; }
+            if (b > c) { tmp = b; b = c; c = tmp; }
+            if (a > b) { tmp = a; a = b; b = tmp; }
+            points[s] = (HistoryPoint) {a, c, b};
+        }
+        History_AddMinute(points);
+        for (uint8_t s = 0; s < HISTORY_SERIES_COUNT; s++) {
+            uint16_t count = History_Count(s, HISTORY_TIER_MINUTE);
+            if (m >= BENCH_WORST_MINUTES / 8 && count < fewest[HISTORY_TIER_MINUTE]) fewest[HISTORY_TIER_MINUTE] = count;
+            count = History_Count(s, HISTORY_TIER_HOUR);
+            if (m >= BENCH_WORST_MINUTES / 2 && count < fewest[HISTORY_TIER_HOUR]) fewest[HISTORY_TIER_HOUR] = count;
+        }
+    }
+
+    printf("worst case (noise / flat segments): fewest points");
+    for (uint8_t tier = 0; tier < HISTORY_TIER_COUNT; tier++) {
+        printf(" %s %u", benchTierName[tier], fewest[tier]);
+        failures += fewest[tier] < HISTORY_MIN_POINTS;
+    }
+    printf(" (need %u)\n", HISTORY_MIN_POINTS);
+    return failures;
+}
+
+// 并发测试: 写入线程已经写完的采样数
+static uint32_t benchStressWritten;
+static uint8_t benchStressDone;
+
+static int16_t Bench_StressValue(uint32_t t) {
+    // 噪声段和缓慢变化段交替, 两种编码、改写成原始编码和丢弃最老的块都会发生
+    return ((t >> 6) & 1U) ? (int16_t) (t * 2654435761U >> 16) : (int16_t) (t >> 3);
+}
+
+static void *Bench_StressWriter(void *arg) {
+    int16_t values[HISTORY_SERIES_COUNT];
+    (void) arg;
+    for (uint32_t t = 0; !__atomic_load_n(&benchStressDone, __ATOMIC_ACQUIRE); t++) {
+        for (uint8_t s = 0; s < HISTORY_SERIES_COUNT; s++) {
+            values[s] = Bench_StressValue(t);
+        }
+        History_Add(values);
+        __atomic_store_n(&benchStressWritten, t + 1U, __ATOMIC_RELEASE);
+    }
+    return NULL;
+}
+
+/**
+ * @brief 读出的 n 个点是否等于以第 last 个采样结尾的一段
+ */
+static int Bench_StressMatches(const int16_t *points, uint32_t n, uint32_t last) {
+    if (last + 1U < n) {
+        return 0;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        if (points[i] != Bench_StressValue(last + 1U - n + i)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief 一个线程写入、本线程不加锁读取秒级序列
+ * @return 读出不连续数据的次数
+ */
+static uint32_t Bench_Stress(void) {
+    static int16_t points[HISTORY_SECOND_BLOCKS * UINT8_MAX];
+    uint32_t stale = 0, broken = 0;
+    pthread_t writer;
+
+    pthread_create(&writer, NULL, Bench_StressWriter, NULL);
+    // 等秒级序列里之前的数据全部被挤出去
+    while (__atomic_load_n(&benchStressWritten, __ATOMIC_ACQUIRE) < HISTORY_SECOND_BLOCKS * UINT8_MAX) {
+    }
+    for (uint32_t r = 0; r < BENCH_STRESS_READS; r++) {
+        HistoryReader reader;
+        HistoryPoint point;
+        uint32_t n = 0;
+        const uint32_t before = __atomic_load_n(&benchStressWritten, __ATOMIC_ACQUIRE);
+        History_Read(&reader, HISTORY_TEMPERATURE, HISTORY_TIER_SECOND, 0);
+        while (History_Next(&reader, &point)) {
+            points[n++] = point.mean;
+        }
+        const uint32_t after = __atomic_load_n(&benchStressWritten, __ATOMIC_ACQUIRE);
+        if (History_Stale(&reader)) {
+            stale++;
+            continue;
+        }
+        // 最后一个点是读取期间写入的某个采样(写入线程可能已经追加完、还没有更新计数)
+        uint32_t last = before ? before - 1U : 0U;
+        while (last <= after && !Bench_StressMatches(points, n, last)) {
+            last++;
+        }
+        broken += n != 0 && last > after;
+    }
+    __atomic_store_n(&benchStressDone, 1, __ATOMIC_RELEASE);
+    pthread_join(writer, NULL);
+
+    printf("concurrent reader: %u reads while writing %u samples, %u stale (retry), %u inconsistent\n",
+           BENCH_STRESS_READS, benchStressWritten, stale, broken);
+    return broken;
+}
+
+int main(int argc, char **argv) {
+    benchTrace = malloc(sizeof(*benchTrace) * BENCH_TRACE_MAX);
+    if (benchTrace == NULL) {
+        return 1;
+    }
+    if (argc > 1) {
+        if (Bench_Recorded(argv[1]) != 0) {
+            return 1;
+        }
+        printf("trace: %s, %u samples (looped)\n", argv[1], benchTraceLen);
+    } else {
+        Bench_Synthetic();
+        printf("trace: synthetic, %u samples\n", benchTraceLen);
+    }
+
+    const uint64_t start = Bench_Cycles();
+    for (uint32_t t = 0; t < BENCH_SAMPLES; t++) {
+        History_Add(Bench_Sample(t));
+    }
+    const double encode = (double) (Bench_Cycles() - start) / BENCH_SAMPLES;
+    const uint32_t mismatches = Bench_Verify(BENCH_SAMPLES);
+
+    printf("%u samples, History_Add %.1f %s per call (%u series), %u mismatches\n", BENCH_SAMPLES, encode,
+#if defined(__x86_64__) || defined(__i386__)
+           "TSC cycles",
+#else
+           "ns",
+#endif
+           HISTORY_SERIES_COUNT, mismatches);
+    printf("%-12s %-7s %7s %7s %11s %9s %7s\n", "series", "tier", "points", "bytes", "bytes/point", "raw", "decode");
+    for (uint8_t s = 0; s < HISTORY_SERIES_COUNT; s++) {
+        for (uint8_t tier = 0; tier < HISTORY_TIER_COUNT; tier++) {
+            const uint16_t count = History_Count(s, tier);
+            const uint16_t size = History_Size(s, tier);
+            printf("%-12s %-7s %7u %7u %11.2f %9u %7.1f\n", benchSeriesName[s], benchTierName[tier], count, size,
+                   count ? (double) size / count : 0.0, tier == HISTORY_TIER_SECOND ? 2U : 6U,
+                   Bench_DecodeCycles(s, tier));
+        }
+    }
+    free(benchTrace);
+
+    const uint32_t worst = Bench_WorstCase();
+    const uint32_t broken = Bench_Stress();
+    return mismatches == 0U && worst == 0U && broken == 0U ? 0 : 1;
+}
@@ -0,0 +1,38 @@
+/**
+ * @file FreeRTOSConfig.h
+ * @brief 主机仿真用的 FreeRTOS 配置包装
+ *
+ * 任务、优先级、节拍频率等全部沿用 Core/Inc/FreeRTOSConfig.h, 只覆盖与移植层相关的几项:
+ * - 堆: 主机上 StackType_t 和指针都是 8 字节, TCB/队列开销翻倍, 按目标板的 6 倍给
+ * - SysTick: 由 POSIX 移植层的 SIGALRM 代替, 不使用 cmsis_os2.c 里的 SysTick_Handler
+ * - 断言: 打印文件行号后退出, 不再关中断死等
+ * - 空闲钩子: 空闲时把主机 CPU 让出去, 直到下一个节拍
+ * - 任务切入钩子: 固件自己用 DWT 测量 STOP 唤醒延迟, 仿真再按虚拟时钟统计一遍, 两者可以互相核对
+ */
+#ifndef HOST_FREERTOS_CONFIG_H
+#define HOST_FREERTOS_CONFIG_H
+
+#include_next <FreeRTOSConfig.h>
+
+#undef configTOTAL_HEAP_SIZE
+#define configTOTAL_HEAP_SIZE                    ((size_t)(10240 * 6))
+
+#undef configUSE_IDLE_HOOK
+#define configUSE_IDLE_HOOK                      1
+
+#undef USE_CUSTOM_SYSTICK_HANDLER_IMPLEMENTATION
+#define USE_CUSTOM_SYSTICK_HANDLER_IMPLEMENTATION 1
+
+#define configUSE_STATS_FORMATTING_FUNCTIONS     1
+
+#define INCLUDE_xTaskGetIdleTaskHandle           1
+
+void Sim_TaskSwitchedIn(void);
+#undef traceTASK_SWITCHED_IN
+#define traceTASK_SWITCHED_IN()                  do { StopMode_TaskSwitchedIn(); Sim_TaskSwitchedIn(); } while (0)
+
+#undef configASSERT
+void vAssertCalled(const char *file, unsigned long line);
+#define configASSERT( x ) if ((x) == 0) { vAssertCalled(__FILE__, __LINE__); }
+
+#endif /* HOST_FREERTOS_CONFIG_H */
@@ -0,0 +1,15 @@
+/**
+ * @file cmsis_compiler.h
+ * @brief 主机仿真用的 cmsis_compiler.h 包装
+ *
+ * cmsis_os2.c 直接引入 cmsis_compiler.h, 后者会用引号在自身目录下找到 ARM 版 cmsis_gcc.h。
+ * 这里先引入 Host/Inc/cmsis_gcc.h 占住头文件保护, 再引入真正的 cmsis_compiler.h。
+ */
+#ifndef HOST_CMSIS_COMPILER_H
+#define HOST_CMSIS_COMPILER_H
+
+#include "cmsis_gcc.h"
+
+#include_next <cmsis_compiler.h>
+
+#endif /* HOST_CMSIS_COMPILER_H */
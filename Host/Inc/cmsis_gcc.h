@@ -0,0 +1,139 @@
+/**
+ * @file cmsis_gcc.h
+ * @brief 主机仿真用的 CMSIS 编译器/内核函数替身
+ *
+ * 主机构建时本目录位于 Drivers/CMSIS/Include 之前, 因此 cmsis_compiler.h 会包含本文件
+ * 而不是真正的 cmsis_gcc.h。原文件里的 mrs/cpsid 等 Cortex-M 汇编在 x86 上无法汇编,
+ * 这里用等价的 C 实现替代:
+ * - __get_IPSR() 根据仿真"中断"嵌套计数返回, 让 CMSIS-RTOS2 在仿真 ISR 中走 FromISR 接口
+ * - 开关中断、屏障、WFI 等在主机上没有意义, 实现为空操作
+ */
+#ifndef __CMSIS_GCC_H
+#define __CMSIS_GCC_H
+
+#include <stdint.h>
+
+/* CMSIS compiler specific defines */
+#ifndef   __ASM
+  #define __ASM                                  __asm
+#endif
+#ifndef   __INLINE
+  #define __INLINE                               inline
+#endif
+#ifndef   __STATIC_INLINE
+  #define __STATIC_INLINE                        static inline
+#endif
+#ifndef   __STATIC_FORCEINLINE
+  #define __STATIC_FORCEINLINE                   __attribute__((always_inline)) static inline
+#endif
+#ifndef   __NO_RETURN
+  #define __NO_RETURN                            __attribute__((__noreturn__))
+#endif
+#ifndef   __USED
+  #define __USED                                 __attribute__((used))
+#endif
+#ifndef   __WEAK
+  #define __WEAK                                 __attribute__((weak))
+#endif
+#ifndef   __PACKED
+  #define __PACKED                               __attribute__((packed, aligned(1)))
+#endif
+#ifndef   __PACKED_STRUCT
+  #define __PACKED_STRUCT                        struct __attribute__((packed, aligned(1)))
+#endif
+#ifndef   __PACKED_UNION
+  #define __PACKED_UNION                         union __attribute__((packed, aligned(1)))
+#endif
+#ifndef   __ALIGNED
+  #define __ALIGNED(x)                           __attribute__((aligned(x)))
+#endif
+#ifndef   __RESTRICT
+  #define __RESTRICT                             __restrict
+#endif
+#ifndef   __COMPILER_BARRIER
+  #define __COMPILER_BARRIER()                   __asm volatile("":::"memory")
+#endif
+
+// 仿真中断嵌套深度, 由 Sim_IrqEnter()/Sim_IrqExit() 维护
+extern volatile uint32_t Sim_IrqNesting;
+
+/* ###########################  Core Function Access  ########################### */
+
+__STATIC_FORCEINLINE void __enable_irq(void) {}
+__STATIC_FORCEINLINE void __disable_irq(void) {}
+__STATIC_FORCEINLINE void __enable_fault_irq(void) {}
+__STATIC_FORCEINLINE void __disable_fault_irq(void) {}
+
+__STATIC_FORCEINLINE uint32_t __get_IPSR(void) { return (Sim_IrqNesting != 0U) ? 0x10U : 0U; }
+__STATIC_FORCEINLINE uint32_t __get_APSR(void) { return 0U; }
+__STATIC_FORCEINLINE uint32_t __get_xPSR(void) { return __get_IPSR(); }
+__STATIC_FORCEINLINE uint32_t __get_CONTROL(void) { return 0U; }
+__STATIC_FORCEINLINE void __set_CONTROL(uint32_t control) { (void)control; }
+__STATIC_FORCEINLINE uint32_t __get_PSP(void) { return 0U; }
+__STATIC_FORCEINLINE void __set_PSP(uint32_t topOfProcStack) { (void)topOfProcStack; }
+__STATIC_FORCEINLINE uint32_t __get_MSP(void) { return 0U; }
+__STATIC_FORCEINLINE void __set_MSP(uint32_t topOfMainStack) { (void)topOfMainStack; }
+__STATIC_FORCEINLINE uint32_t __get_PRIMASK(void) { return 0U; }
+__STATIC_FORCEINLINE void __set_PRIMASK(uint32_t priMask) { (void)priMask; }
+__STATIC_FORCEINLINE uint32_t __get_BASEPRI(void) { return 0U; }
+__STATIC_FORCEINLINE void __set_BASEPRI(uint32_t basePri) { (void)basePri; }
+__STATIC_FORCEINLINE void __set_BASEPRI_MAX(uint32_t basePri) { (void)basePri; }
+__STATIC_FORCEINLINE uint32_t __get_FAULTMASK(void) { return 0U; }
+__STATIC_FORCEINLINE void __set_FAULTMASK(uint32_t faultMask) { (void)faultMask; }
+__STATIC_FORCEINLINE uint32_t __get_FPSCR(void) { return 0U; }
+__STATIC_FORCEINLINE void __set_FPSCR(uint32_t fpscr) { (void)fpscr; }
+
+/* ##########################  Core Instruction Access  ######################### */
+
+#define __NOP()         __COMPILER_BARRIER()
+#define __WFI()         __COMPILER_BARRIER()
+#define __WFE()         __COMPILER_BARRIER()
+#define __SEV()         __COMPILER_BARRIER()
+#define __BKPT(value)   __builtin_trap()
+
+__STATIC_FORCEINLINE void __ISB(void) { __sync_synchronize(); }
+__STATIC_FORCEINLINE void __DSB(void) { __sync_synchronize(); }
+__STATIC_FORCEINLINE void __DMB(void) { __sync_synchronize(); }
+
+__STATIC_FORCEINLINE uint32_t __REV(uint32_t value) { return __builtin_bswap32(value); }
+__STATIC_FORCEINLINE uint32_t __REV16(uint32_t value)
+{
+  return ((value & 0xFF00FF00U) >> 8) | ((value & 0x00FF00FFU) << 8);
+}
+__STATIC_FORCEINLINE int16_t __REVSH(int16_t value) { return (int16_t)__builtin_bswap16((uint16_t)value); }
+__STATIC_FORCEINLINE uint32_t __ROR(uint32_t op1, uint32_t op2)
+{
+  op2 %= 32U;
+  return (op2 == 0U) ? op1 : ((op1 >> op2) | (op1 << (32U - op2)));
+}
+__STATIC_FORCEINLINE uint32_t __RBIT(uint32_t value)
+{
+  uint32_t result = 0U;
+  for (uint32_t i = 0U; i < 32U; i++) {
+    result = (result << 1) | ((value >> i) & 1U);
+  }
+  return result;
+}
+__STATIC_FORCEINLINE uint8_t __CLZ(uint32_t value) { return (value == 0U) ? 32U : (uint8_t)__builtin_clz(value); }
+
+__STATIC_FORCEINLINE int32_t __SSAT(int32_t val, uint32_t sat)
+{
+  if ((sat >= 1U) && (sat <= 32U)) {
+    const int32_t max = (int32_t)((1U << (sat - 1U)) - 1U);
+    const int32_t min = -1 - max;
+    if (val > max) return max;
+    if (val < min) return min;
+  }
+  return val;
+}
+__STATIC_FORCEINLINE uint32_t __USAT(int32_t val, uint32_t sat)
+{
+  if (sat <= 31U) {
+    const uint32_t max = ((1U << sat) - 1U);
+    if (val > (int32_t)max) return max;
+    if (val < 0) return 0U;
+  }
+  return (uint32_t)val;
+}
+
+#endif /* __CMSIS_GCC_H */
@@ -0,0 +1,24 @@
+/**
+ * @file cmsis_nvic_virtual.h
+ * @brief 主机仿真的 NVIC 接口
+ *
+ * 主机上没有 NVIC, 优先级/使能只做记录以外的事情都没有意义。
+ * 仿真外设的"中断"由 SimIrq 任务在 Sim_IrqEnter()/Sim_IrqExit() 之间直接调用回调完成。
+ */
+#ifndef HOST_CMSIS_NVIC_VIRTUAL_H
+#define HOST_CMSIS_NVIC_VIRTUAL_H
+
+#define NVIC_SetPriorityGrouping(PriorityGroup)   ((void)(PriorityGroup))
+#define NVIC_GetPriorityGrouping()                (0U)
+#define NVIC_EnableIRQ(IRQn)                      ((void)(IRQn))
+#define NVIC_GetEnableIRQ(IRQn)                   ((void)(IRQn), 1U)
+#define NVIC_DisableIRQ(IRQn)                     ((void)(IRQn))
+#define NVIC_GetPendingIRQ(IRQn)                  ((void)(IRQn), 0U)
+#define NVIC_SetPendingIRQ(IRQn)                  ((void)(IRQn))
+#define NVIC_ClearPendingIRQ(IRQn)                ((void)(IRQn))
+#define NVIC_GetActive(IRQn)                      ((void)(IRQn), 0U)
+#define NVIC_SetPriority(IRQn, priority)          ((void)(IRQn), (void)(priority))
+#define NVIC_GetPriority(IRQn)                    ((void)(IRQn), 0U)
+#define NVIC_SystemReset()                        __builtin_trap()
+
+#endif /* HOST_CMSIS_NVIC_VIRTUAL_H */
@@ -0,0 +1,37 @@
+/**
+ * @file core_cm3.h
+ * @brief 主机仿真用的 core_cm3.h 包装
+ *
+ * stm32f103xe.h 以 "core_cm3.h" 引入内核头文件, 主机构建时会先命中本文件:
+ * 1. 先引入 Host/Inc/cmsis_gcc.h, 占住 __CMSIS_GCC_H 头文件保护, 真正的 cmsis_gcc.h(ARM 汇编)随后被跳过
+ * 2. 打开 CMSIS_NVIC_VIRTUAL, 让 NVIC_xxx 走 cmsis_nvic_virtual.h 中的空实现, 避免访问 0xE000E000 的系统控制空间
+ * 3. 再用 #include_next 引入真正的 core_cm3.h, 寄存器结构体定义保持与目标板一致;
+ *    其中 __NVIC_SetVector() 等把 32 位 VTOR 转成指针, 在 64 位主机上会告警, 这里屏蔽掉(仿真中不会调用)
+ * 4. SysTick 指向移植层中的寄存器块 SimSysTick: 无节拍空闲代码照常读写 CTRL/VAL, 移植层在 ENABLE 清除期间丢弃节拍
+ * 5. DWT 每次访问都经过 Sim_Dwt(): CYCCNT 按虚拟时钟和当前 SYSCLK 推进, STOP 期间停止; CoreDebug 指向普通内存
+ */
+#ifndef HOST_CORE_CM3_H
+#define HOST_CORE_CM3_H
+
+#include "cmsis_gcc.h"
+
+#define CMSIS_NVIC_VIRTUAL
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wint-to-pointer-cast"
+#include_next <core_cm3.h>
+#pragma GCC diagnostic pop
+
+#undef SysTick
+extern SysTick_Type SimSysTick;
+#define SysTick (&SimSysTick)
+
+#undef CoreDebug
+extern CoreDebug_Type SimCoreDebug;
+#define CoreDebug (&SimCoreDebug)
+
+#undef DWT
+DWT_Type *Sim_Dwt(void);
+#define DWT (Sim_Dwt())
+
+#endif /* HOST_CORE_CM3_H */
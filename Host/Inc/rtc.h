@@ -0,0 +1,24 @@
+/**
+ * @file rtc.h
+ * @brief 主机仿真用的 RTC 句柄声明
+ *
+ * 与 CubeMX 生成的 rtc.h 接口一致(hrtc、MX_RTC_Init), 实现由 Host/Src/sim_hal.c 提供。
+ */
+#ifndef __RTC_H__
+#define __RTC_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+
+extern RTC_HandleTypeDef hrtc;
+
+void MX_RTC_Init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RTC_H__ */
@@ -0,0 +1,165 @@
+/**
+ * @file sim.h
+ * @brief 主机仿真环境的公共接口
+ *
+ * 仿真分三层:
+ * 1. Host/Port: FreeRTOS POSIX 移植层, 提供任务调度和仿真中断上下文
+ * 2. sim_hal.c/sim_i2c.c/sim_uart.c/sim_flash.c: 工程用到的 HAL 函数的替身, 按总线波特率模拟传输耗时
+ * 3. sim_aht20.c/sim_bmp280.c/sim_oled.c/sim_bh1750.c/sim_env.c: 挂在总线上的器件模型和环境数据
+ *
+ * 传输耗时用主机单调时钟忙等实现, 阻塞式 HAL 调用在主机上占用的 CPU 时间与目标板上的量级一致,
+ * 可以直接用 FreeRTOS 运行时间统计和下面的计数器比较各任务的开销。
+ */
+#ifndef SIM_H
+#define SIM_H
+
+#include <signal.h>
+#include <stdint.h>
+#include "main.h"
+
+// 仿真外设中断使用的信号(SIGALRM 是系统节拍, SIGUSR1 用于唤醒 main 线程)
+#define SIM_IRQ_SIGNAL SIGUSR2
+
+// ========================== 时间与中断 ==========================
+
+/**
+ * @brief 仿真启动以来的微秒数(虚拟时钟: 主机单调时钟加上 STOP 模式中快进的时间)
+ */
+uint64_t Sim_NowUs(void);
+
+/**
+ * @brief 忙等指定微秒数, 模拟阻塞式外设传输占用 CPU 的时间
+ */
+void Sim_BusyWaitUs(uint32_t us);
+
+void Sim_IrqEnter(void);
+void Sim_IrqExit(void);
+
+/**
+ * @brief 预约一次仿真外设中断, 多次预约时按最早的时刻触发
+ * @param dueUs 触发时刻(Sim_NowUs() 时间轴)
+ * @note 调用方需处于临界区或仿真中断上下文
+ */
+void Sim_ScheduleIrq(uint64_t dueUs);
+
+/**
+ * @brief 仿真外设中断服务函数, 处理所有到期的 I2C/DMA 传输和硬件节拍(ADC/RTC/按键/控制台)
+ */
+void Sim_PeripheralIrq(void);
+
+/**
+ * @brief STOP 模式中等到下一个硬件节拍并执行它(SIM_FAST_STOP 时虚拟时钟直接跳过去)
+ * @note 在空闲任务的无节拍睡眠中调用, 此时调度器已挂起
+ */
+void Sim_StopStep(void);
+
+/**
+ * @brief 唤醒 STOP 模式(RTC 闹钟、按键 EXTI、控制台命令)
+ */
+void Sim_StopWakeup(void);
+
+/**
+ * @brief traceTASK_SWITCHED_IN: STOP 唤醒后第一个非空闲任务切入时记录唤醒延迟
+ */
+void Sim_TaskSwitchedIn(void);
+
+/**
+ * @brief 虚拟时钟与内核节拍数之差(毫秒), 以调度器启动后的第一个硬件节拍为零点; 正数表示内核时间落后
+ */
+int32_t Sim_TickDriftMs(void);
+
+/**
+ * @brief 启动仿真环境(外设模型与 SimIrq/SimConsole 任务), 由 HAL_Init() 调用
+ */
+void Sim_Start(void);
+
+// ========================== 外设模型 ==========================
+
+/**
+ * @brief I2C 从机模型
+ * @note address 与 HAL 调用中的 DevAddress 一致, 为左移后的 8 位写地址
+ */
+typedef struct {
+    const char *name;
+    uint16_t address;
+    void (*write)(const uint8_t *data, uint16_t len); // 一次写传输(不含地址字节)
+    void (*read)(uint8_t *data, uint16_t len);        // 一次读传输(不含地址字节)
+    uint32_t transfers;
+    uint32_t bytes;
+    uint64_t busyUs;
+} SimI2cDevice;
+
+extern SimI2cDevice Sim_Aht20Device;
+extern SimI2cDevice Sim_Bmp280Device;
+extern SimI2cDevice Sim_OledDevice;
+
+void Sim_HalInit(void);
+void Sim_FlashInit(void);
+void Sim_HalTick(void);
+void Sim_I2cIrq(void);
+void Sim_UartIrq(void);
+
+/**
+ * @brief 模拟按键按下 holdMs 毫秒, 按下沿触发 EXTI
+ */
+void Sim_KeyPress(GPIO_TypeDef *port, uint16_t pin, uint32_t holdMs);
+
+/**
+ * @brief 模拟旋钮转动, steps 为正表示右转
+ */
+void Sim_KnobRotate(int32_t steps);
+
+/**
+ * @brief 软件 I2C 总线(PC4/PC5)上的 BH1750 模型
+ * @param scl SCL 线电平
+ * @param sda 主机一侧的 SDA 电平(主机释放时为 1)
+ * @return 1 表示 BH1750 当前把 SDA 拉低
+ */
+int Sim_Bh1750_Bus(int scl, int sda);
+
+void Sim_OledDump(void);
+void Sim_OledTick(void);
+void Sim_OledPrintStats(void);
+
+/**
+ * @brief 应用代码中 printf 的替身, 经 USART1 阻塞发送(见 cmake/host/CMakeLists.txt)
+ */
+int Sim_Printf(const char *format, ...);
+
+// ========================== 环境数据 ==========================
+
+float Sim_EnvTemperature(void);  // ℃
+float Sim_EnvHumidity(void);     // %RH
+float Sim_EnvPressure(void);     // Pa
+float Sim_EnvLux(void);          // lx
+uint16_t Sim_EnvSoilAdc(void);   // 12 位 ADC 原始值, 越大越干
+uint16_t Sim_EnvRainAdc(void);   // 12 位 ADC 原始值, 越大雨越小
+
+// ========================== 统计 ==========================
+
+typedef struct {
+    uint32_t stopEntries;    // 进入 STOP 模式次数
+    uint64_t stopUs;         // STOP 模式累计时长
+    uint32_t stopBusy;       // 进入 STOP 时 USART1/USART2/I2C2 仍在发送的次数(目标板上这些传输会被截断)
+    uint32_t wakeups;        // STOP 唤醒次数
+    uint64_t wakeClockUs;    // 唤醒到恢复 HAL 时基(时钟已恢复)的累计时长
+    uint64_t wakeClockMaxUs;
+    uint32_t wakeTasks;      // 唤醒后有任务切入的次数(切入之前又进入 STOP 的唤醒不计)
+    uint64_t wakeTaskUs;     // 唤醒到第一个非空闲任务切入的累计时长
+    uint64_t wakeTaskMaxUs;
+    uint32_t uartTxBytes[2]; // USART1 / USART2
+    uint64_t uartBusyUs[2];  // 阻塞式发送忙等的累计时长
+    uint32_t uartDmaStarts[2]; // DMA 发送启动次数(串口从空闲转为发送的次数上限)
+    uint32_t gpioWrites;
+    uint32_t clockConfigs;   // HAL_RCC_ClockConfig 调用次数
+    uint32_t flashErases;    // Flash 页擦除次数
+    uint32_t flashHalfWords; // Flash 写入的半字数
+    uint64_t flashBusyUs;    // Flash 擦写忙等的累计时长
+} SimStats;
+
+extern SimStats Sim_Stats;
+
+void Sim_PrintStats(void);
+void Sim_I2cPrintStats(void);
+
+#endif /* SIM_H */
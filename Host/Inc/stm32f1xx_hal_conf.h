@@ -0,0 +1,98 @@
+/**
+ * @file stm32f1xx_hal_conf.h
+ * @brief 主机仿真用的 HAL 配置包装
+ *
+ * 先引入 Core/Inc 下 CubeMX 生成的真正配置(模块开关与目标板完全一致),
+ * 然后把外设实例宏(I2C2、USART1、RTC、GPIOA ...)从固定的外设地址改指向仿真寄存器块。
+ * 这些宏都是在使用处才展开的, 因此 Core/Src、Core/App、Core/BSP 中对 hrtc.Instance->CRL、
+ * __HAL_TIM_SET_COMPARE()、__HAL_RCC_GPIOA_CLK_ENABLE() 之类的访问在主机上落到普通内存里。
+ * RCC 例外: 每次访问都经过 Sim_Rcc(), 按虚拟时钟推进 HSERDY/PLLRDY 和 SWS, 固件可以直接轮询就绪位。
+ */
+#ifndef HOST_STM32F1XX_HAL_CONF_H
+#define HOST_STM32F1XX_HAL_CONF_H
+
+#include_next <stm32f1xx_hal_conf.h>
+
+// 仿真寄存器块, 定义见 Host/Src/sim_hal.c
+extern GPIO_TypeDef SimGPIO[7];
+extern AFIO_TypeDef SimAFIO;
+extern EXTI_TypeDef SimEXTI;
+extern RCC_TypeDef SimRCC;
+extern PWR_TypeDef SimPWR;
+extern RTC_TypeDef SimRTC;
+extern FLASH_TypeDef SimFLASH;
+extern I2C_TypeDef SimI2C2;
+extern USART_TypeDef SimUSART1;
+extern USART_TypeDef SimUSART2;
+extern TIM_TypeDef SimTIM2;
+extern TIM_TypeDef SimTIM3;
+extern TIM_TypeDef SimTIM4;
+extern ADC_TypeDef SimADC1;
+extern ADC_TypeDef SimADC2;
+extern DMA_TypeDef SimDMA1;
+extern DMA_Channel_TypeDef SimDMA1_Channel[7];
+
+#undef GPIOA
+#undef GPIOB
+#undef GPIOC
+#undef GPIOD
+#undef GPIOE
+#undef GPIOF
+#undef GPIOG
+#define GPIOA (&SimGPIO[0])
+#define GPIOB (&SimGPIO[1])
+#define GPIOC (&SimGPIO[2])
+#define GPIOD (&SimGPIO[3])
+#define GPIOE (&SimGPIO[4])
+#define GPIOF (&SimGPIO[5])
+#define GPIOG (&SimGPIO[6])
+
+#undef AFIO
+#undef EXTI
+#undef RCC
+#undef PWR
+#undef RTC
+#undef FLASH
+#define AFIO (&SimAFIO)
+#define EXTI (&SimEXTI)
+RCC_TypeDef *Sim_Rcc(void);
+#define RCC (Sim_Rcc())
+#define PWR (&SimPWR)
+#define RTC (&SimRTC)
+#define FLASH (&SimFLASH)
+
+#undef I2C2
+#undef USART1
+#undef USART2
+#undef TIM2
+#undef TIM3
+#undef TIM4
+#undef ADC1
+#undef ADC2
+#define I2C2 (&SimI2C2)
+#define USART1 (&SimUSART1)
+#define USART2 (&SimUSART2)
+#define TIM2 (&SimTIM2)
+#define TIM3 (&SimTIM3)
+#define TIM4 (&SimTIM4)
+#define ADC1 (&SimADC1)
+#define ADC2 (&SimADC2)
+
+#undef DMA1
+#undef DMA1_Channel1
+#undef DMA1_Channel2
+#undef DMA1_Channel3
+#undef DMA1_Channel4
+#undef DMA1_Channel5
+#undef DMA1_Channel6
+#undef DMA1_Channel7
+#define DMA1 (&SimDMA1)
+#define DMA1_Channel1 (&SimDMA1_Channel[0])
+#define DMA1_Channel2 (&SimDMA1_Channel[1])
+#define DMA1_Channel3 (&SimDMA1_Channel[2])
+#define DMA1_Channel4 (&SimDMA1_Channel[3])
+#define DMA1_Channel5 (&SimDMA1_Channel[4])
+#define DMA1_Channel6 (&SimDMA1_Channel[5])
+#define DMA1_Channel7 (&SimDMA1_Channel[6])
+
+#endif /* HOST_STM32F1XX_HAL_CONF_H */
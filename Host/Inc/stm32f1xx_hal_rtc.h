@@ -0,0 +1,73 @@
+/**
+ * @file stm32f1xx_hal_rtc.h
+ * @brief 主机仿真用的 HAL RTC 接口子集
+ *
+ * 当前仓库快照里没有 STM32F1 HAL 的 RTC 驱动, 主机构建由本文件提供与官方头文件同名的
+ * 类型、宏和函数声明, 只覆盖工程实际用到的部分(StopModeRtc.c 与 MX_RTC_Init)。
+ * 实现见 Host/Src/sim_hal.c, 计数器按虚拟时钟和预分频寄存器(PRL)递增。
+ */
+#ifndef __STM32F1xx_HAL_RTC_H
+#define __STM32F1xx_HAL_RTC_H
+
+#include "stm32f1xx_hal_def.h"
+
+typedef struct {
+  uint32_t AsynchPrediv;
+  uint32_t OutPut;
+} RTC_InitTypeDef;
+
+typedef struct {
+  uint8_t Hours;
+  uint8_t Minutes;
+  uint8_t Seconds;
+} RTC_TimeTypeDef;
+
+typedef struct {
+  uint8_t WeekDay;
+  uint8_t Month;
+  uint8_t Date;
+  uint8_t Year;
+} RTC_DateTypeDef;
+
+typedef enum {
+  HAL_RTC_STATE_RESET   = 0x00U,
+  HAL_RTC_STATE_READY   = 0x01U,
+  HAL_RTC_STATE_BUSY    = 0x02U,
+  HAL_RTC_STATE_TIMEOUT = 0x03U,
+  HAL_RTC_STATE_ERROR   = 0x04U
+} HAL_RTCStateTypeDef;
+
+typedef struct {
+  RTC_TypeDef                 *Instance;
+  RTC_InitTypeDef             Init;
+  RTC_DateTypeDef             DateToUpdate;
+  HAL_LockTypeDef             Lock;
+  __IO HAL_RTCStateTypeDef    State;
+} RTC_HandleTypeDef;
+
+#define RTC_FORMAT_BIN                      0x000000000U
+#define RTC_FORMAT_BCD                      0x000000001U
+
+#define RTC_AUTO_1_SECOND                   0xFFFFFFFFU
+#define RTC_OUTPUTSOURCE_NONE               0x00000000U
+
+#define RTC_WEEKDAY_MONDAY                  ((uint8_t)0x01)
+#define RTC_MONTH_JANUARY                   ((uint8_t)0x01)
+
+#define RTC_EXTI_LINE_ALARM_EVENT           ((uint32_t)EXTI_IMR_MR17)
+
+#define __HAL_RTC_ALARM_EXTI_ENABLE_IT()            SET_BIT(EXTI->IMR, RTC_EXTI_LINE_ALARM_EVENT)
+#define __HAL_RTC_ALARM_EXTI_DISABLE_IT()           CLEAR_BIT(EXTI->IMR, RTC_EXTI_LINE_ALARM_EVENT)
+#define __HAL_RTC_ALARM_EXTI_ENABLE_RISING_EDGE()   SET_BIT(EXTI->RTSR, RTC_EXTI_LINE_ALARM_EVENT)
+#define __HAL_RTC_ALARM_EXTI_DISABLE_RISING_EDGE()  CLEAR_BIT(EXTI->RTSR, RTC_EXTI_LINE_ALARM_EVENT)
+#define __HAL_RTC_ALARM_EXTI_GET_FLAG()             (EXTI->PR & (RTC_EXTI_LINE_ALARM_EVENT))
+#define __HAL_RTC_ALARM_EXTI_CLEAR_FLAG()           (EXTI->PR = (RTC_EXTI_LINE_ALARM_EVENT))
+
+HAL_StatusTypeDef HAL_RTC_Init(RTC_HandleTypeDef *hrtc);
+HAL_StatusTypeDef HAL_RTC_SetTime(RTC_HandleTypeDef *hrtc, RTC_TimeTypeDef *sTime, uint32_t Format);
+HAL_StatusTypeDef HAL_RTC_GetTime(RTC_HandleTypeDef *hrtc, RTC_TimeTypeDef *sTime, uint32_t Format);
+HAL_StatusTypeDef HAL_RTC_SetDate(RTC_HandleTypeDef *hrtc, RTC_DateTypeDef *sDate, uint32_t Format);
+HAL_StatusTypeDef HAL_RTC_GetDate(RTC_HandleTypeDef *hrtc, RTC_DateTypeDef *sDate, uint32_t Format);
+HAL_StatusTypeDef HAL_RTC_WaitForSynchro(RTC_HandleTypeDef *hrtc);
+
+#endif /* __STM32F1xx_HAL_RTC_H */
@@ -0,0 +1,389 @@
+/**
+ * @file port.c
+ * @brief FreeRTOS 主机(POSIX)移植层
+ *
+ * 实现思路与上游 FreeRTOS-Kernel 的 portable/ThirdParty/GCC/Posix 相同, 针对本工程的 V10.3.1 内核做了裁剪:
+ * - 每个任务一个 pthread, 线程控制块 Thread_t 放在 FreeRTOS 分配的任务栈顶, 线程本身使用 pthread 自己的栈
+ * - 同一时刻只有 pxCurrentTCB 对应的线程在运行, 其余线程都阻塞在各自的事件上
+ * - ITIMER_REAL 产生的 SIGALRM 作为系统节拍, 在当前运行线程的信号处理函数里推进节拍并切换
+ * - 临界区 = 屏蔽本线程的全部信号
+ * - SysTick 寄存器块 SimSysTick: CTRL 的 ENABLE 位清除期间(无节拍空闲)SIGALRM 不推进节拍
+ * - 主机繁忙时 SIGALRM 会合并丢失, 节拍处理函数按虚拟时钟把落下的节拍补上
+ *
+ * 另外提供仿真"中断上下文"(Sim_IrqEnter/Sim_IrqExit): 仿真外设的完成回调在其中执行,
+ * __get_IPSR() 返回非零, CMSIS-RTOS2 会自动改走 FromISR 接口; 期间请求的任务切换推迟到退出时,
+ * 与 Cortex-M 上 PendSV 的行为一致。
+ * 外设中断由 sim_core.c 的单次定时器以 SIM_IRQ_SIGNAL 投递, 与节拍信号一样在当前运行线程里处理。
+ */
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "sim.h"
+
+#define SIG_RESUME SIGUSR1
+
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int signaled;
+} Event_t;
+
+typedef struct {
+    pthread_t pthread;
+    TaskFunction_t pxCode;
+    void *pvParams;
+    BaseType_t xDying;
+    Event_t ev;
+} Thread_t;
+
+static pthread_once_t hSigSetupThread = PTHREAD_ONCE_INIT;
+static sigset_t xAllSignals;
+static pthread_t hMainThread;
+static volatile BaseType_t xSchedulerEnd = pdFALSE;
+static volatile UBaseType_t uxCriticalNesting = 0;
+
+// 节拍定时器, core_cm3.h 把 SysTick 指向这里
+SysTick_Type SimSysTick;
+static uint64_t ullNextTickUs;  // 下一个节拍的虚拟时刻, 0 表示 SysTick 刚重新启动
+static TickType_t xLastTickCount;  // 上次处理完时的节拍数, 对不上说明无节拍空闲已经按 RTC 补过节拍
+
+// 仿真中断嵌套深度, cmsis_gcc.h 中的 __get_IPSR() 据此判断是否处于"中断"中
+volatile uint32_t Sim_IrqNesting = 0;
+// 仿真中断里请求了任务切换, 退出最外层中断时再执行(相当于挂起 PendSV)
+static volatile BaseType_t xYieldPendingFromIrq = pdFALSE;
+
+static void prvEventInit(Event_t *ev) {
+    pthread_mutex_init(&ev->mutex, NULL);
+    pthread_cond_init(&ev->cond, NULL);
+    ev->signaled = 0;
+}
+
+static void prvEventUnlock(void *arg) {
+    pthread_mutex_unlock(&((Event_t *) arg)->mutex);
+}
+
+static void prvEventWait(Event_t *ev) {
+    pthread_mutex_lock(&ev->mutex);
+    pthread_cleanup_push(prvEventUnlock, ev);
+    while (!ev->signaled) {
+        pthread_cond_wait(&ev->cond, &ev->mutex);
+    }
+    ev->signaled = 0;
+    pthread_cleanup_pop(1);
+}
+
+static void prvEventSignal(Event_t *ev) {
+    pthread_mutex_lock(&ev->mutex);
+    ev->signaled = 1;
+    pthread_cond_signal(&ev->cond);
+    pthread_mutex_unlock(&ev->mutex);
+}
+
+static Thread_t *prvGetThreadFromTask(TaskHandle_t xTask) {
+    // TCB 的第一个成员就是 pxTopOfStack, pxPortInitialiseStack() 返回的正是 Thread_t 的地址
+    StackType_t *pxTopOfStack = *(StackType_t **) xTask;
+    return (Thread_t *) pxTopOfStack;
+}
+
+static void prvSuspendSelf(Thread_t *pxThread) {
+    prvEventWait(&pxThread->ev);
+}
+
+static void prvResumeThread(Thread_t *pxThread) {
+    if (!pthread_equal(pthread_self(), pxThread->pthread)) {
+        prvEventSignal(&pxThread->ev);
+    }
+}
+
+static void prvSwitchThread(Thread_t *pxThreadToResume, Thread_t *pxThreadToSuspend) {
+    UBaseType_t uxSavedCriticalNesting;
+
+    if (pxThreadToSuspend != pxThreadToResume) {
+        // 临界区深度是全局的, 每个线程挂起前自己保存, 恢复运行后自己还原
+        uxSavedCriticalNesting = uxCriticalNesting;
+        prvResumeThread(pxThreadToResume);
+        if (pxThreadToSuspend->xDying) {
+            pthread_exit(NULL);
+        }
+        prvSuspendSelf(pxThreadToSuspend);
+        uxCriticalNesting = uxSavedCriticalNesting;
+    }
+}
+
+/**
+ * @brief SIGALRM 处理函数, 相当于 SysTick 中断
+ * @note 信号处理期间所有信号都被屏蔽, 因此本函数内部天然处于临界区
+ */
+static void prvSystemTickHandler(int sig) {
+    Thread_t *pxThreadToSuspend;
+    Thread_t *pxThreadToResume;
+
+    (void) sig;
+    if ((SimSysTick.CTRL & SysTick_CTRL_ENABLE_Msk) == 0U) {
+        ullNextTickUs = 0U;
+        return; // SysTick 已停止: 空闲任务正在无节拍睡眠, 醒来后按 RTC 补节拍
+    }
+    uxCriticalNesting++;
+
+    const uint64_t now = Sim_NowUs();
+    const uint64_t period = 1000000U / configTICK_RATE_HZ;
+    BaseType_t xSwitchRequired = pdFALSE;
+    if (ullNextTickUs == 0U || xTaskGetTickCount() != xLastTickCount) {
+        ullNextTickUs = now; // 从 SysTick 重新启动或补完节拍后的第一个节拍算起
+    }
+    // 信号屏蔽期间合并掉的 SIGALRM 按虚拟时钟补上
+    while (now >= ullNextTickUs) {
+        xSwitchRequired |= xTaskIncrementTick();
+        ullNextTickUs += period;
+    }
+    xLastTickCount = xTaskGetTickCount();
+
+    pxThreadToSuspend = prvGetThreadFromTask(xTaskGetCurrentTaskHandle());
+    if (xSwitchRequired != pdFALSE) {
+        vTaskSwitchContext();
+        pxThreadToResume = prvGetThreadFromTask(xTaskGetCurrentTaskHandle());
+        prvSwitchThread(pxThreadToResume, pxThreadToSuspend);
+    }
+
+    uxCriticalNesting--;
+}
+
+/**
+ * @brief SIM_IRQ_SIGNAL 处理函数, 相当于外设中断(I2C 事件、DMA 传输完成等)
+ */
+static void prvPeripheralIrqHandler(int sig) {
+    (void) sig;
+    uxCriticalNesting++;
+
+    Sim_IrqEnter();
+    Sim_PeripheralIrq();
+    Sim_IrqExit();
+
+    uxCriticalNesting--;
+}
+
+static void prvSetupSignalsAndSchedulerPolicy(void) {
+    struct sigaction sigtick;
+    struct sigaction sigirq;
+
+    sigfillset(&xAllSignals);
+    // 保留 Ctrl+C 以及同步错误信号, 方便调试
+    sigdelset(&xAllSignals, SIGINT);
+    sigdelset(&xAllSignals, SIGSEGV);
+    sigdelset(&xAllSignals, SIGBUS);
+    sigdelset(&xAllSignals, SIGFPE);
+    sigdelset(&xAllSignals, SIGILL);
+    sigdelset(&xAllSignals, SIGABRT);
+
+    // 创建任务的线程(main 线程)屏蔽全部信号, 之后创建的任务线程继承这个掩码
+    pthread_sigmask(SIG_SETMASK, &xAllSignals, NULL);
+
+    memset(&sigtick, 0, sizeof(sigtick));
+    sigtick.sa_flags = SA_RESTART;
+    sigtick.sa_handler = prvSystemTickHandler;
+    sigfillset(&sigtick.sa_mask);
+    if (sigaction(SIGALRM, &sigtick, NULL) != 0) {
+        perror("sigaction");
+        abort();
+    }
+
+    memset(&sigirq, 0, sizeof(sigirq));
+    sigirq.sa_flags = SA_RESTART;
+    sigirq.sa_handler = prvPeripheralIrqHandler;
+    sigfillset(&sigirq.sa_mask);
+    if (sigaction(SIM_IRQ_SIGNAL, &sigirq, NULL) != 0) {
+        perror("sigaction");
+        abort();
+    }
+}
+
+static void *prvWaitForStart(void *pvParams) {
+    Thread_t *pxThread = pvParams;
+
+    prvSuspendSelf(pxThread);
+
+    // 第一次被调度时临界区深度一定为 0
+    uxCriticalNesting = 0;
+    vPortEnableInterrupts();
+
+    pxThread->pxCode(pxThread->pvParams);
+
+    // 任务函数不应返回, 返回了就按删除自身处理
+    vTaskDelete(NULL);
+    return NULL;
+}
+
+StackType_t *pxPortInitialiseStack(StackType_t *pxTopOfStack, TaskFunction_t pxCode, void *pvParameters) {
+    Thread_t *pxThread;
+    int iRet;
+
+    pthread_once(&hSigSetupThread, prvSetupSignalsAndSchedulerPolicy);
+
+    // Thread_t 放在任务栈顶, 8 字节对齐
+    pxThread = (Thread_t *) (((uintptr_t) (pxTopOfStack + 1) - sizeof(Thread_t)) & ~(uintptr_t) portBYTE_ALIGNMENT_MASK);
+    memset(pxThread, 0, sizeof(*pxThread));
+    pxThread->pxCode = pxCode;
+    pxThread->pvParams = pvParameters;
+    pxThread->xDying = pdFALSE;
+    prvEventInit(&pxThread->ev);
+
+    vPortEnterCritical();
+    iRet = pthread_create(&pxThread->pthread, NULL, prvWaitForStart, pxThread);
+    vPortExitCritical();
+    if (iRet != 0) {
+        fprintf(stderr, "pthread_create failed: %s\n", strerror(iRet));
+        abort();
+    }
+
+    return (StackType_t *) pxThread;
+}
+
+BaseType_t xPortStartScheduler(void) {
+    struct itimerval itimer;
+    sigset_t xSignals;
+    int iSignal;
+
+    hMainThread = pthread_self();
+
+    SimSysTick.LOAD = configCPU_CLOCK_HZ / configTICK_RATE_HZ - 1U;
+    SimSysTick.VAL = 0U;
+    SimSysTick.CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk | SysTick_CTRL_ENABLE_Msk;
+
+    // 启动节拍定时器, 此时 vTaskStartScheduler() 已经关闭了"中断"
+    itimer.it_interval.tv_sec = 0;
+    itimer.it_interval.tv_usec = portTICK_RATE_MICROSECONDS;
+    itimer.it_value = itimer.it_interval;
+    if (setitimer(ITIMER_REAL, &itimer, NULL) != 0) {
+        perror("setitimer");
+        abort();
+    }
+
+    prvResumeThread(prvGetThreadFromTask(xTaskGetCurrentTaskHandle()));
+
+    // main 线程不参与调度, 等待 vPortEndScheduler()
+    sigemptyset(&xSignals);
+    sigaddset(&xSignals, SIG_RESUME);
+    while (!xSchedulerEnd) {
+        sigwait(&xSignals, &iSignal);
+    }
+
+    return 0;
+}
+
+void vPortEndScheduler(void) {
+    struct itimerval itimer;
+    struct sigaction sigtick;
+
+    memset(&itimer, 0, sizeof(itimer));
+    setitimer(ITIMER_REAL, &itimer, NULL);
+
+    memset(&sigtick, 0, sizeof(sigtick));
+    sigtick.sa_handler = SIG_IGN;
+    sigaction(SIGALRM, &sigtick, NULL);
+
+    xSchedulerEnd = pdTRUE;
+    pthread_kill(hMainThread, SIG_RESUME);
+
+    prvSuspendSelf(prvGetThreadFromTask(xTaskGetCurrentTaskHandle()));
+}
+
+void vPortYield(void) {
+    Thread_t *pxThreadToSuspend;
+    Thread_t *pxThreadToResume;
+
+    if (Sim_IrqNesting != 0U) {
+        xYieldPendingFromIrq = pdTRUE;
+        return;
+    }
+
+    vPortEnterCritical();
+
+    pxThreadToSuspend = prvGetThreadFromTask(xTaskGetCurrentTaskHandle());
+    vTaskSwitchContext();
+    pxThreadToResume = prvGetThreadFromTask(xTaskGetCurrentTaskHandle());
+    prvSwitchThread(pxThreadToResume, pxThreadToSuspend);
+
+    vPortExitCritical();
+}
+
+void vPortDisableInterrupts(void) {
+    pthread_sigmask(SIG_BLOCK, &xAllSignals, NULL);
+}
+
+void vPortEnableInterrupts(void) {
+    pthread_sigmask(SIG_UNBLOCK, &xAllSignals, NULL);
+}
+
+void vPortEnterCritical(void) {
+    if (uxCriticalNesting == 0) {
+        vPortDisableInterrupts();
+    }
+    uxCriticalNesting++;
+}
+
+void vPortExitCritical(void) {
+    uxCriticalNesting--;
+    if (uxCriticalNesting == 0) {
+        vPortEnableInterrupts();
+    }
+}
+
+BaseType_t xPortSetInterruptMask(void) {
+    sigset_t xOldMask;
+
+    pthread_sigmask(SIG_BLOCK, &xAllSignals, &xOldMask);
+    return sigismember(&xOldMask, SIGALRM) ? pdTRUE : pdFALSE;
+}
+
+void vPortClearInterruptMask(BaseType_t xMask) {
+    // 进入前就已屏蔽(嵌套或在信号处理函数中)时保持屏蔽
+    if (xMask == pdFALSE) {
+        vPortEnableInterrupts();
+    }
+}
+
+void vPortThreadDying(void *pxTaskToDelete, volatile BaseType_t *pxPendYield) {
+    Thread_t *pxThread = prvGetThreadFromTask(pxTaskToDelete);
+
+    (void) pxPendYield;
+    pxThread->xDying = pdTRUE;
+}
+
+void vPortCancelThread(void *pxTaskToDelete) {
+    Thread_t *pxThread = prvGetThreadFromTask(pxTaskToDelete);
+
+    // 删除其他任务时该线程正阻塞在 pthread_cond_wait(取消点)上; 自删除的线程已经 pthread_exit
+    pthread_cancel(pxThread->pthread);
+    pthread_join(pxThread->pthread, NULL);
+    pthread_mutex_destroy(&pxThread->ev.mutex);
+    pthread_cond_destroy(&pxThread->ev.cond);
+}
+
+/**
+ * @brief 进入仿真中断上下文
+ * @note 仿真外设的"中断服务函数"在 SimIrq 任务或 SIM_IRQ_SIGNAL 处理函数里执行, 进入后屏蔽节拍, 不会被其他任务抢占
+ */
+void Sim_IrqEnter(void) {
+    vPortEnterCritical();
+    Sim_IrqNesting++;
+}
+
+/**
+ * @brief 退出仿真中断上下文, 执行期间被推迟的任务切换
+ */
+void Sim_IrqExit(void) {
+    Sim_IrqNesting--;
+    if (Sim_IrqNesting == 0U && xYieldPendingFromIrq != pdFALSE) {
+        xYieldPendingFromIrq = pdFALSE;
+        vPortYield();
+    }
+    vPortExitCritical();
+}
@@ -0,0 +1,64 @@
+/**
+ * @file sim_aht20.c
+ * @brief 主机仿真的 AHT20 温湿度传感器(I2C 地址 0x70)
+ *
+ * - 写 0xAC 0x33 0x00 触发测量, 测量在 80ms 内完成, 期间状态字节的 Busy 位(0x80)置位
+ * - 读 1 字节返回状态字节, 读 6 字节返回状态 + 20 位湿度 + 20 位温度
+ * - 上电即处于已校准状态(0x08), 0xBE 初始化命令被接受但不改变状态
+ */
+#include "sim.h"
+
+#define AHT20_STATUS_BUSY        0x80U
+#define AHT20_STATUS_CALIBRATED  0x08U
+#define AHT20_STATUS_IDLE        0x18U
+#define AHT20_CMD_TRIGGER        0xACU
+#define AHT20_MEASURE_US         80000U
+
+static uint64_t measureDoneUs;
+static uint32_t humidityRaw;
+static uint32_t temperatureRaw;
+
+static uint32_t Sim_Aht20Encode(float ratio) {
+    if (ratio < 0.0f) {
+        ratio = 0.0f;
+    }
+    if (ratio > 1.0f) {
+        ratio = 1.0f;
+    }
+    return (uint32_t) (ratio * (float) ((1UL << 20) - 1U));
+}
+
+static void Sim_Aht20Write(const uint8_t *data, uint16_t len) {
+    if (len >= 1U && data[0] == AHT20_CMD_TRIGGER) {
+        // 在触发时刻采样环境数据, 与真实器件一样读到的是触发时的值
+        humidityRaw = Sim_Aht20Encode(Sim_EnvHumidity() / 100.0f);
+        temperatureRaw = Sim_Aht20Encode((Sim_EnvTemperature() + 50.0f) / 200.0f);
+        measureDoneUs = Sim_NowUs() + AHT20_MEASURE_US;
+    }
+}
+
+static void Sim_Aht20Read(uint8_t *data, uint16_t len) {
+    uint8_t frame[7];
+
+    frame[0] = AHT20_STATUS_IDLE;
+    if (Sim_NowUs() < measureDoneUs) {
+        frame[0] |= AHT20_STATUS_BUSY;
+    }
+    frame[1] = (uint8_t) (humidityRaw >> 12);
+    frame[2] = (uint8_t) (humidityRaw >> 4);
+    frame[3] = (uint8_t) (((humidityRaw & 0x0FU) << 4) | ((temperatureRaw >> 16) & 0x0FU));
+    frame[4] = (uint8_t) (temperatureRaw >> 8);
+    frame[5] = (uint8_t) temperatureRaw;
+    frame[6] = 0xFF; // CRC, 驱动不校验
+
+    for (uint16_t i = 0; i < len; i++) {
+        data[i] = (i < sizeof(frame)) ? frame[i] : 0xFFU;
+    }
+}
+
+SimI2cDevice Sim_Aht20Device = {
+    .name = "AHT20",
+    .address = 0x70,
+    .write = Sim_Aht20Write,
+    .read = Sim_Aht20Read,
+};
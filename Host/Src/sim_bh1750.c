@@ -0,0 +1,132 @@
+/**
+ * @file sim_bh1750.c
+ * @brief 主机仿真的 BH1750 光照传感器, 挂在 PC4(SDA)/PC5(SCL) 的软件 I2C 上
+ *
+ * 按位实现从机协议: SCL 高电平期间 SDA 下降/上升为起始/停止条件, SCL 上升沿采样,
+ * SCL 下降沿由从机改变 SDA(应答或输出下一位)。7 位地址 0x23(写地址 0x46)。
+ * 收到测量命令 120ms 后才有第一个结果, 之后每次读取返回 lux * 1.2 的 16 位原始值。
+ */
+#include "sim.h"
+
+#define BH1750_ADDRESS      0x23U
+#define BH1750_POWER_DOWN   0x00U
+#define BH1750_MEASURE_US   120000U
+
+typedef enum {
+    BH1750_IDLE = 0,
+    BH1750_ADDRESS_PHASE,
+    BH1750_WRITE_PHASE,
+    BH1750_READ_PHASE,
+} Bh1750State;
+
+static struct {
+    Bh1750State state;
+    int lastScl;
+    int lastSda;
+    int pullLow;       // 从机是否拉低 SDA
+    uint8_t clocks;    // 当前字节已经过的 SCL 上升沿数, 第 9 个为应答位
+    uint8_t shift;
+    uint8_t readMode;
+    uint8_t masterAck;
+    uint8_t txIndex;
+    uint8_t txData[2];
+    uint8_t measuring;
+    uint64_t modeSetUs;
+    uint16_t result;
+} bh1750 = {.lastScl = 1, .lastSda = 1};
+
+static void Sim_Bh1750LoadResult(void) {
+    if (bh1750.measuring && Sim_NowUs() - bh1750.modeSetUs >= BH1750_MEASURE_US) {
+        const float raw = Sim_EnvLux() * 1.2f;
+        bh1750.result = (raw >= 65535.0f) ? 65535U : (uint16_t) raw;
+    }
+    bh1750.txData[0] = (uint8_t) (bh1750.result >> 8);
+    bh1750.txData[1] = (uint8_t) bh1750.result;
+    bh1750.txIndex = 0;
+}
+
+static void Sim_Bh1750Command(uint8_t cmd) {
+    if (cmd == BH1750_POWER_DOWN) {
+        bh1750.measuring = 0;
+    } else if ((cmd & 0xF0U) == 0x10U || (cmd & 0xF0U) == 0x20U) {
+        // 连续/单次测量命令, 已在测量中则沿用原来的积分周期
+        if (!bh1750.measuring) {
+            bh1750.measuring = 1;
+            bh1750.modeSetUs = Sim_NowUs();
+        }
+    }
+}
+
+static void Sim_Bh1750Rising(int sda) {
+    if (bh1750.state == BH1750_READ_PHASE) {
+        if (bh1750.clocks == 8U) {
+            bh1750.masterAck = (uint8_t) (sda == 0);
+        }
+    } else if (bh1750.clocks < 8U) {
+        bh1750.shift = (uint8_t) ((bh1750.shift << 1) | (sda ? 1U : 0U));
+    }
+    bh1750.clocks++;
+}
+
+static void Sim_Bh1750Falling(void) {
+    if (bh1750.state == BH1750_READ_PHASE) {
+        if (bh1750.clocks < 8U) {
+            const uint8_t byte = bh1750.txData[bh1750.txIndex];
+            bh1750.pullLow = ((byte >> (7U - bh1750.clocks)) & 1U) == 0U;
+        } else if (bh1750.clocks == 8U) {
+            bh1750.pullLow = 0; // 释放 SDA, 由主机应答
+        } else {
+            bh1750.clocks = 0;
+            bh1750.txIndex++;
+            if (bh1750.masterAck && bh1750.txIndex < sizeof(bh1750.txData)) {
+                bh1750.pullLow = (bh1750.txData[bh1750.txIndex] & 0x80U) == 0U;
+            } else {
+                bh1750.state = BH1750_IDLE;
+            }
+        }
+        return;
+    }
+
+    if (bh1750.clocks == 8U) {
+        if (bh1750.state == BH1750_ADDRESS_PHASE) {
+            if ((bh1750.shift >> 1) != BH1750_ADDRESS) {
+                bh1750.state = BH1750_IDLE; // 不是自己的地址, 不应答
+                return;
+            }
+            bh1750.readMode = bh1750.shift & 1U;
+        } else {
+            Sim_Bh1750Command(bh1750.shift);
+        }
+        bh1750.pullLow = 1;
+    } else if (bh1750.clocks == 9U) {
+        bh1750.pullLow = 0;
+        bh1750.clocks = 0;
+        if (bh1750.state == BH1750_ADDRESS_PHASE && bh1750.readMode) {
+            bh1750.state = BH1750_READ_PHASE;
+            Sim_Bh1750LoadResult();
+            bh1750.pullLow = (bh1750.txData[0] & 0x80U) == 0U;
+        } else {
+            bh1750.state = BH1750_WRITE_PHASE;
+        }
+    }
+}
+
+int Sim_Bh1750_Bus(int scl, int sda) {
+    if (scl && bh1750.lastScl && sda != bh1750.lastSda) {
+        // SCL 高电平期间 SDA 跳变: 起始或停止条件
+        bh1750.pullLow = 0;
+        bh1750.clocks = 0;
+        bh1750.shift = 0;
+        bh1750.state = sda ? BH1750_IDLE : BH1750_ADDRESS_PHASE;
+    } else if (bh1750.state != BH1750_IDLE) {
+        if (scl && !bh1750.lastScl) {
+            // 从机拉低时总线上读到的是低电平
+            Sim_Bh1750Rising(sda && !bh1750.pullLow);
+        } else if (!scl && bh1750.lastScl) {
+            Sim_Bh1750Falling();
+        }
+    }
+    bh1750.lastScl = scl;
+    bh1750.lastSda = sda;
+    return bh1750.pullLow;
+}
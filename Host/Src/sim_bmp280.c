@@ -0,0 +1,154 @@
+/**
+ * @file sim_bmp280.c
+ * @brief 主机仿真的 BMP280 气压传感器(I2C 地址 0xEE)
+ *
+ * - 256 字节寄存器映像, 写传输的第一个字节设置寄存器指针, 读传输从指针处自动递增
+ * - 0x88~0x9F 为一组固定的校准参数, 0xD0 为芯片 ID 0x58
+ * - 0xF7~0xFC 的原始数据由环境温度/气压反解得到, 驱动按数据手册补偿后能还原出环境值;
+ *   与真实器件一样, 数据在一个测量周期内保持不变
+ */
+#include "sim.h"
+
+#define BMP280_REG_CALIB        0x88U
+#define BMP280_REG_ID           0xD0U
+#define BMP280_REG_CTRL_MEAS    0xF4U
+#define BMP280_REG_DATA         0xF7U
+#define BMP280_CHIP_ID          0x58U
+#define BMP280_MEASURE_US       40000U  // 温度 x1 + 气压 x16 过采样的测量时间
+
+static const struct {
+    uint16_t T1;
+    int16_t T2, T3;
+    uint16_t P1;
+    int16_t P2, P3, P4, P5, P6, P7, P8, P9;
+} bmp280Cal = {
+    27504, 26435, -1000,
+    36477, -10685, 3024, 2855, 140, -7, 15500, -14600, 6000,
+};
+
+static uint8_t bmp280Regs[256];
+static uint8_t bmp280Pointer;
+static uint64_t bmp280SampleUs;
+static int bmp280Sampled;
+
+static double Sim_Bmp280CompensateT(int32_t adcT, double *tFine) {
+    const double var1 = ((double) adcT / 16384.0 - (double) bmp280Cal.T1 / 1024.0) * (double) bmp280Cal.T2;
+    const double dt = (double) adcT / 131072.0 - (double) bmp280Cal.T1 / 8192.0;
+    const double var2 = dt * dt * (double) bmp280Cal.T3;
+    *tFine = (double) (int32_t) (var1 + var2);
+    return (var1 + var2) / 5120.0;
+}
+
+static double Sim_Bmp280CompensateP(int32_t adcP, double tFine) {
+    double var1 = tFine / 2.0 - 64000.0;
+    double var2 = var1 * var1 * (double) bmp280Cal.P6 / 32768.0;
+    double p;
+    var2 = var2 + var1 * (double) bmp280Cal.P5 * 2.0;
+    var2 = var2 / 4.0 + (double) bmp280Cal.P4 * 65536.0;
+    var1 = ((double) bmp280Cal.P3 * var1 * var1 / 524288.0 + (double) bmp280Cal.P2 * var1) / 524288.0;
+    var1 = (1.0 + var1 / 32768.0) * (double) bmp280Cal.P1;
+    p = 1048576.0 - (double) adcP;
+    p = (p - var2 / 4096.0) * 6250.0 / var1;
+    var1 = (double) bmp280Cal.P9 * p * p / 2147483648.0;
+    var2 = p * (double) bmp280Cal.P8 / 32768.0;
+    return p + (var1 + var2 + (double) bmp280Cal.P7) / 16.0;
+}
+
+/**
+ * @brief 二分查找 20 位原始值, 温度补偿随原始值递增, 气压补偿随原始值递减
+ */
+static void Sim_Bmp280Sample(void) {
+    const double temperature = Sim_EnvTemperature();
+    const double pressure = Sim_EnvPressure();
+    double tFine = 0.0;
+    int32_t lo = 0;
+    int32_t hi = (1 << 20) - 1;
+    int32_t adcT;
+    int32_t adcP;
+
+    while (lo < hi) {
+        const int32_t mid = (lo + hi) / 2;
+        if (Sim_Bmp280CompensateT(mid, &tFine) < temperature) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    adcT = lo;
+    (void) Sim_Bmp280CompensateT(adcT, &tFine);
+
+    lo = 0;
+    hi = (1 << 20) - 1;
+    while (lo < hi) {
+        const int32_t mid = (lo + hi) / 2;
+        if (Sim_Bmp280CompensateP(mid, tFine) > pressure) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    adcP = lo;
+
+    bmp280Regs[BMP280_REG_DATA + 0] = (uint8_t) (adcP >> 12);
+    bmp280Regs[BMP280_REG_DATA + 1] = (uint8_t) (adcP >> 4);
+    bmp280Regs[BMP280_REG_DATA + 2] = (uint8_t) ((adcP & 0x0F) << 4);
+    bmp280Regs[BMP280_REG_DATA + 3] = (uint8_t) (adcT >> 12);
+    bmp280Regs[BMP280_REG_DATA + 4] = (uint8_t) (adcT >> 4);
+    bmp280Regs[BMP280_REG_DATA + 5] = (uint8_t) ((adcT & 0x0F) << 4);
+}
+
+static void Sim_Bmp280LoadCalibration(void) {
+    const uint16_t words[12] = {
+        bmp280Cal.T1, (uint16_t) bmp280Cal.T2, (uint16_t) bmp280Cal.T3,
+        bmp280Cal.P1, (uint16_t) bmp280Cal.P2, (uint16_t) bmp280Cal.P3,
+        (uint16_t) bmp280Cal.P4, (uint16_t) bmp280Cal.P5, (uint16_t) bmp280Cal.P6,
+        (uint16_t) bmp280Cal.P7, (uint16_t) bmp280Cal.P8, (uint16_t) bmp280Cal.P9,
+    };
+    for (uint32_t i = 0; i < 12U; i++) {
+        bmp280Regs[BMP280_REG_CALIB + 2U * i] = (uint8_t) words[i];
+        bmp280Regs[BMP280_REG_CALIB + 2U * i + 1U] = (uint8_t) (words[i] >> 8);
+    }
+    bmp280Regs[BMP280_REG_ID] = BMP280_CHIP_ID;
+}
+
+static void Sim_Bmp280Write(const uint8_t *data, uint16_t len) {
+    if (len == 0U) {
+        return;
+    }
+    if (bmp280Regs[BMP280_REG_ID] != BMP280_CHIP_ID) {
+        Sim_Bmp280LoadCalibration();
+    }
+
+    bmp280Pointer = data[0];
+    for (uint16_t i = 1; i < len; i++) {
+        // 只有控制/配置寄存器可写
+        if (bmp280Pointer >= BMP280_REG_CTRL_MEAS && bmp280Pointer < BMP280_REG_DATA) {
+            bmp280Regs[bmp280Pointer] = data[i];
+        }
+        bmp280Pointer++;
+    }
+
+    // 指针指向数据寄存器时, 若上一次测量已过期则更新结果
+    if (bmp280Pointer >= BMP280_REG_DATA &&
+        (!bmp280Sampled || Sim_NowUs() - bmp280SampleUs >= BMP280_MEASURE_US)) {
+        Sim_Bmp280Sample();
+        bmp280SampleUs = Sim_NowUs();
+        bmp280Sampled = 1;
+    }
+}
+
+static void Sim_Bmp280Read(uint8_t *data, uint16_t len) {
+    if (bmp280Regs[BMP280_REG_ID] != BMP280_CHIP_ID) {
+        Sim_Bmp280LoadCalibration();
+    }
+    for (uint16_t i = 0; i < len; i++) {
+        data[i] = bmp280Regs[bmp280Pointer++];
+    }
+}
+
+SimI2cDevice Sim_Bmp280Device = {
+    .name = "BMP280",
+    .address = 0xEE,
+    .write = Sim_Bmp280Write,
+    .read = Sim_Bmp280Read,
+};
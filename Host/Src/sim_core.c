@@ -0,0 +1,343 @@
+/**
+ * @file sim_core.c
+ * @brief 主机仿真的时钟、硬件节拍和控制台
+ *
+ * - 硬件节拍: 每毫秒一次, 在 SIM_IRQ_SIGNAL 的仿真中断里推进 ADC/RTC/按键, 每 20ms 轮询一次标准输入;
+ *   它不是 FreeRTOS 任务, 不影响空闲任务计算的睡眠时间, 与目标板上的外设一样在无节拍空闲期间继续运行
+ * - 按键/旋钮直接在硬件节拍里模拟(可以把 STOP 模式唤醒), 打印类命令交给最低优先级的 SimConsole 任务执行
+ * - 虚拟时钟: Sim_NowUs() = 主机单调时钟 + STOP 模式中快进的时间
+ *
+ * 控制台命令:
+ *   1 / 3  按下 KEY1 / KEY3        < / >  旋钮左转 / 右转
+ *   d      打印 OLED 当前画面       s      打印外设统计
+ *   r      打印任务运行时间统计     q      退出
+ *
+ * 环境变量 SIM_EXIT_AFTER_MS 设置后, 运行到指定毫秒数(虚拟时钟)时打印统计并退出, 便于在 CI 中运行。
+ * 环境变量 SIM_FAST_STOP=1 时 STOP 模式不按主机时间等待, 虚拟时钟直接跳到下一个硬件节拍, 长时间的睡眠瞬间完成。
+ */
+#include "sim.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define SIM_CONSOLE_TASK_PRIORITY  (tskIDLE_PRIORITY + 1)
+#define SIM_HW_TICK_US             1000U
+#define SIM_CONSOLE_POLL_US        20000U
+#define SIM_CONSOLE_QUEUE_SIZE     16U
+#define SIM_KEY_HOLD_MS            120
+#define SIM_KNOB_STEP              2
+
+static uint64_t simStartNs;
+static uint64_t simSkippedUs;
+static int simFastStop;
+static uint64_t simHwDueUs;
+static uint64_t simConsoleDueUs;
+static timer_t simIrqTimer;
+static int simIrqTimerReady;
+static uint64_t simIrqArmedUs = UINT64_MAX;
+static uint32_t simExitAfterMs;
+static int consoleEnabled = 1;
+static int termiosSaved;
+static struct termios savedTermios;
+static TaskHandle_t simConsoleTask;
+static char simConsoleQueue[SIM_CONSOLE_QUEUE_SIZE];
+static volatile uint32_t simConsoleHead;
+static volatile uint32_t simConsoleTail;
+static volatile int simExitRequested;
+static int64_t simTickBaseMs = -1;
+
+static uint64_t Sim_MonotonicNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+uint64_t Sim_NowUs(void) {
+    return (Sim_MonotonicNs() - simStartNs) / 1000U + simSkippedUs;
+}
+
+void Sim_BusyWaitUs(uint32_t us) {
+    const uint64_t end = Sim_NowUs() + us;
+    while (Sim_NowUs() < end) {
+    }
+}
+
+static void Sim_RestoreTerminal(void) {
+    if (termiosSaved) {
+        tcsetattr(STDIN_FILENO, TCSANOW, &savedTermios);
+        termiosSaved = 0;
+    }
+}
+
+/**
+ * @brief 结束仿真
+ * @note 其他任务线程可能正挂起在 printf 内部, 这里不走 exit() 的清理流程, 直接 _exit
+ */
+static void Sim_Exit(int code) {
+    fflush(stdout);
+    fflush(stderr);
+    Sim_RestoreTerminal();
+    _exit(code);
+}
+
+static void Sim_ConsoleInit(void) {
+    const int flags = fcntl(STDIN_FILENO, F_GETFL, 0);
+    if (flags < 0) {
+        consoleEnabled = 0;
+        return;
+    }
+    fcntl(STDIN_FILENO, F_SETFL, flags | O_NONBLOCK);
+
+    if (isatty(STDIN_FILENO) && tcgetattr(STDIN_FILENO, &savedTermios) == 0) {
+        struct termios raw = savedTermios;
+        raw.c_lflag &= ~(ICANON | ECHO);
+        raw.c_cc[VMIN] = 0;
+        raw.c_cc[VTIME] = 0;
+        tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+        termiosSaved = 1;
+        atexit(Sim_RestoreTerminal);
+    }
+}
+
+static void Sim_PrintRunTimeStats(void) {
+    static char buffer[1024];
+    vTaskGetRunTimeStats(buffer);
+    printf("---- run time (us) ----\n%s", buffer);
+}
+
+/**
+ * @brief 按键/旋钮在硬件节拍(仿真中断)里直接模拟
+ * @return 0 表示不是按键/旋钮, 交给 SimConsole 任务
+ */
+static int Sim_HandleInputKey(char ch) {
+    switch (ch) {
+        case '1':
+            Sim_KeyPress(KEY1_GPIO_Port, KEY1_Pin, SIM_KEY_HOLD_MS);
+            return 1;
+        case '3':
+            Sim_KeyPress(KEY3_GPIO_Port, KEY3_Pin, SIM_KEY_HOLD_MS);
+            return 1;
+        case '<':
+            Sim_KnobRotate(-SIM_KNOB_STEP);
+            return 1;
+        case '>':
+            Sim_KnobRotate(SIM_KNOB_STEP);
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static void Sim_HandleConsoleKey(char ch) {
+    switch (ch) {
+        case 'd':
+            Sim_OledDump();
+            break;
+        case 's':
+            Sim_PrintStats();
+            break;
+        case 'r':
+            Sim_PrintRunTimeStats();
+            break;
+        case 'q':
+            Sim_PrintStats();
+            Sim_Exit(0);
+            break;
+        default:
+            break;
+    }
+}
+
+static void Sim_IrqTimerInit(void) {
+    struct sigevent event;
+
+    memset(&event, 0, sizeof(event));
+    event.sigev_notify = SIGEV_SIGNAL;
+    event.sigev_signo = SIM_IRQ_SIGNAL;
+    if (timer_create(CLOCK_MONOTONIC, &event, &simIrqTimer) != 0) {
+        perror("timer_create");
+        exit(1);
+    }
+    simIrqTimerReady = 1;
+}
+
+void Sim_ScheduleIrq(uint64_t dueUs) {
+    struct itimerspec spec;
+    uint64_t dueNs;
+
+    if (!simIrqTimerReady || dueUs >= simIrqArmedUs) {
+        return;
+    }
+    simIrqArmedUs = dueUs;
+
+    // 绝对时刻已过去时定时器立即触发; it_value 不能为 0(为 0 表示撤销)
+    dueNs = simStartNs + (dueUs > simSkippedUs ? dueUs - simSkippedUs : 0U) * 1000U + 1U;
+    memset(&spec, 0, sizeof(spec));
+    spec.it_value.tv_sec = (time_t) (dueNs / 1000000000U);
+    spec.it_value.tv_nsec = (long) (dueNs % 1000000000U);
+    timer_settime(simIrqTimer, TIMER_ABSTIME, &spec, NULL);
+}
+
+/**
+ * @brief 把一条打印类命令(或退出请求)交给 SimConsole 任务, 在仿真中断中调用
+ * @note 同时唤醒 STOP 模式, 命令在睡眠期间也能及时执行
+ */
+static void Sim_ConsoleRequest(char ch) {
+    BaseType_t woken = pdFALSE;
+
+    if (ch != '\0' && simConsoleHead - simConsoleTail < SIM_CONSOLE_QUEUE_SIZE) {
+        simConsoleQueue[simConsoleHead % SIM_CONSOLE_QUEUE_SIZE] = ch;
+        simConsoleHead++;
+    }
+    if (simConsoleTask != NULL) {
+        vTaskNotifyGiveFromISR(simConsoleTask, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+    Sim_StopWakeup();
+}
+
+static void Sim_ConsolePoll(void) {
+    char ch;
+    while (consoleEnabled) {
+        const ssize_t n = read(STDIN_FILENO, &ch, 1);
+        if (n == 1) {
+            if (!Sim_HandleInputKey(ch)) {
+                Sim_ConsoleRequest(ch);
+            }
+        } else {
+            if (n == 0) {
+                consoleEnabled = 0; // 标准输入已关闭(例如重定向自 /dev/null)
+            }
+            break;
+        }
+    }
+}
+
+/**
+ * @brief 硬件节拍: 推进外设模型, 轮询控制台, 检查退出时间
+ */
+static void Sim_HardwareTick(void) {
+    const uint64_t now = Sim_NowUs();
+
+    if (now < simHwDueUs) {
+        return;
+    }
+    simHwDueUs = now - now % SIM_HW_TICK_US + SIM_HW_TICK_US;
+
+    Sim_HalTick();
+    Sim_OledTick();
+
+    if (simTickBaseMs < 0 && xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED) {
+        simTickBaseMs = (int64_t) (now / 1000U) - (int64_t) xTaskGetTickCountFromISR();
+    }
+    if (now >= simConsoleDueUs) {
+        simConsoleDueUs = now + SIM_CONSOLE_POLL_US;
+        Sim_ConsolePoll();
+    }
+    if (simExitAfterMs != 0U && !simExitRequested && now >= (uint64_t) simExitAfterMs * 1000U) {
+        simExitRequested = 1;
+        Sim_ConsoleRequest('\0');
+    }
+}
+
+void Sim_PeripheralIrq(void) {
+    // 各外设在自己的处理函数里为尚未到期的传输重新预约
+    simIrqArmedUs = UINT64_MAX;
+    Sim_I2cIrq();
+    Sim_UartIrq();
+    Sim_HardwareTick();
+    Sim_ScheduleIrq(simHwDueUs);
+}
+
+void Sim_StopStep(void) {
+    const uint64_t now = Sim_NowUs();
+
+    if (now < simHwDueUs) {
+        if (simFastStop) {
+            simSkippedUs += simHwDueUs - now;
+        } else {
+            usleep((useconds_t) (simHwDueUs - now));
+        }
+    }
+    Sim_IrqEnter();
+    Sim_PeripheralIrq();
+    Sim_IrqExit();
+}
+
+int32_t Sim_TickDriftMs(void) {
+    if (simTickBaseMs < 0) {
+        return 0;
+    }
+    return (int32_t) ((int64_t) (Sim_NowUs() / 1000U) - simTickBaseMs - (int64_t) xTaskGetTickCount());
+}
+
+static void SimConsoleTask(void *argument) {
+    (void) argument;
+
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        while (simConsoleTail != simConsoleHead) {
+            const char ch = simConsoleQueue[simConsoleTail % SIM_CONSOLE_QUEUE_SIZE];
+            simConsoleTail++;
+            Sim_HandleConsoleKey(ch);
+        }
+        if (simExitRequested) {
+            Sim_PrintStats();
+            Sim_PrintRunTimeStats();
+            Sim_Exit(0);
+        }
+    }
+}
+
+/**
+ * @brief 启动仿真环境, 由 HAL_Init() 调用
+ */
+void Sim_Start(void) {
+    const char *exitAfter = getenv("SIM_EXIT_AFTER_MS");
+    const char *fastStop = getenv("SIM_FAST_STOP");
+
+    simStartNs = Sim_MonotonicNs();
+    if (exitAfter != NULL) {
+        simExitAfterMs = (uint32_t) strtoul(exitAfter, NULL, 10);
+    }
+    simFastStop = fastStop != NULL && strcmp(fastStop, "0") != 0;
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    Sim_ConsoleInit();
+    Sim_HalInit();
+    Sim_FlashInit();
+
+    xTaskCreate(SimConsoleTask, "SimConsole", configMINIMAL_STACK_SIZE, NULL, SIM_CONSOLE_TASK_PRIORITY,
+                &simConsoleTask);
+
+    // 第一次创建任务时移植层已装好 SIM_IRQ_SIGNAL 的处理函数, 这之后才能创建外设中断定时器
+    Sim_IrqTimerInit();
+    Sim_ScheduleIrq(simHwDueUs);
+}
+
+// ========================== FreeRTOS 钩子 ==========================
+
+void vApplicationIdleHook(void) {
+    // 空闲任务里等下一个节拍或硬件节拍信号, 不让主机 CPU 空转
+    pause();
+}
+
+void vAssertCalled(const char *file, unsigned long line) {
+    fprintf(stderr, "configASSERT failed: %s:%lu\n", file, line);
+    Sim_Exit(1);
+}
+
+void configureTimerForRunTimeStats(void) {
+}
+
+unsigned long getRunTimeCounterValue(void) {
+    return (unsigned long) Sim_NowUs();
+}
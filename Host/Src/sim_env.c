@@ -0,0 +1,53 @@
+/**
+ * @file sim_env.c
+ * @brief 主机仿真的环境数据
+ *
+ * 各物理量按不同周期的正弦变化, 幅度覆盖 EnvSafeRange_Init() 的默认安全范围两侧,
+ * 运行几分钟就能走到越限报警、水泵启停等分支。数据只取决于仿真时间, 多次运行结果可复现。
+ */
+#include "sim.h"
+
+#include <math.h>
+
+#define SIM_PI 3.14159265358979f
+
+static float Sim_EnvWave(float periodSeconds, float phase) {
+    const float t = (float) (Sim_NowUs() / 1000U) / 1000.0f;
+    return sinf(2.0f * SIM_PI * t / periodSeconds + phase);
+}
+
+float Sim_EnvTemperature(void) {
+    return 23.0f + 9.0f * Sim_EnvWave(300.0f, 0.0f);
+}
+
+float Sim_EnvHumidity(void) {
+    return 50.0f + 25.0f * Sim_EnvWave(420.0f, 1.0f);
+}
+
+float Sim_EnvPressure(void) {
+    return 101325.0f + 300.0f * Sim_EnvWave(900.0f, 0.5f);
+}
+
+float Sim_EnvLux(void) {
+    const float lux = 400.0f + 450.0f * Sim_EnvWave(240.0f, -1.0f);
+    return (lux > 0.0f) ? lux : 0.0f;
+}
+
+/**
+ * @brief 土壤湿度 5%~55%, 换算成 SoilMoisture_Get() 的反向 ADC 值
+ */
+uint16_t Sim_EnvSoilAdc(void) {
+    const float moisture = 30.0f + 25.0f * Sim_EnvWave(360.0f, 2.0f);
+    return (uint16_t) ((100.0f - moisture) * 40.0f);
+}
+
+/**
+ * @brief 雨量 0%~40%, 一半时间无雨
+ */
+uint16_t Sim_EnvRainAdc(void) {
+    float rain = 40.0f * Sim_EnvWave(500.0f, 0.0f);
+    if (rain < 0.0f) {
+        rain = 0.0f;
+    }
+    return (uint16_t) (4000.0f - rain * 40.0f);
+}
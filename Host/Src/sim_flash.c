@@ -0,0 +1,132 @@
+/**
+ * @file sim_flash.c
+ * @brief 片内 Flash 数据区的仿真: HAL_FLASH_Program/HAL_FLASHEx_Erase 的替身
+ *
+ * 链接脚本在程序区之后保留的数据区(0x08070000 起到 Flash 末尾)映射到主机进程中相同的地址,
+ * 应用代码可以和目标板上一样直接按地址读取。按 F103 的行为建模:
+ * - 擦除以页(2KB)为单位, 擦除后为 0xFF; 写入以半字为单位, 只能写到已擦除(0xFFFF)的位置或写 0
+ * - 写入/擦除前必须 HAL_FLASH_Unlock(), 否则返回错误
+ * - 写一个半字约 52us, 擦一页约 20ms, 期间调用者忙等(目标板上 CPU 取指暂停)
+ *
+ * 设置环境变量 SIM_FLASH_FILE=文件名 时数据区映射到该文件(MAP_SHARED), 进程被杀掉也不会丢失已写入的数据,
+ * 下次启动接着用, 可以用来模拟任意时刻掉电; 不设置时每次启动都是擦除状态。
+ */
+#include "sim.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// 链接脚本中 FLASH 区之后保留的数据区
+#define SIM_FLASH_DATA_ADDR 0x08070000UL
+#define SIM_FLASH_DATA_SIZE (FLASH_BANK1_END + 1UL - SIM_FLASH_DATA_ADDR)
+
+#define SIM_FLASH_PROGRAM_US 52U
+#define SIM_FLASH_ERASE_US   20000U
+
+static uint8_t *flashData;
+static uint8_t flashUnlocked;
+
+void Sim_FlashInit(void) {
+    const char *path = getenv("SIM_FLASH_FILE");
+    int fd = -1;
+    off_t existing = 0;
+    struct stat st;
+
+    if (path != NULL && path[0] != '\0') {
+        fd = open(path, O_RDWR | O_CREAT, 0644);
+        if (fd < 0 || fstat(fd, &st) != 0) {
+            perror(path);
+            exit(1);
+        }
+        existing = st.st_size < (off_t) SIM_FLASH_DATA_SIZE ? st.st_size : (off_t) SIM_FLASH_DATA_SIZE;
+        if (ftruncate(fd, (off_t) SIM_FLASH_DATA_SIZE) != 0) {
+            perror(path);
+            exit(1);
+        }
+    }
+
+    // 主机程序链接为非 PIE, 代码和数据在 0x400000 附近, 0x08070000 一般是空闲的
+    void *map = mmap((void *) SIM_FLASH_DATA_ADDR, SIM_FLASH_DATA_SIZE, PROT_READ | PROT_WRITE,
+                     MAP_FIXED_NOREPLACE | (fd < 0 ? MAP_PRIVATE | MAP_ANONYMOUS : MAP_SHARED), fd, 0);
+    if (map != (void *) SIM_FLASH_DATA_ADDR) {
+        fprintf(stderr, "sim_flash: cannot map 0x%08lx: %s\n", SIM_FLASH_DATA_ADDR, strerror(errno));
+        exit(1);
+    }
+    flashData = map;
+    // 新建的文件或新扩展的部分视为出厂状态(已擦除)
+    memset(flashData + existing, 0xFF, SIM_FLASH_DATA_SIZE - (size_t) existing);
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+static uint8_t *Sim_FlashAddress(uint32_t address, uint32_t size) {
+    if (flashData == NULL || address < SIM_FLASH_DATA_ADDR ||
+        address + size > SIM_FLASH_DATA_ADDR + SIM_FLASH_DATA_SIZE) {
+        fprintf(stderr, "sim_flash: 0x%08lx is outside the data region\n", (unsigned long) address);
+        return NULL;
+    }
+    return flashData + (address - SIM_FLASH_DATA_ADDR);
+}
+
+HAL_StatusTypeDef HAL_FLASH_Unlock(void) {
+    flashUnlocked = 1;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Lock(void) {
+    flashUnlocked = 0;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint64_t Data) {
+    const uint32_t halfWords = TypeProgram == FLASH_TYPEPROGRAM_HALFWORD ? 1U
+                             : TypeProgram == FLASH_TYPEPROGRAM_WORD     ? 2U : 4U;
+    uint8_t *dest = Sim_FlashAddress(Address, halfWords * 2U);
+
+    if (!flashUnlocked || dest == NULL || (Address & 1U) != 0U) {
+        return HAL_ERROR;
+    }
+    for (uint32_t i = 0; i < halfWords; i++, dest += 2) {
+        const uint16_t value = (uint16_t) (Data >> (16U * i));
+        uint16_t current;
+        memcpy(&current, dest, sizeof(current));
+        // 目标板上写入非擦除状态的半字会置 PGERR, 内容不变(写 0 除外)
+        if (current != 0xFFFFU && value != 0U) {
+            fprintf(stderr, "sim_flash: programming 0x%08lx which is not erased\n",
+                    (unsigned long) (Address + 2U * i));
+            return HAL_ERROR;
+        }
+        Sim_BusyWaitUs(SIM_FLASH_PROGRAM_US);
+        memcpy(dest, &value, sizeof(value));
+        Sim_Stats.flashHalfWords++;
+        Sim_Stats.flashBusyUs += SIM_FLASH_PROGRAM_US;
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef *pEraseInit, uint32_t *PageError) {
+    *PageError = 0xFFFFFFFFU;
+    if (!flashUnlocked || pEraseInit->TypeErase != FLASH_TYPEERASE_PAGES) {
+        return HAL_ERROR;
+    }
+    for (uint32_t i = 0; i < pEraseInit->NbPages; i++) {
+        const uint32_t page = pEraseInit->PageAddress + i * FLASH_PAGE_SIZE;
+        uint8_t *dest = Sim_FlashAddress(page & ~(FLASH_PAGE_SIZE - 1U), FLASH_PAGE_SIZE);
+        if (dest == NULL) {
+            *PageError = page;
+            return HAL_ERROR;
+        }
+        Sim_BusyWaitUs(SIM_FLASH_ERASE_US);
+        memset(dest, 0xFF, FLASH_PAGE_SIZE);
+        Sim_Stats.flashErases++;
+        Sim_Stats.flashBusyUs += SIM_FLASH_ERASE_US;
+    }
+    return HAL_OK;
+}
@@ -0,0 +1,896 @@
+/**
+ * @file sim_hal.c
+ * @brief 主机仿真的 HAL 替身: 时基、RCC/PWR、GPIO/EXTI、TIM、ADC、DMA、RTC
+ *
+ * Core/Src 下 CubeMX 生成的初始化代码(gpio.c、adc.c、tim.c ...)原样参与主机编译,
+ * 它们调用的 HAL_xxx_Init() 在这里只登记状态; 工程运行期用到的接口按目标板的可见行为实现:
+ * - HAL_GetTick()/HAL_Delay(): 与 FreeRTOS 节拍无关的独立时基(目标板上是 TIM2), HAL_Delay 仍是忙等
+ * - GPIO: 读 IDR/写 ODR, IDR 由输出电平、上拉和外部器件(按键、BH1750)共同决定, 下降沿触发 EXTI
+ * - ADC: DMA 循环模式下每个节拍把环境模型的数值写入目标缓冲区
+ * - RTC: 32 位计数器和分频计数器(DIV, LSI 40kHz)随虚拟时钟递增, 计数周期由预分频寄存器(PRL)决定,
+ *   计数到闹钟值时置 ALRF 并唤醒 STOP 模式; STOP 唤醒后 CNT/DIV 保持睡前的值, 直到固件清除 RSF、
+ *   两个 RTCCLK 周期后 RSF 重新置位
+ * - STOP 模式: 由空闲任务的无节拍睡眠进入, 逐个硬件节拍等到 RTC 闹钟或按键唤醒, 唤醒后 HSE/PLL 需重新配置,
+ *   SYSCLK(RCC->CFGR 的 SW 位)回到 HSI; RCC 的 HAL 函数按估计的指令周期数和当前 SYSCLK 忙等
+ * - 唤醒延迟: 从 STOP 返回到恢复 HAL 时基(时钟已恢复), 以及到第一个非空闲任务切入(traceTASK_SWITCHED_IN)
+ */
+#include "sim.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "i2c.h"
+#include "rtc.h"
+#include "usart.h"
+#include "power.h"
+#include "StopModeRtc.h"
+
+// HSE 起振与 PLL 锁定的典型时间, 用于模拟 STOP 唤醒后重新配置时钟的开销
+#define SIM_HSE_STARTUP_US  1500U
+#define SIM_PLL_LOCK_US     200U
+
+// RCC 的 HAL 函数本身的执行时间, 按 HAL 源码估计的指令周期数(含 Flash 2 个等待周期), 在当前 SYSCLK 下忙等
+#define SIM_RCC_OSC_CONFIG_CYCLES    600U
+#define SIM_RCC_CLOCK_CONFIG_CYCLES  1500U // 含 HAL_InitTick 重新初始化 TIM2 时基
+#define SIM_RCC_PERIPH_CONFIG_CYCLES 400U  // 含打开 PWR 时钟、访问备份域
+
+#define SIM_GPIO_PORTS      7U
+
+// GPIO_Init->Mode 中的 EXTI 标志位, 与 stm32f1xx_hal_gpio.c 内部定义一致
+#define EXTI_MODE           0x10000000u
+#define RISING_EDGE         0x00100000u
+#define FALLING_EDGE        0x00200000u
+
+// ========================== 寄存器块 ==========================
+
+GPIO_TypeDef SimGPIO[SIM_GPIO_PORTS];
+AFIO_TypeDef SimAFIO;
+EXTI_TypeDef SimEXTI;
+RCC_TypeDef SimRCC;
+PWR_TypeDef SimPWR;
+RTC_TypeDef SimRTC;
+CoreDebug_Type SimCoreDebug;
+static DWT_Type SimDWT;
+FLASH_TypeDef SimFLASH;
+I2C_TypeDef SimI2C2;
+USART_TypeDef SimUSART1;
+USART_TypeDef SimUSART2;
+TIM_TypeDef SimTIM2;
+TIM_TypeDef SimTIM3;
+TIM_TypeDef SimTIM4;
+ADC_TypeDef SimADC1;
+ADC_TypeDef SimADC2;
+DMA_TypeDef SimDMA1;
+DMA_Channel_TypeDef SimDMA1_Channel[7];
+
+uint32_t SystemCoreClock = 72000000U;
+
+__IO uint32_t uwTick;
+uint32_t uwTickPrio = (1UL << __NVIC_PRIO_BITS);
+HAL_TickFreqTypeDef uwTickFreq = HAL_TICK_FREQ_DEFAULT;
+
+RTC_HandleTypeDef hrtc;
+
+SimStats Sim_Stats;
+
+// ========================== 内部状态 ==========================
+
+static uint16_t gpioExternalLow[SIM_GPIO_PORTS]; // 被外部器件拉低的引脚
+static uint16_t gpioPullDown[SIM_GPIO_PORTS];    // 配置为下拉输入的引脚
+static GPIO_TypeDef *extiPort[16];               // EXTI 线与端口的映射(AFIO_EXTICR)
+
+static struct {
+    GPIO_TypeDef *port;
+    uint16_t pin;
+    uint64_t releaseUs;
+} keyHold[2];
+
+static volatile uint16_t *adcDmaBuffer;
+static uint32_t adcDmaLength;
+
+static uint32_t tickSuspended;
+static uint64_t tickSuspendStartUs;
+static uint64_t tickSuspendedUs;
+
+static uint32_t rtcLastCounter;
+static uint32_t rtcPeriod = LSI_VALUE; // PRL + 1, 修改预分频时从当时的计数值重新起算
+static uint64_t rtcBaseLsi;
+static uint32_t rtcBaseCounter;
+static uint8_t rtcShadowStale;   // STOP 唤醒后影子寄存器还没有重新同步
+static uint64_t rtcSyncStartUs;  // 固件清除 RSF 后开始同步的时刻, 0 表示没有在同步
+static volatile uint32_t stopWakeup;
+static uint64_t hseReadyUs;      // HSE 起振完成的时刻, 0 表示 HSE 关闭
+static uint64_t pllReadyUs;      // PLL 锁定的时刻, 0 表示 PLL 关闭或时钟源还没就绪
+static uint8_t hseFailAfterStop; // SIM_HSE_FAIL: STOP 唤醒后晶振不再起振
+static uint8_t hseBroken;
+static uint64_t stopWokeUs;      // 最近一次 STOP 唤醒的时刻, 0 表示已经计入唤醒延迟
+static uint64_t dwtLastUs;       // CYCCNT 上次推进到的虚拟时刻
+static uint8_t stopClockPending; // 唤醒后还没有恢复 HAL 时基
+
+// ========================== 时基 ==========================
+
+HAL_StatusTypeDef HAL_Init(void) {
+    Sim_Start();
+    HAL_MspInit();
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_InitTick(uint32_t TickPriority) {
+    uwTickPrio = TickPriority;
+    return HAL_OK;
+}
+
+void HAL_IncTick(void) {
+    uwTick += uwTickFreq;
+}
+
+uint32_t HAL_GetTick(void) {
+    uint64_t us = Sim_NowUs();
+    if (tickSuspended) {
+        us = tickSuspendStartUs;
+    }
+    return (uint32_t) ((us - tickSuspendedUs) / 1000U);
+}
+
+void HAL_Delay(uint32_t Delay) {
+    const uint32_t tickstart = HAL_GetTick();
+    uint32_t wait = Delay;
+
+    if (wait < HAL_MAX_DELAY) {
+        wait += (uint32_t) uwTickFreq;
+    }
+    while ((HAL_GetTick() - tickstart) < wait) {
+    }
+}
+
+void HAL_SuspendTick(void) {
+    if (!tickSuspended) {
+        tickSuspended = 1;
+        tickSuspendStartUs = Sim_NowUs();
+    }
+}
+
+void HAL_ResumeTick(void) {
+    if (stopClockPending) {
+        const uint64_t us = Sim_NowUs() - stopWokeUs;
+        Sim_Stats.wakeClockUs += us;
+        Sim_Stats.wakeClockMaxUs = us > Sim_Stats.wakeClockMaxUs ? us : Sim_Stats.wakeClockMaxUs;
+        stopClockPending = 0;
+    }
+    if (tickSuspended) {
+        tickSuspendedUs += Sim_NowUs() - tickSuspendStartUs;
+        tickSuspended = 0;
+    }
+}
+
+// ========================== RCC / PWR / NVIC ==========================
+
+/**
+ * @brief 当前 SYSCLK, 由 SWS 和 CFGR 中的 PLL 配置决定
+ */
+static uint32_t Sim_SysclkHz(void) {
+    switch (SimRCC.CFGR & RCC_CFGR_SWS) {
+    case RCC_CFGR_SWS_PLL: {
+        const uint32_t src = (SimRCC.CFGR & RCC_CFGR_PLLSRC)
+                                 ? HSE_VALUE / ((SimRCC.CFGR & RCC_CFGR_PLLXTPRE) ? 2U : 1U)
+                                 : HSI_VALUE / 2U;
+        return src * (((SimRCC.CFGR & RCC_CFGR_PLLMULL) >> RCC_CFGR_PLLMULL_Pos) + 2U);
+    }
+    case RCC_CFGR_SWS_HSE:
+        return HSE_VALUE;
+    default:
+        return HSI_VALUE;
+    }
+}
+
+static void Sim_RtcSyncStep(uint64_t now);
+
+/**
+ * @brief RCC 时钟树: 按虚拟时钟推进 HSERDY/PLLRDY 和 SWS
+ */
+static void Sim_RccStep(uint64_t now) {
+    if (SimRCC.CR & RCC_CR_HSEON) {
+        if (hseReadyUs == 0U) {
+            hseReadyUs = now + SIM_HSE_STARTUP_US;
+        }
+        if (!hseBroken && now >= hseReadyUs) {
+            SimRCC.CR |= RCC_CR_HSERDY;
+        }
+    } else {
+        hseReadyUs = 0U;
+        SimRCC.CR &= ~RCC_CR_HSERDY;
+    }
+
+    const uint8_t pllSourceReady = !(SimRCC.CFGR & RCC_CFGR_PLLSRC) || (SimRCC.CR & RCC_CR_HSERDY);
+    if ((SimRCC.CR & RCC_CR_PLLON) && pllSourceReady) {
+        if (pllReadyUs == 0U) {
+            pllReadyUs = now + SIM_PLL_LOCK_US;
+        }
+        if (now >= pllReadyUs) {
+            SimRCC.CR |= RCC_CR_PLLRDY;
+        }
+    } else {
+        pllReadyUs = 0U;
+        SimRCC.CR &= ~RCC_CR_PLLRDY;
+    }
+
+    // SWS 跟随 SW: 切换只需几个时钟周期, 仿真中看作瞬时完成; 选中的时钟还没就绪时保持原来的 SYSCLK
+    const uint32_t sw = SimRCC.CFGR & RCC_CFGR_SW;
+    if (sw == RCC_CFGR_SW_HSI || (sw == RCC_CFGR_SW_HSE && (SimRCC.CR & RCC_CR_HSERDY)) ||
+        (sw == RCC_CFGR_SW_PLL && (SimRCC.CR & RCC_CR_PLLRDY))) {
+        MODIFY_REG(SimRCC.CFGR, RCC_CFGR_SWS, sw << RCC_CFGR_SWS_Pos);
+    }
+}
+
+/**
+ * @note 固件等待时钟就绪的循环通过指针读 RCC 寄存器, 但每圈都读 CYCCNT: 时钟树也在这里推进
+ */
+DWT_Type *Sim_Dwt(void) {
+    const uint64_t now = Sim_NowUs();
+    // 先按变化之前的 SYSCLK 推进 CYCCNT
+    if ((SimCoreDebug.DEMCR & CoreDebug_DEMCR_TRCENA_Msk) && (SimDWT.CTRL & DWT_CTRL_CYCCNTENA_Msk)) {
+        SimDWT.CYCCNT += (uint32_t) ((now - dwtLastUs) * Sim_SysclkHz() / 1000000U);
+    }
+    dwtLastUs = now;
+    Sim_RccStep(now);
+    Sim_RtcSyncStep(now);
+    return &SimDWT;
+}
+
+RCC_TypeDef *Sim_Rcc(void) {
+    (void) Sim_Dwt();
+    return &SimRCC;
+}
+
+
+/**
+ * @brief 按当前 SYSCLK 忙等 cycles 个周期
+ */
+static void Sim_RccCost(uint32_t cycles) {
+    Sim_BusyWaitUs((uint32_t) ((uint64_t) cycles * 1000000U / Sim_SysclkHz()));
+}
+
+/**
+ * @brief 等待 CR 中的就绪位, 与 HAL 一样最多等 timeoutMs 毫秒
+ */
+static HAL_StatusTypeDef Sim_RccWaitReady(uint32_t flag, uint32_t timeoutMs) {
+    const uint64_t start = Sim_NowUs();
+    while ((Sim_Rcc()->CR & flag) == 0U) {
+        if (Sim_NowUs() - start > (uint64_t) timeoutMs * 1000U) {
+            return HAL_TIMEOUT;
+        }
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RCC_OscConfig(RCC_OscInitTypeDef *RCC_OscInitStruct) {
+    Sim_RccCost(SIM_RCC_OSC_CONFIG_CYCLES);
+    if ((RCC_OscInitStruct->OscillatorType & RCC_OSCILLATORTYPE_HSE) && RCC_OscInitStruct->HSEState == RCC_HSE_ON) {
+        SimRCC.CR |= RCC_CR_HSEON;
+        if (Sim_RccWaitReady(RCC_CR_HSERDY, HSE_TIMEOUT_VALUE) != HAL_OK) {
+            return HAL_TIMEOUT;
+        }
+    }
+    if (RCC_OscInitStruct->PLL.PLLState == RCC_PLL_ON) {
+        MODIFY_REG(SimRCC.CFGR, RCC_CFGR_PLLSRC | RCC_CFGR_PLLXTPRE | RCC_CFGR_PLLMULL,
+                   RCC_OscInitStruct->PLL.PLLSource | RCC_OscInitStruct->HSEPredivValue |
+                       RCC_OscInitStruct->PLL.PLLMUL);
+        SimRCC.CR |= RCC_CR_PLLON;
+        if (Sim_RccWaitReady(RCC_CR_PLLRDY, PLL_TIMEOUT_VALUE) != HAL_OK) {
+            return HAL_TIMEOUT;
+        }
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RCC_ClockConfig(RCC_ClkInitTypeDef *RCC_ClkInitStruct, uint32_t FLatency) {
+    (void) FLatency;
+    Sim_RccCost(SIM_RCC_CLOCK_CONFIG_CYCLES);
+    Sim_Stats.clockConfigs++;
+    if (RCC_ClkInitStruct->ClockType & RCC_CLOCKTYPE_SYSCLK) {
+        MODIFY_REG(Sim_Rcc()->CFGR, RCC_CFGR_SW, RCC_ClkInitStruct->SYSCLKSource);
+        (void) Sim_Rcc();
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RCCEx_PeriphCLKConfig(RCC_PeriphCLKInitTypeDef *PeriphClkInit) {
+    (void) PeriphClkInit;
+    Sim_RccCost(SIM_RCC_PERIPH_CONFIG_CYCLES);
+    return HAL_OK;
+}
+
+uint32_t HAL_RCC_GetHCLKFreq(void) {
+    return SystemCoreClock;
+}
+
+uint32_t HAL_RCC_GetPCLK1Freq(void) {
+    return SystemCoreClock / 2U;
+}
+
+uint32_t HAL_RCC_GetPCLK2Freq(void) {
+    return SystemCoreClock;
+}
+
+void HAL_PWR_EnableBkUpAccess(void) {
+    SimPWR.CR |= PWR_CR_DBP;
+}
+
+void Sim_StopWakeup(void) {
+    stopWakeup = 1;
+}
+
+/**
+ * @brief 进入 STOP 模式
+ * @note 目标板上此时整颗芯片停止; 主机上由空闲任务在调度器挂起时调用, 本线程自己推进硬件节拍直到唤醒事件
+ */
+void HAL_PWR_EnterSTOPMode(uint32_t Regulator, uint8_t STOPEntry) {
+    const uint64_t start = Sim_NowUs();
+
+    (void) Sim_Dwt();
+    (void) Regulator;
+    (void) STOPEntry;
+
+    Sim_Stats.stopEntries++;
+    if (huart1.gState != HAL_UART_STATE_READY || huart2.gState != HAL_UART_STATE_READY ||
+        hi2c2.State != HAL_I2C_STATE_READY) {
+        Sim_Stats.stopBusy++;
+    }
+    // APB1 停止: RTC 的影子寄存器停在睡前的值, 唤醒后要等固件清除 RSF 重新同步(RSF 仍是睡前的 1)
+    rtcShadowStale = 1;
+    stopWakeup = 0;
+    while (!stopWakeup) {
+        Sim_StopStep();
+    }
+
+    // 唤醒后系统时钟切回 HSI, HSE 与 PLL 都已关闭; PLL 的倍频和来源保留
+    SimRCC.CR &= ~(RCC_CR_HSEON | RCC_CR_HSERDY | RCC_CR_PLLON | RCC_CR_PLLRDY);
+    SimRCC.CFGR &= ~(RCC_CFGR_SW | RCC_CFGR_SWS);
+    hseReadyUs = 0U;
+    pllReadyUs = 0U;
+    hseBroken = hseFailAfterStop;
+    stopWokeUs = Sim_NowUs();
+    dwtLastUs = stopWokeUs; // STOP 期间内核时钟停止, CYCCNT 不计数
+    stopClockPending = 1;
+    Sim_Stats.stopUs += stopWokeUs - start;
+    Sim_Stats.wakeups++;
+}
+
+void Sim_TaskSwitchedIn(void) {
+    if (stopWokeUs != 0U && xTaskGetCurrentTaskHandle() != xTaskGetIdleTaskHandle()) {
+        const uint64_t us = Sim_NowUs() - stopWokeUs;
+        Sim_Stats.wakeTasks++;
+        Sim_Stats.wakeTaskUs += us;
+        Sim_Stats.wakeTaskMaxUs = us > Sim_Stats.wakeTaskMaxUs ? us : Sim_Stats.wakeTaskMaxUs;
+        stopWokeUs = 0;
+    }
+}
+
+void HAL_NVIC_SetPriorityGrouping(uint32_t PriorityGroup) {
+    (void) PriorityGroup;
+}
+
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority) {
+    (void) IRQn;
+    (void) PreemptPriority;
+    (void) SubPriority;
+}
+
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn) {
+    (void) IRQn;
+}
+
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn) {
+    (void) IRQn;
+}
+
+// ========================== GPIO / EXTI ==========================
+
+static uint32_t Sim_GpioIndex(GPIO_TypeDef *port) {
+    return (uint32_t) (port - SimGPIO);
+}
+
+static uint32_t Sim_GpioConfig(GPIO_TypeDef *port, uint32_t pin) {
+    const volatile uint32_t *reg = (pin < 8U) ? &port->CRL : &port->CRH;
+    return (*reg >> ((pin & 7U) * 4U)) & 0xFU;
+}
+
+/**
+ * @brief 计算端口各引脚的实际电平
+ * @param externalLow 被外部器件拉低的引脚
+ */
+static uint16_t Sim_GpioLevels(GPIO_TypeDef *port, uint16_t externalLow) {
+    const uint32_t index = Sim_GpioIndex(port);
+    uint16_t levels = 0;
+
+    for (uint32_t pin = 0; pin < 16U; pin++) {
+        const uint32_t config = Sim_GpioConfig(port, pin);
+        const uint16_t mask = (uint16_t) (1U << pin);
+        uint16_t high;
+
+        if ((config & 0x3U) != 0U) {
+            high = port->ODR & mask;                 // 输出: 由 ODR 决定
+        } else {
+            high = (gpioPullDown[index] & mask) ? 0 : mask; // 输入: 上拉/浮空视为高
+        }
+        if (externalLow & mask) {
+            high = 0;
+        }
+        levels |= high;
+    }
+    return levels;
+}
+
+/**
+ * @brief 重新计算 IDR, 检测 EXTI 边沿
+ */
+static void Sim_GpioRefresh(GPIO_TypeDef *port) {
+    const uint32_t index = Sim_GpioIndex(port);
+    uint16_t oldIdr;
+    uint16_t newIdr;
+    uint16_t falling;
+    uint16_t rising;
+
+    if (port == SDA_GPIO_Port) {
+        // 软件 I2C 上的 BH1750: 先按主机一侧的电平推进协议, 再叠加从机对 SDA 的拉低
+        const uint16_t master = Sim_GpioLevels(port, gpioExternalLow[index] & (uint16_t) ~SDA_Pin);
+        if (Sim_Bh1750_Bus((master & SCL_Pin) != 0U, (master & SDA_Pin) != 0U)) {
+            gpioExternalLow[index] |= SDA_Pin;
+        } else {
+            gpioExternalLow[index] &= (uint16_t) ~SDA_Pin;
+        }
+    }
+
+    oldIdr = (uint16_t) port->IDR;
+    newIdr = Sim_GpioLevels(port, gpioExternalLow[index]);
+    port->IDR = newIdr;
+
+    falling = oldIdr & (uint16_t) ~newIdr;
+    rising = newIdr & (uint16_t) ~oldIdr;
+    for (uint32_t line = 0; line < 16U; line++) {
+        const uint16_t mask = (uint16_t) (1U << line);
+        if (extiPort[line] != port || !(SimEXTI.IMR & mask)) {
+            continue;
+        }
+        if (((falling & mask) && (SimEXTI.FTSR & mask)) || ((rising & mask) && (SimEXTI.RTSR & mask))) {
+            SimEXTI.PR |= mask;
+            stopWakeup = 1;
+            Sim_IrqEnter();
+            HAL_GPIO_EXTI_IRQHandler(mask);
+            Sim_IrqExit();
+        }
+    }
+}
+
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init) {
+    const uint32_t index = Sim_GpioIndex(GPIOx);
+
+    vPortEnterCritical();
+
+    for (uint32_t pin = 0; pin < 16U; pin++) {
+        const uint16_t mask = (uint16_t) (1U << pin);
+        volatile uint32_t *reg = (pin < 8U) ? &GPIOx->CRL : &GPIOx->CRH;
+        const uint32_t shift = (pin & 7U) * 4U;
+        uint32_t config;
+
+        if (!(GPIO_Init->Pin & mask)) {
+            continue;
+        }
+
+        // 按 F1 的 CNF[1:0]MODE[1:0] 编码记录引脚模式
+        switch (GPIO_Init->Mode) {
+            case GPIO_MODE_OUTPUT_PP: config = 0x2U; break;
+            case GPIO_MODE_OUTPUT_OD: config = 0x6U; break;
+            case GPIO_MODE_AF_PP:     config = 0xAU; break;
+            case GPIO_MODE_AF_OD:     config = 0xEU; break;
+            case GPIO_MODE_ANALOG:    config = 0x0U; break;
+            default:
+                config = (GPIO_Init->Pull == GPIO_NOPULL) ? 0x4U : 0x8U;
+                break;
+        }
+        *reg = (*reg & ~(0xFU << shift)) | (config << shift);
+
+        if ((config & 0x3U) == 0U) {
+            if (GPIO_Init->Pull == GPIO_PULLUP) {
+                GPIOx->ODR |= mask;
+                gpioPullDown[index] &= (uint16_t) ~mask;
+            } else if (GPIO_Init->Pull == GPIO_PULLDOWN) {
+                GPIOx->ODR &= ~(uint32_t) mask;
+                gpioPullDown[index] |= mask;
+            } else {
+                gpioPullDown[index] &= (uint16_t) ~mask;
+            }
+        }
+
+        if ((GPIO_Init->Mode & EXTI_MODE) == EXTI_MODE) {
+            extiPort[pin] = GPIOx;
+            SimEXTI.IMR |= mask;
+            if (GPIO_Init->Mode & RISING_EDGE) {
+                SimEXTI.RTSR |= mask;
+            }
+            if (GPIO_Init->Mode & FALLING_EDGE) {
+                SimEXTI.FTSR |= mask;
+            }
+        }
+    }
+    Sim_GpioRefresh(GPIOx);
+    vPortExitCritical();
+}
+
+void HAL_GPIO_DeInit(GPIO_TypeDef *GPIOx, uint32_t GPIO_Pin) {
+    GPIO_InitTypeDef init = {0};
+    init.Pin = GPIO_Pin;
+    init.Mode = GPIO_MODE_INPUT;
+    HAL_GPIO_Init(GPIOx, &init);
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin) {
+    return (GPIOx->IDR & GPIO_Pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState) {
+    // 目标板上经 BSRR 写入是原子的, 这里用临界区保证同样的效果
+    vPortEnterCritical();
+    if (PinState != GPIO_PIN_RESET) {
+        GPIOx->ODR |= GPIO_Pin;
+    } else {
+        GPIOx->ODR &= ~(uint32_t) GPIO_Pin;
+    }
+    Sim_Stats.gpioWrites++;
+    Sim_GpioRefresh(GPIOx);
+    vPortExitCritical();
+}
+
+void HAL_GPIO_TogglePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin) {
+    vPortEnterCritical();
+    GPIOx->ODR ^= GPIO_Pin;
+    Sim_Stats.gpioWrites++;
+    Sim_GpioRefresh(GPIOx);
+    vPortExitCritical();
+}
+
+void HAL_GPIO_EXTI_IRQHandler(uint16_t GPIO_Pin) {
+    if (SimEXTI.PR & GPIO_Pin) {
+        SimEXTI.PR &= ~(uint32_t) GPIO_Pin;
+        HAL_GPIO_EXTI_Callback(GPIO_Pin);
+    }
+}
+
+__weak void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin) {
+    (void) GPIO_Pin;
+}
+
+void Sim_KeyPress(GPIO_TypeDef *port, uint16_t pin, uint32_t holdMs) {
+    const uint32_t slot = (pin == KEY1_Pin) ? 0U : 1U;
+
+    vPortEnterCritical();
+    keyHold[slot].port = port;
+    keyHold[slot].pin = pin;
+    keyHold[slot].releaseUs = Sim_NowUs() + (uint64_t) holdMs * 1000U;
+    gpioExternalLow[Sim_GpioIndex(port)] |= pin;
+    Sim_GpioRefresh(port);
+    vPortExitCritical();
+}
+
+// ========================== TIM ==========================
+
+HAL_StatusTypeDef HAL_TIM_PWM_Init(TIM_HandleTypeDef *htim) {
+    if (htim->State == HAL_TIM_STATE_RESET) {
+        HAL_TIM_PWM_MspInit(htim);
+    }
+    htim->Instance->ARR = htim->Init.Period;
+    htim->Instance->PSC = htim->Init.Prescaler;
+    htim->State = HAL_TIM_STATE_READY;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_ConfigChannel(TIM_HandleTypeDef *htim, const TIM_OC_InitTypeDef *sConfig, uint32_t Channel) {
+    __HAL_TIM_SET_COMPARE(htim, Channel, sConfig->Pulse);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef *htim, uint32_t Channel) {
+    htim->Instance->CCER |= (TIM_CCER_CC1E << (Channel & 0x1FU));
+    htim->Instance->CR1 |= TIM_CR1_CEN;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_Stop(TIM_HandleTypeDef *htim, uint32_t Channel) {
+    htim->Instance->CCER &= ~(TIM_CCER_CC1E << (Channel & 0x1FU));
+    if ((htim->Instance->CCER & 0x1111U) == 0U) {
+        htim->Instance->CR1 &= ~TIM_CR1_CEN;
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_Encoder_Init(TIM_HandleTypeDef *htim, const TIM_Encoder_InitTypeDef *sConfig) {
+    (void) sConfig;
+    if (htim->State == HAL_TIM_STATE_RESET) {
+        HAL_TIM_Encoder_MspInit(htim);
+    }
+    htim->Instance->ARR = htim->Init.Period;
+    htim->State = HAL_TIM_STATE_READY;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_Encoder_Start(TIM_HandleTypeDef *htim, uint32_t Channel) {
+    (void) Channel;
+    htim->Instance->CR1 |= TIM_CR1_CEN;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIMEx_MasterConfigSynchronization(TIM_HandleTypeDef *htim,
+                                                        const TIM_MasterConfigTypeDef *sMasterConfig) {
+    (void) htim;
+    (void) sMasterConfig;
+    return HAL_OK;
+}
+
+void HAL_TIM_IRQHandler(TIM_HandleTypeDef *htim) {
+    (void) htim;
+}
+
+void Sim_KnobRotate(int32_t steps) {
+    vPortEnterCritical();
+    SimTIM4.CNT = (uint32_t) ((int32_t) SimTIM4.CNT + steps) & 0xFFFFU;
+    vPortExitCritical();
+}
+
+// ========================== ADC / DMA ==========================
+
+HAL_StatusTypeDef HAL_ADC_Init(ADC_HandleTypeDef *hadc) {
+    if (hadc->State == HAL_ADC_STATE_RESET) {
+        HAL_ADC_MspInit(hadc);
+    }
+    hadc->State = HAL_ADC_STATE_READY;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADC_ConfigChannel(ADC_HandleTypeDef *hadc, ADC_ChannelConfTypeDef *sConfig) {
+    (void) hadc;
+    (void) sConfig;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADC_Start_DMA(ADC_HandleTypeDef *hadc, uint32_t *pData, uint32_t Length) {
+    // adc.c 中 DMA 按半字搬运, 循环模式
+    adcDmaBuffer = (volatile uint16_t *) pData;
+    adcDmaLength = Length;
+    hadc->Instance->CR2 |= ADC_CR2_ADON | ADC_CR2_DMA;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma) {
+    hdma->State = HAL_DMA_STATE_READY;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_DeInit(DMA_HandleTypeDef *hdma) {
+    hdma->State = HAL_DMA_STATE_RESET;
+    return HAL_OK;
+}
+
+// ========================== RTC ==========================
+
+static uint64_t Sim_RtcLsi(uint64_t now) {
+    return now * LSI_VALUE / 1000000U;
+}
+
+static uint32_t Sim_RtcCounter(uint64_t now) {
+    return rtcBaseCounter + (uint32_t) ((Sim_RtcLsi(now) - rtcBaseLsi) / rtcPeriod);
+}
+
+/**
+ * @brief 分频计数器: 每个计数从 PRL 递减到 0
+ */
+static uint32_t Sim_RtcDivider(uint64_t now) {
+    return rtcPeriod - 1U - (uint32_t) ((Sim_RtcLsi(now) - rtcBaseLsi) % rtcPeriod);
+}
+
+/**
+ * @brief 把计数器和分频计数器同步到 APB1 一侧的寄存器
+ */
+static void Sim_RtcShadow(uint64_t now) {
+    const uint32_t counter = Sim_RtcCounter(now);
+    const uint32_t divider = Sim_RtcDivider(now);
+    SimRTC.CNTL = counter & 0xFFFFU;
+    SimRTC.CNTH = counter >> 16;
+    SimRTC.DIVL = divider & 0xFFFFU;
+    SimRTC.DIVH = divider >> 16;
+}
+
+/**
+ * @brief 固件修改了预分频寄存器: 从当前计数值起按新的周期计数
+ */
+static void Sim_RtcPrescaler(uint64_t now) {
+    const uint32_t period = (((SimRTC.PRLH & RTC_PRLH_PRL) << 16) | SimRTC.PRLL) + 1U;
+    if (period != rtcPeriod) {
+        rtcBaseCounter = Sim_RtcCounter(now);
+        rtcBaseLsi = Sim_RtcLsi(now);
+        rtcPeriod = period;
+    }
+}
+
+void MX_RTC_Init(void) {
+    hrtc.Instance = RTC;
+    hrtc.Init.AsynchPrediv = RTC_AUTO_1_SECOND;
+    hrtc.Init.OutPut = RTC_OUTPUTSOURCE_NONE;
+    if (HAL_RTC_Init(&hrtc) != HAL_OK) {
+        Error_Handler();
+    }
+}
+
+HAL_StatusTypeDef HAL_RTC_Init(RTC_HandleTypeDef *hrtc) {
+    // RTC_AUTO_1_SECOND: 按 LSI 频率分频, 每秒计数一次
+    hrtc->Instance->PRLH = (LSI_VALUE - 1U) >> 16;
+    hrtc->Instance->PRLL = (LSI_VALUE - 1U) & 0xFFFFU;
+    hrtc->Instance->CRL = RTC_CRL_RTOFF | RTC_CRL_RSF;
+    hrtc->State = HAL_RTC_STATE_READY;
+    return HAL_OK;
+}
+
+/**
+ * @brief 固件清除 RSF 两个 RTCCLK 周期后影子寄存器重新同步, RSF 置位
+ * @note 固件等待 RSF 的循环每圈都读 CYCCNT, 关中断时也在这里推进
+ */
+static void Sim_RtcSyncStep(uint64_t now) {
+    if (SimRTC.CRL & RTC_CRL_RSF) {
+        rtcSyncStartUs = 0U;
+        return;
+    }
+    if (rtcSyncStartUs == 0U) {
+        rtcSyncStartUs = now;
+    } else if (now - rtcSyncStartUs >= 2U * 1000000U / LSI_VALUE) {
+        Sim_RtcShadow(now);
+        SimRTC.CRL |= RTC_CRL_RSF;
+        rtcShadowStale = 0;
+        rtcSyncStartUs = 0U;
+    }
+}
+
+/**
+ * @brief 清除 RSF, 等两个 RTCCLK 周期后影子寄存器重新同步
+ */
+HAL_StatusTypeDef HAL_RTC_WaitForSynchro(RTC_HandleTypeDef *hrtc) {
+    hrtc->Instance->CRL &= ~RTC_CRL_RSF;
+    Sim_BusyWaitUs(2U * 1000000U / LSI_VALUE);
+    Sim_RtcShadow(Sim_NowUs());
+    hrtc->Instance->CRL |= RTC_CRL_RSF;
+    rtcShadowStale = 0;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RTC_SetTime(RTC_HandleTypeDef *hrtc, RTC_TimeTypeDef *sTime, uint32_t Format) {
+    (void) hrtc;
+    (void) sTime;
+    (void) Format;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RTC_GetTime(RTC_HandleTypeDef *hrtc, RTC_TimeTypeDef *sTime, uint32_t Format) {
+    const uint32_t counter = hrtc->Instance->CNTL | (hrtc->Instance->CNTH << 16);
+    (void) Format;
+    sTime->Hours = (uint8_t) ((counter / 3600U) % 24U);
+    sTime->Minutes = (uint8_t) ((counter / 60U) % 60U);
+    sTime->Seconds = (uint8_t) (counter % 60U);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RTC_SetDate(RTC_HandleTypeDef *hrtc, RTC_DateTypeDef *sDate, uint32_t Format) {
+    (void) Format;
+    hrtc->DateToUpdate = *sDate;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RTC_GetDate(RTC_HandleTypeDef *hrtc, RTC_DateTypeDef *sDate, uint32_t Format) {
+    (void) Format;
+    *sDate = hrtc->DateToUpdate;
+    return HAL_OK;
+}
+
+/**
+ * @brief 推进 RTC 计数器, 计数到闹钟值时置位 ALRF 并通过 EXTI17 唤醒
+ */
+static void Sim_RtcTick(void) {
+    const uint64_t now = Sim_NowUs();
+    Sim_RtcPrescaler(now);
+    const uint32_t counter = Sim_RtcCounter(now);
+    const uint32_t alarm = SimRTC.ALRL | (SimRTC.ALRH << 16);
+
+    // STOP 唤醒后重新同步之前 APB1 一侧的影子寄存器不更新, 固件必须先清除 RSF 并等它置位
+    Sim_RtcSyncStep(now);
+    if ((SimRTC.CRL & RTC_CRL_RSF) && !rtcShadowStale) {
+        Sim_RtcShadow(now);
+    }
+    SimRTC.CRL |= RTC_CRL_RTOFF | RTC_CRL_SECF;
+
+    if (rtcLastCounter < alarm && counter >= alarm) {
+        SimRTC.CRL |= RTC_CRL_ALRF;
+        if ((SimRTC.CRH & RTC_CRH_ALRIE) && (SimEXTI.IMR & RTC_EXTI_LINE_ALARM_EVENT)) {
+            SimEXTI.PR |= RTC_EXTI_LINE_ALARM_EVENT;
+            Sim_StopWakeup();
+        }
+    }
+    rtcLastCounter = counter;
+}
+
+// ========================== 仿真入口 ==========================
+
+void Sim_HalInit(void) {
+    memset(SimGPIO, 0, sizeof(SimGPIO));
+    for (uint32_t i = 0; i < SIM_GPIO_PORTS; i++) {
+        // 复位后所有引脚为浮空输入(CNF=01, MODE=00)
+        SimGPIO[i].CRL = 0x44444444U;
+        SimGPIO[i].CRH = 0x44444444U;
+        SimGPIO[i].IDR = 0xFFFFU;
+    }
+    SimRTC.CRL = RTC_CRL_RTOFF;
+    SimTIM4.CNT = 0;
+    // 复位后 HSI 打开并作为 SYSCLK
+    SimRCC.CR = RCC_CR_HSION | RCC_CR_HSIRDY;
+
+    const char *hseFail = getenv("SIM_HSE_FAIL");
+    hseFailAfterStop = hseFail != NULL && strcmp(hseFail, "0") != 0;
+}
+
+/**
+ * @brief 每个硬件节拍(1ms)在仿真中断上下文中调用一次
+ */
+void Sim_HalTick(void) {
+    const uint64_t now = Sim_NowUs();
+
+    for (uint32_t i = 0; i < 2U; i++) {
+        if (keyHold[i].port != NULL && now >= keyHold[i].releaseUs) {
+            gpioExternalLow[Sim_GpioIndex(keyHold[i].port)] &= (uint16_t) ~keyHold[i].pin;
+            Sim_GpioRefresh(keyHold[i].port);
+            keyHold[i].port = NULL;
+        }
+    }
+
+    if (adcDmaBuffer != NULL && adcDmaLength >= 2U) {
+        // 规则组顺序见 adc.c: Rank1 = CH12(土壤湿度), Rank2 = CH11(雨量)
+        adcDmaBuffer[0] = Sim_EnvSoilAdc();
+        adcDmaBuffer[1] = Sim_EnvRainAdc();
+    }
+
+    Sim_RtcTick();
+}
+
+void Sim_PrintStats(void) {
+    StopMode_WakeStats wake;
+    StopMode_GetWakeStats(&wake);
+
+    printf("---- sim stats @ %lu ms ----\n", (unsigned long) (Sim_NowUs() / 1000U));
+    printf("STOP   : %lu entries, %lu ms asleep, %lu clock configs, %lu entered with a transfer in flight\n",
+           (unsigned long) Sim_Stats.stopEntries, (unsigned long) (Sim_Stats.stopUs / 1000U),
+           (unsigned long) Sim_Stats.clockConfigs, (unsigned long) Sim_Stats.stopBusy);
+    printf("WAKE   : clocks restored in %lu us avg / %lu us max; a task ran after %lu of %lu wakeups, "
+           "%lu us avg / %lu us max\n",
+           (unsigned long) (Sim_Stats.wakeups ? Sim_Stats.wakeClockUs / Sim_Stats.wakeups : 0U),
+           (unsigned long) Sim_Stats.wakeClockMaxUs, (unsigned long) Sim_Stats.wakeTasks,
+           (unsigned long) Sim_Stats.wakeups,
+           (unsigned long) (Sim_Stats.wakeTasks ? Sim_Stats.wakeTaskUs / Sim_Stats.wakeTasks : 0U),
+           (unsigned long) Sim_Stats.wakeTaskMaxUs);
+    printf("DWT    : firmware measured %lu wakeups to the first task, %lu us avg / %lu us max / %lu us last; %s\n",
+           (unsigned long) wake.count, (unsigned long) (wake.count ? wake.totalUs / wake.count : 0U),
+           (unsigned long) wake.maxUs, (unsigned long) wake.lastUs,
+           wake.hseFailed ? "HSE timed out, running on HSI" : "HSE/PLL restored");
+    printf("POWER  : %lu idle notifications could not be deferred to the timer task\n",
+           (unsigned long) Power_GetPendFailures());
+    printf("TICK   : %lu kernel ticks, %ld ms behind the sim clock\n", (unsigned long) xTaskGetTickCount(),
+           (long) Sim_TickDriftMs());
+    printf("USART1 : %lu bytes, %lu us blocking, %lu DMA starts\n", (unsigned long) Sim_Stats.uartTxBytes[0],
+           (unsigned long) Sim_Stats.uartBusyUs[0], (unsigned long) Sim_Stats.uartDmaStarts[0]);
+    printf("USART2 : %lu bytes, %lu us blocking, %lu DMA starts\n", (unsigned long) Sim_Stats.uartTxBytes[1],
+           (unsigned long) Sim_Stats.uartBusyUs[1], (unsigned long) Sim_Stats.uartDmaStarts[1]);
+    printf("GPIO   : %lu writes\n", (unsigned long) Sim_Stats.gpioWrites);
+    printf("FLASH  : %lu page erases, %lu half-words, %lu us stalled\n", (unsigned long) Sim_Stats.flashErases,
+           (unsigned long) Sim_Stats.flashHalfWords, (unsigned long) Sim_Stats.flashBusyUs);
+    printf("Heap   : %lu free, %lu min ever free\n", (unsigned long) xPortGetFreeHeapSize(),
+           (unsigned long) xPortGetMinimumEverFreeHeapSize());
+    Sim_I2cPrintStats();
+    Sim_OledPrintStats();
+}
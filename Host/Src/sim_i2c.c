@@ -0,0 +1,420 @@
+/**
+ * @file sim_i2c.c
+ * @brief 主机仿真的硬件 I2C(hi2c2) HAL 接口
+ *
+ * 按从机地址把传输分发给 sim.h 中的 I2C 从机模型, 并按 hi2c->Init.ClockSpeed 模拟线上耗时:
+ * 每字节 9 个时钟(8 位数据 + ACK), 每个起始/停止条件约 1 个时钟。
+ * - 阻塞式接口: 目标板上 HAL 在传输期间一直轮询标志位, 这里同样在调用任务中忙等, 期间句柄状态为 BUSY
+ * - 中断式接口(_IT): 立即返回, 线上时间结束后由仿真外设中断调用完成/错误回调, 读到的数据在完成时才写入缓冲区;
+ *   与目标板一样, 从机不应答时函数本身返回 HAL_OK, 错误通过 HAL_I2C_ErrorCallback() 报告
+ * - 顺序发送(HAL_I2C_Master_Seq_Transmit_IT): 各段先缓存, 到 I2C_LAST_FRAME 时作为一次写传输交给从机
+ */
+#include "sim.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define SIM_I2C_BITS_PER_BYTE   9U
+#define SIM_I2C_BITS_PER_START  1U
+
+static SimI2cDevice *const simI2cDevices[] = {
+    &Sim_Aht20Device,
+    &Sim_Bmp280Device,
+    &Sim_OledDevice,
+};
+
+static struct {
+    uint32_t transfers;
+    uint32_t nacks;
+    uint32_t busyRejects;
+    uint64_t busyUs;
+} simI2cBus;
+
+static SimI2cDevice *Sim_I2cFind(uint16_t address) {
+    for (uint32_t i = 0; i < sizeof(simI2cDevices) / sizeof(simI2cDevices[0]); i++) {
+        if (simI2cDevices[i]->address == (address & 0xFEU)) {
+            return simI2cDevices[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief 计算一次传输在总线上占用的时间
+ * @param bytes 线上字节数(含地址字节)
+ * @param starts 起始条件个数(含重复起始)
+ */
+static uint32_t Sim_I2cWireUs(const I2C_HandleTypeDef *hi2c, uint32_t bytes, uint32_t starts) {
+    const uint32_t clock = (hi2c->Init.ClockSpeed != 0U) ? hi2c->Init.ClockSpeed : 100000U;
+    const uint64_t bits = (uint64_t) bytes * SIM_I2C_BITS_PER_BYTE + (uint64_t) (starts + 1U) * SIM_I2C_BITS_PER_START;
+    return (uint32_t) ((bits * 1000000U + clock - 1U) / clock);
+}
+
+/**
+ * @brief 占用总线, 与 HAL 中 __HAL_LOCK + 状态检查的效果一致
+ */
+static HAL_StatusTypeDef Sim_I2cAcquire(I2C_HandleTypeDef *hi2c, HAL_I2C_StateTypeDef state) {
+    HAL_StatusTypeDef status = HAL_OK;
+
+    vPortEnterCritical();
+    if (hi2c->State != HAL_I2C_STATE_READY) {
+        simI2cBus.busyRejects++;
+        status = HAL_BUSY;
+    } else {
+        hi2c->State = state;
+        hi2c->ErrorCode = HAL_I2C_ERROR_NONE;
+    }
+    vPortExitCritical();
+    return status;
+}
+
+static void Sim_I2cAccount(I2C_HandleTypeDef *hi2c, SimI2cDevice *device, uint32_t bytes, uint32_t wireUs,
+                           uint32_t starts) {
+    // 顺序传输的后续段不产生起始条件, 与前面的段算作同一次传输
+    const uint32_t transfers = (starts != 0U) ? 1U : 0U;
+
+    simI2cBus.transfers += transfers;
+    simI2cBus.busyUs += wireUs;
+    if (device != NULL) {
+        device->transfers += transfers;
+        device->bytes += bytes;
+        device->busyUs += wireUs;
+    } else {
+        simI2cBus.nacks++;
+        hi2c->ErrorCode = HAL_I2C_ERROR_AF;
+    }
+}
+
+/**
+ * @brief 模拟线上传输并释放总线(阻塞式接口)
+ */
+static HAL_StatusTypeDef Sim_I2cFinish(I2C_HandleTypeDef *hi2c, SimI2cDevice *device, uint32_t bytes,
+                                       uint32_t starts) {
+    const uint32_t wireUs = Sim_I2cWireUs(hi2c, (device != NULL) ? bytes : 1U, starts);
+
+    Sim_BusyWaitUs(wireUs);
+    Sim_I2cAccount(hi2c, device, bytes, wireUs, starts);
+
+    hi2c->State = HAL_I2C_STATE_READY;
+    return (device != NULL) ? HAL_OK : HAL_ERROR;
+}
+
+HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef *hi2c) {
+    if (hi2c->State == HAL_I2C_STATE_RESET) {
+        hi2c->Lock = HAL_UNLOCKED;
+        HAL_I2C_MspInit(hi2c);
+    }
+    hi2c->ErrorCode = HAL_I2C_ERROR_NONE;
+    hi2c->State = HAL_I2C_STATE_READY;
+    hi2c->Mode = HAL_I2C_MODE_NONE;
+    return HAL_OK;
+}
+
+HAL_I2C_StateTypeDef HAL_I2C_GetState(I2C_HandleTypeDef *hi2c) {
+    return hi2c->State;
+}
+
+uint32_t HAL_I2C_GetError(I2C_HandleTypeDef *hi2c) {
+    return hi2c->ErrorCode;
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Transmit(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData,
+                                          uint16_t Size, uint32_t Timeout) {
+    SimI2cDevice *device;
+    (void) Timeout;
+
+    if (Sim_I2cAcquire(hi2c, HAL_I2C_STATE_BUSY_TX) != HAL_OK) {
+        return HAL_BUSY;
+    }
+    device = Sim_I2cFind(DevAddress);
+    if (device != NULL) {
+        device->write(pData, Size);
+    }
+    return Sim_I2cFinish(hi2c, device, 1U + Size, 1U);
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Receive(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData,
+                                         uint16_t Size, uint32_t Timeout) {
+    SimI2cDevice *device;
+    (void) Timeout;
+
+    if (Sim_I2cAcquire(hi2c, HAL_I2C_STATE_BUSY_RX) != HAL_OK) {
+        return HAL_BUSY;
+    }
+    device = Sim_I2cFind(DevAddress);
+    if (device != NULL) {
+        device->read(pData, Size);
+    }
+    return Sim_I2cFinish(hi2c, device, 1U + Size, 1U);
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+                                    uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout) {
+    SimI2cDevice *device;
+    (void) Timeout;
+
+    if (Sim_I2cAcquire(hi2c, HAL_I2C_STATE_BUSY_TX) != HAL_OK) {
+        return HAL_BUSY;
+    }
+    device = Sim_I2cFind(DevAddress);
+    if (device != NULL) {
+        // 寄存器地址与数据在线上是同一次写传输
+        uint8_t buffer[2U + Size];
+        uint16_t offset = 0;
+        if (MemAddSize == I2C_MEMADD_SIZE_16BIT) {
+            buffer[offset++] = (uint8_t) (MemAddress >> 8);
+        }
+        buffer[offset++] = (uint8_t) MemAddress;
+        memcpy(&buffer[offset], pData, Size);
+        device->write(buffer, (uint16_t) (offset + Size));
+    }
+    return Sim_I2cFinish(hi2c, device, 1U + MemAddSize + Size, 1U);
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+                                   uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout) {
+    SimI2cDevice *device;
+    (void) Timeout;
+
+    if (Sim_I2cAcquire(hi2c, HAL_I2C_STATE_BUSY_RX) != HAL_OK) {
+        return HAL_BUSY;
+    }
+    device = Sim_I2cFind(DevAddress);
+    if (device != NULL) {
+        uint8_t address[2];
+        uint16_t length = 0;
+        if (MemAddSize == I2C_MEMADD_SIZE_16BIT) {
+            address[length++] = (uint8_t) (MemAddress >> 8);
+        }
+        address[length++] = (uint8_t) MemAddress;
+        device->write(address, length);
+        device->read(pData, Size);
+    }
+    // 写寄存器地址 + 重复起始 + 读数据, 两个地址字节
+    return Sim_I2cFinish(hi2c, device, 2U + MemAddSize + Size, 2U);
+}
+
+// ========================== 中断式接口 ==========================
+
+typedef enum {
+    SIM_I2C_MASTER_TX = 0,
+    SIM_I2C_MASTER_RX,
+    SIM_I2C_MEM_TX,
+    SIM_I2C_MEM_RX,
+} SimI2cItKind;
+
+// 正在进行的中断式传输, 每个句柄同一时刻最多一个
+static struct {
+    I2C_HandleTypeDef *hi2c;
+    SimI2cDevice *device;
+    SimI2cItKind kind;
+    uint8_t *rxData;
+    uint16_t rxLen;
+    uint32_t bytes;
+    uint32_t starts;
+    uint32_t wireUs;
+    uint64_t doneUs;
+} simI2cIt;
+
+// 顺序传输(HAL_I2C_Master_Seq_Transmit_IT)中尚未产生停止条件的部分, 停止时整体交给从机
+#define SIM_I2C_SEQ_MAX 256U
+
+static struct {
+    SimI2cDevice *device;
+    uint8_t buffer[SIM_I2C_SEQ_MAX];
+    uint16_t len;
+    uint8_t open;
+} simI2cSeq;
+
+static void Sim_I2cScheduleIt(I2C_HandleTypeDef *hi2c, SimI2cDevice *device, SimI2cItKind kind, uint8_t *rxData,
+                              uint16_t rxLen, uint32_t bytes, uint32_t starts) {
+    vPortEnterCritical();
+    simI2cIt.hi2c = hi2c;
+    simI2cIt.device = device;
+    simI2cIt.kind = kind;
+    simI2cIt.rxData = rxData;
+    simI2cIt.rxLen = rxLen;
+    simI2cIt.bytes = bytes;
+    simI2cIt.starts = starts;
+    simI2cIt.wireUs = Sim_I2cWireUs(hi2c, (device != NULL) ? bytes : 1U, starts);
+    simI2cIt.doneUs = Sim_NowUs() + simI2cIt.wireUs;
+    Sim_ScheduleIrq(simI2cIt.doneUs);
+    vPortExitCritical();
+}
+
+static HAL_StatusTypeDef Sim_I2cStartIt(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, SimI2cItKind kind,
+                                        uint16_t MemAddress, uint16_t MemAddSize, uint8_t *pData, uint16_t Size) {
+    const int isRead = (kind == SIM_I2C_MASTER_RX || kind == SIM_I2C_MEM_RX);
+    const int isMem = (kind == SIM_I2C_MEM_TX || kind == SIM_I2C_MEM_RX);
+    SimI2cDevice *device;
+    uint32_t bytes;
+    uint32_t starts;
+
+    if (pData == NULL || Size == 0U) {
+        return HAL_ERROR;
+    }
+    if (Sim_I2cAcquire(hi2c, isRead ? HAL_I2C_STATE_BUSY_RX : HAL_I2C_STATE_BUSY_TX) != HAL_OK) {
+        return HAL_BUSY;
+    }
+    hi2c->Mode = isMem ? HAL_I2C_MODE_MEM : HAL_I2C_MODE_MASTER;
+
+    // 写方向的数据在启动时交给从机, 读方向的数据在完成时才从从机取出
+    device = Sim_I2cFind(DevAddress);
+    if (device != NULL && isMem) {
+        uint8_t buffer[2U + Size];
+        uint16_t offset = 0;
+        if (MemAddSize == I2C_MEMADD_SIZE_16BIT) {
+            buffer[offset++] = (uint8_t) (MemAddress >> 8);
+        }
+        buffer[offset++] = (uint8_t) MemAddress;
+        if (!isRead) {
+            memcpy(&buffer[offset], pData, Size);
+        }
+        device->write(buffer, (uint16_t) (offset + (isRead ? 0U : Size)));
+    } else if (device != NULL && !isRead) {
+        device->write(pData, Size);
+    }
+
+    bytes = 1U + Size + (isMem ? MemAddSize : 0U) + (kind == SIM_I2C_MEM_RX ? 1U : 0U);
+    starts = (kind == SIM_I2C_MEM_RX) ? 2U : 1U;
+
+    Sim_I2cScheduleIt(hi2c, device, kind, isRead ? pData : NULL, Size, bytes, starts);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Transmit_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData,
+                                             uint16_t Size) {
+    return Sim_I2cStartIt(hi2c, DevAddress, SIM_I2C_MASTER_TX, 0, 0, pData, Size);
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Receive_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData,
+                                            uint16_t Size) {
+    return Sim_I2cStartIt(hi2c, DevAddress, SIM_I2C_MASTER_RX, 0, 0, pData, Size);
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+                                       uint16_t MemAddSize, uint8_t *pData, uint16_t Size) {
+    return Sim_I2cStartIt(hi2c, DevAddress, SIM_I2C_MEM_TX, MemAddress, MemAddSize, pData, Size);
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+                                      uint16_t MemAddSize, uint8_t *pData, uint16_t Size) {
+    return Sim_I2cStartIt(hi2c, DevAddress, SIM_I2C_MEM_RX, MemAddress, MemAddSize, pData, Size);
+}
+
+/**
+ * @brief 顺序发送: I2C_FIRST_FRAME 产生起始条件, I2C_LAST_FRAME 产生停止条件, 中间各段在总线上连续发送
+ * @note 只支持本工程用到的写方向
+ */
+HAL_StatusTypeDef HAL_I2C_Master_Seq_Transmit_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData,
+                                                 uint16_t Size, uint32_t XferOptions) {
+    const int first = (XferOptions == I2C_FIRST_FRAME || XferOptions == I2C_FIRST_AND_LAST_FRAME ||
+                       XferOptions == I2C_FIRST_AND_NEXT_FRAME || !simI2cSeq.open);
+    const int last = (XferOptions == I2C_LAST_FRAME || XferOptions == I2C_FIRST_AND_LAST_FRAME);
+    uint32_t bytes = Size;
+
+    if (pData == NULL || Size == 0U) {
+        return HAL_ERROR;
+    }
+    if (Sim_I2cAcquire(hi2c, HAL_I2C_STATE_BUSY_TX) != HAL_OK) {
+        return HAL_BUSY;
+    }
+    hi2c->Mode = HAL_I2C_MODE_MASTER;
+
+    if (first) {
+        simI2cSeq.device = Sim_I2cFind(DevAddress);
+        simI2cSeq.len = 0;
+        simI2cSeq.open = 1;
+        bytes += 1U; // 地址字节
+    }
+    for (uint16_t i = 0; i < Size && simI2cSeq.len < SIM_I2C_SEQ_MAX; i++) {
+        simI2cSeq.buffer[simI2cSeq.len++] = pData[i];
+    }
+    if (last) {
+        if (simI2cSeq.device != NULL) {
+            simI2cSeq.device->write(simI2cSeq.buffer, simI2cSeq.len);
+        }
+        simI2cSeq.open = 0;
+    }
+
+    Sim_I2cScheduleIt(hi2c, simI2cSeq.device, SIM_I2C_MASTER_TX, NULL, Size, bytes, first ? 1U : 0U);
+    return HAL_OK;
+}
+
+__weak void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef *hi2c) {
+    (void) hi2c;
+}
+
+__weak void HAL_I2C_MasterRxCpltCallback(I2C_HandleTypeDef *hi2c) {
+    (void) hi2c;
+}
+
+__weak void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c) {
+    (void) hi2c;
+}
+
+__weak void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c) {
+    (void) hi2c;
+}
+
+__weak void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c) {
+    (void) hi2c;
+}
+
+/**
+ * @brief 在仿真外设中断中完成到期的中断式传输
+ */
+void Sim_I2cIrq(void) {
+    I2C_HandleTypeDef *hi2c = simI2cIt.hi2c;
+    SimI2cDevice *device = simI2cIt.device;
+
+    if (hi2c == NULL) {
+        return;
+    }
+    if (Sim_NowUs() < simI2cIt.doneUs) {
+        Sim_ScheduleIrq(simI2cIt.doneUs);
+        return;
+    }
+
+    simI2cIt.hi2c = NULL;
+    if (device != NULL && simI2cIt.rxData != NULL) {
+        device->read(simI2cIt.rxData, simI2cIt.rxLen);
+    }
+    Sim_I2cAccount(hi2c, device, simI2cIt.bytes, simI2cIt.wireUs, simI2cIt.starts);
+
+    // 与 HAL 一致: 先释放句柄再调用回调, 回调里可以直接启动下一次传输
+    hi2c->State = HAL_I2C_STATE_READY;
+    hi2c->Mode = HAL_I2C_MODE_NONE;
+    if (device == NULL) {
+        HAL_I2C_ErrorCallback(hi2c);
+        return;
+    }
+    switch (simI2cIt.kind) {
+        case SIM_I2C_MASTER_TX:
+            HAL_I2C_MasterTxCpltCallback(hi2c);
+            break;
+        case SIM_I2C_MASTER_RX:
+            HAL_I2C_MasterRxCpltCallback(hi2c);
+            break;
+        case SIM_I2C_MEM_TX:
+            HAL_I2C_MemTxCpltCallback(hi2c);
+            break;
+        case SIM_I2C_MEM_RX:
+            HAL_I2C_MemRxCpltCallback(hi2c);
+            break;
+    }
+}
+
+void Sim_I2cPrintStats(void) {
+    printf("I2C2   : %lu transfers, %lu us on bus, %lu NACK, %lu busy rejects\n",
+           (unsigned long) simI2cBus.transfers, (unsigned long) simI2cBus.busyUs, (unsigned long) simI2cBus.nacks,
+           (unsigned long) simI2cBus.busyRejects);
+    for (uint32_t i = 0; i < sizeof(simI2cDevices) / sizeof(simI2cDevices[0]); i++) {
+        const SimI2cDevice *device = simI2cDevices[i];
+        printf("  %-7s: %lu transfers, %lu bytes, %lu us\n", device->name, (unsigned long) device->transfers,
+               (unsigned long) device->bytes, (unsigned long) device->busyUs);
+    }
+}
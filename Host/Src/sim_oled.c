@@ -0,0 +1,184 @@
+/**
+ * @file sim_oled.c
+ * @brief 主机仿真的 CH1116 OLED 控制器(I2C 地址 0x78)
+ *
+ * - 控制字节 0x00 后为命令流, 带参数的命令可以拆在多次传输里发送(OLED_SendCmd() 就是这样做的)
+ * - 控制字节 0x40 后为显存数据, 按页寻址模式写入当前页, 列地址自动递增
+ * - 控制字节 0x80/0xC0(Co=1)后只跟 1 个命令/数据字节, 驱动用它在同一次传输里先设置页和列地址再写数据
+ * - 显存为 8 页 x 132 列, 屏幕可见部分从第 2 列开始共 128 列
+ * - 按应用当前显示的页面(pageIndex)统计每帧在总线上传输的字节数, 帧数取自驱动的 OLED_Stats
+ */
+#include "sim.h"
+
+#include <stdio.h>
+
+#include "oled.h"
+#include "screen.h"
+
+#define OLED_PAGES            8U
+#define OLED_RAM_COLUMNS      132U
+#define OLED_VISIBLE_OFFSET   2U
+#define OLED_VISIBLE_COLUMNS  128U
+#define OLED_CONTROL_CO       0x80U // 控制字节 bit7: 后面只跟 1 个字节, 之后还是控制字节
+#define OLED_CONTROL_DATA     0x40U // 控制字节 bit6: 0 为命令, 1 为显存数据
+
+static uint8_t oledRam[OLED_PAGES][OLED_RAM_COLUMNS];
+static uint8_t oledPage;
+static uint8_t oledColumn;
+static uint8_t oledPendingArg; // 正在等待参数的命令, 0 表示没有
+static uint8_t oledDisplayOn;
+static uint8_t oledReversed;
+static uint32_t oledPageWrites;
+
+// 按界面页面统计
+static struct {
+    uint32_t frames;
+    uint32_t skipped;
+    uint64_t bytes; // 含地址字节
+} oledScreenStats[PAGE_End];
+static uint32_t oledLastFrames;
+static uint32_t oledLastSkipped;
+
+static const char *const oledScreenNames[PAGE_End] = {
+    "HOME1", "HOME2", "RANGE", "HISTORY", "HIST_RAIN", "HIST_LIGHT",
+};
+
+/**
+ * @brief 判断命令是否带 1 字节参数
+ */
+static int Sim_OledHasArg(uint8_t cmd) {
+    switch (cmd) {
+        case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xAD:
+        case 0xD3: case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static void Sim_OledCommand(uint8_t cmd) {
+    if (oledPendingArg != 0U) {
+        oledPendingArg = 0; // 参数本身只影响显示效果, 这里不需要保存
+        return;
+    }
+    if (Sim_OledHasArg(cmd)) {
+        oledPendingArg = cmd;
+    } else if (cmd <= 0x0FU) {
+        oledColumn = (uint8_t) ((oledColumn & 0xF0U) | cmd);
+    } else if (cmd <= 0x1FU) {
+        oledColumn = (uint8_t) ((oledColumn & 0x0FU) | ((cmd & 0x0FU) << 4));
+    } else if (cmd >= 0xB0U && cmd <= 0xB7U) {
+        oledPage = (uint8_t) (cmd - 0xB0U);
+    } else if (cmd == 0xAEU || cmd == 0xAFU) {
+        oledDisplayOn = (uint8_t) (cmd == 0xAFU);
+    } else if (cmd == 0xA6U || cmd == 0xA7U) {
+        oledReversed = (uint8_t) (cmd == 0xA7U);
+    }
+}
+
+static void Sim_OledData(uint8_t data) {
+    if (oledColumn < OLED_RAM_COLUMNS) {
+        oledRam[oledPage][oledColumn] = data;
+    }
+    oledColumn++;
+}
+
+static void Sim_OledWrite(const uint8_t *data, uint16_t len) {
+    uint16_t i = 0;
+
+    if (len == 0U) {
+        return;
+    }
+    if ((uint32_t) pageIndex < PAGE_End) {
+        oledScreenStats[pageIndex].bytes += len + 1U;
+    }
+    // Co=1 的控制字节后只跟 1 个字节, 可以连续出现; Co=0 的控制字节后直到停止条件都是同一类字节
+    while (i + 1U < len && (data[i] & OLED_CONTROL_CO) != 0U) {
+        if ((data[i] & OLED_CONTROL_DATA) != 0U) {
+            Sim_OledData(data[i + 1U]);
+        } else {
+            Sim_OledCommand(data[i + 1U]);
+        }
+        i += 2U;
+    }
+    if (i >= len) {
+        return;
+    }
+    if ((data[i] & OLED_CONTROL_DATA) != 0U) {
+        for (i++; i < len; i++) {
+            Sim_OledData(data[i]);
+        }
+        oledPageWrites++;
+    } else {
+        for (i++; i < len; i++) {
+            Sim_OledCommand(data[i]);
+        }
+    }
+}
+
+static void Sim_OledRead(uint8_t *data, uint16_t len) {
+    for (uint16_t i = 0; i < len; i++) {
+        data[i] = oledDisplayOn ? 0x00U : 0x40U; // 状态字节, bit6 为显示关闭
+    }
+}
+
+/**
+ * @brief 把上一个节拍内驱动完成的帧计入当前界面页面, 由 SimIrq 任务每个节拍调用
+ */
+void Sim_OledTick(void) {
+    const uint32_t frames = OLED_Stats.frames;
+    const uint32_t skipped = OLED_Stats.skippedFrames;
+
+    if ((uint32_t) pageIndex < PAGE_End) {
+        oledScreenStats[pageIndex].frames += frames - oledLastFrames;
+        oledScreenStats[pageIndex].skipped += skipped - oledLastSkipped;
+    }
+    oledLastFrames = frames;
+    oledLastSkipped = skipped;
+}
+
+void Sim_OledPrintStats(void) {
+    printf("OLED   : %lu frames, %lu skipped, %lu pages, %lu bytes sent by driver\n",
+           (unsigned long) OLED_Stats.frames, (unsigned long) OLED_Stats.skippedFrames,
+           (unsigned long) OLED_Stats.pages, (unsigned long) OLED_Stats.bytes);
+    for (uint32_t i = 0; i < PAGE_End; i++) {
+        if (oledScreenStats[i].frames == 0U) {
+            continue;
+        }
+        printf("  %-10s: %lu frames, %lu skipped, %.1f bytes/frame on bus\n", oledScreenNames[i],
+               (unsigned long) oledScreenStats[i].frames, (unsigned long) oledScreenStats[i].skipped,
+               (double) oledScreenStats[i].bytes / (double) oledScreenStats[i].frames);
+    }
+}
+
+/**
+ * @brief 以字符画打印屏幕内容, 每个字符对应横向 1 像素、纵向 2 像素
+ */
+void Sim_OledDump(void) {
+    static const char shade[4] = {' ', '\'', '.', ':'};
+    char line[OLED_VISIBLE_COLUMNS + 3U];
+
+    printf("---- OLED %s%s, %lu page writes ----\n", oledDisplayOn ? "on" : "off",
+           oledReversed ? " reversed" : "", (unsigned long) oledPageWrites);
+    for (uint32_t y = 0; y < OLED_PAGES * 8U; y += 2U) {
+        line[0] = '|';
+        for (uint32_t x = 0; x < OLED_VISIBLE_COLUMNS; x++) {
+            const uint8_t byte = oledRam[y / 8U][x + OLED_VISIBLE_OFFSET];
+            uint32_t bits = (uint32_t) ((byte >> (y % 8U)) & 0x03U);
+            if (oledReversed) {
+                bits ^= 0x03U;
+            }
+            line[x + 1U] = shade[bits];
+        }
+        line[OLED_VISIBLE_COLUMNS + 1U] = '|';
+        line[OLED_VISIBLE_COLUMNS + 2U] = '\0';
+        printf("%s\n", line);
+    }
+}
+
+SimI2cDevice Sim_OledDevice = {
+    .name = "OLED",
+    .address = 0x78,
+    .write = Sim_OledWrite,
+    .read = Sim_OledRead,
+};
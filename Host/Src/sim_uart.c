@@ -0,0 +1,242 @@
+/**
+ * @file sim_uart.c
+ * @brief 主机仿真的 USART1(调试串口)/USART2(蓝牙)发送接口
+ *
+ * - USART1 的内容原样写到标准输出
+ * - USART2 相当于手机端: 二进制帧按 0x00 分帧, 用 telemetry.c 解码后以 JSON 输出并注明帧长;
+ *   JSON 格式(TELEMETRY_FORMAT_JSON)按换行分行。每行加 "[BLE] " 前缀。
+ *   设置 SIM_BLE_FILE 时 USART2 的原始字节同时追加到该文件, 可以交给 telemetry_decode 解码
+ * - 阻塞式发送按波特率(每字节 10 位)忙等
+ * - DMA 发送立即返回, gState 保持 BUSY_TX; 发出一半时在仿真外设中断中调用 HAL_UART_TxHalfCpltCallback(),
+ *   线上时间结束后置回 READY, 并在中断上下文中调用 HAL_UART_TxCpltCallback()
+ * - 应用代码里的 printf 在构建时被替换为 Sim_Printf(), 与目标板上 newlib 经 _write() 走 USART1 阻塞发送的路径一致
+ */
+#include "sim.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "telemetry.h"
+
+#define SIM_UART_BITS_PER_BYTE 10U
+#define SIM_UART_COUNT         2U
+#define SIM_PRINTF_BUF_SIZE    256U
+#define SIM_BLE_LINE_SIZE      256U
+
+static struct {
+    UART_HandleTypeDef *huart;
+    uint64_t halfUs;   // 0 表示半传输回调已调用
+    uint64_t doneUs;
+} simUartDma[SIM_UART_COUNT];
+
+static uint8_t simBleLine[SIM_BLE_LINE_SIZE];
+static uint32_t simBleLineLen;
+static FILE *simBleFile;
+static uint8_t simBleFileOpened;
+
+static uint32_t Sim_UartIndex(const UART_HandleTypeDef *huart) {
+    return (huart->Instance == USART2) ? 1U : 0U;
+}
+
+static uint32_t Sim_UartWireUs(const UART_HandleTypeDef *huart, uint16_t size) {
+    const uint32_t baud = (huart->Init.BaudRate != 0U) ? huart->Init.BaudRate : 115200U;
+    return (uint32_t) (((uint64_t) size * SIM_UART_BITS_PER_BYTE * 1000000U + baud - 1U) / baud);
+}
+
+/**
+ * @brief 输出收到的一条完整消息(不含分隔符)
+ */
+static void Sim_BleMessage(const uint8_t *data, uint32_t len) {
+#if TELEMETRY_FORMAT == TELEMETRY_FORMAT_JSON
+    printf("[BLE] %.*s\n", (int) len, (const char *) data);
+#else
+    Telemetry_Message msg;
+    char text[TELEMETRY_JSON_MAX];
+    const Telemetry_Status status = Telemetry_DecodeFrame(data, (uint16_t) len, &msg);
+
+    if (status != TELEMETRY_OK) {
+        printf("[BLE] bad frame (%u bytes, error %d)\n", (unsigned) len + 1U, (int) status);
+        return;
+    }
+    const uint16_t textLen = Telemetry_FormatJson(&msg, text, sizeof(text));
+    printf("[BLE] %.*s  (frame %u bytes)\n", (int) textLen - 1, text, (unsigned) len + 1U);
+#endif
+}
+
+static void Sim_BleReceive(const uint8_t *data, uint16_t size) {
+#if TELEMETRY_FORMAT == TELEMETRY_FORMAT_JSON
+    const uint8_t delimiter = '\n';
+#else
+    const uint8_t delimiter = TELEMETRY_DELIMITER;
+#endif
+
+    if (!simBleFileOpened) {
+        const char *path = getenv("SIM_BLE_FILE");
+        simBleFileOpened = 1;
+        if (path != NULL && (simBleFile = fopen(path, "ab")) == NULL) {
+            perror(path);
+        }
+    }
+    if (simBleFile != NULL) {
+        fwrite(data, 1, size, simBleFile);
+        fflush(simBleFile);
+    }
+
+    // 一次 DMA 发送可能包含多条消息或半条消息, 凑满一条再输出
+    for (uint16_t i = 0; i < size; i++) {
+        if (data[i] == delimiter) {
+            Sim_BleMessage(simBleLine, simBleLineLen);
+            simBleLineLen = 0;
+        } else if (simBleLineLen < SIM_BLE_LINE_SIZE) {
+            simBleLine[simBleLineLen++] = data[i];
+        }
+    }
+}
+
+static void Sim_UartOutput(uint32_t index, const uint8_t *data, uint16_t size) {
+    if (index == 0U) {
+        fwrite(data, 1, size, stdout);
+    } else {
+        Sim_BleReceive(data, size);
+    }
+    Sim_Stats.uartTxBytes[index] += size;
+}
+
+static HAL_StatusTypeDef Sim_UartAcquire(UART_HandleTypeDef *huart) {
+    HAL_StatusTypeDef status = HAL_OK;
+
+    vPortEnterCritical();
+    if (huart->gState != HAL_UART_STATE_READY) {
+        status = HAL_BUSY;
+    } else {
+        huart->gState = HAL_UART_STATE_BUSY_TX;
+        huart->ErrorCode = HAL_UART_ERROR_NONE;
+        huart->Instance->SR &= ~USART_SR_TC;
+    }
+    vPortExitCritical();
+    return status;
+}
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart) {
+    if (huart->gState == HAL_UART_STATE_RESET) {
+        huart->Lock = HAL_UNLOCKED;
+        HAL_UART_MspInit(huart);
+    }
+    huart->Instance->SR = USART_SR_TXE | USART_SR_TC;
+    huart->Instance->CR1 |= USART_CR1_UE;
+    huart->ErrorCode = HAL_UART_ERROR_NONE;
+    huart->gState = HAL_UART_STATE_READY;
+    huart->RxState = HAL_UART_STATE_READY;
+    return HAL_OK;
+}
+
+HAL_UART_StateTypeDef HAL_UART_GetState(const UART_HandleTypeDef *huart) {
+    return (HAL_UART_StateTypeDef) (huart->gState | huart->RxState);
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size,
+                                    uint32_t Timeout) {
+    const uint32_t index = Sim_UartIndex(huart);
+    uint32_t wireUs;
+    (void) Timeout;
+
+    if (pData == NULL || Size == 0U) {
+        return HAL_ERROR;
+    }
+    if (Sim_UartAcquire(huart) != HAL_OK) {
+        return HAL_BUSY;
+    }
+
+    Sim_UartOutput(index, pData, Size);
+    wireUs = Sim_UartWireUs(huart, Size);
+    Sim_BusyWaitUs(wireUs);
+    Sim_Stats.uartBusyUs[index] += wireUs;
+
+    huart->Instance->SR |= USART_SR_TC;
+    huart->gState = HAL_UART_STATE_READY;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size) {
+    const uint32_t index = Sim_UartIndex(huart);
+
+    if (pData == NULL || Size == 0U) {
+        return HAL_ERROR;
+    }
+    if (Sim_UartAcquire(huart) != HAL_OK) {
+        return HAL_BUSY;
+    }
+
+    // 数据在启动 DMA 时就输出, 调用方要等完成回调后才能释放缓冲区, 这一点与目标板一致
+    Sim_UartOutput(index, pData, Size);
+
+    vPortEnterCritical();
+    Sim_Stats.uartDmaStarts[index]++;
+    simUartDma[index].huart = huart;
+    simUartDma[index].halfUs = Sim_NowUs() + Sim_UartWireUs(huart, Size / 2U);
+    simUartDma[index].doneUs = Sim_NowUs() + Sim_UartWireUs(huart, Size);
+    Sim_ScheduleIrq(simUartDma[index].halfUs);
+    vPortExitCritical();
+    return HAL_OK;
+}
+
+__weak void HAL_UART_TxHalfCpltCallback(UART_HandleTypeDef *huart) {
+    (void) huart;
+}
+
+__weak void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart) {
+    (void) huart;
+}
+
+/**
+ * @brief 在仿真中断上下文中推进 DMA 发送: 到达一半时调用半传输回调, 到期时完成
+ */
+void Sim_UartIrq(void) {
+    const uint64_t now = Sim_NowUs();
+
+    for (uint32_t i = 0; i < SIM_UART_COUNT; i++) {
+        UART_HandleTypeDef *huart = simUartDma[i].huart;
+        if (huart != NULL && simUartDma[i].halfUs != 0U) {
+            if (now < simUartDma[i].halfUs) {
+                Sim_ScheduleIrq(simUartDma[i].halfUs);
+                continue;
+            }
+            simUartDma[i].halfUs = 0;
+            HAL_UART_TxHalfCpltCallback(huart);
+        }
+        if (huart != NULL && now < simUartDma[i].doneUs) {
+            Sim_ScheduleIrq(simUartDma[i].doneUs);
+        } else if (huart != NULL) {
+            simUartDma[i].huart = NULL;
+            huart->Instance->SR |= USART_SR_TC;
+            huart->gState = HAL_UART_STATE_READY;
+            HAL_UART_TxCpltCallback(huart);
+        }
+    }
+}
+
+extern int _write(int file, char *ptr, int len);
+
+/**
+ * @brief 应用代码中 printf 的替身, 格式化后交给 debug_log.c 的 _write()
+ */
+int Sim_Printf(const char *format, ...) {
+    char buffer[SIM_PRINTF_BUF_SIZE];
+    va_list args;
+    int len;
+
+    va_start(args, format);
+    len = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+
+    if (len <= 0) {
+        return len;
+    }
+    if ((size_t) len >= sizeof(buffer)) {
+        len = (int) sizeof(buffer) - 1;
+    }
+    return _write(1, buffer, len);
+}
@@ -0,0 +1,226 @@
+/**
+ * @file aht20_test.c
+ * @brief AHT20 分步测量(aht20.c)的主机单元测试
+ *
+ * aht20.c 和仿真器件模型 sim_aht20.c 原样编译, 其余换成这里的假实现:
+ * - 虚拟时钟: osDelay() 把时钟拨到唤醒时刻并计入睡眠时间, I2C 传输按 100kHz 的线上时间拨动时钟并计入占用总线的时间
+ * - HAL_Delay() 只作为绊线: 驱动里不能再有忙等
+ * 按 SensorTask 的顺序(触发, 读 BMP280, 等待取回)跑若干个周期, 检查每个周期占用总线的时间只有零点几毫秒、
+ * 等待期间任务挂起且只等剩余的测量时间、读数与触发时刻的环境值一致; 任一检查失败时返回非 0
+ *
+ * 用法: cmake --build build/Host --target aht20_test && ./build/Host/cmake/host/aht20_test
+ */
+#include <math.h>
+#include <stdio.h>
+
+#include "aht20.h"
+#include "i2c_bus.h"
+#include "sim.h"
+
+#define TEST_I2C_CLOCK_HZ   100000U
+#define TEST_CYCLES         20U
+#define TEST_CYCLE_MS       1000U   // SensorTask 的采样周期
+#define TEST_BMP280_MS      12U     // 触发之后读 BMP280 占用的时间
+#define TEST_BUS_LIMIT_US   2000U   // 每个周期 AHT20 占用总线的上限
+#define TEST_MEASURE_MS     80U
+
+static int testFailures;
+
+#define CHECK(cond)                                                          \
+    do {                                                                     \
+        if (!(cond)) {                                                       \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);           \
+            testFailures++;                                                  \
+        }                                                                    \
+    } while (0)
+
+static struct {
+    uint64_t nowUs;
+    uint64_t busUs;      // 线上时间
+    uint64_t sleepUs;    // osDelay 挂起的时间
+    uint32_t transfers;
+    uint32_t busyWaits;  // HAL_Delay 调用次数
+    uint8_t nack;        // 下一次传输不应答
+} fake;
+
+// ========================== 仿真环境 ==========================
+
+uint64_t Sim_NowUs(void) {
+    return fake.nowUs;
+}
+
+/**
+ * @brief 随虚拟时钟缓慢变化的温湿度, 每个周期读数都不同
+ */
+float Sim_EnvTemperature(void) {
+    return 20.0f + (float) (fake.nowUs / 1000U) * 0.0005f;
+}
+
+float Sim_EnvHumidity(void) {
+    return 60.0f - (float) (fake.nowUs / 1000U) * 0.001f;
+}
+
+// ========================== RTOS / I2C 假实现 ==========================
+
+uint32_t osKernelGetTickFreq(void) {
+    return 1000U;
+}
+
+uint32_t osKernelGetTickCount(void) {
+    return (uint32_t) (fake.nowUs / 1000U);
+}
+
+osStatus_t osDelay(uint32_t ticks) {
+    // 与内核一样唤醒在节拍边界上
+    const uint64_t wakeUs = (fake.nowUs / 1000U + ticks) * 1000U;
+
+    fake.sleepUs += wakeUs - fake.nowUs;
+    fake.nowUs = wakeUs;
+    return osOK;
+}
+
+void HAL_Delay(uint32_t Delay) {
+    fake.busyWaits++;
+    fake.nowUs += (uint64_t) Delay * 1000U;
+}
+
+static HAL_StatusTypeDef Fake_Transfer(uint16_t address, uint8_t *data, uint16_t len, uint8_t isRead) {
+    // 地址字节 + 数据, 每字节 9 个时钟, 起始和停止条件各 1 个时钟
+    const uint32_t bits = (1U + len) * 9U + 2U;
+    const uint32_t wireUs = (bits * 1000000U + TEST_I2C_CLOCK_HZ - 1U) / TEST_I2C_CLOCK_HZ;
+
+    fake.transfers++;
+    fake.busUs += wireUs;
+    if (fake.nack || (address & 0xFEU) != Sim_Aht20Device.address) {
+        fake.nack = 0;
+        fake.nowUs += wireUs;
+        return HAL_ERROR;
+    }
+    if (isRead) {
+        Sim_Aht20Device.read(data, len);
+    } else {
+        Sim_Aht20Device.write(data, len);
+    }
+    fake.nowUs += wireUs;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef I2CBus_Write(uint16_t address, uint8_t *data, uint16_t len) {
+    return Fake_Transfer(address, data, len, 0);
+}
+
+HAL_StatusTypeDef I2CBus_Read(uint16_t address, uint8_t *data, uint16_t len) {
+    return Fake_Transfer(address, data, len, 1);
+}
+
+// ========================== 测试 ==========================
+
+/**
+ * @brief 上电等待期间任务挂起, 不忙等
+ */
+static void Test_Init(void) {
+    AHT20_Init();
+
+    CHECK(fake.busyWaits == 0U);
+    CHECK(fake.sleepUs >= 40000U);
+    CHECK(fake.busUs < 1000U);
+}
+
+/**
+ * @brief 测量时间未到时取结果不访问总线
+ */
+static void Test_FetchEarly(void) {
+    float temperature = -100.0f;
+    float humidity = -100.0f;
+
+    CHECK(AHT20_Trigger() == AHT20_OK);
+    const uint32_t transfers = fake.transfers;
+    fake.nowUs += 40000U;
+    CHECK(AHT20_Fetch(&temperature, &humidity) == AHT20_BUSY);
+    CHECK(fake.transfers == transfers);
+    CHECK(temperature == -100.0f && humidity == -100.0f);
+
+    CHECK(AHT20_Wait(&temperature, &humidity) == AHT20_OK);
+    CHECK(AHT20_Fetch(&temperature, &humidity) == AHT20_ERROR); // 结果已取走
+}
+
+/**
+ * @brief SensorTask 的采样周期: 触发 -> 读 BMP280 -> 等剩余时间并取回
+ */
+static void Test_Cycles(void) {
+    uint64_t maxBusUs = 0;
+    uint64_t totalBusUs = 0;
+    uint64_t maxWaitSleepUs = 0;
+
+    for (uint32_t cycle = 0; cycle < TEST_CYCLES; cycle++) {
+        float temperature = 0.0f;
+        float humidity = 0.0f;
+        const uint64_t cycleStartUs = fake.nowUs;
+        const uint64_t busBefore = fake.busUs;
+
+        const float expectedTemperature = Sim_EnvTemperature();
+        const float expectedHumidity = Sim_EnvHumidity();
+        CHECK(AHT20_Trigger() == AHT20_OK);
+        const uint64_t triggerUs = fake.nowUs;
+
+        fake.nowUs += TEST_BMP280_MS * 1000U;
+        const uint64_t sleepBefore = fake.sleepUs;
+        CHECK(AHT20_Wait(&temperature, &humidity) == AHT20_OK);
+        const uint64_t waitSleepUs = fake.sleepUs - sleepBefore;
+        const uint64_t busUs = fake.busUs - busBefore;
+
+        // 读数是触发时刻的环境值(20 位量化误差远小于 0.01)
+        CHECK(fabsf(temperature - expectedTemperature) < 0.01f);
+        CHECK(fabsf(humidity - expectedHumidity) < 0.01f);
+        // 测量完成之后才取结果, 等待只覆盖读 BMP280 之后剩下的部分
+        CHECK(fake.nowUs - triggerUs >= TEST_MEASURE_MS * 1000U);
+        CHECK(waitSleepUs <= (TEST_MEASURE_MS - TEST_BMP280_MS + 1U) * 1000U);
+        CHECK(busUs < TEST_BUS_LIMIT_US);
+
+        if (busUs > maxBusUs) {
+            maxBusUs = busUs;
+        }
+        if (waitSleepUs > maxWaitSleepUs) {
+            maxWaitSleepUs = waitSleepUs;
+        }
+        totalBusUs += busUs;
+        fake.nowUs = cycleStartUs + TEST_CYCLE_MS * 1000U;
+    }
+    CHECK(fake.busyWaits == 0U);
+
+    printf("aht20_test: %u cycles, bus %lu us avg / %lu us max per cycle, waited at most %lu us after the BMP280\n",
+           TEST_CYCLES, (unsigned long) (totalBusUs / TEST_CYCLES), (unsigned long) maxBusUs,
+           (unsigned long) maxWaitSleepUs);
+}
+
+/**
+ * @brief 通信失败时报告错误, 不改写输出值
+ */
+static void Test_Errors(void) {
+    float temperature = -100.0f;
+    float humidity = -100.0f;
+
+    fake.nack = 1;
+    CHECK(AHT20_Trigger() == AHT20_ERROR);
+    CHECK(AHT20_Fetch(&temperature, &humidity) == AHT20_ERROR);
+
+    CHECK(AHT20_Trigger() == AHT20_OK);
+    fake.nowUs += TEST_MEASURE_MS * 1000U;
+    fake.nack = 1;
+    CHECK(AHT20_Fetch(&temperature, &humidity) == AHT20_ERROR);
+    CHECK(temperature == -100.0f && humidity == -100.0f);
+}
+
+int main(void) {
+    Test_Init();
+    Test_FetchEarly();
+    Test_Cycles();
+    Test_Errors();
+
+    if (testFailures != 0) {
+        printf("aht20_test: %d check(s) failed\n", testFailures);
+        return 1;
+    }
+    printf("aht20_test: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,220 @@
+/**
+ * @file alarm_test.c
+ * @brief 报警状态机(alarm.c)的主机单元测试
+ *
+ * alarm.c 原样编译, 每秒喂一次采样, 记录回调产生的事件和时刻。只让温度通道(上限 30℃、下限 15℃、
+ * 回差 0.5℃、保持 ALARM_HOLD_S 秒)偏离, 其余通道固定在范围中间:
+ * - 每次越限(叠加在阈值附近抖动的噪声)只产生一次 raised 和一次 cleared, 且都在保持时间之后
+ * - 数值停在回差带内(报警前不超过上限, 报警后不低于 上限-回差)或越限不到保持时间时没有任何事件
+ * - 报警持续期间 reminder 只在距上一次报警或提醒 ALARM_REMINDER_S 秒之后出现
+ * 任一检查失败时返回非 0
+ *
+ * 用法: cmake --build build/Host --target alarm_test && ./build/Host/cmake/host/alarm_test
+ */
+#include <stdio.h>
+
+#include "alarm.h"
+
+#define TEST_MAX_EVENTS 64U
+
+static int testFailures;
+
+#define CHECK(cond)                                                          \
+    do {                                                                     \
+        if (!(cond)) {                                                       \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);           \
+            testFailures++;                                                  \
+        }                                                                    \
+    } while (0)
+
+static const FarmSafeRange testRange = {
+    .minTemperature = 15, .maxTemperature = 30,
+    .minHumidity = 20, .maxHumidity = 70,
+    .maxRainGauge = 30,
+    .minSoilMoisture = 10, .maxSoilMoisture = 50,
+    .minLightIntensity = 50, .maxLightIntensity = 800,
+};
+
+static struct {
+    uint32_t now;
+    uint32_t count;
+    struct {
+        Telemetry_Reason reason;
+        Telemetry_Event event;
+        uint32_t at;
+    } events[TEST_MAX_EVENTS];
+} recorded;
+
+static void Test_Notify(Telemetry_Reason reason, Telemetry_Event event, int32_t value) {
+    (void) value;
+    if (recorded.count < TEST_MAX_EVENTS) {
+        recorded.events[recorded.count].reason = reason;
+        recorded.events[recorded.count].event = event;
+        recorded.events[recorded.count].at = recorded.now;
+    }
+    recorded.count++;
+}
+
+static void Test_Reset(void) {
+    Alarm_Reset();
+    recorded.now = 0;
+    recorded.count = 0;
+}
+
+/**
+ * @brief 以温度 temperature 采样 seconds 秒, 其余通道在范围中间
+ * @return 最后一次采样时处于报警状态的通道数
+ */
+static uint8_t Test_Feed(float temperature, uint32_t seconds) {
+    FarmState state = {
+        .temperature = temperature,
+        .humidity = 45.0f,
+        .rainGauge = 0,
+        .soilMoisture = 30,
+        .lightIntensity = 400,
+    };
+    uint8_t active = 0;
+
+    for (uint32_t i = 0; i < seconds; i++) {
+        active = Alarm_Update(&state, &testRange, recorded.now, Test_Notify);
+        recorded.now++;
+    }
+    return active;
+}
+
+/**
+ * @brief 在 center 附近按固定的锯齿抖动 ±amplitude 采样 seconds 秒
+ */
+static void Test_FeedNoisy(float center, float amplitude, uint32_t seconds) {
+    static const float shape[] = {-1.0f, 0.5f, 1.0f, -0.5f, 0.0f, -0.75f, 0.75f};
+
+    for (uint32_t i = 0; i < seconds; i++) {
+        (void) Test_Feed(center + amplitude * shape[i % (sizeof(shape) / sizeof(shape[0]))], 1);
+    }
+}
+
+/**
+ * @brief 阈值附近带噪声的多次越限, 每次只报警和解除各一次
+ */
+static void Test_Excursions(void) {
+    Test_Reset();
+    Test_Feed(25.0f, 10);
+
+    for (uint32_t i = 0; i < 4U; i++) {
+        const uint32_t first = recorded.count;
+
+        // 上升时在上限附近抖动(29.7~30.3)十几秒, 再明显越限一分钟
+        Test_FeedNoisy(30.0f, 0.3f, 15);
+        const uint32_t crossedAt = recorded.now;
+        Test_FeedNoisy(31.0f, 0.3f, 60);
+        // 回落时同样在回差带附近抖动(29.5~30.1, 最后一个采样在带内), 然后回到正常
+        Test_FeedNoisy(29.8f, 0.3f, 14);
+        const uint32_t backAt = recorded.now;
+        CHECK(Test_Feed(25.0f, 30) == 0U);
+
+        CHECK(recorded.count - first == 2U);
+        if (recorded.count - first == 2U && recorded.count <= TEST_MAX_EVENTS) {
+            CHECK(recorded.events[first].reason == TELEMETRY_REASON_TEMPERATURE_HIGH);
+            CHECK(recorded.events[first].event == TELEMETRY_EVENT_RAISED);
+            CHECK(recorded.events[first].at == crossedAt + ALARM_HOLD_S);
+            CHECK(recorded.events[first + 1U].reason == TELEMETRY_REASON_TEMPERATURE_HIGH);
+            CHECK(recorded.events[first + 1U].event == TELEMETRY_EVENT_CLEARED);
+            CHECK(recorded.events[first + 1U].at == backAt + ALARM_HOLD_S);
+        }
+    }
+
+    // 下限一侧同样只有一次报警和一次解除
+    const uint32_t first = recorded.count;
+    Test_FeedNoisy(15.0f, 0.3f, 15);
+    CHECK(Test_Feed(13.0f, 30) == 1U);
+    Test_FeedNoisy(15.2f, 0.3f, 15);
+    CHECK(Test_Feed(20.0f, 30) == 0U);
+    CHECK(recorded.count - first == 2U);
+    if (recorded.count - first == 2U && recorded.count <= TEST_MAX_EVENTS) {
+        CHECK(recorded.events[first].reason == TELEMETRY_REASON_TEMPERATURE_LOW);
+        CHECK(recorded.events[first].event == TELEMETRY_EVENT_RAISED);
+        CHECK(recorded.events[first + 1U].event == TELEMETRY_EVENT_CLEARED);
+    }
+}
+
+/**
+ * @brief 回差带内和短于保持时间的越限不产生事件
+ */
+static void Test_HysteresisBand(void) {
+    Test_Reset();
+
+    // 未报警: 贴着上限(29.6~30.0)不越过
+    Test_FeedNoisy(29.8f, 0.2f, 120);
+    CHECK(recorded.count == 0U);
+
+    // 越限时间短于保持时间
+    for (uint32_t i = 0; i < 5U; i++) {
+        Test_Feed(32.0f, ALARM_HOLD_S - 1U);
+        Test_Feed(29.0f, 5);
+    }
+    CHECK(recorded.count == 0U);
+
+    // 报警之后回到范围内但不低于 上限-回差(29.6~30.0): 保持报警, 没有解除
+    CHECK(Test_Feed(32.0f, ALARM_HOLD_S + 1U) == 1U);
+    CHECK(recorded.count == 1U);
+    Test_FeedNoisy(29.8f, 0.2f, 120);
+    CHECK(recorded.count == 1U);
+
+    // 低于 上限-回差 的时间短于保持时间, 也不解除
+    for (uint32_t i = 0; i < 5U; i++) {
+        Test_Feed(28.0f, ALARM_HOLD_S - 1U);
+        Test_Feed(29.8f, 5);
+    }
+    CHECK(recorded.count == 1U);
+    CHECK(Test_Feed(29.8f, 1) == 1U);
+}
+
+/**
+ * @brief 报警持续期间每 ALARM_REMINDER_S 秒提醒一次, 保持时间和提醒周期之前都没有提醒
+ */
+static void Test_Reminder(void) {
+    uint32_t lastNotified = 0;
+    uint32_t reminders = 0;
+
+    Test_Reset();
+    Test_Feed(25.0f, 10);
+    const uint32_t crossedAt = recorded.now;
+    Test_Feed(35.0f, 3U * ALARM_REMINDER_S + 10U);
+    CHECK(Test_Feed(25.0f, ALARM_HOLD_S + 1U) == 0U);
+
+    CHECK(recorded.count == 5U);
+    for (uint32_t i = 0; i < recorded.count && i < TEST_MAX_EVENTS; i++) {
+        const uint32_t at = recorded.events[i].at;
+        switch (recorded.events[i].event) {
+            case TELEMETRY_EVENT_RAISED:
+                CHECK(i == 0U);
+                CHECK(at - crossedAt >= ALARM_HOLD_S);
+                lastNotified = at;
+                break;
+            case TELEMETRY_EVENT_REMINDER:
+                CHECK(i != 0U);
+                CHECK(at - lastNotified >= ALARM_REMINDER_S);
+                CHECK(at - lastNotified <= ALARM_REMINDER_S + 1U);
+                lastNotified = at;
+                reminders++;
+                break;
+            default:
+                CHECK(i == recorded.count - 1U);
+                break;
+        }
+    }
+    CHECK(reminders == 3U);
+}
+
+int main(void) {
+    Test_Excursions();
+    Test_HysteresisBand();
+    Test_Reminder();
+
+    if (testFailures != 0) {
+        printf("alarm_test: %d check(s) failed\n", testFailures);
+        return 1;
+    }
+    printf("alarm_test: all checks passed\n");
+    return 0;
+}
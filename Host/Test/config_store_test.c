@@ -0,0 +1,274 @@
+/**
+ * @file config_store_test.c
+ * @brief 配置存储(config_store.c)换页与掉电的主机单元测试
+ *
+ * config_store.c 原样编译, CONFIG 区的两页映射到与目标板相同的地址, HAL_FLASH_Program/HAL_FLASHEx_Erase
+ * 换成与 flash_log_test 相同的带故障注入的假实现(第 N 次擦写操作时掉电, 正在写的半字只清了一部分位,
+ * 正在擦的页只擦回一部分位, 之后的擦写全部失败):
+ * - 换页: 连续写入不同的值, 每写一次重新 ConfigStore_Init() 读回最新值, 两页轮流擦除多次
+ * - 掉电: 从第 0 次操作起逐个在每一次擦写时掉电, 覆盖追加记录和换页(清魔数、擦除、复制、写段头)的每一步;
+ *   重新上电后读到的必须是最后一次写入成功的值或掉电时正在写的值(从未写入成功时可以读不到), 不能是别的内容;
+ *   之后恢复供电再写一个新值, 必须写入成功并在下次上电读回
+ * 任一检查失败时返回非 0
+ *
+ * 用法: cmake --build build/Host --target config_store_test && ./build/Host/cmake/host/config_store_test
+ */
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "config_store.h"
+
+#define TEST_REGION_SIZE (CONFIG_STORE_PAGES * FLASH_PAGE_SIZE)
+#define TEST_VALUE_SIZE  28U
+// 每条记录 34 字节, 一页约 60 条; 写 200 个值换页 3 次
+#define TEST_WRITES      200U
+#define TEST_NO_POWER_CUT UINT32_MAX
+
+static int testFailures;
+
+#define CHECK(cond)                                                          \
+    do {                                                                     \
+        if (!(cond)) {                                                       \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);           \
+            testFailures++;                                                  \
+        }                                                                    \
+    } while (0)
+
+static uint8_t *testFlash;
+static uint8_t testUnlocked;
+static uint32_t testPowerLeft;    // 还能完成的擦写操作数, 用完时掉电
+static uint8_t testPowerDown;     // 已掉电, 之后的擦写全部失败
+static uint32_t testOperations;   // 完成的擦写操作数
+static uint32_t testErases;
+
+// ========================== 带故障注入的 HAL 假实现 ==========================
+
+typedef enum {
+    TEST_POWER_OK,
+    TEST_POWER_CUT,   // 这次操作进行到一半时掉电
+    TEST_POWER_DOWN,  // 已经掉电
+} Test_Power;
+
+static Test_Power Test_Operation(void) {
+    if (testPowerDown) {
+        return TEST_POWER_DOWN;
+    }
+    if (testPowerLeft == 0U) {
+        testPowerDown = 1;
+        return TEST_POWER_CUT;
+    }
+    if (testPowerLeft != TEST_NO_POWER_CUT) {
+        testPowerLeft--;
+    }
+    testOperations++;
+    return TEST_POWER_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Unlock(void) {
+    testUnlocked = 1;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Lock(void) {
+    testUnlocked = 0;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint64_t Data) {
+    uint16_t *dest = (uint16_t *) (testFlash + (Address - CONFIG_STORE_ADDR));
+    const uint16_t value = (uint16_t) Data;
+
+    // 锁着写、越界、半字以外的宽度或者把 0 写回 1, 在目标板上都会失败, 驱动不应这样做
+    CHECK(testUnlocked);
+    CHECK(TypeProgram == FLASH_TYPEPROGRAM_HALFWORD);
+    CHECK(Address >= CONFIG_STORE_ADDR && Address + 2U <= CONFIG_STORE_ADDR + TEST_REGION_SIZE);
+    if (Address < CONFIG_STORE_ADDR || Address + 2U > CONFIG_STORE_ADDR + TEST_REGION_SIZE) {
+        return HAL_ERROR;
+    }
+    CHECK(*dest == 0xFFFFU || value == 0U);
+
+    const Test_Power power = Test_Operation();
+    if (power != TEST_POWER_OK) {
+        if (power == TEST_POWER_CUT) {
+            // 掉电时正在写的半字: 该清零的位只清了一部分
+            *dest &= (uint16_t) (value | rand());
+        }
+        return HAL_ERROR;
+    }
+    *dest = value;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef *pEraseInit, uint32_t *PageError) {
+    uint8_t *page = testFlash + (pEraseInit->PageAddress - CONFIG_STORE_ADDR);
+
+    *PageError = 0xFFFFFFFFU;
+    CHECK(testUnlocked);
+    CHECK(pEraseInit->NbPages == 1U);
+    CHECK(pEraseInit->PageAddress % FLASH_PAGE_SIZE == 0U);
+    CHECK(pEraseInit->PageAddress >= CONFIG_STORE_ADDR &&
+          pEraseInit->PageAddress < CONFIG_STORE_ADDR + TEST_REGION_SIZE);
+    if (pEraseInit->PageAddress < CONFIG_STORE_ADDR || pEraseInit->PageAddress >= CONFIG_STORE_ADDR + TEST_REGION_SIZE) {
+        return HAL_ERROR;
+    }
+
+    const Test_Power power = Test_Operation();
+    if (power != TEST_POWER_OK) {
+        if (power == TEST_POWER_CUT) {
+            // 掉电时正在擦的页: 每个字节只有一部分位回到 1
+            for (uint32_t i = 0; i < FLASH_PAGE_SIZE; i++) {
+                page[i] |= (uint8_t) rand();
+            }
+        }
+        *PageError = pEraseInit->PageAddress;
+        return HAL_ERROR;
+    }
+    memset(page, 0xFF, FLASH_PAGE_SIZE);
+    testErases++;
+    return HAL_OK;
+}
+
+// ========================== 测试 ==========================
+
+/**
+ * @brief 第 index 次写入的值由 index 决定, 相邻两次一定不同
+ */
+static void Test_Value(uint32_t index, uint8_t *value) {
+    memcpy(value, &index, sizeof(index));
+    for (uint32_t i = sizeof(index); i < TEST_VALUE_SIZE; i++) {
+        value[i] = (uint8_t) (index * 13U + i);
+    }
+}
+
+static void Test_Format(void) {
+    memset(testFlash, 0xFF, TEST_REGION_SIZE);
+    testPowerLeft = TEST_NO_POWER_CUT;
+    testPowerDown = 0;
+    testOperations = 0;
+    testErases = 0;
+}
+
+/**
+ * @brief 重新上电后读出的值的编号
+ * @return -1 表示读不到
+ */
+static int32_t Test_Reboot(void) {
+    uint8_t value[TEST_VALUE_SIZE];
+    uint8_t expected[TEST_VALUE_SIZE];
+    uint32_t index;
+
+    ConfigStore_Init();
+    if (ConfigStore_Read(CONFIG_KEY_SAFE_RANGE, value, sizeof(value)) != HAL_OK) {
+        return -1;
+    }
+    memcpy(&index, value, sizeof(index));
+    Test_Value(index, expected);
+    CHECK(memcmp(value, expected, sizeof(value)) == 0);
+    return (int32_t) index;
+}
+
+/**
+ * @brief 没有掉电时连续写入, 每次重新上电都读回最新值, 两页轮流使用
+ */
+static void Test_Swap(void) {
+    uint8_t value[TEST_VALUE_SIZE];
+
+    Test_Format();
+    CHECK(Test_Reboot() == -1);
+    for (uint32_t i = 0; i < TEST_WRITES; i++) {
+        Test_Value(i, value);
+        CHECK(ConfigStore_Write(CONFIG_KEY_SAFE_RANGE, value, sizeof(value)) == HAL_OK);
+        CHECK(Test_Reboot() == (int32_t) i);
+    }
+    // 第一次写入时换到第 0 页, 之后每写满一页换一次
+    CHECK(testErases >= 3U);
+
+    // 与已保存的值相同时不写
+    const uint32_t operations = testOperations;
+    CHECK(ConfigStore_Write(CONFIG_KEY_SAFE_RANGE, value, sizeof(value)) == HAL_OK);
+    CHECK(testOperations == operations);
+
+    // 长度不符时读不到, 也不改写输出
+    uint8_t shorter[TEST_VALUE_SIZE - 2U];
+    memset(shorter, 0xA5, sizeof(shorter));
+    CHECK(ConfigStore_Read(CONFIG_KEY_SAFE_RANGE, shorter, sizeof(shorter)) == HAL_ERROR);
+    CHECK(shorter[0] == 0xA5U);
+}
+
+/**
+ * @brief 在每一次擦写操作时掉电, 重新上电后读到的是完整的旧值或新值
+ */
+static void Test_PowerLoss(void) {
+    uint8_t value[TEST_VALUE_SIZE];
+    uint32_t totalOperations;
+    uint32_t torn = 0;
+
+    // 先数一遍不掉电时写完 TEST_WRITES 个值一共多少次擦写操作
+    Test_Format();
+    ConfigStore_Init();
+    for (uint32_t i = 0; i < TEST_WRITES; i++) {
+        Test_Value(i, value);
+        (void) ConfigStore_Write(CONFIG_KEY_SAFE_RANGE, value, sizeof(value));
+    }
+    totalOperations = testOperations;
+
+    for (uint32_t cutAt = 0; cutAt < totalOperations; cutAt++) {
+        int32_t acked = -1;
+        uint32_t next = 0;
+        const int failuresBefore = testFailures;
+
+        Test_Format();
+        srand(cutAt + 1U);
+        ConfigStore_Init();
+        testPowerLeft = cutAt;
+        while (!testPowerDown) {
+            Test_Value(next, value);
+            if (ConfigStore_Write(CONFIG_KEY_SAFE_RANGE, value, sizeof(value)) == HAL_OK) {
+                acked = (int32_t) next;
+            }
+            next++;
+        }
+
+        // 重新上电: 最后一次写入成功的值, 或者掉电时正在写的值
+        testPowerLeft = TEST_NO_POWER_CUT;
+        testPowerDown = 0;
+        const int32_t read = Test_Reboot();
+        CHECK(read == acked || read == (int32_t) next - 1);
+        torn += read != acked;
+
+        // 恢复供电后继续写入
+        Test_Value(next, value);
+        CHECK(ConfigStore_Write(CONFIG_KEY_SAFE_RANGE, value, sizeof(value)) == HAL_OK);
+        CHECK(Test_Reboot() == (int32_t) next);
+
+        if (testFailures != failuresBefore) {
+            printf("  power cut at operation %u: %d written, %d acknowledged, read %d\n", cutAt, (int) next,
+                   (int) acked, (int) read);
+            return;
+        }
+    }
+    printf("config_store_test: %u power cuts recovered (%u kept the interrupted write)\n", totalOperations, torn);
+}
+
+int main(void) {
+    // 与目标板相同的地址, config_store.c 直接按 CONFIG_STORE_ADDR 读取
+    testFlash = mmap((void *) CONFIG_STORE_ADDR, TEST_REGION_SIZE, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if (testFlash != (uint8_t *) CONFIG_STORE_ADDR) {
+        fprintf(stderr, "cannot map the CONFIG region at 0x%08lx: %s\n", CONFIG_STORE_ADDR, strerror(errno));
+        return 1;
+    }
+
+    Test_Swap();
+    Test_PowerLoss();
+
+    if (testFailures != 0) {
+        printf("config_store_test: %d check(s) failed\n", testFailures);
+        return 1;
+    }
+    printf("config_store_test: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,255 @@
+/**
+ * @file flash_log_test.c
+ * @brief Flash 日志(flash_log.c)掉电恢复的主机单元测试
+ *
+ * flash_log.c 原样编译, LOG 区映射到与目标板相同的地址, HAL_FLASH_Program/HAL_FLASHEx_Erase 换成带故障注入的假实现:
+ * 每一轮在第 N 次擦写操作时"掉电", 正在写的半字只有一部分位被写入, 正在擦的页只有一部分位被擦除,
+ * 之后的擦写全部失败。然后重新 FlashLog_Init()/FlashLog_Replay() 检查:
+ * 回放的记录内容正确、顺序递增、没有从未写过的记录; 写入成功的记录从回放到的最老一条起一条不缺;
+ * 最后一条写入成功的记录一定在; 掉电后继续写入的记录在下一次掉电后同样满足以上条件(每轮连续掉电三次)。
+ * 前 64 轮逐个覆盖最开始的几次擦写操作, 之后的掉电时刻在 LOG 区转两圈左右的范围内均匀分布; 任一检查失败时返回非 0
+ *
+ * 用法: cmake --build build/Host --target flash_log_test && ./build/Host/cmake/host/flash_log_test [轮数]
+ */
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "flash_log.h"
+
+#define TEST_ROUNDS_DEFAULT 1000U
+#define TEST_POWER_CUTS     3
+#define TEST_RECORD_MAX     64
+// 每一轮最多写入的记录数: 足够在 LOG 区里转两圈以上
+#define TEST_RECORDS        6000U
+
+static int testFailures;
+
+#define CHECK(cond)                                                          \
+    do {                                                                     \
+        if (!(cond)) {                                                       \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);           \
+            testFailures++;                                                  \
+        }                                                                    \
+    } while (0)
+
+static uint8_t *testFlash;
+static uint8_t testUnlocked;
+static uint32_t testPowerLeft;    // 还能完成的擦写操作数, 用完时掉电
+static uint8_t testPowerDown;     // 已掉电, 之后的擦写全部失败
+
+// ========================== 带故障注入的 HAL 假实现 ==========================
+
+typedef enum {
+    TEST_POWER_OK,
+    TEST_POWER_CUT,   // 这次操作进行到一半时掉电
+    TEST_POWER_DOWN,  // 已经掉电
+} Test_Power;
+
+static Test_Power Test_Operation(void) {
+    if (testPowerDown) {
+        return TEST_POWER_DOWN;
+    }
+    if (testPowerLeft == 0U) {
+        testPowerDown = 1;
+        return TEST_POWER_CUT;
+    }
+    testPowerLeft--;
+    return TEST_POWER_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Unlock(void) {
+    testUnlocked = 1;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Lock(void) {
+    testUnlocked = 0;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint64_t Data) {
+    uint16_t *dest = (uint16_t *) (testFlash + (Address - FLASH_LOG_ADDR));
+    const uint16_t value = (uint16_t) Data;
+
+    // 锁着写、越界、半字以外的宽度或者把 0 写回 1, 在目标板上都会失败, 驱动不应这样做
+    CHECK(testUnlocked);
+    CHECK(TypeProgram == FLASH_TYPEPROGRAM_HALFWORD);
+    CHECK(Address >= FLASH_LOG_ADDR && Address + 2U <= FLASH_LOG_ADDR + FLASH_LOG_SIZE);
+    if (Address < FLASH_LOG_ADDR || Address + 2U > FLASH_LOG_ADDR + FLASH_LOG_SIZE) {
+        return HAL_ERROR;
+    }
+    CHECK(*dest == 0xFFFFU || value == 0U);
+
+    const Test_Power power = Test_Operation();
+    if (power != TEST_POWER_OK) {
+        if (power == TEST_POWER_CUT) {
+            // 掉电时正在写的半字: 该清零的位只清了一部分
+            *dest &= (uint16_t) (value | rand());
+        }
+        return HAL_ERROR;
+    }
+    *dest = value;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef *pEraseInit, uint32_t *PageError) {
+    uint8_t *page = testFlash + (pEraseInit->PageAddress - FLASH_LOG_ADDR);
+
+    *PageError = 0xFFFFFFFFU;
+    CHECK(testUnlocked);
+    CHECK(pEraseInit->NbPages == 1U);
+    CHECK(pEraseInit->PageAddress % FLASH_PAGE_SIZE == 0U);
+    CHECK(pEraseInit->PageAddress >= FLASH_LOG_ADDR && pEraseInit->PageAddress < FLASH_LOG_ADDR + FLASH_LOG_SIZE);
+    if (pEraseInit->PageAddress < FLASH_LOG_ADDR || pEraseInit->PageAddress >= FLASH_LOG_ADDR + FLASH_LOG_SIZE) {
+        return HAL_ERROR;
+    }
+
+    const Test_Power power = Test_Operation();
+    if (power != TEST_POWER_OK) {
+        if (power == TEST_POWER_CUT) {
+            // 掉电时正在擦的页: 每个字节只有一部分位回到 1
+            for (uint32_t i = 0; i < FLASH_PAGE_SIZE; i++) {
+                page[i] |= (uint8_t) rand();
+            }
+        }
+        *PageError = pEraseInit->PageAddress;
+        return HAL_ERROR;
+    }
+    memset(page, 0xFF, FLASH_PAGE_SIZE);
+    return HAL_OK;
+}
+
+// ========================== 记录内容 ==========================
+
+/**
+ * @brief 第 index 条记录的长度和内容由 index 决定, 回放时可以逐字节核对
+ */
+static uint16_t Test_Record(uint32_t index, uint8_t *data) {
+    const uint16_t len = (uint16_t) (4U + index * 7U % (TEST_RECORD_MAX - 3U));
+    memcpy(data, &index, sizeof(index));
+    for (uint16_t i = sizeof(index); i < len; i++) {
+        data[i] = (uint8_t) (index * 31U + i);
+    }
+    return len;
+}
+
+static uint32_t *testReplayed;
+static uint32_t testReplayedCount;
+static uint32_t testBadRecords;
+static uint8_t *testAcked;   // testAcked[i]: 第 i 条记录写入成功
+
+static void Test_Collect(FlashLog_Type type, const void *data, uint16_t len, void *context) {
+    uint8_t expected[TEST_RECORD_MAX];
+    uint32_t index;
+    (void) context;
+
+    memcpy(&index, data, sizeof(index));
+    if (type != FLASH_LOG_HISTORY_MINUTE || len < sizeof(index) || index >= TEST_RECORDS ||
+        Test_Record(index, expected) != len || memcmp(expected, data, len) != 0) {
+        testBadRecords++;
+        return;
+    }
+    testReplayed[testReplayedCount++] = index;
+}
+
+static void Test_Reboot(void) {
+    testReplayedCount = 0;
+    testBadRecords = 0;
+    FlashLog_Init();
+    FlashLog_Replay(Test_Collect, NULL);
+}
+
+// ========================== 掉电测试 ==========================
+
+/**
+ * @brief 检查一次重新上电后的回放结果
+ * @param next 已经尝试写入的记录数
+ * @return 1: 通过
+ */
+static int Test_Check(uint32_t next) {
+    const int failuresBefore = testFailures;
+    int32_t lastAcked = -1;
+
+    for (uint32_t i = 0; i < next; i++) {
+        if (testAcked[i]) {
+            lastAcked = (int32_t) i;
+        }
+    }
+    CHECK(testBadRecords == 0U);
+    for (uint32_t i = 1; i < testReplayedCount; i++) {
+        CHECK(testReplayed[i] > testReplayed[i - 1]);
+    }
+    if (testReplayedCount > 0U) {
+        CHECK(testReplayed[testReplayedCount - 1] < next);
+    }
+    if (lastAcked >= 0) {
+        CHECK(testReplayedCount > 0U && testReplayed[testReplayedCount - 1] >= (uint32_t) lastAcked);
+    }
+    // 从回放到的最老一条起, 写入成功的记录必须全部回放
+    for (uint32_t i = testReplayedCount > 0U ? testReplayed[0] : next, r = 0; i < next; i++) {
+        while (r < testReplayedCount && testReplayed[r] < i) {
+            r++;
+        }
+        if (testAcked[i] && (r == testReplayedCount || testReplayed[r] != i)) {
+            CHECK(!"acknowledged record missing");
+            break;
+        }
+    }
+    return testFailures == failuresBefore;
+}
+
+static void Test_PowerLoss(uint32_t rounds) {
+    uint8_t data[TEST_RECORD_MAX];
+    uint32_t cuts = 0;
+
+    for (uint32_t round = 0; round < rounds; round++) {
+        uint32_t next = 0;
+        memset(testFlash, 0xFF, FLASH_LOG_SIZE);
+        memset(testAcked, 0, TEST_RECORDS);
+        srand(round + 1U);
+        Test_Reboot();
+
+        for (int cut = 0; cut < TEST_POWER_CUTS; cut++) {
+            testPowerLeft = round < 64U ? round + (uint32_t) cut : (uint32_t) rand() % 60000U;
+            testPowerDown = 0;
+            while (next < TEST_RECORDS && !testPowerDown) {
+                const uint16_t len = Test_Record(next, data);
+                testAcked[next] = FlashLog_Append(FLASH_LOG_HISTORY_MINUTE, data, len) == HAL_OK;
+                next++;
+            }
+            Test_Reboot(); // 重新上电
+            cuts++;
+            if (!Test_Check(next)) {
+                printf("  round %u, power cut %d: %u written, %u replayed\n", round, cut, next, testReplayedCount);
+                return;
+            }
+        }
+    }
+    printf("flash_log_test: %u rounds, %u power cuts recovered\n", rounds, cuts);
+}
+
+int main(int argc, char **argv) {
+    const uint32_t rounds = argc > 1 ? (uint32_t) strtoul(argv[1], NULL, 10) : TEST_ROUNDS_DEFAULT;
+
+    // 与目标板相同的地址, flash_log.c 直接按 FLASH_LOG_ADDR 读取
+    testFlash = mmap((void *) FLASH_LOG_ADDR, FLASH_LOG_SIZE, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    testReplayed = malloc(sizeof(*testReplayed) * TEST_RECORDS);
+    testAcked = malloc(TEST_RECORDS);
+    if (testFlash != (uint8_t *) FLASH_LOG_ADDR || testReplayed == NULL || testAcked == NULL) {
+        fprintf(stderr, "cannot map the LOG region at 0x%08lx: %s\n", FLASH_LOG_ADDR, strerror(errno));
+        return 1;
+    }
+
+    Test_PowerLoss(rounds);
+
+    if (testFailures != 0) {
+        printf("flash_log_test: %d check(s) failed\n", testFailures);
+        return 1;
+    }
+    printf("flash_log_test: all checks passed\n");
+    return 0;
+}
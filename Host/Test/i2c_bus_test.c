@@ -0,0 +1,539 @@
+/**
+ * @file i2c_bus_test.c
+ * @brief I2C2 传输队列(i2c_bus.c)的主机单元测试
+ *
+ * i2c_bus.c 原样编译, HAL 的 I2C 中断式接口、线程标志、临界区、睡眠屏障和定时器服务任务都换成这里的假实现:
+ * - 假控制器同一时刻只接受一次传输, 由测试调用 Fake_Irq() 模拟完成/错误中断
+ * - 停止条件发出后 BUSY 标志还会保持若干次读取, 用来检查启动前的 BUSY 处理:
+ *   HAL 启动函数不能在 BUSY 置位时被调用(目标板上会原地等待), 在临界区里也不能等 BUSY
+ * - xTimerPendFunctionCall(FromISR) 只记录待执行的函数, 由 Fake_RunTimerTask() 模拟定时器服务任务;
+ *   BUSY 一直不清除时, 每次执行只能读一两次 tick, 不能在定时器服务任务里原地等满 25ms
+ * 检查提交顺序与启动/完成顺序一致、完成状态和通知正确、队列取空时才通知睡眠屏障; 任一检查失败时返回非 0
+ *
+ * 用法: cmake --build build/Host --target i2c_bus_test && ./build/Host/cmake/host/i2c_bus_test
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "i2c_bus.h"
+#include "i2c.h"
+#include "power.h"
+#include "task.h"
+#include "timers.h"
+
+#define FAKE_MAX_STARTS  32U
+#define FAKE_MAX_THREADS 4U
+
+I2C_HandleTypeDef hi2c2;
+I2C_TypeDef SimI2C2;
+
+static int testFailures;
+
+#define CHECK(cond)                                                          \
+    do {                                                                     \
+        if (!(cond)) {                                                       \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);           \
+            testFailures++;                                                  \
+        }                                                                    \
+    } while (0)
+
+// ========================== 假控制器 ==========================
+
+typedef enum {
+    FAKE_TX = 0,
+    FAKE_RX,
+    FAKE_MEM_TX,
+    FAKE_MEM_RX,
+    FAKE_SEQ_FIRST,
+    FAKE_SEQ_LAST,
+} Fake_Kind;
+
+typedef struct {
+    Fake_Kind kind;
+    uint16_t address;
+    uint8_t *data;
+} Fake_Start;
+
+static struct {
+    Fake_Start starts[FAKE_MAX_STARTS];
+    uint32_t startCount;
+    uint8_t active;          // 有传输在进行, 等待 Fake_Irq()
+    Fake_Kind activeKind;
+    uint8_t nack;            // 下一次 Fake_Irq() 报告错误
+    uint32_t stopPolls;      // 停止条件发出后 BUSY 还保持的读取次数
+    uint32_t busyLeft;
+    uint8_t busyStuck;       // 总线卡死, BUSY 一直置位
+    uint32_t busyStarts;     // BUSY 置位时调用了 HAL 启动函数
+    uint32_t criticalNesting;
+    uint32_t criticalBusyPolls; // 在临界区里读取 BUSY 等待
+    uint32_t tick;
+} fakeI2c;
+
+static struct {
+    uint32_t flags[FAKE_MAX_THREADS];
+    uint32_t current;
+} fakeThreads;
+
+static struct {
+    PendedFunction_t function;
+    void *param1;
+    uint32_t param2;
+    uint8_t pending;
+    uint8_t full;            // 定时器命令队列已满
+    uint32_t rejected;
+    uint32_t runs;
+    uint32_t maxTicksPerRun; // 一次执行中 HAL_GetTick() 前进的最大值
+} fakeTimer;
+
+static struct {
+    uint32_t busyCalls;
+    uint32_t idleCalls;
+    uint8_t idleSeenIdle;    // 最后一次通知时 I2CBus_IsIdle() 的结果
+} fakePower;
+
+static void Fake_Reset(void) {
+    memset(&fakeI2c, 0, sizeof(fakeI2c));
+    memset(&fakeThreads, 0, sizeof(fakeThreads));
+    memset(&fakeTimer, 0, sizeof(fakeTimer));
+    memset(&fakePower, 0, sizeof(fakePower));
+    memset(&SimI2C2, 0, sizeof(SimI2C2));
+    memset(&hi2c2, 0, sizeof(hi2c2));
+    hi2c2.Instance = I2C2;
+    hi2c2.State = HAL_I2C_STATE_READY;
+}
+
+static void Fake_UpdateBusy(void) {
+    if (fakeI2c.active || fakeI2c.busyStuck || fakeI2c.busyLeft != 0U) {
+        SimI2C2.SR2 |= I2C_SR2_BUSY;
+    } else {
+        SimI2C2.SR2 &= ~I2C_SR2_BUSY;
+    }
+}
+
+static HAL_StatusTypeDef Fake_StartIt(I2C_HandleTypeDef *hi2c, Fake_Kind kind, uint16_t address, uint8_t *data) {
+    const uint8_t continued = (kind == FAKE_SEQ_LAST);
+
+    // 顺序传输的后续段在总线仍被占用时发出, HAL 不检查 BUSY
+    if (!continued && (SimI2C2.SR2 & I2C_SR2_BUSY) != 0U) {
+        fakeI2c.busyStarts++;
+    }
+    if (hi2c->State != HAL_I2C_STATE_READY || fakeI2c.startCount >= FAKE_MAX_STARTS) {
+        return HAL_BUSY;
+    }
+    fakeI2c.starts[fakeI2c.startCount++] = (Fake_Start) {kind, address, data};
+    fakeI2c.active = 1;
+    fakeI2c.activeKind = kind;
+    hi2c->State = HAL_I2C_STATE_BUSY_TX;
+    Fake_UpdateBusy();
+    return HAL_OK;
+}
+
+/**
+ * @brief 模拟 I2C2 中断: 结束正在进行的传输并调用对应的 HAL 回调
+ */
+static void Fake_Irq(void) {
+    const Fake_Kind kind = fakeI2c.activeKind;
+    const uint8_t nack = fakeI2c.nack;
+
+    if (!fakeI2c.active) {
+        return;
+    }
+    fakeI2c.active = 0;
+    fakeI2c.nack = 0;
+    hi2c2.State = HAL_I2C_STATE_READY;
+    // 顺序传输的第一段结束时没有停止条件, 总线仍被占用
+    if (kind == FAKE_SEQ_FIRST && !nack) {
+        SimI2C2.SR2 |= I2C_SR2_BUSY;
+        HAL_I2C_MasterTxCpltCallback(&hi2c2);
+        return;
+    }
+    fakeI2c.busyLeft = fakeI2c.stopPolls;
+    Fake_UpdateBusy();
+
+    if (nack) {
+        HAL_I2C_ErrorCallback(&hi2c2);
+        return;
+    }
+    switch (kind) {
+        case FAKE_TX:
+        case FAKE_SEQ_LAST:
+            HAL_I2C_MasterTxCpltCallback(&hi2c2);
+            break;
+        case FAKE_RX:
+            HAL_I2C_MasterRxCpltCallback(&hi2c2);
+            break;
+        case FAKE_MEM_TX:
+            HAL_I2C_MemTxCpltCallback(&hi2c2);
+            break;
+        case FAKE_MEM_RX:
+            HAL_I2C_MemRxCpltCallback(&hi2c2);
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief 模拟定时器服务任务执行一个挂起的函数调用
+ */
+static uint8_t Fake_RunTimerTask(void) {
+    if (!fakeTimer.pending) {
+        return 0;
+    }
+    const uint32_t tick = fakeI2c.tick;
+
+    fakeTimer.pending = 0;
+    fakeTimer.runs++;
+    fakeTimer.function(fakeTimer.param1, fakeTimer.param2);
+    if (fakeI2c.tick - tick > fakeTimer.maxTicksPerRun) {
+        fakeTimer.maxTicksPerRun = fakeI2c.tick - tick;
+    }
+    return 1;
+}
+
+/**
+ * @brief 推进到没有进行中的传输和挂起的启动为止
+ */
+static void Fake_Drain(void) {
+    while (fakeI2c.active || fakeTimer.pending) {
+        Fake_Irq();
+        (void) Fake_RunTimerTask();
+    }
+}
+
+// ========================== HAL / RTOS 假实现 ==========================
+
+HAL_StatusTypeDef HAL_I2C_Master_Transmit_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData,
+                                             uint16_t Size) {
+    (void) Size;
+    return Fake_StartIt(hi2c, FAKE_TX, DevAddress, pData);
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Receive_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData,
+                                            uint16_t Size) {
+    (void) Size;
+    return Fake_StartIt(hi2c, FAKE_RX, DevAddress, pData);
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+                                       uint16_t MemAddSize, uint8_t *pData, uint16_t Size) {
+    (void) MemAddress;
+    (void) MemAddSize;
+    (void) Size;
+    return Fake_StartIt(hi2c, FAKE_MEM_TX, DevAddress, pData);
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+                                      uint16_t MemAddSize, uint8_t *pData, uint16_t Size) {
+    (void) MemAddress;
+    (void) MemAddSize;
+    (void) Size;
+    return Fake_StartIt(hi2c, FAKE_MEM_RX, DevAddress, pData);
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Seq_Transmit_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData,
+                                                 uint16_t Size, uint32_t XferOptions) {
+    (void) Size;
+    return Fake_StartIt(hi2c, (XferOptions == I2C_LAST_FRAME) ? FAKE_SEQ_LAST : FAKE_SEQ_FIRST, DevAddress, pData);
+}
+
+HAL_I2C_StateTypeDef HAL_I2C_GetState(I2C_HandleTypeDef *hi2c) {
+    return hi2c->State;
+}
+
+/**
+ * @brief i2c_bus.c 只在 BUSY 推迟启动时读取 tick, 每读一次时间前进 1ms, 停止条件逐步发完
+ */
+uint32_t HAL_GetTick(void) {
+    if (fakeI2c.criticalNesting != 0U) {
+        fakeI2c.criticalBusyPolls++;
+    }
+    if (fakeI2c.busyLeft != 0U) {
+        fakeI2c.busyLeft--;
+        Fake_UpdateBusy();
+    }
+    return fakeI2c.tick++;
+}
+
+void vPortEnterCritical(void) {
+    fakeI2c.criticalNesting++;
+}
+
+void vPortExitCritical(void) {
+    fakeI2c.criticalNesting--;
+}
+
+BaseType_t xTimerPendFunctionCall(PendedFunction_t xFunctionToPend, void *pvParameter1, uint32_t ulParameter2,
+                                  TickType_t xTicksToWait) {
+    // 定时器服务任务里不能等自己的命令队列
+    CHECK(xTicksToWait == 0U);
+    return xTimerPendFunctionCallFromISR(xFunctionToPend, pvParameter1, ulParameter2, NULL);
+}
+
+BaseType_t xTimerPendFunctionCallFromISR(PendedFunction_t xFunctionToPend, void *pvParameter1,
+                                         uint32_t ulParameter2, BaseType_t *pxHigherPriorityTaskWoken) {
+    (void) pxHigherPriorityTaskWoken;
+    if (fakeTimer.full || fakeTimer.pending) {
+        fakeTimer.rejected++;
+        return pdFAIL;
+    }
+    fakeTimer.function = xFunctionToPend;
+    fakeTimer.param1 = pvParameter1;
+    fakeTimer.param2 = ulParameter2;
+    fakeTimer.pending = 1;
+    return pdPASS;
+}
+
+osThreadId_t osThreadGetId(void) {
+    return (osThreadId_t) (uintptr_t) (fakeThreads.current + 1U);
+}
+
+uint32_t osThreadFlagsSet(osThreadId_t thread_id, uint32_t flags) {
+    const uint32_t index = (uint32_t) (uintptr_t) thread_id - 1U;
+
+    if (index < FAKE_MAX_THREADS) {
+        fakeThreads.flags[index] |= flags;
+        return fakeThreads.flags[index];
+    }
+    return osFlagsErrorParameter;
+}
+
+/**
+ * @brief 当前线程挂起等待期间 I2C2 中断和定时器服务任务继续推进
+ */
+uint32_t osThreadFlagsWait(uint32_t flags, uint32_t options, uint32_t timeout) {
+    uint32_t *own = &fakeThreads.flags[fakeThreads.current];
+
+    (void) options;
+    (void) timeout;
+    while ((*own & flags) == 0U && (fakeI2c.active || fakeTimer.pending)) {
+        Fake_Irq();
+        (void) Fake_RunTimerTask();
+    }
+    if ((*own & flags) == 0U) {
+        return osFlagsErrorTimeout;
+    }
+    const uint32_t got = *own & flags;
+    *own &= ~flags;
+    return got;
+}
+
+void Power_Busy(uint32_t bits) {
+    (void) bits;
+    fakePower.busyCalls++;
+}
+
+void Power_IdleFromISR(uint32_t bits, Power_IdleCheck isIdle) {
+    (void) bits;
+    fakePower.idleCalls++;
+    fakePower.idleSeenIdle = isIdle();
+}
+
+// ========================== 测试 ==========================
+
+/**
+ * @brief 两个任务交替提交各类传输, 启动和完成都按提交顺序
+ */
+static void Test_Order(uint32_t stopPolls) {
+    uint8_t buffers[6][4] = {{0}};
+    uint8_t header[1] = {0x40};
+    I2CBus_Transfer transfers[6] = {
+        {.op = I2C_BUS_MEM_READ, .address = 0x70, .data = buffers[0], .len = 4},
+        {.op = I2C_BUS_WRITE, .address = 0x78, .data = buffers[1], .len = 4, .header = header, .headerLen = 1},
+        {.op = I2C_BUS_READ, .address = 0x38, .data = buffers[2], .len = 4},
+        {.op = I2C_BUS_MEM_WRITE, .address = 0xEC, .data = buffers[3], .len = 1},
+        {.op = I2C_BUS_WRITE, .address = 0x70, .data = buffers[4], .len = 2},
+        {.op = I2C_BUS_MEM_READ, .address = 0xEC, .data = buffers[5], .len = 4},
+    };
+    static const Fake_Kind expected[] = {
+        FAKE_MEM_RX, FAKE_SEQ_FIRST, FAKE_SEQ_LAST, FAKE_RX, FAKE_MEM_TX, FAKE_TX, FAKE_MEM_RX,
+    };
+
+    Fake_Reset();
+    fakeI2c.stopPolls = stopPolls;
+    for (uint32_t i = 0; i < 6U; i++) {
+        fakeThreads.current = i & 1U;
+        I2CBus_Submit(&transfers[i]);
+        CHECK(fakeI2c.criticalNesting == 0U);
+    }
+    // 只有第一个已经启动, 其余在队列中等待
+    CHECK(fakeI2c.startCount == 1U);
+    CHECK(!I2CBus_IsIdle());
+
+    for (uint32_t i = 0; i < 6U; i++) {
+        // 完成严格按提交顺序, 前面的完成之前后面的不会完成
+        // 推迟的启动可能重新排队几次, 定时器服务任务把命令队列跑空
+        Fake_Irq();
+        while (Fake_RunTimerTask()) {
+        }
+        if (transfers[i].headerLen != 0U) {
+            CHECK(!transfers[i].done);
+            Fake_Irq();
+            while (Fake_RunTimerTask()) {
+            }
+        }
+        CHECK(transfers[i].done);
+        CHECK(transfers[i].status == HAL_OK);
+        for (uint32_t j = i + 1U; j < 6U; j++) {
+            CHECK(!transfers[j].done);
+        }
+        CHECK(fakePower.idleCalls == ((i == 5U) ? 1U : 0U));
+    }
+    Fake_Drain();
+
+    CHECK(fakeI2c.startCount == sizeof(expected) / sizeof(expected[0]));
+    for (uint32_t i = 0; i < fakeI2c.startCount && i < sizeof(expected) / sizeof(expected[0]); i++) {
+        CHECK(fakeI2c.starts[i].kind == expected[i]);
+    }
+    CHECK(fakeI2c.starts[1].data == header);
+    CHECK(fakeI2c.starts[2].data == buffers[1]);
+    CHECK(fakeThreads.flags[0] != 0U && fakeThreads.flags[1] != 0U);
+    CHECK(fakeI2c.busyStarts == 0U);
+    CHECK(fakeI2c.criticalBusyPolls == 0U);
+    CHECK(fakePower.busyCalls == 6U);
+    CHECK(fakePower.idleSeenIdle);
+    CHECK(I2CBus_IsIdle());
+    // 停止条件拖延时, 中断里的启动全部交给了定时器服务任务
+    if (stopPolls != 0U) {
+        CHECK(fakeTimer.rejected == 0U);
+    }
+}
+
+/**
+ * @brief 上一次传输的停止条件还没发完时提交: 在临界区外等 BUSY 清除后再启动
+ */
+static void Test_SubmitWhileStopPending(void) {
+    uint8_t data[2] = {0};
+    I2CBus_Transfer transfer = {.op = I2C_BUS_WRITE, .address = 0x70, .data = data, .len = 2};
+
+    Fake_Reset();
+    fakeI2c.busyLeft = 3;
+    Fake_UpdateBusy();
+    I2CBus_Submit(&transfer);
+
+    // 提交者不等, 交给定时器服务任务
+    CHECK(fakeI2c.startCount == 0U);
+    CHECK(fakeTimer.pending);
+    CHECK(I2CBus_Wait(&transfer) == HAL_OK);
+    CHECK(fakeI2c.startCount == 1U);
+    CHECK(fakeI2c.busyStarts == 0U);
+    CHECK(fakeI2c.criticalBusyPolls == 0U);
+}
+
+/**
+ * @brief 出错的传输以 HAL_ERROR 结束, 不影响后面的传输
+ */
+static void Test_Error(void) {
+    uint8_t data[3][2] = {{0}};
+    I2CBus_Transfer transfers[3] = {
+        {.op = I2C_BUS_READ, .address = 0x38, .data = data[0], .len = 2},
+        {.op = I2C_BUS_READ, .address = 0x46, .data = data[1], .len = 2},
+        {.op = I2C_BUS_MEM_WRITE, .address = 0xEC, .data = data[2], .len = 1},
+    };
+
+    Fake_Reset();
+    fakeI2c.stopPolls = 2;
+    for (uint32_t i = 0; i < 3U; i++) {
+        I2CBus_Submit(&transfers[i]);
+    }
+    Fake_Irq();
+    (void) Fake_RunTimerTask();
+    fakeI2c.nack = 1;
+    Fake_Drain();
+
+    CHECK(transfers[0].done && transfers[0].status == HAL_OK);
+    CHECK(transfers[1].done && transfers[1].status == HAL_ERROR);
+    CHECK(transfers[2].done && transfers[2].status == HAL_OK);
+    CHECK(fakeI2c.startCount == 3U);
+    CHECK(fakePower.idleCalls == 1U);
+    CHECK(fakeI2c.busyStarts == 0U);
+}
+
+/**
+ * @brief 总线卡死(BUSY 一直置位): 超时后以 HAL_BUSY 结束, 不调用 HAL, 也不会漏掉任何描述符
+ */
+static void Test_BusStuck(void) {
+    uint8_t data[2][2] = {{0}};
+    I2CBus_Transfer transfers[2] = {
+        {.op = I2C_BUS_READ, .address = 0x38, .data = data[0], .len = 2},
+        {.op = I2C_BUS_READ, .address = 0x46, .data = data[1], .len = 2},
+    };
+
+    Fake_Reset();
+    I2CBus_Submit(&transfers[0]);
+    fakeI2c.busyStuck = 1;
+    I2CBus_Submit(&transfers[1]);
+    Fake_Drain();
+
+    CHECK(transfers[0].done && transfers[0].status == HAL_OK);
+    CHECK(transfers[1].done && transfers[1].status == HAL_BUSY);
+    CHECK(fakeI2c.startCount == 1U);
+    CHECK(fakeI2c.busyStarts == 0U);
+    CHECK(fakeI2c.criticalBusyPolls == 0U);
+    CHECK(fakePower.idleCalls == 1U);
+    CHECK(I2CBus_IsIdle());
+    // 25ms 分散在多次执行里, 每次执行之间其他软件定时器可以运行
+    CHECK(fakeTimer.runs > 10U);
+    CHECK(fakeTimer.maxTicksPerRun <= 2U);
+}
+
+/**
+ * @brief 定时器命令队列已满, 中断里无法推迟启动: 以 HAL_BUSY 结束而不是在中断里等 BUSY
+ */
+static void Test_TimerQueueFull(void) {
+    uint8_t data[3][2] = {{0}};
+    I2CBus_Transfer transfers[3] = {
+        {.op = I2C_BUS_READ, .address = 0x38, .data = data[0], .len = 2},
+        {.op = I2C_BUS_READ, .address = 0x46, .data = data[1], .len = 2},
+        {.op = I2C_BUS_READ, .address = 0x70, .data = data[2], .len = 2},
+    };
+
+    Fake_Reset();
+    fakeI2c.stopPolls = 2;
+    for (uint32_t i = 0; i < 3U; i++) {
+        I2CBus_Submit(&transfers[i]);
+    }
+    fakeTimer.full = 1;
+    Fake_Drain();
+
+    CHECK(transfers[0].done && transfers[0].status == HAL_OK);
+    CHECK(transfers[1].done && transfers[1].status == HAL_BUSY);
+    CHECK(transfers[2].done && transfers[2].status == HAL_BUSY);
+    CHECK(fakeTimer.rejected == 2U);
+    CHECK(fakeI2c.busyStarts == 0U);
+    CHECK(fakePower.idleCalls == 1U);
+}
+
+/**
+ * @brief 同步接口: 提交后挂起等待, 返回时传输已完成
+ */
+static void Test_Sync(void) {
+    uint8_t data[4] = {0};
+
+    Fake_Reset();
+    fakeI2c.stopPolls = 1;
+    CHECK(I2CBus_MemRead(0xEC, 0xF7, data, sizeof(data)) == HAL_OK);
+    CHECK(I2CBus_Write(0x70, data, 2) == HAL_OK);
+    CHECK(fakeI2c.startCount == 2U);
+    CHECK(fakeI2c.starts[0].kind == FAKE_MEM_RX && fakeI2c.starts[1].kind == FAKE_TX);
+    CHECK(fakeI2c.busyStarts == 0U);
+    CHECK(I2CBus_IsIdle());
+}
+
+int main(void) {
+    Test_Order(0);
+    Test_Order(3);
+    Test_SubmitWhileStopPending();
+    Test_Error();
+    Test_BusStuck();
+    Test_TimerQueueFull();
+    Test_Sync();
+
+    if (testFailures != 0) {
+        printf("i2c_bus_test: %d check(s) failed\n", testFailures);
+        return 1;
+    }
+    printf("i2c_bus_test: all checks passed\n");
+    return 0;
+}
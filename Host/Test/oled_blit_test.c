@@ -0,0 +1,151 @@
+/**
+ * @file oled_blit_test.c
+ * @brief OLED_SetBlock 按列移位实现的主机单元测试
+ *
+ * oled.c 和 font.c 原样编译, I2C 传输用桩函数代替, 只比较显存。以原来逐字节调用 OLED_SetBits/OLED_SetBits_Fine
+ * 的实现为参照: 所有 ASCII 字体(含只有字模数组的 24x12)的全部字符和 font12x12/font16x16 的全部汉字,
+ * 在 y 的每个取值(覆盖页内偏移 0-7 和底部裁剪)、若干 x(含右侧裁剪)和两种颜色下分别绘制到同一张随机底图上,
+ * 整个显存逐字节比较; 第一个不一致的用例打印出来并返回非 0
+ *
+ * 用法: cmake --build build/Host --target oled_blit_test && ./build/Host/cmake/host/oled_blit_test
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "font.h"
+#include "i2c_bus.h"
+#include "oled.h"
+
+#define TEST_GRAM_SIZE  (8 * 128)
+#define TEST_MAX_GLYPHS 512
+
+extern uint8_t (*OLED_GRAM)[128];
+extern const ASCIIFont afont8x6;
+extern const ASCIIFont afont16x8;
+// font.c 只有 24x12 的字模数组, 没有对应的 ASCIIFont
+extern const unsigned char ascii_24x12[][36];
+static const ASCIIFont testFont24x12 = {24, 12, (unsigned char *) ascii_24x12};
+
+void OLED_SetBits(uint8_t x, uint8_t y, uint8_t data, OLED_ColorMode color);
+void OLED_SetBits_Fine(uint8_t x, uint8_t y, uint8_t data, uint8_t len, OLED_ColorMode color);
+
+// 只比较显存, I2C 传输用桩函数代替
+void I2CBus_Submit(I2CBus_Transfer *transfer) {
+    transfer->status = HAL_OK;
+    transfer->done = 1;
+}
+
+HAL_StatusTypeDef I2CBus_Wait(I2CBus_Transfer *transfer) {
+    return transfer->status;
+}
+
+HAL_StatusTypeDef I2CBus_Write(uint16_t address, uint8_t *data, uint16_t len) {
+    (void) address;
+    (void) data;
+    (void) len;
+    return HAL_OK;
+}
+
+typedef struct {
+    const uint8_t *data;
+    uint8_t w;
+    uint8_t h;
+} Test_Glyph;
+
+static Test_Glyph testGlyphs[TEST_MAX_GLYPHS];
+static uint32_t testGlyphCount;
+
+static void Test_AddAscii(const ASCIIFont *font) {
+    const uint32_t size = (uint32_t) ((font->h + 7) / 8) * font->w;
+    for (uint32_t ch = 0; ch < 95U && testGlyphCount < TEST_MAX_GLYPHS; ch++) {
+        testGlyphs[testGlyphCount++] = (Test_Glyph) {font->chars + ch * size, font->w, font->h};
+    }
+}
+
+static void Test_AddFont(const Font *font) {
+    const uint32_t size = (uint32_t) ((font->h + 7) / 8) * font->w + 4U;
+    for (uint32_t i = 0; i < font->len && testGlyphCount < TEST_MAX_GLYPHS; i++) {
+        testGlyphs[testGlyphCount++] = (Test_Glyph) {font->chars + i * size + 4U, font->w, font->h};
+    }
+}
+
+/**
+ * @brief 参照实现: 每个字节分别调用 OLED_SetBits / OLED_SetBits_Fine
+ */
+static void Test_SetBlockReference(uint8_t x, uint8_t y, const uint8_t *data, uint8_t w, uint8_t h,
+                                   OLED_ColorMode color) {
+    uint8_t fullRow = h / 8;
+    uint8_t partBit = h % 8;
+    for (uint8_t i = 0; i < w; i++) {
+        for (uint8_t j = 0; j < fullRow; j++) {
+            OLED_SetBits(x + i, y + j * 8, data[i + j * w], color);
+        }
+    }
+    if (partBit) {
+        uint16_t fullNum = w * fullRow;
+        for (uint8_t i = 0; i < w; i++) {
+            OLED_SetBits_Fine(x + i, y + (fullRow * 8), data[fullNum + i], partBit, color);
+        }
+    }
+}
+
+/**
+ * @brief 逐像素比较
+ * @return 0: 全部一致; 1: 遇到第一个不一致的用例
+ */
+static int Test_Verify(void) {
+    static const uint8_t xs[] = {0, 1, 61, 120, 122, 127};
+    static uint8_t background[TEST_GRAM_SIZE];
+    static uint8_t expected[TEST_GRAM_SIZE];
+    uint32_t cases = 0;
+
+    srand(1);
+    for (uint32_t i = 0; i < TEST_GRAM_SIZE; i++) {
+        background[i] = (uint8_t) rand();
+    }
+
+    for (uint32_t g = 0; g < testGlyphCount; g++) {
+        const Test_Glyph *glyph = &testGlyphs[g];
+        for (uint32_t xi = 0; xi < sizeof(xs); xi++) {
+            for (uint8_t y = 0; y < 64; y++) {
+                for (int color = OLED_COLOR_NORMAL; color <= OLED_COLOR_REVERSED; color++) {
+                    memcpy(OLED_GRAM, background, TEST_GRAM_SIZE);
+                    Test_SetBlockReference(xs[xi], y, glyph->data, glyph->w, glyph->h, (OLED_ColorMode) color);
+                    memcpy(expected, OLED_GRAM, TEST_GRAM_SIZE);
+
+                    memcpy(OLED_GRAM, background, TEST_GRAM_SIZE);
+                    OLED_SetBlock(xs[xi], y, glyph->data, glyph->w, glyph->h, (OLED_ColorMode) color);
+                    for (uint32_t i = 0; i < TEST_GRAM_SIZE; i++) {
+                        const uint8_t got = ((const uint8_t *) OLED_GRAM)[i];
+                        if (got != expected[i]) {
+                            printf("FAIL glyph %u (%ux%u) at x=%u y=%u color=%d: page %u column %u is 0x%02x, "
+                                   "expected 0x%02x\n",
+                                   g, glyph->w, glyph->h, xs[xi], y, color, i / 128U, i % 128U, got, expected[i]);
+                            return 1;
+                        }
+                    }
+                    cases++;
+                }
+            }
+        }
+    }
+    printf("oled_blit_test: %u glyphs, %u cases match the byte-by-byte path\n", testGlyphCount, cases);
+    return 0;
+}
+
+int main(void) {
+    Test_AddAscii(&afont8x6);
+    Test_AddAscii(&afont12x6);
+    Test_AddAscii(&afont16x8);
+    Test_AddAscii(&testFont24x12);
+    Test_AddFont(&font12x12);
+    Test_AddFont(&font16x16);
+
+    OLED_NewFrame();
+    if (Test_Verify() != 0) {
+        return 1;
+    }
+    printf("oled_blit_test: all checks passed\n");
+    return 0;
+}
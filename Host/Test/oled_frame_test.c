@@ -0,0 +1,359 @@
+/**
+ * @file oled_frame_test.c
+ * @brief OLED_ShowFrame 增量刷新的主机单元测试
+ *
+ * oled.c 和 font.c 原样编译, I2C 传输队列换成这里的假实现, 后面挂一个按页寻址解析指令和数据的屏幕显存模型:
+ * - I2CBus_Submit 只记录描述符, 到 I2CBus_Wait 时才把数据写进屏幕, 与中断接力发送一样;
+ *   这期间继续绘制下一帧, 若驱动改写了还在发送的显存, 屏幕内容就会和提交时不一致
+ * - 按首页、阈值设置页和历史曲线页的画法绘制若干帧, 统计每帧线上字节数
+ * 检查每一帧屏幕内容都与提交时的显存一致、没有变化的帧不访问总线、小改动只发送变化的页和列、
+ * 传输失败后下一帧整屏重发; 任一检查失败时返回非 0
+ *
+ * 用法: cmake --build build/Host --target oled_frame_test && ./build/Host/cmake/host/oled_frame_test
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "font.h"
+#include "i2c_bus.h"
+#include "oled.h"
+
+#define TEST_PAGES        8U
+#define TEST_COLUMNS      128U
+#define TEST_PANEL_COLS   132U  // SH1106 显存 132 列, 屏幕第 0 列对应第 2 列
+#define TEST_COLUMN_SHIFT 2U
+#define TEST_FULL_FRAME   (TEST_PAGES * (7U + TEST_COLUMNS))
+#define TEST_MAX_PENDING  16U
+
+extern uint8_t (*OLED_GRAM)[128];
+
+static int testFailures;
+
+#define CHECK(cond)                                                          \
+    do {                                                                     \
+        if (!(cond)) {                                                       \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);           \
+            testFailures++;                                                  \
+        }                                                                    \
+    } while (0)
+
+// ========================== 屏幕模型 ==========================
+
+static struct {
+    uint8_t gram[TEST_PAGES][TEST_PANEL_COLS];
+    uint8_t page;
+    uint8_t column;
+} panel;
+
+static struct {
+    I2CBus_Transfer *pending[TEST_MAX_PENDING];
+    uint32_t pendingCount;
+    uint32_t bytes;          // 线上字节数(不含地址字节), 与 OLED_Stats.bytes 的口径一致
+    uint32_t submits;
+    uint8_t failNext;        // 下一个提交的描述符以失败结束, 不写入屏幕
+} fakeBus;
+
+/**
+ * @brief 按 SSD1306/SH1106 的控制字节解析一段传输: Co=1 时只跟一个字节, D/C#=1 时是显存数据
+ */
+static void Panel_Parse(const uint8_t *bytes, uint32_t len, uint8_t *control, uint8_t *expectControl) {
+    for (uint32_t i = 0; i < len; i++) {
+        const uint8_t byte = bytes[i];
+        if (*expectControl) {
+            *control = byte;
+            *expectControl = 0;
+            continue;
+        }
+        if ((*control & 0x40U) != 0U) {
+            if (panel.page < TEST_PAGES && panel.column < TEST_PANEL_COLS) {
+                panel.gram[panel.page][panel.column] = byte;
+            }
+            panel.column++;
+        } else if (byte >= 0xB0U && byte <= 0xB7U) {
+            panel.page = byte - 0xB0U;
+        } else if (byte <= 0x0FU) {
+            panel.column = (uint8_t) ((panel.column & 0xF0U) | byte);
+        } else if (byte <= 0x1FU) {
+            panel.column = (uint8_t) ((panel.column & 0x0FU) | ((byte & 0x0FU) << 4));
+        }
+        if ((*control & 0x80U) != 0U) {
+            *expectControl = 1;
+        }
+    }
+}
+
+static void Panel_Write(const uint8_t *header, uint16_t headerLen, const uint8_t *data, uint16_t len) {
+    uint8_t control = 0;
+    uint8_t expectControl = 1;
+
+    Panel_Parse(header, headerLen, &control, &expectControl);
+    Panel_Parse(data, len, &control, &expectControl);
+}
+
+/**
+ * @brief 屏幕上可见的 128 列是否与 image 一致
+ */
+static uint8_t Panel_Matches(const uint8_t image[TEST_PAGES][TEST_COLUMNS]) {
+    for (uint32_t page = 0; page < TEST_PAGES; page++) {
+        if (memcmp(&panel.gram[page][TEST_COLUMN_SHIFT], image[page], TEST_COLUMNS) != 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// ========================== I2C 传输队列假实现 ==========================
+
+void I2CBus_Submit(I2CBus_Transfer *transfer) {
+    transfer->status = HAL_BUSY;
+    transfer->done = 0;
+    if (fakeBus.pendingCount < TEST_MAX_PENDING) {
+        fakeBus.pending[fakeBus.pendingCount++] = transfer;
+    }
+    fakeBus.submits++;
+    fakeBus.bytes += transfer->headerLen + transfer->len;
+}
+
+/**
+ * @brief 按提交顺序完成到 transfer 为止的所有描述符
+ */
+HAL_StatusTypeDef I2CBus_Wait(I2CBus_Transfer *transfer) {
+    while (!transfer->done && fakeBus.pendingCount != 0U) {
+        I2CBus_Transfer *head = fakeBus.pending[0];
+
+        memmove(&fakeBus.pending[0], &fakeBus.pending[1], (fakeBus.pendingCount - 1U) * sizeof(fakeBus.pending[0]));
+        fakeBus.pendingCount--;
+        if (fakeBus.failNext) {
+            fakeBus.failNext = 0;
+            head->status = HAL_ERROR;
+        } else {
+            Panel_Write(head->header, head->headerLen, head->data, head->len);
+            head->status = HAL_OK;
+        }
+        head->done = 1;
+    }
+    return transfer->status;
+}
+
+HAL_StatusTypeDef I2CBus_Write(uint16_t address, uint8_t *data, uint16_t len) {
+    (void) address;
+    fakeBus.bytes += len;
+    Panel_Write(NULL, 0, data, len);
+    return HAL_OK;
+}
+
+static void Fake_Flush(void) {
+    if (fakeBus.pendingCount != 0U) {
+        (void) I2CBus_Wait(fakeBus.pending[fakeBus.pendingCount - 1U]);
+    }
+}
+
+// ========================== 帧统计 ==========================
+
+typedef struct {
+    const char *name;
+    uint32_t frames;
+    uint32_t skipped;
+    uint32_t bytes;
+    uint32_t maxBytes;
+} Test_PageStats;
+
+// 最近一次提交的显存内容, 下一次 OLED_ShowFrame 等待发送完成后屏幕应与它一致
+static uint8_t expectedFrame[TEST_PAGES][TEST_COLUMNS];
+
+/**
+ * @brief 提交当前显存并检查: 上一帧已完整写到屏幕, 本帧的字节数与驱动统计一致
+ * @return 本帧的线上字节数
+ */
+static uint32_t Test_Show(Test_PageStats *stats) {
+    uint8_t submitted[TEST_PAGES][TEST_COLUMNS];
+    const uint32_t bytesBefore = fakeBus.bytes;
+    const uint32_t statsBefore = OLED_Stats.bytes;
+    const uint32_t skippedBefore = OLED_Stats.skippedFrames;
+
+    memcpy(submitted, OLED_GRAM, sizeof(submitted));
+    OLED_ShowFrame();
+    // 等待上一帧时才写入屏幕, 这期间绘制本帧不能破坏上一帧
+    CHECK(Panel_Matches(expectedFrame));
+    memcpy(expectedFrame, submitted, sizeof(expectedFrame));
+
+    const uint32_t bytes = fakeBus.bytes - bytesBefore;
+    CHECK(OLED_Stats.bytes - statsBefore == bytes);
+    CHECK((OLED_Stats.skippedFrames != skippedBefore) == (bytes == 0U));
+    if (stats != NULL) {
+        stats->frames++;
+        stats->skipped += (bytes == 0U) ? 1U : 0U;
+        stats->bytes += bytes;
+        if (bytes > stats->maxBytes) {
+            stats->maxBytes = bytes;
+        }
+    }
+    return bytes;
+}
+
+static void Test_Print(const Test_PageStats *stats) {
+    printf("oled_frame_test: %-8s %3lu frames, %3lu skipped, %4lu bytes avg / %4lu max per frame (full frame %u)\n",
+           stats->name, (unsigned long) stats->frames, (unsigned long) stats->skipped,
+           (unsigned long) (stats->frames ? stats->bytes / stats->frames : 0U), (unsigned long) stats->maxBytes,
+           TEST_FULL_FRAME);
+}
+
+// ========================== 各页面 ==========================
+
+OLED_LAYER(homeLayer, 0, 7);
+OLED_LAYER(rangeLayer, 0, 2);
+
+static void drawHomeLayer(void) {
+    OLED_PrintASCIIString(30, 0, " Smart Farm ", &afont12x6, OLED_COLOR_REVERSED);
+    OLED_PrintString(9, 15, "温度", &font12x12, OLED_COLOR_NORMAL);
+    OLED_PrintString(52, 15, "湿度", &font12x12, OLED_COLOR_NORMAL);
+    OLED_PrintString(95, 15, "光照", &font12x12, OLED_COLOR_NORMAL);
+    OLED_PrintString(9, 42, "土壤", &font12x12, OLED_COLOR_NORMAL);
+    OLED_PrintString(52, 42, "降雨", &font12x12, OLED_COLOR_NORMAL);
+    OLED_PrintString(95, 42, "水泵", &font12x12, OLED_COLOR_NORMAL);
+}
+
+static void drawRangeLayer(void) {
+    OLED_PrintString(25, 0, " 报警阈值(1/2) ", &font12x12, OLED_COLOR_REVERSED);
+}
+
+/**
+ * @brief 首页: 每秒只有温度末位变化, 其余帧与上一帧相同
+ */
+static void Test_Home(void) {
+    Test_PageStats stats = {.name = "home"};
+    char text[16];
+
+    for (uint32_t frame = 0; frame < 100U; frame++) {
+        const uint32_t tenths = 235U + frame / 10U;
+
+        OLED_NewFrameWithLayer(&homeLayer, drawHomeLayer);
+        snprintf(text, sizeof(text), "%lu.%luC", (unsigned long) (tenths / 10U), (unsigned long) (tenths % 10U));
+        OLED_PrintString(6, 26, text, &font12x12, OLED_COLOR_NORMAL);
+        OLED_PrintString(52, 26, "61%", &font12x12, OLED_COLOR_NORMAL);
+        OLED_PrintString(92, 26, "420lx", &font12x12, OLED_COLOR_NORMAL);
+        OLED_PrintString(12, 52, "35%", &font12x12, OLED_COLOR_NORMAL);
+        OLED_PrintString(55, 52, "0%", &font12x12, OLED_COLOR_NORMAL);
+        OLED_PrintString(101, 52, "关", &font12x12, OLED_COLOR_NORMAL);
+
+        const uint32_t bytes = Test_Show(&stats);
+        if (frame == 0U) {
+            CHECK(bytes > 0U && bytes < TEST_FULL_FRAME);
+        } else if (frame % 10U != 0U) {
+            CHECK(bytes == 0U);
+        } else {
+            // 温度数字在第 3、4 页, 每页只发送变化的那几列
+            CHECK(bytes > 0U && bytes <= 2U * (7U + 12U));
+        }
+    }
+    Test_Print(&stats);
+}
+
+/**
+ * @brief 阈值设置页: 光标下划线每 5 帧闪烁一次
+ */
+static void Test_Range(void) {
+    Test_PageStats stats = {.name = "range"};
+
+    for (uint32_t frame = 0; frame < 40U; frame++) {
+        OLED_NewFrameWithLayer(&rangeLayer, drawRangeLayer);
+        OLED_PrintString(10, 16, "温度 10-35", &font12x12, OLED_COLOR_NORMAL);
+        OLED_PrintString(10, 30, "湿度 30-80", &font12x12, OLED_COLOR_NORMAL);
+        OLED_PrintString(10, 44, "光照 100-900", &font12x12, OLED_COLOR_NORMAL);
+        if ((frame / 5U) % 2U == 0U) {
+            OLED_DrawLine(40, 28, 52, 28, OLED_COLOR_NORMAL);
+        }
+
+        const uint32_t bytes = Test_Show(&stats);
+        if (frame != 0U && frame % 5U == 0U) {
+            // 下划线在第 3 页的 13 列
+            CHECK(bytes == 7U + 13U);
+        } else if (frame != 0U) {
+            CHECK(bytes == 0U);
+        }
+    }
+    Test_Print(&stats);
+}
+
+/**
+ * @brief 历史曲线页: 每帧曲线左移一列, 整个绘图区都在变化
+ */
+static void Test_History(void) {
+    Test_PageStats stats = {.name = "history"};
+
+    for (uint32_t frame = 0; frame < 40U; frame++) {
+        uint8_t lastY = 0;
+
+        OLED_NewFrame();
+        OLED_PrintASCIIString(0, 0, "T 24h", &afont12x6, OLED_COLOR_NORMAL);
+        for (uint8_t x = 0; x < 100U; x++) {
+            const uint32_t phase = (x + frame) % 32U;
+            const uint8_t y = (uint8_t) (20U + ((phase < 16U) ? phase : 32U - phase) * 2U);
+            if (x == 0U) {
+                OLED_SetPixel(x + 28U, y, OLED_COLOR_NORMAL);
+            } else {
+                OLED_DrawLine(x + 27U, lastY, x + 28U, y, OLED_COLOR_NORMAL);
+            }
+            lastY = y;
+        }
+
+        const uint32_t bytes = Test_Show(&stats);
+        // 第一帧之后标题所在的第 0、1 页不变, 曲线只在第 2-6 页的 100 列内
+        if (frame != 0U) {
+            CHECK(bytes > 0U && bytes <= 5U * (7U + 100U));
+        }
+    }
+    Test_Print(&stats);
+}
+
+static void drawError(void) {
+    OLED_NewFrame();
+    OLED_PrintString(10, 20, "ERROR", &font12x12, OLED_COLOR_NORMAL);
+}
+
+/**
+ * @brief 传输失败后屏幕内容未知, 下一帧即使没有变化也整屏重发
+ */
+static void Test_Failure(void) {
+    // 先让上一帧发完, 这一帧的第一页发送失败, 屏幕与显存不一致
+    Fake_Flush();
+    drawError();
+    fakeBus.failNext = 1;
+    OLED_ShowFrame();
+    Fake_Flush();
+    CHECK(fakeBus.failNext == 0U);
+
+    // 同样的内容: 驱动在等待时得知失败, 整屏重发
+    drawError();
+    memcpy(expectedFrame, OLED_GRAM, sizeof(expectedFrame));
+    const uint32_t bytesBefore = fakeBus.bytes;
+    OLED_ShowFrame();
+    CHECK(fakeBus.bytes - bytesBefore == TEST_FULL_FRAME);
+
+    // 重发完成后屏幕恢复一致, 之后没有变化的帧又不访问总线
+    drawError();
+    CHECK(Test_Show(NULL) == 0U);
+}
+
+int main(void) {
+    OLED_Init();
+    Fake_Flush();
+    // 初始化时整屏清零
+    CHECK(Panel_Matches(expectedFrame));
+    CHECK(OLED_Stats.bytes == TEST_FULL_FRAME);
+
+    Test_Home();
+    Test_Range();
+    Test_History();
+    Test_Failure();
+
+    Fake_Flush();
+    CHECK(Panel_Matches(expectedFrame));
+
+    if (testFailures != 0) {
+        printf("oled_frame_test: %d check(s) failed\n", testFailures);
+        return 1;
+    }
+    printf("oled_frame_test: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,87 @@
+/**
+ * @file telemetry_decode.c
+ * @brief 蓝牙二进制帧(telemetry.h)的主机端解码工具
+ *
+ * 从文件或标准输入读取蓝牙模块收到的原始字节, 按 0x00 分帧, 每个正确的帧输出一行 JSON(与 JSON 模式的格式相同),
+ * 损坏的帧(截断、CRC 不对、未知类型)在标准错误上报告后跳过, 从下一个 0x00 继续。结束时在标准错误上输出统计。
+ *
+ * 解码使用与固件相同的 Core/App/global/telemetry.c, 构建为静态库 telemetry, 主机上的应用可以直接链接:
+ * Telemetry_DecodeFrame() 解一帧, Telemetry_FormatJson() 转成文本
+ *
+ * 用法: cmake --build build/Host --target telemetry_decode
+ *       ./build/Host/cmake/host/telemetry_decode ble.bin
+ *       stty -F /dev/ttyUSB0 9600 raw && ./build/Host/cmake/host/telemetry_decode < /dev/ttyUSB0
+ *       SIM_BLE_FILE=ble.bin ./build/Host/cmake/host/SmartFramZET6_host   (主机仿真的蓝牙输出)
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "telemetry.h"
+
+static const char *const decodeError[] = {
+    [TELEMETRY_OK] = "ok",
+    [TELEMETRY_ERROR_COBS] = "bad COBS encoding",
+    [TELEMETRY_ERROR_CRC] = "CRC mismatch",
+    [TELEMETRY_ERROR_LENGTH] = "bad length",
+    [TELEMETRY_ERROR_TYPE] = "unknown type",
+};
+
+int main(int argc, char **argv) {
+    FILE *input = stdin;
+    uint8_t frame[TELEMETRY_FRAME_MAX];
+    uint32_t len = 0;
+    uint8_t overflow = 0;
+    unsigned long bytes = 0;
+    unsigned long good = 0;
+    unsigned long bad = 0;
+    int c;
+
+    if (argc > 2 || (argc == 2 && strcmp(argv[1], "-h") == 0)) {
+        fprintf(stderr, "usage: %s [file]   (reads stdin without a file)\n", argv[0]);
+        return 2;
+    }
+    if (argc == 2 && (input = fopen(argv[1], "rb")) == NULL) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    while ((c = fgetc(input)) != EOF) {
+        bytes++;
+        if (c != TELEMETRY_DELIMITER) {
+            if (len < sizeof(frame)) {
+                frame[len++] = (uint8_t) c;
+            } else {
+                overflow = 1;
+            }
+            continue;
+        }
+        // 连续的分隔符(例如接收端刚上电时)不算帧
+        if (len == 0U && !overflow) {
+            continue;
+        }
+
+        Telemetry_Message msg;
+        const Telemetry_Status status =
+            overflow ? TELEMETRY_ERROR_LENGTH : Telemetry_DecodeFrame(frame, (uint16_t) len, &msg);
+        if (status == TELEMETRY_OK) {
+            char text[TELEMETRY_JSON_MAX];
+            fwrite(text, 1, Telemetry_FormatJson(&msg, text, sizeof(text)), stdout);
+            fflush(stdout);
+            good++;
+        } else {
+            fprintf(stderr, "frame ending at byte %lu: %s\n", bytes, decodeError[status]);
+            bad++;
+        }
+        len = 0;
+        overflow = 0;
+    }
+    if (len != 0U) {
+        fprintf(stderr, "%u trailing bytes without a delimiter\n", (unsigned) len);
+    }
+
+    fprintf(stderr, "%lu bytes, %lu frames decoded, %lu bad frames\n", bytes, good, bad);
+    if (input != stdin) {
+        fclose(input);
+    }
+    return bad == 0U ? 0 : 1;
+}
@@ -0,0 +1,82 @@
+#
+# Glyph index generator for the CJK fonts in Core/BSP/oled/font.c
+#
+# Usage: cmake -DFONT_SOURCE=<font.c> -DFONT_INDEX=<font_index.h> -P font_index.cmake
+#
+# Every "const uint8_t zhHxW[][N] = {" table in font.c holds one glyph per row, the first 4 bytes being the
+# UTF-8 code of the character padded with 0x00. For each table this script emits
+#     static const uint16_t zhHxW_index[] = { ... };
+# listing the row numbers ordered by those 4 bytes. Byte order of UTF-8 equals code point order, so
+# OLED_FindGlyph() can binary search the table through the index without reordering the generated glyph data.
+# Empty tables get a NULL index.
+#
+if(NOT FONT_SOURCE OR NOT FONT_INDEX)
+    message(FATAL_ERROR "font_index.cmake: FONT_SOURCE and FONT_INDEX must be set")
+endif()
+
+file(STRINGS ${FONT_SOURCE} font_lines)
+
+set(tables)
+set(current "")
+foreach(line IN LISTS font_lines)
+    if(line MATCHES "const[ \t]+uint8_t[ \t]+(zh[0-9]+x[0-9]+)[ \t]*\\[\\]")
+        set(current ${CMAKE_MATCH_1})
+        list(APPEND tables ${current})
+        set(${current}_rows 0)
+        set(${current}_keys)
+    elseif(current AND line MATCHES "^[ \t]*}")
+        set(current "")
+    elseif(current AND line MATCHES "{[ \t]*0[xX]([0-9a-fA-F]+)[ \t]*,[ \t]*0[xX]([0-9a-fA-F]+)[ \t]*,[ \t]*0[xX]([0-9a-fA-F]+)[ \t]*,[ \t]*0[xX]([0-9a-fA-F]+)")
+        # Key: the 4 header bytes as fixed width hex, so that string order equals byte order
+        set(key "")
+        foreach(i 1 2 3 4)
+            string(TOLOWER "${CMAKE_MATCH_${i}}" byte)
+            string(LENGTH "${byte}" byte_len)
+            if(byte_len EQUAL 1)
+                set(byte "0${byte}")
+            endif()
+            string(APPEND key "${byte}")
+        endforeach()
+        math(EXPR row "${${current}_rows}")
+        string(LENGTH "${row}" row_len)
+        math(EXPR pad "5 - ${row_len}")
+        string(REPEAT "0" ${pad} row_pad)
+        list(APPEND ${current}_keys "${key}:${row_pad}${row}:${row}")
+        math(EXPR ${current}_rows "${${current}_rows} + 1")
+    endif()
+endforeach()
+
+set(out "// Generated by cmake/font_index.cmake from font.c, do not edit\n")
+string(APPEND out "#ifndef SMARTFARM_FONT_INDEX_H\n#define SMARTFARM_FONT_INDEX_H\n\n#include <stdint.h>\n")
+foreach(table IN LISTS tables)
+    string(APPEND out "\n// ${table}: ${${table}_rows} glyphs, row numbers in UTF-8 order\n")
+    if(${table}_rows EQUAL 0)
+        string(APPEND out "#define ${table}_index ((const uint16_t *) 0)\n")
+        continue()
+    endif()
+
+    list(SORT ${table}_keys)
+    set(previous "")
+    set(rows)
+    foreach(entry IN LISTS ${table}_keys)
+        string(REPLACE ":" ";" fields "${entry}")
+        list(GET fields 0 key)
+        list(GET fields 2 row)
+        if(key STREQUAL previous)
+            message(FATAL_ERROR "font_index.cmake: ${table} row ${row} duplicates the character 0x${key}")
+        endif()
+        set(previous ${key})
+        list(APPEND rows ${row})
+    endforeach()
+    list(JOIN rows ", " rows)
+    string(APPEND out "static const uint16_t ${table}_index[] = {${rows}};\n")
+endforeach()
+string(APPEND out "\n#endif // SMARTFARM_FONT_INDEX_H\n")
+
+# Only touch the header when it changes, so font.c is not rebuilt needlessly
+if(EXISTS ${FONT_INDEX})
+    file(READ ${FONT_INDEX} previous_out)
+endif()
+if(NOT previous_out STREQUAL out)
+    file(WRITE ${FONT_INDEX} "${out}")
+endif()